@@ -1,14 +1,221 @@
 // Copyright 2025 MarketSystem
 #include "AdminService.h"
+#include "AuditLog.h"
+#include "AuthService.h"
+#include "ChangeNotifier.h"
+#include "Metrics.h"
+#include "ShardRouter.h"
+#include "UserCache.h"
+#include <QStringList>
+#include <QSqlRecord>
+#include <QHash>
+#include <QMap>
 #include <QDebug>
+#include <algorithm>
+#include <queue>
+#include <vector>
+
+namespace {
+struct AdminMetrics {
+    Metrics::Counter& bans;
+    Metrics::Counter& unbans;
+    Metrics::Counter& moderationErrors;
+    Metrics::Counter& reportsResolved;
+    Metrics::Histogram& listSeconds;
+    Metrics::Histogram& searchSeconds;
+};
+
+AdminMetrics& adminMetrics() {
+    static Metrics& metrics = Metrics::getInstance();
+    static const QString changes = "market_moderation_changes_total";
+    static const QString changesHelp = "Users banned or unbanned, bulk moderation included.";
+    static const QString listing = "market_admin_listing_seconds";
+    static const QString listingHelp = "Latency of user listing and search pages.";
+    static AdminMetrics instance{
+        metrics.counter(changes, changesHelp, "action=\"ban\""),
+        metrics.counter(changes, changesHelp, "action=\"unban\""),
+        metrics.counter("market_moderation_errors_total", "Ban or unban updates that failed in the database."),
+        metrics.counter("market_reports_resolved_total", "Reports resolved or rejected."),
+        metrics.histogram(listing, listingHelp, Metrics::latencyBounds(), "kind=\"list\""),
+        metrics.histogram(listing, listingHelp, Metrics::latencyBounds(), "kind=\"search\"")};
+    return instance;
+}
+
+// Ids per "id IN (...)" statement, well below SQLite's bound-parameter limit.
+const int kIdChunk = 500;
+
+// Columns: id, phone, username, created_at, is_admin, is_banned
+User userFromRow(const QSqlQuery& row) {
+    return User(
+        row.value(0).toInt(),
+        row.value(1).toString(),
+        "",  // Password not returned
+        row.value(2).toString(),
+        row.value(3).toDateTime(),
+        row.value(4).toBool(),
+        row.value(5).toBool());
+}
+
+QString idPlaceholders(const QVariantList& ids) {
+    QStringList placeholders;
+    placeholders.reserve(ids.size());
+    for (int i = 0; i < ids.size(); ++i) {
+        placeholders.append("?");
+    }
+    return "(" + placeholders.join(", ") + ")";
+}
+
+// K-way merge of one page per shard, each sorted like the listing: by
+// (created_at, id) descending, or by id ascending for search pages. Keeps
+// the first limit rows after skipping skip; the next page starts after the
+// last of them.
+UserListResult mergeUserPages(std::vector<UserListResult>* pages, int limit, bool newestFirst,
+                              qint64 skip = 0) {
+    UserListResult merged;
+    struct Head {
+        int page;
+        int row;
+    };
+    // True if a is listed after b; the queue's top is the next row
+    auto listedAfter = [pages, newestFirst](const Head& a, const Head& b) {
+        const UserTable& left = (*pages)[a.page].users;
+        const UserTable& right = (*pages)[b.page].users;
+        if (!newestFirst) {
+            return left.id(a.row) > right.id(b.row);
+        }
+        if (left.createdAtSecs(a.row) != right.createdAtSecs(b.row)) {
+            return left.createdAtSecs(a.row) < right.createdAtSecs(b.row);
+        }
+        return left.id(a.row) < right.id(b.row);
+    };
+    std::priority_queue<Head, std::vector<Head>, decltype(listedAfter)> heads(listedAfter);
+    for (int page = 0; page < static_cast<int>(pages->size()); ++page) {
+        if (!(*pages)[page].ok) {
+            return merged;
+        }
+        if (!(*pages)[page].users.isEmpty()) {
+            heads.push(Head{page, 0});
+        }
+    }
+
+    merged.users.reserve(limit);
+    while (!heads.empty() && merged.users.size() < limit) {
+        Head head = heads.top();
+        heads.pop();
+        const UserTable& table = (*pages)[head.page].users;
+        if (skip > 0) {
+            --skip;
+        } else {
+            merged.users.append(table.id(head.row), table.phone(head.row), table.username(head.row),
+                                table.createdAtSecs(head.row), table.isAdmin(head.row), table.isBanned(head.row));
+        }
+        if (head.row + 1 < table.size()) {
+            heads.push(Head{head.page, head.row + 1});
+        }
+    }
+
+    int count = merged.users.size();
+    if (count > 0) {
+        merged.next.createdAtSecs = merged.users.createdAtSecs(count - 1);
+        merged.next.id = merged.users.id(count - 1);
+    }
+    merged.ok = true;
+    return merged;
+}
+
+// Same for report pages, newest first. A report lives with the reported
+// user, so its reporter's name may be on another shard; names the shard
+// could not join are looked up afterwards, one query per shard.
+QPair<bool, QList<Report>> mergeReportPages(const std::vector<QPair<bool, QList<Report>>>& pages, int limit,
+                                            qint64 skip = 0) {
+    struct Head {
+        int page;
+        int row;
+    };
+    auto listedAfter = [&pages](const Head& a, const Head& b) {
+        const Report& left = pages[a.page].second[a.row];
+        const Report& right = pages[b.page].second[b.row];
+        qint64 leftSecs = left.getCreatedAt().toSecsSinceEpoch();
+        qint64 rightSecs = right.getCreatedAt().toSecsSinceEpoch();
+        if (leftSecs != rightSecs) {
+            return leftSecs < rightSecs;
+        }
+        return left.getId() < right.getId();
+    };
+    std::priority_queue<Head, std::vector<Head>, decltype(listedAfter)> heads(listedAfter);
+    for (int page = 0; page < static_cast<int>(pages.size()); ++page) {
+        if (!pages[page].first) {
+            return qMakePair(false, QList<Report>());
+        }
+        if (!pages[page].second.isEmpty()) {
+            heads.push(Head{page, 0});
+        }
+    }
+
+    QList<Report> merged;
+    merged.reserve(limit);
+    while (!heads.empty() && merged.size() < limit) {
+        Head head = heads.top();
+        heads.pop();
+        if (skip > 0) {
+            --skip;
+        } else {
+            merged.append(pages[head.page].second[head.row]);
+        }
+        if (head.row + 1 < pages[head.page].second.size()) {
+            heads.push(Head{head.page, head.row + 1});
+        }
+    }
+
+    ShardRouter& shards = ShardRouter::getInstance();
+    QMap<int, QVariantList> missing;
+    for (const Report& report : merged) {
+        if (report.getReporterName().isEmpty()) {
+            missing[shards.shardForId(report.getReporterId())].append(report.getReporterId());
+        }
+    }
+    QHash<int, QString> names;
+    for (auto it = missing.cbegin(); it != missing.cend(); ++it) {
+        QSqlQuery result = shards.executeQueryWithResult(
+            it.key(), "SELECT id, username FROM users WHERE id IN " + idPlaceholders(it.value()), it.value(), true);
+        while (result.next()) {
+            names.insert(result.value(0).toInt(), result.value(1).toString());
+        }
+    }
+    if (!names.isEmpty()) {
+        for (Report& report : merged) {
+            if (report.getReporterName().isEmpty() && names.contains(report.getReporterId())) {
+                report = Report(report.getId(), report.getReporterId(), names.value(report.getReporterId()),
+                                report.getReportedUserId(), report.getReportedName(), report.getReason(),
+                                report.getStatus(), report.getCreatedAt(), report.getResolvedAt(),
+                                report.getClaimedBy());
+            }
+        }
+    }
+    return qMakePair(true, merged);
+}
+
+// The rows of a listing as User values, for the QList-based callers.
+QPair<bool, QList<User>> usersFromListing(const UserListResult& listing) {
+    QList<User> users;
+    users.reserve(listing.users.size());
+    for (int row = 0; row < listing.users.size(); ++row) {
+        users.append(listing.users.at(row));
+    }
+    return qMakePair(listing.ok, users);
+}
+}  // namespace
 
 DatabaseManager& AdminService::getDatabase() {
     return DatabaseManager::getInstance();
 }
 
 QPair<bool, QList<User>> AdminService::getAllUsers(int page, int pageSize) {
+    if (ShardRouter::getInstance().isEnabled()) {
+        return usersFromListing(listUserPage(false, page, pageSize));
+    }
     DatabaseManager& db = getDatabase();
-    int offset = page * pageSize;
+    qint64 offset = static_cast<qint64>(page) * pageSize;
 
     QString query = "SELECT id, phone, username, created_at, "
     "is_admin, is_banned FROM users ORDER BY created_at DESC LIMIT ? OFFSET ?";
@@ -36,58 +243,360 @@ QPair<bool, QList<User>> AdminService::getAllUsers(int page, int pageSize) {
     return qMakePair(true, users);
 }
 
-QPair<bool, QString> AdminService::banUser(int userId, const QString& reason) {
-    Q_UNUSED(reason);
-    DatabaseManager& db = getDatabase();
+UserListResult AdminService::fetchUserTable(const QString& query, const QVariantList& params,
+                                            int expectedRows, int shard) {
+    UserListResult listing;
+    QSqlQuery result = shard < 0 ? getDatabase().executeQueryWithResult(query, params, true)
+                                 : ShardRouter::getInstance().executeQueryWithResult(shard, query, params, true);
 
-    // First check if user exists and isn't already banned
-    QString checkQuery = "SELECT is_banned FROM users WHERE id = ?";
-    QSqlQuery checkResult = db.executeQueryWithResult(checkQuery, {userId});
+    if (result.lastError().isValid()) {
+        qWarning() << "Error fetching users:" << result.lastError().text();
+        return listing;
+    }
 
-    if (!checkResult.next()) {
-        return qMakePair(false, "User not found");
+    listing.users.reserve(expectedRows);
+    while (result.next()) {
+        listing.users.append(
+            result.value(0).toInt(),
+            result.value(1).toString(),
+            result.value(2).toString(),
+            result.value(3).toLongLong(),
+            result.value(4).toBool(),
+            result.value(5).toBool());
     }
 
-    if (checkResult.value(0).toBool()) {
-        return qMakePair(false, "User is already banned");
+    int count = listing.users.size();
+    if (count > 0) {
+        listing.next.createdAtSecs = listing.users.createdAtSecs(count - 1);
+        listing.next.id = listing.users.id(count - 1);
+        if (result.record().count() > 6) {
+            listing.next.rank = result.value(6).toInt();
+        }
     }
 
-    // Update user to banned
-    QString updateQuery = "UPDATE users SET is_banned = 1 WHERE id = ?";
-    if (db.executeQuery(updateQuery, {userId})) {
-        return qMakePair(true, "User banned successfully");
+    listing.ok = true;
+    return listing;
+}
+
+UserListResult AdminService::listUsers(int page, int pageSize) {
+    return listUserPage(false, page, pageSize);
+}
+
+UserListResult AdminService::listBannedUsers(int page, int pageSize) {
+    return listUserPage(true, page, pageSize);
+}
+
+UserListResult AdminService::listUserPage(bool bannedOnly, int page, int pageSize) {
+    QString query = "SELECT id, phone, username, CAST(strftime('%s', created_at) AS INTEGER), "
+        "is_admin, is_banned FROM users ";
+    if (bannedOnly) {
+        query += "WHERE is_banned = 1 ";
+    }
+    qint64 offset = static_cast<qint64>(page) * pageSize;
+
+    ShardRouter& shards = ShardRouter::getInstance();
+    if (shards.isEnabled()) {
+        // A shard cannot skip rows for the others: each returns its first
+        // offset + pageSize and the merge drops the first offset of those.
+        // Deep pages cost that much per shard; listUsersAfter() does not.
+        query += "ORDER BY created_at DESC, id DESC LIMIT ?";
+        qint64 rows = offset + pageSize;
+        std::vector<UserListResult> pages(shards.shardCount());
+        shards.forEachShard([&](int shard) { pages[shard] = fetchUserTable(query, {rows}, pageSize, shard); });
+        return mergeUserPages(&pages, pageSize, true, offset);
+    }
+    query += "ORDER BY created_at DESC LIMIT ? OFFSET ?";
+    return fetchUserTable(query, {pageSize, offset}, pageSize);
+}
+
+bool AdminService::updateBanFlag(int userId, bool banned, QString* error) {
+    // Flip the flag only if it still has the old value, so two concurrent
+    // bans cannot both report success. RETURNING hands back the updated row
+    // for views to patch without a second query.
+    QString query = "UPDATE users SET is_banned = ? WHERE id = ? AND is_banned = ? "
+        "RETURNING id, phone, username, created_at, is_admin, is_banned";
+    UserCache::ServiceWrite write;
+    QSqlQuery result = ShardRouter::getInstance().executeForId(userId, query,
+                                                              {banned ? 1 : 0, userId, banned ? 0 : 1});
+    if (!result.isActive()) {
+        *error = result.lastError().text();
+        return false;
+    }
+    if (!result.next()) {
+        // Already in that state, so a cached row saying otherwise is stale
+        result.finish();
+        UserCache::getInstance().invalidate(userId);
+        return false;
     }
 
-    return qMakePair(false, "Failed to ban user: " + db.getLastError());
+    User user = userFromRow(result);
+    // The autocommit transaction ends when the statement is reset
+    result.finish();
+    UserCache::getInstance().invalidate(userId);
+
+    emit ChangeNotifier::getInstance().userChanged(user);
+    return true;
 }
 
-QPair<bool, QString> AdminService::unbanUser(int userId) {
-    DatabaseManager& db = getDatabase();
+QPair<bool, QString> AdminService::banUser(int userId, const QString& reason, int actorId) {
+    QString error;
+    if (updateBanFlag(userId, true, &error)) {
+        adminMetrics().bans.inc();
+        AuditLog::record(AuditEvent::UserBanned, actorId, userId, -1, reason);
+        return qMakePair(true, "User banned successfully");
+    }
+    if (!error.isEmpty()) {
+        adminMetrics().moderationErrors.inc();
+        return qMakePair(false, "Failed to ban user: " + error);
+    }
 
-    // First check if user exists and is banned
-    QString checkQuery = "SELECT is_banned FROM users WHERE id = ?";
-    QSqlQuery checkResult = db.executeQueryWithResult(checkQuery, {userId});
+    // Nothing changed; find out why. Read through the cache: the fresh row
+    // is what the next login needs
+    if (!AuthService::findUserById(userId).first) {
+        return qMakePair(false, "User not found");
+    }
 
-    if (!checkResult.next()) {
+    return qMakePair(false, "User is already banned");
+}
+
+QPair<bool, QString> AdminService::unbanUser(int userId, int actorId) {
+    QString error;
+    if (updateBanFlag(userId, false, &error)) {
+        adminMetrics().unbans.inc();
+        AuditLog::record(AuditEvent::UserUnbanned, actorId, userId);
+        return qMakePair(true, "User unbanned successfully");
+    }
+    if (!error.isEmpty()) {
+        adminMetrics().moderationErrors.inc();
+        return qMakePair(false, "Failed to unban user: " + error);
+    }
+
+    if (!AuthService::findUserById(userId).first) {
         return qMakePair(false, "User not found");
     }
 
-    if (!checkResult.value(0).toBool()) {
-        return qMakePair(false, "User is not banned");
+    return qMakePair(false, "User is not banned");
+}
+
+UserListResult AdminService::listUsersAfter(const ListCursor& after, int limit, bool bannedOnly) {
+    Metrics::Histogram::Timer timer(adminMetrics().listSeconds);
+    QString query = "SELECT id, phone, username, CAST(strftime('%s', created_at) AS INTEGER), "
+        "is_admin, is_banned FROM users";
+    QStringList conditions;
+    QVariantList params;
+    if (bannedOnly) {
+        conditions << "is_banned = 1";
+    }
+    if (!after.isStart()) {
+        // created_at holds CURRENT_TIMESTAMP text, which sorts like the time it names
+        conditions << "(created_at, id) < (datetime(?, 'unixepoch'), ?)";
+        params << after.createdAtSecs << after.id;
+    }
+    if (!conditions.isEmpty()) {
+        query += " WHERE " + conditions.join(" AND ");
+    }
+    query += " ORDER BY created_at DESC, id DESC LIMIT ?";
+    params << limit;
+
+    ShardRouter& shards = ShardRouter::getInstance();
+    if (shards.isEnabled()) {
+        // Every shard's first limit rows after the cursor include the merged page
+        std::vector<UserListResult> pages(shards.shardCount());
+        shards.forEachShard([&](int shard) { pages[shard] = fetchUserTable(query, params, limit, shard); });
+        return mergeUserPages(&pages, limit, true);
+    }
+    return fetchUserTable(query, params, limit);
+}
+
+UserListResult AdminService::searchUsers(const QString& text, const ListCursor& after, int limit,
+                                         bool bannedOnly) {
+    QString needle = text.trimmed();
+    if (needle.isEmpty()) {
+        return listUsersAfter(after, limit, bannedOnly);
+    }
+    Metrics::Histogram::Timer timer(adminMetrics().searchSeconds);
+
+    QString query;
+    QVariantList params;
+    ShardRouter& shards = ShardRouter::getInstance();
+    // Trigrams need at least three characters; the index covers only the
+    // primary file
+    if (!shards.isEnabled() && getDatabase().hasFullTextSearch() && needle.size() >= 3) {
+        // The needle is matched as one quoted phrase, i.e. a plain substring
+        // bm25 scores shift as rows are written and are not exact enough to
+        // page on, so matches are ranked by how the text matches instead.
+        // lower() on both sides, like the case-folding trigram index.
+        QString phrase = "\"" + QString(needle).replace("\"", "\"\"") + "\"";
+        query = "SELECT id, phone, username, created_secs, is_admin, is_banned, match_rank FROM ("
+            "SELECT u.id, u.phone, u.username, CAST(strftime('%s', u.created_at) AS INTEGER) AS created_secs, "
+            "u.is_admin, u.is_banned, "
+            "CASE WHEN u.phone = ? OR lower(u.username) = lower(?) THEN 0 "
+            "WHEN instr(u.phone, ?) = 1 OR instr(lower(u.username), lower(?)) = 1 THEN 1 "
+            "ELSE 2 END AS match_rank "
+            "FROM users_fts f JOIN users u ON u.id = f.rowid "
+            "WHERE users_fts MATCH ?";
+        params << needle << needle << needle << needle << phrase;
+        if (bannedOnly) {
+            query += " AND u.is_banned = 1";
+        }
+        query += ")";
+        if (!after.isStart()) {
+            query += " WHERE (match_rank, id) > (?, ?)";
+            params << after.rank << after.id;
+        }
+        query += " ORDER BY match_rank, id LIMIT ?";
+    } else {
+        QString escaped = needle;
+        escaped.replace("\\", "\\\\").replace("%", "\\%").replace("_", "\\_");
+        QString pattern = "%" + escaped + "%";
+        query = "SELECT id, phone, username, CAST(strftime('%s', created_at) AS INTEGER), "
+            "is_admin, is_banned, 0 FROM users "
+            "WHERE (phone LIKE ? ESCAPE '\\' OR username LIKE ? ESCAPE '\\')";
+        params << pattern << pattern;
+        if (bannedOnly) {
+            query += " AND is_banned = 1";
+        }
+        if (!after.isStart()) {
+            query += " AND id > ?";
+            params << after.id;
+        }
+        query += " ORDER BY id LIMIT ?";
     }
+    params << limit;
 
-    // Update user to unbanned
-    QString updateQuery = "UPDATE users SET is_banned = 0 WHERE id = ?";
-    if (db.executeQuery(updateQuery, {userId})) {
-        return qMakePair(true, "User unbanned successfully");
+    if (shards.isEnabled()) {
+        std::vector<UserListResult> pages(shards.shardCount());
+        shards.forEachShard([&](int shard) { pages[shard] = fetchUserTable(query, params, limit, shard); });
+        return mergeUserPages(&pages, limit, false);
     }
+    return fetchUserTable(query, params, limit);
+}
 
-    return qMakePair(false, "Failed to unban user: " + db.getLastError());
+ModerationResult AdminService::banUsers(const QList<int>& userIds, const QString& reason, int actorId) {
+    return updateBanFlags(userIds, true, reason, actorId);
+}
+
+ModerationResult AdminService::unbanUsers(const QList<int>& userIds, int actorId) {
+    return updateBanFlags(userIds, false, QString(), actorId);
+}
+
+ModerationResult AdminService::updateBanFlags(const QList<int>& userIds, bool banned, const QString& reason,
+                                              int actorId) {
+    ModerationResult result;
+    DatabaseManager& db = getDatabase();
+
+    // Outcome per distinct id; repeated ids share it
+    QHash<int, ModerationStatus> outcome;
+    QVariantList distinct;
+    for (int id : userIds) {
+        if (!outcome.contains(id)) {
+            outcome.insert(id, ModerationStatus::NotFound);
+            distinct.append(id);
+        }
+    }
+
+    // One transaction on the primary file (key -1), or one per shard
+    ShardRouter& shards = ShardRouter::getInstance();
+    QMap<int, QVariantList> groups;
+    for (const QVariant& id : distinct) {
+        groups[shards.isEnabled() ? shards.shardForId(id.toInt()) : -1].append(id);
+    }
+    auto run = [&](int shard, const QString& query, const QVariantList& params) {
+        return shard < 0 ? db.executeQueryWithResult(query, params, true)
+                         : shards.executeQueryWithResult(shard, query, params, true);
+    };
+
+    UserCache::ServiceWrite write;
+    UserCache& cache = UserCache::getInstance();
+    QList<User> changed;
+    for (auto group = groups.cbegin(); group != groups.cend(); ++group) {
+        const int shard = group.key();
+        const QVariantList& ids = group.value();
+        QList<User> groupChanged;
+        bool ok = shard < 0 ? db.beginTransaction() : shards.beginTransaction(shard);
+        for (int start = 0; ok && start < ids.size(); start += kIdChunk) {
+            QVariantList chunk = ids.mid(start, kIdChunk);
+
+            // Same compare-and-set as updateBanFlag(), one statement per chunk
+            QVariantList params = {banned ? 1 : 0, banned ? 0 : 1};
+            params.append(chunk);
+            QSqlQuery update = run(shard,
+                "UPDATE users SET is_banned = ? WHERE is_banned = ? AND id IN " + idPlaceholders(chunk) +
+                " RETURNING id, phone, username, created_at, is_admin, is_banned", params);
+            if (!update.isActive()) {
+                ok = false;
+                break;
+            }
+            while (update.next()) {
+                User user = userFromRow(update);
+                outcome[user.getId()] = ModerationStatus::Changed;
+                groupChanged.append(user);
+            }
+            update.finish();
+
+            // Ids left over are either already in the target state or missing
+            QSqlQuery existing = run(shard,
+                "SELECT id FROM users WHERE is_banned = ? AND id IN " + idPlaceholders(chunk),
+                QVariantList{banned ? 1 : 0} + chunk);
+            if (!existing.isActive()) {
+                ok = false;
+                break;
+            }
+            while (existing.next()) {
+                ModerationStatus& status = outcome[existing.value(0).toInt()];
+                if (status != ModerationStatus::Changed) {
+                    status = ModerationStatus::Unchanged;
+                }
+            }
+        }
+
+        if (ok) {
+            ok = shard < 0 ? db.commitTransaction() : shards.commitTransaction(shard);
+        }
+        if (!ok) {
+            qWarning() << "Bulk ban update failed:"
+                       << (shard < 0 ? db.getLastError() : shards.connection(shard).lastError().text());
+            if (shard < 0) {
+                db.rollbackTransaction();
+            } else {
+                shards.rollbackTransaction(shard);
+            }
+            for (const QVariant& id : ids) {
+                outcome[id.toInt()] = ModerationStatus::DatabaseError;
+                cache.invalidate(id.toInt());
+            }
+            adminMetrics().moderationErrors.inc(ids.size());
+            continue;
+        }
+        // Committed; unchanged ids are dropped too, their cached flag may be stale
+        for (const QVariant& id : ids) {
+            cache.invalidate(id.toInt());
+        }
+        changed.append(groupChanged);
+    }
+
+    result.statuses.reserve(userIds.size());
+    for (int id : userIds) {
+        result.statuses.append(outcome.value(id));
+    }
+    result.changedCount = changed.size();
+    (banned ? adminMetrics().bans : adminMetrics().unbans).inc(changed.size());
+
+    // Announce and record only what was committed
+    for (const User& user : changed) {
+        AuditLog::record(banned ? AuditEvent::UserBanned : AuditEvent::UserUnbanned, actorId, user.getId(),
+                         -1, reason);
+        emit ChangeNotifier::getInstance().userChanged(user);
+    }
+    return result;
 }
 
 QPair<bool, QList<User>> AdminService::getBannedUsers(int page, int pageSize) {
+    if (ShardRouter::getInstance().isEnabled()) {
+        return usersFromListing(listUserPage(true, page, pageSize));
+    }
     DatabaseManager& db = getDatabase();
-    int offset = page * pageSize;
+    qint64 offset = static_cast<qint64>(page) * pageSize;
 
     QString query = "SELECT id, phone, username, created_at, is_admin, "
         "is_banned FROM users WHERE is_banned = 1 "
@@ -117,68 +626,299 @@ QPair<bool, QList<User>> AdminService::getBannedUsers(int page, int pageSize) {
     return qMakePair(true, users);
 }
 
-QPair<bool, QList<QPair<User, QString>>>
-AdminService::getReports(int page, int pageSize) {
+QPair<bool, QList<Report>> AdminService::fetchReports(const QString& whereOrder, const QVariantList& params,
+                                                      int expectedRows, int shard) {
+    // On a shard the reporter may live elsewhere; the merge fills in the name
+    QString join = shard < 0 ? "JOIN" : "LEFT JOIN";
+    QString query = "SELECT r.id, r.reporter_id, u.username, r.reported_user_id, u2.username, "
+                    "r.reason, r.status, CAST(strftime('%s', r.created_at) AS INTEGER), "
+                    "CAST(strftime('%s', r.resolved_at) AS INTEGER), r.claimed_by "
+                    "FROM reports r " +
+                    join + " users u ON r.reporter_id = u.id " +
+                    join + " users u2 ON r.reported_user_id = u2.id " + whereOrder;
+
+    QSqlQuery result = shard < 0 ? getDatabase().executeQueryWithResult(query, params, true)
+                                 : ShardRouter::getInstance().executeQueryWithResult(shard, query, params, true);
+    if (result.lastError().isValid()) {
+        qWarning() << "Error fetching reports:" << result.lastError().text();
+        return qMakePair(false, QList<Report>());
+    }
+
+    QList<Report> reports;
+    reports.reserve(expectedRows);
+    while (result.next()) {
+        QVariant resolvedAt = result.value(8);
+        reports.append(Report(
+            result.value(0).toInt(),
+            result.value(1).toInt(),
+            result.value(2).toString(),
+            result.value(3).toInt(),
+            result.value(4).toString(),
+            result.value(5).toString(),
+            result.value(6).toString(),
+            QDateTime::fromSecsSinceEpoch(result.value(7).toLongLong(), Qt::UTC),
+            resolvedAt.isNull() ? QDateTime() : QDateTime::fromSecsSinceEpoch(resolvedAt.toLongLong(), Qt::UTC),
+            result.value(9).toInt()));
+    }
+
+    return qMakePair(true, reports);
+}
+
+QPair<bool, QList<Report>> AdminService::getReports(int page, int pageSize) {
+    qint64 offset = static_cast<qint64>(page) * pageSize;
+    ShardRouter& shards = ShardRouter::getInstance();
+    if (shards.isEnabled()) {
+        // As in listUserPage(): every shard's first offset + pageSize rows
+        qint64 rows = offset + pageSize;
+        std::vector<QPair<bool, QList<Report>>> pages(shards.shardCount());
+        shards.forEachShard([&](int shard) {
+            pages[shard] = fetchReports("ORDER BY r.created_at DESC, r.id DESC LIMIT ?", {rows}, pageSize, shard);
+        });
+        return mergeReportPages(pages, pageSize, offset);
+    }
+    return fetchReports("ORDER BY r.created_at DESC LIMIT ? OFFSET ?", {pageSize, offset}, pageSize);
+}
+
+QPair<bool, QList<Report>> AdminService::getReportsAfter(const ListCursor& after, int limit) {
+    QString whereOrder;
+    QVariantList params;
+    if (!after.isStart()) {
+        whereOrder = "WHERE (r.created_at, r.id) < (datetime(?, 'unixepoch'), ?) ";
+        params << after.createdAtSecs << after.id;
+    }
+    whereOrder += "ORDER BY r.created_at DESC, r.id DESC LIMIT ?";
+    params << limit;
+
+    ShardRouter& shards = ShardRouter::getInstance();
+    if (shards.isEnabled()) {
+        std::vector<QPair<bool, QList<Report>>> pages(shards.shardCount());
+        shards.forEachShard([&](int shard) { pages[shard] = fetchReports(whereOrder, params, limit, shard); });
+        return mergeReportPages(pages, limit);
+    }
+    return fetchReports(whereOrder, params, limit);
+}
+
+QPair<bool, QList<Report>> AdminService::claimNextReports(int adminId, int count) {
+    if (ShardRouter::getInstance().isEnabled()) {
+        return claimReportsOnShards(adminId, count);
+    }
     DatabaseManager& db = getDatabase();
-    int offset = page * pageSize;
+    if (!releaseExpiredClaims(-1)) {
+        return qMakePair(false, QList<Report>());
+    }
 
-    QString query = "SELECT r.*, u.username AS reporter_name, "
-                    "u2.username AS reported_name "
-                    "FROM reports r "
-                    "JOIN users u ON r.reporter_id = u.id "
-                    "JOIN users u2 ON r.reported_user_id = u2.id "
-                    "ORDER BY r.created_at DESC LIMIT ? OFFSET ?";
+    // One statement, so two admins can never claim the same report. The
+    // subquery walks idx_reports_queue, which holds only open reports.
+    QString claimQuery = "UPDATE reports SET claimed_by = ?, claimed_at = CURRENT_TIMESTAMP "
+        "WHERE id IN (SELECT id FROM reports WHERE status = 'pending' AND claimed_by IS NULL "
+        "ORDER BY created_at, id LIMIT ?) RETURNING id";
+    QSqlQuery claimed = db.executeQueryWithResult(claimQuery, {adminId, count}, true);
+    if (!claimed.isActive()) {
+        qWarning() << "Error claiming reports:" << claimed.lastError().text();
+        return qMakePair(false, QList<Report>());
+    }
 
-    QVariantList params = {pageSize, offset};
-    QSqlQuery result = db.executeQueryWithResult(query, params);
+    QVariantList ids;
+    while (claimed.next()) {
+        ids.append(claimed.value(0));
+    }
+    claimed.finish();
+    if (ids.isEmpty()) {
+        return qMakePair(true, QList<Report>());
+    }
 
-    if (result.lastError().isValid()) {
-        qWarning() << "Error fetching reports:" << result.lastError().text();
-        return qMakePair(false, QList<QPair<User, QString>>());
+    return fetchReports("WHERE r.id IN " + idPlaceholders(ids) + " ORDER BY r.created_at, r.id", ids, ids.size());
+}
+
+// claimNextReports() with sharding on. The oldest open reports over all
+// shards are picked first and then claimed on their own shards; one that
+// another admin claimed in between is left out of the result.
+QPair<bool, QList<Report>> AdminService::claimReportsOnShards(int adminId, int count) {
+    ShardRouter& shards = ShardRouter::getInstance();
+    struct Candidate {
+        qint64 createdAtSecs;
+        int id;
+        int shard;
+    };
+    std::vector<std::vector<Candidate>> found(shards.shardCount());
+    std::vector<char> read(shards.shardCount(), 0);
+    shards.forEachShard([&](int shard) {
+        if (!releaseExpiredClaims(shard)) {
+            return;
+        }
+        QSqlQuery result = shards.executeQueryWithResult(
+            shard, "SELECT CAST(strftime('%s', created_at) AS INTEGER), id FROM reports "
+            "WHERE status = 'pending' AND claimed_by IS NULL ORDER BY created_at, id LIMIT ?", {count}, true);
+        read[shard] = !result.lastError().isValid();
+        while (result.next()) {
+            found[shard].push_back(Candidate{result.value(0).toLongLong(), result.value(1).toInt(), shard});
+        }
+    });
+
+    std::vector<Candidate> oldest;
+    for (int shard = 0; shard < shards.shardCount(); ++shard) {
+        if (!read[shard]) {
+            return qMakePair(false, QList<Report>());
+        }
+        oldest.insert(oldest.end(), found[shard].begin(), found[shard].end());
+    }
+    std::sort(oldest.begin(), oldest.end(), [](const Candidate& a, const Candidate& b) {
+        return a.createdAtSecs != b.createdAtSecs ? a.createdAtSecs < b.createdAtSecs : a.id < b.id;
+    });
+    if (static_cast<int>(oldest.size()) > count) {
+        oldest.resize(count);
     }
 
-    QList<QPair<User, QString>> reports;
-    while (result.next()) {
-        User reporter(
-            result.value("reporter_id").toInt(),
-            "",  // Phone not returned
-            "",  // Password not returned
-            result.value("reporter_name").toString());
+    QMap<int, QVariantList> byShard;
+    for (const Candidate& candidate : oldest) {
+        byShard[candidate.shard].append(candidate.id);
+    }
+    std::vector<QPair<bool, QList<Report>>> pages;
+    for (auto it = byShard.cbegin(); it != byShard.cend(); ++it) {
+        QVariantList params = {adminId};
+        params += it.value();
+        QSqlQuery claimed = shards.executeQueryWithResult(
+            it.key(), "UPDATE reports SET claimed_by = ?, claimed_at = CURRENT_TIMESTAMP WHERE id IN "
+            + idPlaceholders(it.value()) + " AND status = 'pending' AND claimed_by IS NULL RETURNING id",
+            params, true);
+        if (claimed.lastError().isValid()) {
+            // Claims already taken on other shards stay until released
+            qWarning() << "Error claiming reports:" << claimed.lastError().text();
+            return qMakePair(false, QList<Report>());
+        }
+        QVariantList ids;
+        while (claimed.next()) {
+            ids.append(claimed.value(0));
+        }
+        claimed.finish();
+        if (!ids.isEmpty()) {
+            pages.push_back(fetchReports("WHERE r.id IN " + idPlaceholders(ids)
+                                         + " ORDER BY r.created_at DESC, r.id DESC", ids, ids.size(), it.key()));
+        }
+    }
 
-        QString reportDetails = QString("Reported %1: %2 (Status: %3)")
-                                .arg(result.value("reported_name").toString())
-                                .arg(result.value("reason").toString())
-                                .arg(result.value("status").toString());
+    // Merged newest first, like the listings
+    QPair<bool, QList<Report>> merged = mergeReportPages(pages, count);
+    std::reverse(merged.second.begin(), merged.second.end());
+    return merged;
+}
 
-        reports.append(qMakePair(reporter, reportDetails));
+QPair<bool, int> AdminService::releaseClaims(int adminId) {
+    QString query = "UPDATE reports SET claimed_by = NULL, claimed_at = NULL "
+        "WHERE claimed_by = ? AND status = 'pending'";
+    ShardRouter& shards = ShardRouter::getInstance();
+    int released = 0;
+    // shard -1 is the primary file
+    for (int shard = shards.isEnabled() ? 0 : -1; shard < shards.shardCount(); ++shard) {
+        QSqlQuery result = shard < 0 ? getDatabase().executeQueryWithResult(query, {adminId})
+                                     : shards.executeQueryWithResult(shard, query, {adminId});
+        if (!result.isActive()) {
+            qWarning() << "Error releasing claims:" << result.lastError().text();
+            return qMakePair(false, released);
+        }
+        released += result.numRowsAffected();
     }
+    return qMakePair(true, released);
+}
 
-    return qMakePair(true, reports);
+// Puts claims older than kClaimTimeoutSecs back in the queue; shard -1 is
+// the primary file. idx_reports_claimed holds only the open claims.
+bool AdminService::releaseExpiredClaims(int shard) {
+    QString query = "UPDATE reports SET claimed_by = NULL, claimed_at = NULL "
+        "WHERE claimed_by IS NOT NULL AND status = 'pending' AND claimed_at < datetime('now', ?)";
+    QVariantList params = {QString("-%1 seconds").arg(kClaimTimeoutSecs)};
+    QSqlQuery result = shard < 0 ? getDatabase().executeQueryWithResult(query, params)
+                                 : ShardRouter::getInstance().executeQueryWithResult(shard, query, params);
+    if (!result.isActive()) {
+        qWarning() << "Error releasing expired claims:" << result.lastError().text();
+        return false;
+    }
+    return true;
 }
 
 QPair<bool, QString> AdminService::resolveReport
-    (int reportId, const QString& action, const QString& comment) {
-     Q_UNUSED(comment);
-    DatabaseManager& db = getDatabase();
+    (int reportId, const QString& action, const QString& comment, int actorId) {
+    if (action != "resolved" && action != "rejected") {
+        return qMakePair(false, "Invalid action: " + action);
+    }
+    ShardRouter& shards = ShardRouter::getInstance();
+
+    // Only a pending report can be resolved; checked in the UPDATE itself so
+    // two admins cannot both resolve it. Resolving also ends any claim.
+    QString updateQuery = "UPDATE reports SET status = ?, resolved_at = CURRENT_TIMESTAMP, "
+        "claimed_by = NULL, claimed_at = NULL WHERE id = ? AND status = 'pending' "
+        "RETURNING reported_user_id";
+    QSqlQuery updateResult = shards.executeForId(reportId, updateQuery, {action, reportId});
+    if (!updateResult.isActive()) {
+        return qMakePair(false, "Failed to resolve report: " + updateResult.lastError().text());
+    }
+    if (updateResult.next()) {
+        int reportedUserId = updateResult.value(0).toInt();
+        updateResult.finish();
+
+        adminMetrics().reportsResolved.inc();
+        AuditLog::record(AuditEvent::ReportResolved, actorId, reportedUserId, reportId,
+                         comment.isEmpty() ? action : action + ": " + comment);
+        emit ChangeNotifier::getInstance().reportStatusChanged(reportId, action);
+        return qMakePair(true, "Report resolved successfully");
+    }
 
-    // First check if report exists
     QString checkQuery = "SELECT status FROM reports WHERE id = ?";
-    QSqlQuery checkResult = db.executeQueryWithResult(checkQuery, {reportId});
+    QSqlQuery checkResult = shards.executeForId(reportId, checkQuery, {reportId});
 
     if (!checkResult.next()) {
         return qMakePair(false, "Report not found");
     }
 
-    if (checkResult.value(0).toString() != "pending") {
-        return qMakePair(false, "Report has already been processed");
-    }
+    return qMakePair(false, "Report has already been processed");
+}
 
-    // Update report status
-    QString updateQuery = "UPDATE reports SET status = ?, "
-        "report_time = CURRENT_TIMESTAMP WHERE id = ?";
-    if (db.executeQuery(updateQuery, {action, reportId})) {
-        return qMakePair(true, "Report resolved successfully");
+QPair<bool, MarketStats> AdminService::getStats() {
+    QString query = "SELECT total_users, banned_users, admin_users, pending_reports, resolved_reports, "
+        "rejected_reports FROM market_stats WHERE id = 1";
+    ShardRouter& shards = ShardRouter::getInstance();
+    MarketStats stats;
+    // shard -1 is the primary file; each shard keeps its own row
+    for (int shard = shards.isEnabled() ? 0 : -1; shard < shards.shardCount(); ++shard) {
+        QSqlQuery result = shard < 0 ? getDatabase().executeQueryWithResult(query)
+                                     : shards.executeQueryWithResult(shard, query);
+        if (!result.next()) {
+            qWarning() << "getStats: no statistics row:" << result.lastError().text();
+            return qMakePair(false, MarketStats());
+        }
+        stats.totalUsers += result.value(0).toInt();
+        stats.bannedUsers += result.value(1).toInt();
+        stats.adminUsers += result.value(2).toInt();
+        stats.pendingReports += result.value(3).toInt();
+        stats.resolvedReports += result.value(4).toInt();
+        stats.rejectedReports += result.value(5).toInt();
     }
+    return qMakePair(true, stats);
+}
 
-    return qMakePair(false, "Failed to resolve report: " + db.getLastError());
+QPair<bool, MarketStats> AdminService::recomputeStats() {
+    QString countUsers =
+        "SELECT COUNT(*), COALESCE(SUM(is_banned = 1), 0), COALESCE(SUM(is_admin = 1), 0) FROM users";
+    QString countReports =
+        "SELECT COALESCE(SUM(status = 'pending'), 0), COALESCE(SUM(status = 'resolved'), 0), "
+        "COALESCE(SUM(status = 'rejected'), 0) FROM reports";
+    ShardRouter& shards = ShardRouter::getInstance();
+    MarketStats stats;
+    for (int shard = shards.isEnabled() ? 0 : -1; shard < shards.shardCount(); ++shard) {
+        QSqlQuery users = shard < 0 ? getDatabase().executeQueryWithResult(countUsers)
+                                    : shards.executeQueryWithResult(shard, countUsers);
+        QSqlQuery reports = shard < 0 ? getDatabase().executeQueryWithResult(countReports)
+                                      : shards.executeQueryWithResult(shard, countReports);
+        if (!users.next() || !reports.next()) {
+            qWarning() << "recomputeStats: count failed:" << users.lastError().text() << reports.lastError().text();
+            return qMakePair(false, MarketStats());
+        }
+        stats.totalUsers += users.value(0).toInt();
+        stats.bannedUsers += users.value(1).toInt();
+        stats.adminUsers += users.value(2).toInt();
+        stats.pendingReports += reports.value(0).toInt();
+        stats.resolvedReports += reports.value(1).toInt();
+        stats.rejectedReports += reports.value(2).toInt();
+    }
+    return qMakePair(true, stats);
 }
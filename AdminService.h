@@ -6,23 +6,132 @@
 #include <QList>
 #include <QPair>
 #include "User.h"
+#include "Report.h"
+#include "UserTable.h"
 #include "DatabaseManager.h"
 
+// Position in the newest-first (created_at DESC, id DESC) order used by the
+// keyset listings. The default cursor is the start of the list; a page
+// starts right after the row the cursor names, so no OFFSET scan is needed.
+// Search results are ordered by (rank, id) instead and use rank, the match
+// class: 0 exact, 1 prefix, 2 anywhere. It depends on the row and the text
+// alone, so it stays comparable from one page to the next.
+struct ListCursor {
+    qint64 createdAtSecs = 0;
+    int id = 0;
+    int rank = 0;
+
+    bool isStart() const { return id == 0; }
+};
+
+// Move-only listing result; rows stay in compact form until displayed.
+struct UserListResult {
+    bool ok = false;
+    UserTable users;
+    ListCursor next;  // after the last row, for requesting the following page
+};
+
+enum class ModerationStatus {
+    Changed,     // flag flipped by this call
+    Unchanged,   // already banned (banUsers) or not banned (unbanUsers)
+    NotFound,
+    DatabaseError
+};
+
+// Dashboard counters, see AdminService::getStats().
+struct MarketStats {
+    int totalUsers = 0;
+    int bannedUsers = 0;
+    int adminUsers = 0;
+    int pendingReports = 0;
+    int resolvedReports = 0;
+    int rejectedReports = 0;
+
+    bool operator==(const MarketStats& other) const {
+        return totalUsers == other.totalUsers && bannedUsers == other.bannedUsers
+            && adminUsers == other.adminUsers && pendingReports == other.pendingReports
+            && resolvedReports == other.resolvedReports && rejectedReports == other.rejectedReports;
+    }
+    bool operator!=(const MarketStats& other) const { return !(*this == other); }
+};
+
+// Per-id outcome of AdminService::banUsers()/unbanUsers(), indexed like the
+// input list.
+struct ModerationResult {
+    QList<ModerationStatus> statuses;
+    int changedCount = 0;
+};
+
+
 class AdminService {
  public:
     static QPair<bool, QList<User>> getAllUsers(int page = 0, int pageSize = 10);
 
-    static QPair<bool, QString> banUser(int userId, const QString& reason);
+    static UserListResult listUsers(int page = 0, int pageSize = 10);
+
+    static UserListResult listBannedUsers(int page = 0, int pageSize = 10);
+
+    // Up to limit users following after, optionally only banned ones.
+    static UserListResult listUsersAfter(const ListCursor& after, int limit, bool bannedOnly = false);
+
+    // Users whose phone or username contains text, best match first, in
+    // keyset pages like listUsersAfter(), optionally only banned ones.
+    static UserListResult searchUsers(const QString& text, const ListCursor& after = ListCursor(),
+                                      int limit = 50, bool bannedOnly = false);
+
+    // Moderation actions are recorded in the AuditLog with actorId, the
+    // admin's user id (-1 for automatic actions), once they succeed.
+    static QPair<bool, QString> banUser(int userId, const QString& reason, int actorId = -1);
+
+    static QPair<bool, QString> unbanUser(int userId, int actorId = -1);
 
-    static QPair<bool, QString> unbanUser(int userId);
+    // Set-based ban/unban of many users in one transaction; either every
+    // Changed row is stored or, on a database error, none is. With sharding
+    // that holds per shard.
+    static ModerationResult banUsers(const QList<int>& userIds, const QString& reason, int actorId = -1);
+    static ModerationResult unbanUsers(const QList<int>& userIds, int actorId = -1);
 
     static QPair<bool, QList<User>> getBannedUsers(int page = 0, int pageSize = 10);
 
-    static QPair<bool, QList<QPair<User, QString>>> getReports(int page = 0, int pageSize = 10);
+    static QPair<bool, QList<Report>> getReports(int page = 0, int pageSize = 10);
+
+    static QPair<bool, QList<Report>> getReportsAfter(const ListCursor& after, int limit);
+
+    // Moderation queue: claims up to count pending, unclaimed reports for
+    // adminId, oldest first, and returns them. Claimed reports are skipped
+    // by other admins until resolved, released or kClaimTimeoutSecs old.
+    // With sharding the queue is merged over the shards.
+    static QPair<bool, QList<Report>> claimNextReports(int adminId, int count);
+    static const int kClaimTimeoutSecs = 30 * 60;
+
+    // Puts adminId's unresolved claims back in the queue; returns how many.
+    static QPair<bool, int> releaseClaims(int adminId);
+
+    // action is "resolved" or "rejected".
+    static QPair<bool, QString> resolveReport(int reportId, const QString& action, const QString& comment = "",
+                                              int actorId = -1);
+
+    // Reads the trigger-maintained market_stats row; one primary-key lookup,
+    // per shard with sharding on.
+    static QPair<bool, MarketStats> getStats();
 
-    static QPair<bool, QString> resolveReport(int reportId, const QString& action, const QString& comment = "");
+    // Counts everything from scratch with full scans. For consistency
+    // checks against getStats(), not for display.
+    static QPair<bool, MarketStats> recomputeStats();
 
  private:
     static DatabaseManager& getDatabase();
+    static bool updateBanFlag(int userId, bool banned, QString* error);
+    static ModerationResult updateBanFlags(const QList<int>& userIds, bool banned, const QString& reason,
+                                           int actorId);
+    // shard -1 reads the primary file
+    static QPair<bool, QList<Report>> fetchReports(const QString& whereOrder, const QVariantList& params,
+                                                   int expectedRows, int shard = -1);
+    static UserListResult fetchUserTable(const QString& query, const QVariantList& params, int expectedRows,
+                                         int shard = -1);
+    // Page-numbered listing behind listUsers()/listBannedUsers()
+    static UserListResult listUserPage(bool bannedOnly, int page, int pageSize);
+    static QPair<bool, QList<Report>> claimReportsOnShards(int adminId, int count);
+    static bool releaseExpiredClaims(int shard);
 };
 #endif  // ADMINSERVICE_H
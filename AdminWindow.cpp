@@ -9,10 +9,23 @@
 #include <QGroupBox>
 #include <QInputDialog>
 #include <QColor>
+#include <QDebug>
+#include <QLoggingCategory>
+#include <QPointer>
+#include <QProgressDialog>
+#include <QThreadPool>
+#include "ChangeNotifier.h"
+#include "UserCache.h"
 #include <utility>
 
+// Open-to-first-paint and first-rows timings; off unless enabled with
+// QT_LOGGING_RULES="market.admin.timing.debug=true".
+Q_LOGGING_CATEGORY(adminTiming, "market.admin.timing", QtInfoMsg)
+
 AdminWindow::AdminWindow(const User& adminUser, QWidget* parent)
-    : QDialog(parent), m_adminUser(adminUser) {
+    : QDialog(parent), m_adminUser(adminUser),
+      m_searchGeneration(std::make_shared<std::atomic<int>>(0)) {
+    m_openTimer.start();
     setWindowTitle("Admin Panel - " + adminUser.getUsername());
     setWindowIcon(QIcon(":/icons/admin_icon.png"));
 
@@ -29,20 +42,43 @@ AdminWindow::AdminWindow(const User& adminUser, QWidget* parent)
     setupUI();
     setupConnections();
 
-    // Load initial data
-    loadUsers();
-    loadReports();
+    // Only the tab on display is loaded now; the others wait for a click
+    ensureTabLoaded(m_tabWidget->currentIndex());
+    m_changeFeed->start(1000);
 }
 
 AdminWindow::~AdminWindow() {
 }
 
+void AdminWindow::paintEvent(QPaintEvent* event) {
+    QDialog::paintEvent(event);
+    if (!m_firstPaintLogged) {
+        m_firstPaintLogged = true;
+        qCDebug(adminTiming) << "Admin panel first paint after" << m_openTimer.elapsed() << "ms";
+    }
+}
+
 void AdminWindow::setupUI() {
     // Create main layout
     QVBoxLayout* mainLayout = new QVBoxLayout(this);
     mainLayout->setContentsMargins(10, 10, 10, 10);
     mainLayout->setSpacing(10);
 
+    // Dashboard header
+    m_statsLabel = new QLabel(this);
+    m_statsLabel->setStyleSheet("font-size: 13px; color: #2c3e50; padding: 4px;");
+    mainLayout->addWidget(m_statsLabel);
+
+    m_statsTimer = new QTimer(this);
+    m_statsTimer->setSingleShot(true);
+    m_statsTimer->setInterval(100);
+
+    m_prefetchTimer = new QTimer(this);
+    m_prefetchTimer->setSingleShot(true);
+    m_prefetchTimer->setInterval(150);
+
+    m_changeFeed = new ChangeFeed(this);
+
     // Create tab widget
     m_tabWidget = new QTabWidget(this);
 
@@ -70,17 +106,29 @@ void AdminWindow::setupUsersTab() {
         "QPushButton { background-color: #3498db; color: white; border: none; border-radius: 4px; padding: 8px; }"
         "QPushButton:hover { background-color: #2980b9; }");
 
+    m_searchEdit = new QLineEdit(this);
+    m_searchEdit->setPlaceholderText("Search phone or username");
+    m_searchEdit->setClearButtonEnabled(true);
+    m_searchEdit->setMinimumWidth(240);
+
+    m_searchTimer = new QTimer(this);
+    m_searchTimer->setSingleShot(true);
+    m_searchTimer->setInterval(250);
+
     headerLayout->addWidget(titleLabel);
     headerLayout->addStretch();
+    headerLayout->addWidget(m_searchEdit);
     headerLayout->addWidget(m_refreshUsersButton);
 
-    // Users table
-    m_usersTable = new QTableWidget(this);
-    m_usersTable->setColumnCount(5);
-    m_usersTable->setHorizontalHeaderLabels({"ID", "Phone", "Username", "Created", "Status"});
+    // Users table, rows fetched page by page as the view scrolls
+    m_usersModel = new UserTableModel(this);
+    m_usersTable = new QTableView(this);
+    m_usersTable->setModel(m_usersModel);
+    m_usersTable->verticalHeader()->setVisible(false);
+    m_usersTable->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
     m_usersTable->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
     m_usersTable->setSelectionBehavior(QAbstractItemView::SelectRows);
-    m_usersTable->setSelectionMode(QAbstractItemView::SingleSelection);
+    m_usersTable->setSelectionMode(QAbstractItemView::ExtendedSelection);
 
     // Action buttons
     QHBoxLayout* buttonLayout = new QHBoxLayout();
@@ -136,9 +184,11 @@ void AdminWindow::setupReportsTab() {
     headerLayout->addWidget(m_refreshReportsButton);
 
     // Reports table
-    m_reportsTable = new QTableWidget(this);
-    m_reportsTable->setColumnCount(3);
-    m_reportsTable->setHorizontalHeaderLabels({"ID", "Reporter", "Report Details"});
+    m_reportsModel = new ReportTableModel(this);
+    m_reportsTable = new QTableView(this);
+    m_reportsTable->setModel(m_reportsModel);
+    m_reportsTable->verticalHeader()->setVisible(false);
+    m_reportsTable->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
     m_reportsTable->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
     m_reportsTable->setSelectionBehavior(QAbstractItemView::SelectRows);
     m_reportsTable->setSelectionMode(QAbstractItemView::SingleSelection);
@@ -175,153 +225,296 @@ void AdminWindow::setupReportsTab() {
 
 void AdminWindow::setupConnections() {
     connect(m_refreshUsersButton, &QPushButton::clicked, this, &AdminWindow::onRefreshUsersClicked);
+    connect(m_searchEdit, &QLineEdit::textChanged, this, &AdminWindow::onSearchTextChanged);
+    connect(m_searchTimer, &QTimer::timeout, this, &AdminWindow::runSearch);
     connect(m_banUserButton, &QPushButton::clicked, this, &AdminWindow::onBanUserClicked);
     connect(m_unbanUserButton, &QPushButton::clicked, this, &AdminWindow::onUnbanUserClicked);
     connect(m_viewBannedUsersButton, &QPushButton::clicked, this, &AdminWindow::onViewBannedUsersClicked);
-    connect(m_usersTable, &QTableWidget::cellClicked, this, &AdminWindow::onUserSelected);
+    connect(m_usersTable->selectionModel(), &QItemSelectionModel::selectionChanged,
+            this, &AdminWindow::onUserSelectionChanged);
 
     connect(m_refreshReportsButton, &QPushButton::clicked, this, &AdminWindow::onRefreshReportsClicked);
     connect(m_resolveReportButton, &QPushButton::clicked, this, &AdminWindow::onResolveReportClicked);
-    connect(m_reportsTable, &QTableWidget::cellClicked, this, &AdminWindow::onReportSelected);
+    connect(m_reportsTable, &QTableView::clicked, this, &AdminWindow::onReportSelected);
+
+    connect(m_tabWidget, &QTabWidget::currentChanged, this, &AdminWindow::ensureTabLoaded);
+
+    // Read ahead once scrolling stops or a page has been added
+    connect(m_prefetchTimer, &QTimer::timeout, this, &AdminWindow::prefetchVisiblePages);
+    connect(m_tabWidget, &QTabWidget::currentChanged, m_prefetchTimer, qOverload<>(&QTimer::start));
+    connect(m_usersTable->verticalScrollBar(), &QScrollBar::valueChanged, m_prefetchTimer, qOverload<>(&QTimer::start));
+    connect(m_usersModel, &QAbstractItemModel::rowsInserted, m_prefetchTimer, qOverload<>(&QTimer::start));
+    connect(m_reportsTable->verticalScrollBar(), &QScrollBar::valueChanged, m_prefetchTimer, qOverload<>(&QTimer::start));
+    connect(m_reportsModel, &QAbstractItemModel::rowsInserted, m_prefetchTimer, qOverload<>(&QTimer::start));
+
+    // A bulk ban announces every user; read the counters once afterwards
+    connect(m_statsTimer, &QTimer::timeout, this, &AdminWindow::refreshStats);
+    ChangeNotifier& notifier = ChangeNotifier::getInstance();
+    connect(&notifier, &ChangeNotifier::userChanged, m_statsTimer, qOverload<>(&QTimer::start));
+    connect(&notifier, &ChangeNotifier::reportStatusChanged, m_statsTimer, qOverload<>(&QTimer::start));
+
+    connect(m_changeFeed, &ChangeFeed::usersChanged, this, &AdminWindow::onUsersChanged);
+    connect(m_changeFeed, &ChangeFeed::reportsChanged, this, &AdminWindow::onReportsChanged);
 }
 
-void AdminWindow::loadUsers() {
-    m_usersTable->clearContents();
-    m_usersTable->setRowCount(0);
+void AdminWindow::ensureTabLoaded(int index) {
+    QWidget* tab = m_tabWidget->widget(index);
+    QAbstractItemModel* model = nullptr;
+    if (tab == m_usersTab && !m_usersLoaded) {
+        m_usersLoaded = true;
+        model = m_usersModel;
+        loadUsers();
+    } else if (tab == m_reportsTab && !m_reportsLoaded) {
+        m_reportsLoaded = true;
+        model = m_reportsModel;
+        loadReports();
+    } else {
+        return;
+    }
 
-    QPair<bool, QList<User>> result = AdminService::getAllUsers();
+    // The view fetches the first page itself once it is laid out
+    if (!adminTiming().isDebugEnabled()) {
+        return;
+    }
+    QString name = m_tabWidget->tabText(index);
+    connect(model, &QAbstractItemModel::rowsInserted, this, [this, name]() {
+        qCDebug(adminTiming) << "Admin panel" << name << "tab first rows after" << m_openTimer.elapsed() << "ms";
+    }, Qt::SingleShotConnection);
+}
 
-    if (result.first) {
-        m_usersTable->setRowCount(result.second.size());
+void AdminWindow::prefetchVisiblePages() {
+    // The top and bottom rows can sit on different pages
+    if (m_tabWidget->currentWidget() == m_usersTab) {
+        m_usersModel->prefetchAround(m_usersTable->rowAt(0));
+        m_usersModel->prefetchAround(m_usersTable->rowAt(m_usersTable->viewport()->height() - 1));
+    } else if (m_tabWidget->currentWidget() == m_reportsTab) {
+        m_reportsModel->prefetchAround(m_reportsTable->rowAt(0));
+        m_reportsModel->prefetchAround(m_reportsTable->rowAt(m_reportsTable->viewport()->height() - 1));
+    }
+}
 
-        for (int i = 0; i < result.second.size(); ++i) {
-            const User& user = result.second[i];
+void AdminWindow::refreshStats() {
+    QPair<bool, MarketStats> stats = AdminService::getStats();
+    if (!stats.first) {
+        m_statsLabel->setText("Statistics unavailable");
+        return;
+    }
 
-            m_usersTable->setItem(i, 0, new QTableWidgetItem(QString::number(user.getId())));
-            m_usersTable->setItem(i, 1, new QTableWidgetItem(user.getPhone()));
-            m_usersTable->setItem(i, 2, new QTableWidgetItem(user.getUsername()));
-            m_usersTable->setItem(i, 3, new QTableWidgetItem(user.getCreatedAt().toString("yyyy-MM-dd hh:mm:ss")));
+    const MarketStats& s = stats.second;
+    m_statsLabel->setText(QString("Users: %1  |  Banned: %2  |  Admins: %3  |  "
+                                  "Reports pending: %4  resolved: %5  rejected: %6")
+                              .arg(s.totalUsers)
+                              .arg(s.bannedUsers)
+                              .arg(s.adminUsers)
+                              .arg(s.pendingReports)
+                              .arg(s.resolvedReports)
+                              .arg(s.rejectedReports));
+}
 
-            QTableWidgetItem* statusItem = new QTableWidgetItem(user.isBanned() ? "Banned" : "Active");
-            if (user.isBanned()) {
-                statusItem->setBackground(QColor(255, 150, 150));
-            } else {
-                statusItem->setBackground(QColor(200, 255, 200));
-            }
-            m_usersTable->setItem(i, 4, statusItem);
-        }
-    } else {
-        QMessageBox::warning(this, "Error", "Failed to load users");
-    }
+void AdminWindow::loadUsers() {
+    clearSearch();
+    m_usersModel->setBannedOnly(false);
+    m_banUserButton->setEnabled(false);
+    m_unbanUserButton->setEnabled(false);
+    refreshStats();
 }
 
 void AdminWindow::loadReports() {
-    m_reportsTable->clearContents();
-    m_reportsTable->setRowCount(0);
+    m_reportsModel->reload();
+    refreshStats();
+    m_reportDetailsText->clear();
+    m_resolveReportButton->setEnabled(false);
+}
 
-    QPair<bool, QList<QPair<User, QString>>> result = AdminService::getReports();
+void AdminWindow::showReportDetails(int row) {
+    if (row < 0 || row >= m_reportsModel->rowCount()) {
+        return;
+    }
 
-    if (result.first) {
-        m_reportsTable->setRowCount(result.second.size());
+    m_reportDetailsText->setText(m_reportsModel->details(row));
+}
 
-        for (int i = 0; i < result.second.size(); ++i) {
-            const User& reporter = result.second[i].first;
-            const QString& details = result.second[i].second;
+void AdminWindow::onRefreshUsersClicked() {
+    loadUsers();
+}
 
-            m_reportsTable->setItem(i, 0, new QTableWidgetItem(QString::number(i + 1)));
-            m_reportsTable->setItem(i, 1, new QTableWidgetItem(reporter.getUsername()));
-            m_reportsTable->setItem(i, 2, new QTableWidgetItem(details));
-        }
-    } else {
-        QMessageBox::warning(this, "Error", "Failed to load reports");
-    }
+void AdminWindow::clearSearch() {
+    m_searchTimer->stop();
+    ++*m_searchGeneration;
+    m_searchEdit->blockSignals(true);
+    m_searchEdit->clear();
+    m_searchEdit->blockSignals(false);
 }
 
-void AdminWindow::showReportDetails(int row) {
-    if (row < 0 || row >= m_reportsTable->rowCount()) {
+void AdminWindow::onSearchTextChanged() {
+    // Whatever is still running is for an outdated text
+    ++*m_searchGeneration;
+    m_searchTimer->start();
+}
+
+void AdminWindow::runSearch() {
+    QString text = m_searchEdit->text().trimmed();
+    int generation = ++*m_searchGeneration;
+    m_banUserButton->setEnabled(false);
+    m_unbanUserButton->setEnabled(false);
+
+    if (text.isEmpty()) {
+        m_usersModel->setSearchText(QString());
+        return;
+    }
+
+    if (m_searchRunning) {
+        m_searchPending = true;
         return;
     }
 
-    QString details = m_reportsTable->item(row, 2)->text();
-    m_reportDetailsText->setText(details);
+    // The first page is queried off the GUI thread; later pages come through
+    // fetchMore() as the view scrolls. Searching the banned list stays in it.
+    std::shared_ptr<std::atomic<int>> current = m_searchGeneration;
+    QPointer<AdminWindow> self(this);
+    bool bannedOnly = m_usersModel->bannedOnly();
+    m_searchRunning = true;
+    QThreadPool::globalInstance()->start([self, current, generation, text, bannedOnly]() {
+        std::shared_ptr<UserListResult> result;
+        if (current->load() == generation) {  // else superseded while queued
+            result = std::make_shared<UserListResult>(
+                AdminService::searchUsers(text, ListCursor(), UserTableModel::kPageSize, bannedOnly));
+        }
+        QMetaObject::invokeMethod(qApp, [self, current, generation, text, result]() {
+            if (!self) {
+                return;
+            }
+            self->m_searchRunning = false;
+            if (self->m_searchPending) {
+                self->m_searchPending = false;
+                self->runSearch();
+                return;
+            }
+            if (!result || current->load() != generation) {
+                return;
+            }
+            self->m_usersModel->showSearchResults(text, std::move(*result));
+        }, Qt::QueuedConnection);
+    });
 }
 
-void AdminWindow::onRefreshUsersClicked() {
-    loadUsers();
+QList<int> AdminWindow::selectedUserIds() const {
+    QList<int> userIds;
+    const QModelIndexList rows = m_usersTable->selectionModel()->selectedRows();
+    userIds.reserve(rows.size());
+    for (const QModelIndex& index : rows) {
+        int userId = m_usersModel->userId(index.row());
+        if (userId >= 0) {
+            userIds.append(userId);
+        }
+    }
+    return userIds;
+}
+
+void AdminWindow::moderateUsers(const QList<int>& userIds, bool ban) {
+    // One transaction per chunk keeps the dialog responsive and cancelable
+    const int chunkSize = 1000;
+    QProgressDialog progress(ban ? "Banning users..." : "Unbanning users...", "Cancel",
+                             0, userIds.size(), this);
+    progress.setWindowModality(Qt::WindowModal);
+    progress.setMinimumDuration(300);
+
+    int processed = 0;
+    int changed = 0;
+    int failed = 0;
+    while (processed < userIds.size() && !progress.wasCanceled()) {
+        QList<int> chunk = userIds.mid(processed, chunkSize);
+        ModerationResult result = ban ? AdminService::banUsers(chunk, "Banned by admin", m_adminUser.getId())
+                                      : AdminService::unbanUsers(chunk, m_adminUser.getId());
+        changed += result.changedCount;
+        failed += result.statuses.count(ModerationStatus::DatabaseError);
+        processed += chunk.size();
+        progress.setValue(processed);
+    }
+    progress.reset();
+
+    onUserSelectionChanged();
+    QString summary = QString("%1 of %2 users %3")
+                          .arg(changed)
+                          .arg(userIds.size())
+                          .arg(ban ? "banned" : "unbanned");
+    if (processed < userIds.size()) {
+        summary += QString("\nCanceled, %1 not processed").arg(userIds.size() - processed);
+    }
+    if (failed > 0) {
+        QMessageBox::warning(this, "Error", summary + QString("\n%1 failed").arg(failed));
+    } else {
+        QMessageBox::information(this, "Success", summary);
+    }
 }
 
 void AdminWindow::onBanUserClicked() {
-    if (m_usersTable->selectedItems().isEmpty()) {
+    QList<int> userIds = selectedUserIds();
+    if (userIds.isEmpty()) {
         QMessageBox::warning(this, "Error", "Please select a user to ban");
         return;
     }
+    if (userIds.size() > 1) {
+        moderateUsers(userIds, true);
+        return;
+    }
 
-    int userId = m_usersTable->item(m_usersTable->currentRow(), 0)->text().toInt();
-
-    QPair<bool, QString> result = AdminService::banUser(userId, "Banned by admin");
+    QPair<bool, QString> result = AdminService::banUser(userIds.first(), "Banned by admin", m_adminUser.getId());
 
     if (result.first) {
+        // The model has already patched the row through ChangeNotifier
+        onUserSelectionChanged();
         QMessageBox::information(this, "Success", result.second);
-        loadUsers();
     } else {
         QMessageBox::warning(this, "Error", result.second);
     }
 }
 
 void AdminWindow::onUnbanUserClicked() {
-    if (m_usersTable->selectedItems().isEmpty()) {
+    QList<int> userIds = selectedUserIds();
+    if (userIds.isEmpty()) {
         QMessageBox::warning(this, "Error", "Please select a user to unban");
         return;
     }
+    if (userIds.size() > 1) {
+        moderateUsers(userIds, false);
+        return;
+    }
 
-    int userId = m_usersTable->item(m_usersTable->currentRow(), 0)->text().toInt();
-
-    QPair<bool, QString> result = AdminService::unbanUser(userId);
+    QPair<bool, QString> result = AdminService::unbanUser(userIds.first(), m_adminUser.getId());
 
     if (result.first) {
+        onUserSelectionChanged();
         QMessageBox::information(this, "Success", result.second);
-        loadUsers();
     } else {
         QMessageBox::warning(this, "Error", result.second);
     }
 }
 
 void AdminWindow::onViewBannedUsersClicked() {
-    QPair<bool, QList<User>> result = AdminService::getBannedUsers();
-
-    if (result.first) {
-        m_usersTable->clearContents();
-        m_usersTable->setRowCount(0);
-
-        m_usersTable->setRowCount(result.second.size());
-
-        for (int i = 0; i < result.second.size(); ++i) {
-            const User& user = result.second[i];
-
-            m_usersTable->setItem(i, 0, new QTableWidgetItem(QString::number(user.getId())));
-            m_usersTable->setItem(i, 1, new QTableWidgetItem(user.getPhone()));
-            m_usersTable->setItem(i, 2, new QTableWidgetItem(user.getUsername()));
-            m_usersTable->setItem(i, 3, new QTableWidgetItem(user.getCreatedAt().toString("yyyy-MM-dd hh:mm:ss")));
-
-            QTableWidgetItem* statusItem = new QTableWidgetItem("Banned");
-            statusItem->setBackground(QColor(255, 150, 150));
-            m_usersTable->setItem(i, 4, statusItem);
-        }
-    } else {
-        QMessageBox::warning(this, "Error", "Failed to load banned users");
-    }
+    clearSearch();
+    m_usersModel->setBannedOnly(true);
+    m_banUserButton->setEnabled(false);
+    m_unbanUserButton->setEnabled(false);
 }
 
-void AdminWindow::onUserSelected(int row, int column) {
-    Q_UNUSED(column);
-
-    if (row < 0 || row >= m_usersTable->rowCount()) {
-        return;
+void AdminWindow::onUserSelectionChanged() {
+    // Enable whichever actions would change at least one selected user
+    bool anyBanned = false;
+    bool anyActive = false;
+    const QModelIndexList rows = m_usersTable->selectionModel()->selectedRows();
+    for (const QModelIndex& index : rows) {
+        if (m_usersModel->isBanned(index.row())) {
+            anyBanned = true;
+        } else {
+            anyActive = true;
+        }
+        if (anyBanned && anyActive) {
+            break;
+        }
     }
-
-    bool isBanned = m_usersTable->item(row, 4)->text() == "Banned";
-    m_banUserButton->setEnabled(!isBanned);
-    m_unbanUserButton->setEnabled(isBanned);
+    m_banUserButton->setEnabled(anyActive);
+    m_unbanUserButton->setEnabled(anyBanned);
 }
 
 void AdminWindow::onRefreshReportsClicked() {
@@ -329,13 +522,14 @@ void AdminWindow::onRefreshReportsClicked() {
 }
 
 void AdminWindow::onResolveReportClicked() {
-    if (m_reportsTable->selectedItems().isEmpty()) {
+    int row = m_reportsTable->currentIndex().row();
+    int reportId = m_reportsModel->reportId(row);
+    if (!m_reportsTable->selectionModel()->hasSelection() || reportId < 0) {
         QMessageBox::warning(this, "Error", "Please select a report to resolve");
         return;
     }
 
-    int row = m_reportsTable->currentRow();
-    QString reportDetails = m_reportsTable->item(row, 2)->text();
+    QString reportDetails = m_reportsModel->details(row);
 
     QStringList options = {"resolved", "rejected"};
     bool ok;
@@ -347,27 +541,48 @@ void AdminWindow::onResolveReportClicked() {
         return;
     }
 
-    // In a real implementation, we would need the actual report ID
-    // For this simplified version, we'll use the row index + 1
-    int reportId = row + 1;
-
-    QPair<bool, QString> result = AdminService::resolveReport(reportId, action);
+    QPair<bool, QString> result = AdminService::resolveReport(reportId, action, QString(), m_adminUser.getId());
 
     if (result.first) {
+        showReportDetails(row);
         QMessageBox::information(this, "Success", result.second);
-        loadReports();
     } else {
         QMessageBox::warning(this, "Error", result.second);
     }
 }
 
-void AdminWindow::onReportSelected(int row, int column) {
-    Q_UNUSED(column);
-
-    if (row < 0 || row >= m_reportsTable->rowCount()) {
+void AdminWindow::onReportSelected(const QModelIndex& index) {
+    int row = index.row();
+    if (row < 0 || row >= m_reportsModel->rowCount()) {
         return;
     }
 
     showReportDetails(row);
     m_resolveReportButton->setEnabled(true);
 }
+
+void AdminWindow::onUsersChanged(const TableChanges& changes) {
+    // May include writes by other processes, which never reached the cache
+    UserCache::getInstance().invalidate(changes);
+    m_statsTimer->start();
+    if (m_usersLoaded) {
+        m_usersModel->refreshRows(changes);
+    }
+}
+
+void AdminWindow::onReportsChanged(const TableChanges& changes) {
+    m_statsTimer->start();
+    if (!m_reportsLoaded) {
+        return;
+    }
+
+    // New reports belong at the top. Reload only when that is what is on
+    // display and nothing is being read; otherwise Refresh picks them up.
+    bool atTop = m_reportsTable->verticalScrollBar()->value() == 0;
+    bool newRows = changes.overflow || !changes.inserted.isEmpty();
+    if (newRows && atTop && !m_reportsTable->selectionModel()->hasSelection()) {
+        loadReports();
+        return;
+    }
+    m_reportsModel->refreshRows(changes);
+}
@@ -4,15 +4,23 @@
 
 #include <QDialog>
 #include <QTabWidget>
-#include <QTableWidget>
+#include <QTableView>
 #include <QPushButton>
 #include <QLabel>
 #include <QVBoxLayout>
 #include <QHBoxLayout>
 #include <QComboBox>
 #include <QTextEdit>
+#include <QLineEdit>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <atomic>
+#include <memory>
 #include "User.h"
 #include "AdminService.h"
+#include "ChangeFeed.h"
+#include "UserTableModel.h"
+#include "ReportTableModel.h"
 
 class AdminWindow : public QDialog {
     Q_OBJECT
@@ -20,18 +28,39 @@ class AdminWindow : public QDialog {
  private:
     User m_adminUser;
     QTabWidget* m_tabWidget;
+    QLabel* m_statsLabel;   // dashboard header, from AdminService::getStats()
+    QTimer* m_statsTimer;   // coalesces refreshes during bulk changes
+    QTimer* m_prefetchTimer;  // reads neighbouring pages once a view settles
+    ChangeFeed* m_changeFeed;  // writes made by other connections and processes
+
+    // Each tab's model is loaded the first time the tab is shown
+    bool m_usersLoaded = false;
+    bool m_reportsLoaded = false;
+    QElapsedTimer m_openTimer;  // since construction, for the market.admin.timing log
+    bool m_firstPaintLogged = false;
 
     // Users tab
     QWidget* m_usersTab;
-    QTableWidget* m_usersTable;
+    QTableView* m_usersTable;
+    UserTableModel* m_usersModel;
     QPushButton* m_refreshUsersButton;
+    QLineEdit* m_searchEdit;
+    QTimer* m_searchTimer;  // debounces typing in m_searchEdit
+    // Bumped per search; a worker whose number is no longer current skips
+    // its query or drops its result. Shared so workers can outlive us.
+    std::shared_ptr<std::atomic<int>> m_searchGeneration;
+    // A query cannot be stopped once SQLite runs it, so at most one search
+    // is out at a time; text changed meanwhile is searched when it returns.
+    bool m_searchRunning = false;
+    bool m_searchPending = false;
     QPushButton* m_banUserButton;
     QPushButton* m_unbanUserButton;
     QPushButton* m_viewBannedUsersButton;
 
     // Reports tab
     QWidget* m_reportsTab;
-    QTableWidget* m_reportsTable;
+    QTableView* m_reportsTable;
+    ReportTableModel* m_reportsModel;
     QPushButton* m_refreshReportsButton;
     QPushButton* m_resolveReportButton;
     QTextEdit* m_reportDetailsText;
@@ -40,7 +69,13 @@ class AdminWindow : public QDialog {
     void setupUsersTab();
     void setupReportsTab();
     void setupConnections();
+    void ensureTabLoaded(int index);
+    void prefetchVisiblePages();
+    void refreshStats();
     void loadUsers();
+    void clearSearch();
+    QList<int> selectedUserIds() const;
+    void moderateUsers(const QList<int>& userIds, bool ban);
     void loadReports();
     void showReportDetails(int row);
 
@@ -48,14 +83,21 @@ class AdminWindow : public QDialog {
     explicit AdminWindow(const User& adminUser, QWidget* parent = nullptr);
     ~AdminWindow();
 
+ protected:
+    void paintEvent(QPaintEvent* event) override;
+
  private slots:
     void onRefreshUsersClicked();
+    void onSearchTextChanged();
+    void runSearch();
     void onBanUserClicked();
     void onUnbanUserClicked();
     void onViewBannedUsersClicked();
-    void onUserSelected(int row, int column);
+    void onUserSelectionChanged();
     void onRefreshReportsClicked();
     void onResolveReportClicked();
-    void onReportSelected(int row, int column);
+    void onReportSelected(const QModelIndex& index);
+    void onUsersChanged(const TableChanges& changes);
+    void onReportsChanged(const TableChanges& changes);
 };
 #endif  // ADMINWINDOW_H
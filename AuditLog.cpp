@@ -0,0 +1,653 @@
+// Copyright 2025 MarketSystem
+#include "AuditLog.h"
+#include "DatabaseManager.h"
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QFileInfo>
+#include <QMutexLocker>
+#include <QSaveFile>
+#include <QtEndian>
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <utility>
+
+#ifdef Q_OS_WIN
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace {
+// Segment file: magic, then records of
+//   u32 payload length | u32 CRC32 of payload | payload
+// with payload
+//   u64 sequence | i64 timestamp ms | u8 event | i32 actor | i32 user |
+//   i32 report | u16 detail length | detail (UTF-8)
+// All integers little-endian.
+const char kSegmentMagic[8] = {'M', 'K', 'T', 'A', 'U', 'D', '1', '\n'};
+// Index file: magic, u32 block count, blocks, u32 CRC32 of all before it.
+const char kIndexMagic[8] = {'M', 'K', 'T', 'A', 'I', 'X', '1', '\n'};
+
+const qint64 kHeaderSize = sizeof(kSegmentMagic);
+const int kRecordHeader = 8;
+const int kFixedPayload = 8 + 8 + 1 + 4 + 4 + 4 + 2;
+const int kMaxDetail = 4096;
+const qint64 kMaxRecordBytes = kRecordHeader + kFixedPayload + kMaxDetail;
+const int kIndexBlockSize = 8 + 8 + 8 + 4 * 8;
+
+quint32 crc32(const char* data, qint64 size) {
+    static const std::array<quint32, 256> table = [] {
+        std::array<quint32, 256> t{};
+        for (quint32 i = 0; i < 256; ++i) {
+            quint32 c = i;
+            for (int k = 0; k < 8; ++k) {
+                c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            }
+            t[i] = c;
+        }
+        return t;
+    }();
+
+    quint32 crc = 0xFFFFFFFFu;
+    for (qint64 i = 0; i < size; ++i) {
+        crc = table[(crc ^ static_cast<quint8>(data[i])) & 0xFF] ^ (crc >> 8);
+    }
+    return crc ^ 0xFFFFFFFFu;
+}
+
+quint32 mixUserId(int userId) {
+    quint32 x = static_cast<quint32>(userId);
+    x ^= x >> 16;
+    x *= 0x7feb352du;
+    x ^= x >> 15;
+    x *= 0x846ca68bu;
+    x ^= x >> 16;
+    return x;
+}
+
+template <typename T>
+void put(QByteArray* out, T value) {
+    char bytes[sizeof(T)];
+    qToLittleEndian(value, bytes);
+    out->append(bytes, sizeof(T));
+}
+
+template <typename T>
+T get(const char* data) {
+    return qFromLittleEndian<T>(data);
+}
+
+// File name prefix of a writer stream: "audit-" for the first writer,
+// "audit-w<stream>-" for the others.
+QString streamPrefix(int stream) {
+    return stream == 0 ? QString("audit-") : QString("audit-w%1-").arg(stream);
+}
+
+QString lockPath(const QString& directory, int stream) {
+    return directory + (stream == 0 ? QString("/audit.lock") : QString("/audit-w%1.lock").arg(stream));
+}
+
+QString segmentPath(const QString& directory, int stream, int number) {
+    return directory + "/" + streamPrefix(stream) + QString("%1.log").arg(number, 8, 10, QChar('0'));
+}
+
+QString indexPath(const QString& directory, int stream, int number) {
+    return directory + "/" + streamPrefix(stream) + QString("%1.idx").arg(number, 8, 10, QChar('0'));
+}
+
+// Segment numbers of stream present in directory, ascending.
+QList<int> segmentNumbers(const QString& directory, int stream) {
+    QList<int> numbers;
+    QString prefix = streamPrefix(stream);
+    const QStringList names = QDir(directory).entryList({prefix + "*.log"}, QDir::Files, QDir::Name);
+    for (const QString& name : names) {
+        // "audit-*.log" also matches the other streams' files
+        if (name.size() != prefix.size() + 8 + 4) {
+            continue;
+        }
+        bool ok = false;
+        int number = name.mid(prefix.size(), 8).toInt(&ok);
+        if (ok && number > 0) {
+            numbers.append(number);
+        }
+    }
+    return numbers;
+}
+
+// Streams with segments in directory, ascending.
+QList<int> streamNumbers(const QString& directory) {
+    QList<int> streams;
+    if (!segmentNumbers(directory, 0).isEmpty()) {
+        streams.append(0);
+    }
+    const QStringList names = QDir(directory).entryList({"audit-w*-*.log"}, QDir::Files);
+    for (const QString& name : names) {
+        bool ok = false;
+        int stream = name.mid(7, name.indexOf('-', 7) - 7).toInt(&ok);
+        if (ok && stream > 0 && !streams.contains(stream)) {
+            streams.append(stream);
+        }
+    }
+    std::sort(streams.begin(), streams.end());
+    return streams;
+}
+
+void encodeRecord(const AuditRecord& record, QByteArray* out) {
+    QByteArray detail = record.detail.toUtf8().left(kMaxDetail);
+    QByteArray payload;
+    payload.reserve(kFixedPayload + detail.size());
+    put<quint64>(&payload, record.sequence);
+    put<qint64>(&payload, record.timestampMs);
+    put<quint8>(&payload, static_cast<quint8>(record.event));
+    put<qint32>(&payload, record.actorId);
+    put<qint32>(&payload, record.userId);
+    put<qint32>(&payload, record.reportId);
+    put<quint16>(&payload, static_cast<quint16>(detail.size()));
+    payload.append(detail);
+
+    put<quint32>(out, static_cast<quint32>(payload.size()));
+    put<quint32>(out, crc32(payload.constData(), payload.size()));
+    out->append(payload);
+}
+
+enum class Decoded { Ok, Corrupt, Incomplete };
+
+// Decodes the record at data. Corrupt means the checksum failed but the
+// length is plausible, so the caller can step over it by *consumed bytes;
+// Incomplete means nothing after this point can be trusted.
+Decoded decodeRecord(const char* data, qint64 available, AuditRecord* record, qint64* consumed) {
+    if (available < kRecordHeader) {
+        return Decoded::Incomplete;
+    }
+    quint32 length = get<quint32>(data);
+    if (length < quint32(kFixedPayload) || length > quint32(kFixedPayload + kMaxDetail)
+        || available < kRecordHeader + qint64(length)) {
+        return Decoded::Incomplete;
+    }
+    *consumed = kRecordHeader + length;
+
+    const char* payload = data + kRecordHeader;
+    if (crc32(payload, length) != get<quint32>(data + 4)
+        || get<quint16>(payload + 29) != length - kFixedPayload) {
+        return Decoded::Corrupt;
+    }
+
+    record->sequence = get<quint64>(payload);
+    record->timestampMs = get<qint64>(payload + 8);
+    record->event = static_cast<AuditEvent>(get<quint8>(payload + 16));
+    record->actorId = get<qint32>(payload + 17);
+    record->userId = get<qint32>(payload + 21);
+    record->reportId = get<qint32>(payload + 25);
+    record->detail = QString::fromUtf8(payload + kFixedPayload, length - kFixedPayload);
+    return Decoded::Ok;
+}
+
+// Calls visit(offset, record) for the records in data, which starts at
+// segment offset base. Returns the segment offset where decoding stopped,
+// at the end of data or at a record whose length cannot be trusted.
+// Records failing their checksum are counted in *corrupt and skipped.
+template <typename Visitor>
+qint64 walkRecords(const QByteArray& data, qint64 base, Visitor visit, int* corrupt) {
+    qint64 position = 0;
+    AuditRecord record;
+    while (position < data.size()) {
+        qint64 consumed = 0;
+        Decoded result = decodeRecord(data.constData() + position, data.size() - position, &record, &consumed);
+        if (result == Decoded::Incomplete) {
+            break;
+        }
+        if (result == Decoded::Corrupt) {
+            ++*corrupt;
+        } else {
+            visit(base + position, record);
+        }
+        position += consumed;
+    }
+    return base + position;
+}
+
+void indexRecord(QList<AuditIndexBlock>* blocks, int* fill, qint64 offset, const AuditRecord& record) {
+    if (*fill == 0) {
+        AuditIndexBlock block;
+        block.offset = offset;
+        block.minTimestampMs = record.timestampMs;
+        block.maxTimestampMs = record.timestampMs;
+        blocks->append(block);
+    }
+    blocks->last().add(record);
+    *fill = (*fill + 1) % AuditLog::kBlockRecords;
+}
+
+bool writeIndex(const QString& path, const QList<AuditIndexBlock>& blocks) {
+    QByteArray data(kIndexMagic, sizeof(kIndexMagic));
+    put<quint32>(&data, static_cast<quint32>(blocks.size()));
+    for (const AuditIndexBlock& block : blocks) {
+        put<qint64>(&data, block.offset);
+        put<qint64>(&data, block.minTimestampMs);
+        put<qint64>(&data, block.maxTimestampMs);
+        for (quint64 word : block.userBloom) {
+            put<quint64>(&data, word);
+        }
+    }
+    put<quint32>(&data, crc32(data.constData(), data.size()));
+
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly) || file.write(data) != data.size() || !file.commit()) {
+        qWarning() << "AuditLog: failed to write index" << path << file.errorString();
+        return false;
+    }
+    return true;
+}
+
+bool readIndex(const QString& path, QList<AuditIndexBlock>* blocks) {
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    QByteArray data = file.readAll();
+    const qint64 fixed = sizeof(kIndexMagic) + 4 + 4;
+    if (data.size() < fixed || std::memcmp(data.constData(), kIndexMagic, sizeof(kIndexMagic)) != 0) {
+        return false;
+    }
+    quint32 count = get<quint32>(data.constData() + sizeof(kIndexMagic));
+    if (data.size() != fixed + qint64(count) * kIndexBlockSize
+        || crc32(data.constData(), data.size() - 4) != get<quint32>(data.constData() + data.size() - 4)) {
+        qWarning() << "AuditLog: ignoring damaged index" << path;
+        return false;
+    }
+
+    const char* entry = data.constData() + sizeof(kIndexMagic) + 4;
+    blocks->clear();
+    blocks->reserve(count);
+    for (quint32 i = 0; i < count; ++i, entry += kIndexBlockSize) {
+        AuditIndexBlock block;
+        block.offset = get<qint64>(entry);
+        block.minTimestampMs = get<qint64>(entry + 8);
+        block.maxTimestampMs = get<qint64>(entry + 16);
+        for (int word = 0; word < 4; ++word) {
+            block.userBloom[word] = get<quint64>(entry + 24 + word * 8);
+        }
+        blocks->append(block);
+    }
+    return true;
+}
+
+bool syncFile(QFile& file) {
+#ifdef Q_OS_WIN
+    return _commit(file.handle()) == 0;
+#else
+    return ::fsync(file.handle()) == 0;
+#endif
+}
+}  // namespace
+
+void AuditIndexBlock::add(const AuditRecord& record) {
+    minTimestampMs = qMin(minTimestampMs, record.timestampMs);
+    maxTimestampMs = qMax(maxTimestampMs, record.timestampMs);
+    if (record.userId >= 0) {
+        quint32 hash = mixUserId(record.userId);
+        userBloom[(hash & 0xFF) >> 6] |= quint64(1) << (hash & 63);
+        userBloom[((hash >> 8) & 0xFF) >> 6] |= quint64(1) << ((hash >> 8) & 63);
+    }
+}
+
+bool AuditIndexBlock::mayContainUser(int userId) const {
+    quint32 hash = mixUserId(userId);
+    return (userBloom[(hash & 0xFF) >> 6] & (quint64(1) << (hash & 63)))
+        && (userBloom[((hash >> 8) & 0xFF) >> 6] & (quint64(1) << ((hash >> 8) & 63)));
+}
+
+AuditLog::AuditLog(const QString& directory, const Options& options)
+    : m_directory(directory), m_options(options) {
+    QDir().mkpath(m_directory);
+    if (lockStream()) {
+        recover();
+    }
+    m_writer = std::thread(&AuditLog::run, this);
+}
+
+AuditLog::~AuditLog() {
+    {
+        QMutexLocker locker(&m_mutex);
+        m_stopping = true;
+        m_workAvailable.wakeOne();
+    }
+    m_writer.join();
+    // The active segment stays unsealed; recover() picks it up next time
+    m_segment.close();
+    if (m_lock) {
+        m_lock->unlock();
+    }
+}
+
+AuditLog& AuditLog::getInstance() {
+    static AuditLog instance(QFileInfo(DatabaseManager::databasePath()).absolutePath() + "/audit");
+    return instance;
+}
+
+quint64 AuditLog::record(AuditEvent event, int actorId, int userId, int reportId, const QString& detail) {
+    AuditRecord record;
+    record.event = event;
+    record.actorId = actorId;
+    record.userId = userId;
+    record.reportId = reportId;
+    record.detail = detail;
+    return getInstance().append(std::move(record));
+}
+
+// Takes the first stream no other live writer holds. A lock left behind by
+// a process that died is stale and taken over, its torn tail included.
+bool AuditLog::lockStream() {
+    for (int stream = 0; stream < kMaxStreams; ++stream) {
+        auto lock = std::make_unique<QLockFile>(lockPath(m_directory, stream));
+        lock->setStaleLockTime(0);  // only a dead owner makes it stale
+        if (lock->tryLock(0)) {
+            m_lock = std::move(lock);
+            m_stream = stream;
+            if (stream > 0) {
+                qDebug() << "AuditLog: another writer holds" << m_directory << "- writing stream" << stream;
+            }
+            return true;
+        }
+        if (lock->error() != QLockFile::LockFailedError) {
+            qWarning() << "AuditLog: cannot create lock file" << lockPath(m_directory, stream);
+            return false;
+        }
+    }
+    qWarning() << "AuditLog: all" << kMaxStreams << "streams in" << m_directory << "are in use";
+    return false;
+}
+
+void AuditLog::recover() {
+    QList<int> numbers = segmentNumbers(m_directory, m_stream);
+    if (numbers.isEmpty()) {
+        openSegment(1, true);
+        return;
+    }
+
+    // The sequence continues after the newest record on disk
+    quint64 lastSequence = 0;
+    int corrupt = 0;
+    for (int i = numbers.size() - 1; i >= 0 && lastSequence == 0; --i) {
+        QFile file(segmentPath(m_directory, m_stream, numbers[i]));
+        if (!file.open(QIODevice::ReadOnly)) {
+            continue;
+        }
+        file.seek(kHeaderSize);
+        walkRecords(file.readAll(), kHeaderSize, [&](qint64, const AuditRecord& record) {
+            lastSequence = qMax(lastSequence, record.sequence);
+        }, &corrupt);
+    }
+    m_nextSequence = lastSequence + 1;
+
+    int last = numbers.last();
+    if (QFile::exists(indexPath(m_directory, m_stream, last))) {
+        openSegment(last + 1, true);
+        return;
+    }
+
+    // Unsealed segment: rebuild its index and cut off a torn tail. Corrupt
+    // records are stepped over and kept, as the reader does; only bytes
+    // too short to be a whole record count as a tail.
+    QString path = segmentPath(m_directory, m_stream, last);
+    qint64 validEnd = kHeaderSize;
+    qint64 fileSize = 0;
+    corrupt = 0;
+    {
+        QFile file(path);
+        if (file.open(QIODevice::ReadOnly) && file.size() >= kHeaderSize) {
+            fileSize = file.size();
+            file.seek(kHeaderSize);
+            validEnd = walkRecords(file.readAll(), kHeaderSize, [&](qint64 offset, const AuditRecord& record) {
+                indexRecord(&m_blocks, &m_blockFill, offset, record);
+            }, &corrupt);
+        }
+    }
+    if (corrupt > 0) {
+        qWarning() << "AuditLog: skipping" << corrupt << "corrupt records in" << path;
+    }
+    if (fileSize - validEnd >= kMaxRecordBytes) {
+        // Damage in the middle, not a torn write: keep every byte for
+        // inspection and continue in a new segment
+        qWarning() << "AuditLog: undecodable data at offset" << validEnd << "in" << path << "- sealing it";
+        m_segmentNumber = last;
+        sealSegment();
+        return;
+    }
+    if (validEnd < fileSize) {
+        qWarning() << "AuditLog: dropping" << fileSize - validEnd << "bytes of torn tail in" << path;
+    }
+    if (!QFile::resize(path, validEnd) || !openSegment(last, false)) {
+        m_blocks.clear();
+        m_blockFill = 0;
+        openSegment(last + 1, true);
+    }
+}
+
+bool AuditLog::openSegment(int number, bool create) {
+    m_segment.close();
+    m_segmentNumber = number;
+    m_segment.setFileName(segmentPath(m_directory, m_stream, number));
+
+    QIODevice::OpenMode mode = QIODevice::ReadWrite | QIODevice::Unbuffered;
+    if (create) {
+        mode |= QIODevice::Truncate;
+        m_blocks.clear();
+        m_blockFill = 0;
+    }
+    if (!m_segment.open(mode)) {
+        qWarning() << "AuditLog: cannot open" << m_segment.fileName() << m_segment.errorString();
+        return false;
+    }
+
+    if (create || m_segment.size() < kHeaderSize) {
+        m_segment.resize(0);
+        m_segment.write(kSegmentMagic, kHeaderSize);
+        syncFile(m_segment);
+    } else {
+        QByteArray magic = m_segment.read(kHeaderSize);
+        if (magic != QByteArray(kSegmentMagic, kHeaderSize)) {
+            qWarning() << "AuditLog: not an audit segment:" << m_segment.fileName();
+            m_segment.close();
+            return false;
+        }
+    }
+    m_segmentSize = m_segment.size();
+    m_segment.seek(m_segmentSize);
+    return true;
+}
+
+void AuditLog::sealSegment() {
+    writeIndex(indexPath(m_directory, m_stream, m_segmentNumber), m_blocks);
+    openSegment(m_segmentNumber + 1, true);
+}
+
+bool AuditLog::writeBatch(const QList<AuditRecord>& batch) {
+    bool ok = m_segment.isOpen();
+    QByteArray buffer;
+    QByteArray encoded;
+
+    auto writeOut = [&]() {
+        if (!buffer.isEmpty()) {
+            qint64 written = m_segment.write(buffer);
+            if (written != buffer.size()) {
+                ok = false;
+                // Cut off a partial write so later batches still decode
+                if (written > 0 && m_segment.resize(m_segmentSize)) {
+                    written = 0;
+                }
+                m_segment.seek(m_segmentSize + qMax<qint64>(written, 0));
+            }
+            m_segmentSize += qMax<qint64>(written, 0);
+            buffer.clear();
+        }
+        ok = syncFile(m_segment) && ok;
+    };
+
+    for (const AuditRecord& record : batch) {
+        encoded.clear();
+        encodeRecord(record, &encoded);
+
+        qint64 end = m_segmentSize + buffer.size();
+        if (end > kHeaderSize && end + encoded.size() > m_options.maxSegmentBytes) {
+            writeOut();
+            sealSegment();
+            ok = m_segment.isOpen() && ok;
+        }
+
+        indexRecord(&m_blocks, &m_blockFill, m_segmentSize + buffer.size(), record);
+        buffer.append(encoded);
+    }
+    writeOut();
+
+    if (!ok) {
+        qWarning() << "AuditLog: write to" << m_segment.fileName() << "failed:" << m_segment.errorString();
+    }
+    return ok;
+}
+
+void AuditLog::run() {
+    QMutexLocker locker(&m_mutex);
+    while (true) {
+        while (m_queue.isEmpty() && !m_stopping) {
+            m_workAvailable.wait(&m_mutex);
+        }
+        if (m_queue.isEmpty()) {
+            break;
+        }
+
+        // Group commit: let concurrent actions join this batch for a few
+        // milliseconds, unless it is full or someone is waiting on it
+        if (!m_stopping && !m_flushRequested && m_queue.size() < m_options.maxBatchRecords) {
+            m_workAvailable.wait(&m_mutex, m_options.flushIntervalMs);
+        }
+
+        QList<AuditRecord> batch;
+        batch.swap(m_queue);
+        m_flushRequested = false;
+
+        locker.unlock();
+        bool ok = writeBatch(batch);
+        locker.relock();
+
+        ++m_syncCount;
+        if (!ok) {
+            m_failedRecords += batch.size();
+        }
+        m_durableSequence = batch.last().sequence;
+        m_durable.wakeAll();
+    }
+}
+
+quint64 AuditLog::append(AuditRecord record) {
+    QMutexLocker locker(&m_mutex);
+    record.sequence = m_nextSequence++;
+    record.timestampMs = QDateTime::currentMSecsSinceEpoch();
+
+    // Wake the writer for the first record of a batch or a full batch only;
+    // in between it is already waiting out the flush interval.
+    bool wake = m_queue.isEmpty() || m_queue.size() + 1 >= m_options.maxBatchRecords;
+    quint64 sequence = record.sequence;
+    m_queue.append(std::move(record));
+    if (wake) {
+        m_workAvailable.wakeOne();
+    }
+    return sequence;
+}
+
+void AuditLog::flush() {
+    QMutexLocker locker(&m_mutex);
+    quint64 target = m_nextSequence - 1;
+    if (m_durableSequence >= target) {
+        return;
+    }
+    m_flushRequested = true;
+    m_workAvailable.wakeOne();
+    while (m_durableSequence < target) {
+        m_durable.wait(&m_mutex);
+    }
+}
+
+quint64 AuditLog::syncCount() const {
+    QMutexLocker locker(&m_mutex);
+    return m_syncCount;
+}
+
+quint64 AuditLog::failedRecords() const {
+    QMutexLocker locker(&m_mutex);
+    return m_failedRecords;
+}
+
+AuditLogReader::AuditLogReader(const QString& directory) : m_directory(directory) {}
+
+QList<AuditRecord> AuditLogReader::readRange(qint64 fromMs, qint64 toMs) const {
+    return scan(fromMs, toMs, -1);
+}
+
+QList<AuditRecord> AuditLogReader::readUser(int userId, qint64 fromMs, qint64 toMs) const {
+    return scan(fromMs, toMs, userId);
+}
+
+QList<AuditRecord> AuditLogReader::scan(qint64 fromMs, qint64 toMs, int userId) const {
+    m_corruptRecords = 0;
+    QList<AuditRecord> records;
+    int stream = 0;
+    auto collect = [&](qint64, const AuditRecord& record) {
+        if (record.timestampMs >= fromMs && record.timestampMs < toMs
+            && (userId < 0 || record.userId == userId)) {
+            records.append(record);
+            records.last().stream = stream;
+        }
+    };
+
+    const QList<int> streams = streamNumbers(m_directory);
+    for (int current : streams) {
+        stream = current;
+        scanStream(stream, fromMs, toMs, userId, collect);
+    }
+    if (streams.size() > 1) {
+        // Each stream is in sequence order already; ties keep stream order
+        std::stable_sort(records.begin(), records.end(), [](const AuditRecord& a, const AuditRecord& b) {
+            return a.timestampMs < b.timestampMs;
+        });
+    }
+    return records;
+}
+
+void AuditLogReader::scanStream(int stream, qint64 fromMs, qint64 toMs, int userId,
+                                const std::function<void(qint64, const AuditRecord&)>& collect) const {
+    for (int number : segmentNumbers(m_directory, stream)) {
+        QFile file(segmentPath(m_directory, stream, number));
+        if (!file.open(QIODevice::ReadOnly)) {
+            qWarning() << "AuditLogReader: cannot open" << file.fileName();
+            continue;
+        }
+        if (file.read(kHeaderSize) != QByteArray(kSegmentMagic, kHeaderSize)) {
+            qWarning() << "AuditLogReader: not an audit segment:" << file.fileName();
+            continue;
+        }
+
+        QList<AuditIndexBlock> blocks;
+        if (!readIndex(indexPath(m_directory, stream, number), &blocks)) {
+            // Active (or unindexed) segment: read it whole
+            walkRecords(file.readAll(), kHeaderSize, collect, &m_corruptRecords);
+            continue;
+        }
+
+        qint64 fileSize = file.size();
+        for (int i = 0; i < blocks.size(); ++i) {
+            const AuditIndexBlock& block = blocks[i];
+            if (block.maxTimestampMs < fromMs || block.minTimestampMs >= toMs
+                || (userId >= 0 && !block.mayContainUser(userId))) {
+                continue;
+            }
+            qint64 end = i + 1 < blocks.size() ? blocks[i + 1].offset : fileSize;
+            if (!file.seek(block.offset)) {
+                break;
+            }
+            walkRecords(file.read(end - block.offset), block.offset, collect, &m_corruptRecords);
+        }
+    }
+}
@@ -0,0 +1,162 @@
+// Copyright 2025 MarketSystem
+#ifndef AUDITLOG_H
+#define AUDITLOG_H
+
+#include <QFile>
+#include <QList>
+#include <QLockFile>
+#include <QMutex>
+#include <QString>
+#include <QWaitCondition>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <thread>
+
+enum class AuditEvent : quint8 {
+    UserRegistered = 1,
+    UserBanned = 2,
+    UserUnbanned = 3,
+    ReportResolved = 4
+};
+
+// One moderation or registration event. userId is the user the event is
+// about (the new, banned or reported user); actorId is who did it, -1 when
+// unknown or the system itself.
+struct AuditRecord {
+    quint64 sequence = 0;   // assigned by AuditLog::append(), starts at 1 per stream
+    int stream = 0;         // writer stream the record was read from, see AuditLog
+    qint64 timestampMs = 0; // UTC milliseconds since the epoch
+    AuditEvent event = AuditEvent::UserRegistered;
+    int actorId = -1;
+    int userId = -1;
+    int reportId = -1;
+    QString detail;         // reason, action and comment; UTF-8, max 4 KiB
+};
+
+// Per-segment sparse index, one entry per block of kBlockRecords records:
+// where the block starts, its time span and a bloom filter of its user ids.
+struct AuditIndexBlock {
+    qint64 offset = 0;
+    qint64 minTimestampMs = 0;
+    qint64 maxTimestampMs = 0;
+    quint64 userBloom[4] = {0, 0, 0, 0};
+
+    void add(const AuditRecord& record);
+    bool mayContainUser(int userId) const;
+};
+
+// Append-only audit trail in numbered segment files (audit-00000001.log,
+// ...). Every record carries a CRC32, so a torn tail after a crash is
+// detected and cut off when the log is reopened.
+//
+// Each writer owns a stream: it holds the stream's lock file (audit.lock)
+// for as long as it lives. A second writer on the same directory, e.g. the
+// daemon next to the GUI, takes the next free stream (audit-w1.lock,
+// audit-w1-00000001.log, ...), so no two writers ever append to or recover
+// the same file. Sequence numbers count per stream.
+//
+// append() only queues the record. A writer thread takes whatever queued up
+// within flushIntervalMs, writes it with one write() and one fsync, so an
+// fsync is shared by every action in the batch instead of paid by each.
+// When a segment passes maxSegmentBytes it is sealed: its sparse index is
+// written next to it (.idx) and the next segment is started.
+class AuditLog {
+ public:
+    struct Options {
+        qint64 maxSegmentBytes = 8 * 1024 * 1024;
+        int flushIntervalMs = 5;
+        int maxBatchRecords = 4096;
+    };
+
+    static const int kBlockRecords = 32;
+    static const int kMaxStreams = 64;
+
+    AuditLog(const QString& directory, const Options& options);
+    explicit AuditLog(const QString& directory) : AuditLog(directory, Options()) {}
+    ~AuditLog();  // flushes what is queued
+
+    AuditLog(const AuditLog&) = delete;
+    AuditLog& operator=(const AuditLog&) = delete;
+
+    // Log used by the services, in "audit" next to the database file.
+    static AuditLog& getInstance();
+
+    // Shorthand for getInstance().append() used by the services.
+    static quint64 record(AuditEvent event, int actorId, int userId, int reportId = -1,
+                          const QString& detail = QString());
+
+    // Queues record and returns its sequence number; never blocks on I/O.
+    // sequence and timestampMs are filled in here.
+    quint64 append(AuditRecord record);
+
+    // Waits until everything appended before the call is on disk.
+    void flush();
+
+    QString directory() const { return m_directory; }
+    int stream() const { return m_stream; }  // -1 when every stream was taken
+    quint64 syncCount() const;     // fsyncs done, one per batch
+    quint64 failedRecords() const; // records lost to write errors
+
+ private:
+    QString m_directory;
+    Options m_options;
+    std::unique_ptr<QLockFile> m_lock;
+    int m_stream = -1;
+
+    mutable QMutex m_mutex;
+    QWaitCondition m_workAvailable;
+    QWaitCondition m_durable;
+    QList<AuditRecord> m_queue;
+    quint64 m_nextSequence = 1;
+    quint64 m_durableSequence = 0;
+    quint64 m_syncCount = 0;
+    quint64 m_failedRecords = 0;
+    bool m_flushRequested = false;
+    bool m_stopping = false;
+
+    // Writer thread only
+    int m_segmentNumber = 0;
+    QFile m_segment;
+    qint64 m_segmentSize = 0;
+    QList<AuditIndexBlock> m_blocks;
+    int m_blockFill = 0;
+
+    std::thread m_writer;
+
+    bool lockStream();
+    void recover();
+    bool openSegment(int number, bool create);
+    void sealSegment();
+    bool writeBatch(const QList<AuditRecord>& batch);
+    void run();
+};
+
+// Reads the segments of every stream in an AuditLog directory, including
+// the ones still being written. Sealed segments are narrowed down through their index
+// blocks; only blocks whose time span and user bloom filter can match are
+// read and decoded.
+class AuditLogReader {
+ public:
+    explicit AuditLogReader(const QString& directory);
+
+    // Records with fromMs <= timestampMs < toMs, in sequence order; with
+    // several streams, merged by time.
+    QList<AuditRecord> readRange(qint64 fromMs, qint64 toMs) const;
+
+    // Records about userId (AuditRecord::userId), optionally within a range.
+    QList<AuditRecord> readUser(int userId, qint64 fromMs = 0,
+                                qint64 toMs = std::numeric_limits<qint64>::max()) const;
+
+    // Records skipped because their checksum did not match, in the last read.
+    int corruptRecords() const { return m_corruptRecords; }
+
+ private:
+    QString m_directory;
+    mutable int m_corruptRecords = 0;
+
+    QList<AuditRecord> scan(qint64 fromMs, qint64 toMs, int userId) const;
+    void scanStream(int stream, qint64 fromMs, qint64 toMs, int userId,
+                    const std::function<void(qint64, const AuditRecord&)>& collect) const;
+};
+#endif  // AUDITLOG_H
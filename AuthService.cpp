@@ -1,7 +1,218 @@
 // Copyright 2025 MarketSystem
 #include "AuthService.h"
+#include "AuditLog.h"
+#include "Metrics.h"
+#include "ShardRouter.h"
+#include "UserCache.h"
 #include <QCryptographicHash>
+#include <QElapsedTimer>
 #include <QRegularExpression>
+#include <QtConcurrent>
+#include <QHash>
+#include <QSet>
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <numeric>
+#include <vector>
+
+namespace {
+struct AuthMetrics {
+    Metrics::Counter& loginAttempts;
+    Metrics::Counter& logins;
+    Metrics::Counter& loginBanned;
+    Metrics::Counter& loginBadCredentials;
+    Metrics::Counter& loginBusy;
+    Metrics::Counter& loginError;
+    Metrics::Histogram& loginSeconds;
+    Metrics::Counter& registrations;
+    Metrics::Counter& registrationTaken;
+    Metrics::Counter& registrationInvalid;
+    Metrics::Counter& registrationError;
+};
+
+AuthMetrics& authMetrics() {
+    static Metrics& metrics = Metrics::getInstance();
+    static const QString loginFailures = "market_login_failures_total";
+    static const QString loginFailuresHelp = "Failed logins by reason.";
+    static const QString registrationFailures = "market_registration_failures_total";
+    static const QString registrationFailuresHelp = "Rejected registrations by reason.";
+    static AuthMetrics instance{
+        metrics.counter("market_login_attempts_total", "Login attempts."),
+        metrics.counter("market_logins_total", "Successful logins."),
+        metrics.counter(loginFailures, loginFailuresHelp, "reason=\"banned\""),
+        metrics.counter(loginFailures, loginFailuresHelp, "reason=\"bad_credentials\""),
+        metrics.counter(loginFailures, loginFailuresHelp, "reason=\"busy\""),
+        metrics.counter(loginFailures, loginFailuresHelp, "reason=\"error\""),
+        metrics.histogram("market_login_seconds", "Login latency."),
+        metrics.counter("market_registrations_total", "Accounts created, batches included."),
+        metrics.counter(registrationFailures, registrationFailuresHelp, "reason=\"taken\""),
+        metrics.counter(registrationFailures, registrationFailuresHelp, "reason=\"invalid\""),
+        metrics.counter(registrationFailures, registrationFailuresHelp, "reason=\"error\"")};
+    return instance;
+}
+
+// Full users row for phone, or for id when phone is empty, read through
+// UserCache. error is set when the read failed rather than found nothing;
+// *cached tells whether the row came from the cache.
+bool fetchUser(const QString& phone, int id, User* user, QSqlError* error, bool* cached = nullptr) {
+    UserCache& cache = UserCache::getInstance();
+    bool byPhone = !phone.isEmpty();
+    bool hit = byPhone ? cache.findByPhone(phone, user) : cache.findById(id, user);
+    if (cached) {
+        *cached = hit;
+    }
+    if (hit) {
+        return true;
+    }
+
+    const QString columns = "SELECT id, phone, password, username, created_at, is_admin, is_banned FROM users ";
+    quint64 token = cache.fillToken();
+    ShardRouter& shards = ShardRouter::getInstance();
+    QSqlQuery row = byPhone ? shards.executeForPhone(phone, columns + "WHERE phone = ?", {phone})
+                            : shards.executeForId(id, columns + "WHERE id = ?", {id});
+    if (!row.next()) {
+        if (error) {
+            *error = row.lastError();
+        }
+        return false;
+    }
+    *user = User(row.value(0).toInt(), row.value(1).toString(), row.value(2).toString(), row.value(3).toString(),
+                 row.value(4).toDateTime(), row.value(5).toBool(), row.value(6).toBool());
+    row.finish();
+    cache.insert(*user, token);
+    return true;
+}
+
+// Current is_banned for phone, or for id when phone is empty, always from
+// the database: other processes ban users too, and the cache only learns of
+// that when the row expires.
+bool readBanFlag(const QString& phone, int id, bool* banned, QSqlError* error) {
+    ShardRouter& shards = ShardRouter::getInstance();
+    QSqlQuery row = phone.isEmpty()
+        ? shards.executeForId(id, "SELECT is_banned FROM users WHERE id = ?", {id})
+        : shards.executeForPhone(phone, "SELECT is_banned FROM users WHERE phone = ?", {phone});
+    if (!row.next()) {
+        if (error) {
+            *error = row.lastError();
+        }
+        return false;
+    }
+    *banned = row.value(0).toBool();
+    return true;
+}
+
+// Counts a finished login under outcome and records its latency.
+void loginDone(Metrics::Counter& outcome, const QElapsedTimer& timer) {
+    outcome.inc();
+    authMetrics().loginSeconds.observeNs(timer.nsecsElapsed());
+}
+
+// Rows per "phone IN (...)" lookup, well below SQLite's bound-parameter limit.
+const int kPhoneLookupChunk = 500;
+
+// Marks rows whose phone already has an account. lookup runs one
+// "SELECT phone FROM users WHERE phone IN (...)" for the given phones.
+void markRegistered(const QStringList& phones, const QHash<QString, int>& firstRow,
+                    const std::function<QSqlQuery(const QString&, const QVariantList&)>& lookup,
+                    std::vector<RegistrationStatus>* statuses) {
+    for (int start = 0; start < phones.size(); start += kPhoneLookupChunk) {
+        QStringList chunk = phones.mid(start, kPhoneLookupChunk);
+        QStringList placeholders;
+        QVariantList params;
+        placeholders.reserve(chunk.size());
+        params.reserve(chunk.size());
+        for (const QString& phone : chunk) {
+            placeholders.append("?");
+            params.append(phone);
+        }
+
+        QString query = "SELECT phone FROM users WHERE phone IN (" + placeholders.join(", ") + ")";
+        QSqlQuery existing = lookup(query, params);
+        while (existing.next()) {
+            (*statuses)[firstRow.value(existing.value(0).toString())] = RegistrationStatus::AlreadyRegistered;
+        }
+    }
+}
+
+// registerUsers() with sharding on: every shard checks and inserts its own
+// rows in its own transaction, all shards at once. Rows of a shard whose
+// commit fails are DatabaseError; other shards keep theirs.
+int registerOnShards(const RegistrationBatch& batch, const QHash<QString, int>& firstRow,
+                     const std::vector<QString>& hashes, std::vector<RegistrationStatus>* statuses,
+                     std::vector<int>* ids) {
+    ShardRouter& shards = ShardRouter::getInstance();
+    std::vector<QStringList> phonesByShard(shards.shardCount());
+    for (auto it = firstRow.cbegin(); it != firstRow.cend(); ++it) {
+        phonesByShard[shards.shardForPhone(it.key())].append(it.key());
+    }
+
+    std::atomic<int> created{0};
+    shards.forEachShard([&](int shard) {
+        const QStringList& phones = phonesByShard[shard];
+        if (phones.isEmpty()) {
+            return;
+        }
+        markRegistered(phones, firstRow, [&](const QString& query, const QVariantList& params) {
+            return shards.executeQueryWithResult(shard, query, params, true);
+        }, statuses);
+
+        QList<int> rows;
+        for (const QString& phone : phones) {
+            int row = firstRow.value(phone);
+            if ((*statuses)[row] == RegistrationStatus::Created) {
+                rows.append(row);
+            }
+        }
+        if (rows.isEmpty()) {
+            return;
+        }
+        // Keep the batch's order within the shard
+        std::sort(rows.begin(), rows.end());
+
+        bool ok = shards.beginTransaction(shard);
+        int shardCreated = 0;
+        if (ok) {
+            QSqlQuery insert(shards.connection(shard));
+            ok = insert.prepare(shards.insertStatement(shard, "users", {"phone", "password", "username"}));
+            for (int i : rows) {
+                if (!ok) {
+                    break;
+                }
+                insert.bindValue(0, batch.phones[i]);
+                insert.bindValue(1, hashes[i]);
+                insert.bindValue(2, batch.usernames.value(i));
+                if (insert.exec() && insert.next()) {
+                    (*ids)[i] = insert.value(0).toInt();
+                    ++shardCreated;
+                } else {
+                    qWarning() << "registerUsers: insert failed for" << batch.phones[i]
+                               << insert.lastError().text();
+                    (*statuses)[i] = RegistrationStatus::DatabaseError;
+                }
+                insert.finish();
+            }
+            if (!ok) {
+                qWarning() << "registerUsers: failed to prepare insert:" << insert.lastError().text();
+            }
+            ok = ok && shards.commitTransaction(shard);
+            if (!ok) {
+                shards.rollbackTransaction(shard);
+            }
+        }
+
+        if (!ok) {
+            for (int i : rows) {
+                (*statuses)[i] = RegistrationStatus::DatabaseError;
+                (*ids)[i] = -1;
+            }
+            shardCreated = 0;
+        }
+        created += shardCreated;
+    });
+    return created;
+}
+}  // namespace
 
 QString AuthService::hashPassword(const QString& password) {
     // 使用 MD5 哈希（与数据库中 admin 账户一致）
@@ -13,8 +224,10 @@ QString AuthService::hashPassword(const QString& password) {
 QPair<bool, User> AuthService::registerUser(const QString& phone, const QString& password, const QString& username) {
     qDebug() << "Attempting to register user:" << phone;
 
+    AuthMetrics& metrics = authMetrics();
     if (isPhoneRegistered(phone)) {
         qDebug() << "Phone already registered:" << phone;
+        metrics.registrationTaken.inc();
         return qMakePair(false, User());
     }
 
@@ -26,6 +239,27 @@ QPair<bool, User> AuthService::registerUser(const QString& phone, const QString&
     buf[0] = 'a';
     delete[] buf;
 
+    ShardRouter& shards = ShardRouter::getInstance();
+    if (shards.isEnabled()) {
+        // The phone's shard; its UNIQUE(phone) covers every shard
+        int shard = shards.shardForPhone(phone);
+        QSqlQuery inserted = shards.executeQueryWithResult(
+            shard, shards.insertStatement(shard, "users", {"phone", "password", "username"}),
+            {phone, hashedPassword, username});
+        if (!inserted.next()) {
+            qDebug() << "Database error:" << inserted.lastError().text();
+            metrics.registrationError.inc();
+            return qMakePair(false, User());
+        }
+        int userId = inserted.value(0).toInt();
+        QDateTime createdAt = QDateTime::fromSecsSinceEpoch(inserted.value(1).toLongLong(), Qt::UTC);
+        inserted.finish();
+        qDebug() << "User created with ID:" << userId << "on shard" << shard;
+        metrics.registrations.inc();
+        AuditLog::record(AuditEvent::UserRegistered, userId, userId);
+        return qMakePair(true, User(userId, phone, hashedPassword, username, createdAt, false, false));
+    }
+
     DatabaseManager& db = DatabaseManager::getInstance();
     qDebug() << "Database open:" << db.isOpen();
 
@@ -36,68 +270,221 @@ QPair<bool, User> AuthService::registerUser(const QString& phone, const QString&
     if (db.executeQuery(query, params)) {
         int userId = db.getLastInsertId();
         qDebug() << "User created with ID:" << userId;
+        metrics.registrations.inc();
+        AuditLog::record(AuditEvent::UserRegistered, userId, userId);
         User newUser(userId, phone, hashedPassword, username, QDateTime::currentDateTime(), false, false);
         return qMakePair(true, newUser);
     }
 
     qDebug() << "Database error:" << db.getLastError();
+    metrics.registrationError.inc();
     return qMakePair(false, User());
 }
 
-QPair<bool, User> AuthService::loginUser(const QString& phone, const QString& password) {
-    qDebug() << "Attempting to login user:" << phone;
+RegistrationResult AuthService::registerUsers(const RegistrationBatch& batch) {
+    const int n = batch.size();
+    RegistrationResult result;
+    if (n == 0) {
+        return result;
+    }
 
-    // 首先检查用户是否被Ban
-    if (isUserBanned(phone)) {
-        qDebug() << "Login failed: User is banned -" << phone;
-        return qMakePair(false, User());
+    std::vector<RegistrationStatus> statuses(n, RegistrationStatus::Created);
+    std::vector<QString> messages(n);
+    std::vector<QString> hashes(n);
+
+    if (batch.passwords.size() != n) {
+        qWarning() << "registerUsers: phones and passwords have different lengths";
+        for (int i = 0; i < n; ++i) {
+            result.statuses.append(RegistrationStatus::InvalidInput);
+            result.ids.append(-1);
+            result.messages.append("Batch columns have mismatched lengths");
+        }
+        return result;
+    }
+
+    // Validate and hash in parallel; every row is independent and the
+    // per-row vectors are preallocated, so workers never share an element.
+    std::vector<int> rows(n);
+    std::iota(rows.begin(), rows.end(), 0);
+    QtConcurrent::blockingMap(rows, [&](int i) {
+        QPair<bool, QString> validation = validateUserInput(
+            batch.phones[i], batch.passwords[i], batch.usernames.value(i));
+        if (!validation.first) {
+            statuses[i] = RegistrationStatus::InvalidInput;
+            messages[i] = validation.second;
+            return;
+        }
+        hashes[i] = hashPassword(batch.passwords[i]);
+    });
+
+    // Keep the first occurrence of every phone inside the batch.
+    QHash<QString, int> firstRow;
+    firstRow.reserve(n);
+    for (int i = 0; i < n; ++i) {
+        if (statuses[i] != RegistrationStatus::Created) {
+            continue;
+        }
+        if (firstRow.contains(batch.phones[i])) {
+            statuses[i] = RegistrationStatus::DuplicateInBatch;
+        } else {
+            firstRow.insert(batch.phones[i], i);
+        }
     }
 
+    std::vector<int> ids(n, -1);
+    int created = 0;
     DatabaseManager& db = DatabaseManager::getInstance();
-    QString hashedPassword = hashPassword(password);
-    qDebug() << "Hashed password for login:" << hashedPassword;
+    const bool sharded = ShardRouter::getInstance().isEnabled();
+
+    if (sharded) {
+        created = registerOnShards(batch, firstRow, hashes, &statuses, &ids);
+    } else {
+        // Set-based existence check instead of one isPhoneRegistered() per row.
+        markRegistered(firstRow.keys(), firstRow, [&db](const QString& query, const QVariantList& params) {
+            return db.executeQueryWithResult(query, params);
+        }, &statuses);
+    }
 
-    QString query = "SELECT id, phone, username, is_admin, is_banned, created_at FROM users WHERE phone = ? AND password = ?";
-    QVariantList params = {phone, hashedPassword};
+    if (!sharded && db.beginTransaction()) {
+        QSqlQuery insert(db.getDatabase());
+        bool prepared = insert.prepare("INSERT INTO users (phone, password, username) VALUES (?, ?, ?)");
+        if (!prepared) {
+            qWarning() << "registerUsers: failed to prepare insert:" << insert.lastError().text();
+        }
 
-    qDebug() << "Executing login query:" << query;
-    QSqlQuery result = db.executeQueryWithResult(query, params);
+        for (int i = 0; i < n; ++i) {
+            if (statuses[i] != RegistrationStatus::Created) {
+                continue;
+            }
+            if (!prepared) {
+                statuses[i] = RegistrationStatus::DatabaseError;
+                continue;
+            }
+
+            insert.bindValue(0, batch.phones[i]);
+            insert.bindValue(1, hashes[i]);
+            insert.bindValue(2, batch.usernames.value(i));
+            if (insert.exec()) {
+                ids[i] = insert.lastInsertId().toInt();
+                ++created;
+            } else {
+                // A failed statement only rolls back itself, the batch goes on.
+                qWarning() << "registerUsers: insert failed for" << batch.phones[i]
+                           << insert.lastError().text();
+                statuses[i] = RegistrationStatus::DatabaseError;
+            }
+        }
+        insert.finish();
+
+        if ((batch.beforeCommit && !batch.beforeCommit()) || !db.commitTransaction()) {
+            db.rollbackTransaction();
+            for (int i = 0; i < n; ++i) {
+                if (ids[i] > 0) {
+                    statuses[i] = RegistrationStatus::DatabaseError;
+                    ids[i] = -1;
+                }
+            }
+            created = 0;
+        }
+    } else if (!sharded) {
+        for (int i = 0; i < n; ++i) {
+            if (statuses[i] == RegistrationStatus::Created) {
+                statuses[i] = RegistrationStatus::DatabaseError;
+            }
+        }
+    }
 
-    if (result.lastError().isValid()) {
-        qDebug() << "Query error:" << result.lastError().text();
+    result.statuses.reserve(n);
+    result.ids.reserve(n);
+    result.messages.reserve(n);
+    for (int i = 0; i < n; ++i) {
+        result.statuses.append(statuses[i]);
+        result.ids.append(ids[i]);
+        result.messages.append(messages[i]);
     }
+    result.createdCount = created;
 
-    if (result.next()) {
-        qDebug() << "User found in database";
+    AuthMetrics& metrics = authMetrics();
+    metrics.registrations.inc(created);
+    for (int i = 0; i < n; ++i) {
+        if (ids[i] > 0) {
+            AuditLog::record(AuditEvent::UserRegistered, ids[i], ids[i]);
+        }
+        switch (statuses[i]) {
+        case RegistrationStatus::AlreadyRegistered:
+        case RegistrationStatus::DuplicateInBatch:
+            metrics.registrationTaken.inc();
+            break;
+        case RegistrationStatus::InvalidInput:
+            metrics.registrationInvalid.inc();
+            break;
+        case RegistrationStatus::DatabaseError:
+            metrics.registrationError.inc();
+            break;
+        case RegistrationStatus::Created:
+            break;
+        }
+    }
 
-        // 再次确认用户没有被Ban（双重验证）
-        if (result.value("is_banned").toBool()) {
-            qDebug() << "Login failed: User is banned (database check) -" << phone;
-            return qMakePair(false, User());
+    qDebug() << "Bulk registration:" << created << "of" << n << "users created";
+    return result;
+}
+
+QPair<bool, User> AuthService::loginUser(const QString& phone, const QString& password) {
+    qDebug() << "Attempting to login user:" << phone;
+    AuthMetrics& metrics = authMetrics();
+    QElapsedTimer timer;
+    timer.start();
+    metrics.loginAttempts.inc();
+
+    // The row, usually cached, answers the password check. A cached ban flag
+    // may predate a ban from another process, so a hit re-reads just that.
+    User stored;
+    QSqlError error;
+    bool cached = false;
+    bool found = fetchUser(phone, -1, &stored, &error, &cached);
+    if (found && cached) {
+        bool banned = false;
+        found = readBanFlag(phone, -1, &banned, &error);
+        if (found && banned != stored.isBanned()) {
+            UserCache::getInstance().invalidate(stored.getId());
+            stored.setIsBanned(banned);
         }
+    }
+    if (!found) {
+        if (error.isValid()) {
+            qDebug() << "Query error:" << error.text();
+            loginDone(DatabaseManager::isBusyError(error) ? metrics.loginBusy : metrics.loginError, timer);
+        } else {
+            qDebug() << "User not found or password incorrect";
+            loginDone(metrics.loginBadCredentials, timer);
+        }
+        return qMakePair(false, User());
+    }
 
-        User user(
-            result.value("id").toInt(),
-            result.value("phone").toString(),
-            hashedPassword,
-            result.value("username").toString(),
-            result.value("created_at").toDateTime(),
-            result.value("is_admin").toBool(),
-            false);  // is_banned 应为 false，因为我们已经检查过
-        qDebug() << "Login successful for user:" << user.getUsername() << "isAdmin:" << user.isAdmin();
-        return qMakePair(true, user);
+    // 首先检查用户是否被Ban
+    if (stored.isBanned()) {
+        qDebug() << "Login failed: User is banned -" << phone;
+        loginDone(metrics.loginBanned, timer);
+        return qMakePair(false, User());
     }
 
-    qDebug() << "User not found or password incorrect";
-    return qMakePair(false, User());
+    if (stored.getPassword() != hashPassword(password)) {
+        qDebug() << "User not found or password incorrect";
+        loginDone(metrics.loginBadCredentials, timer);
+        return qMakePair(false, User());
+    }
+
+    qDebug() << "Login successful for user:" << stored.getUsername() << "isAdmin:" << stored.isAdmin();
+    loginDone(metrics.logins, timer);
+    return qMakePair(true, stored);
 }
 
 bool AuthService::isPhoneRegistered(const QString& phone) {
-    DatabaseManager& db = DatabaseManager::getInstance();
     QString query = "SELECT COUNT(*) as count FROM users WHERE phone = ?";
     QVariantList params = {phone};
 
-    QSqlQuery result = db.executeQueryWithResult(query, params);
+    QSqlQuery result = ShardRouter::getInstance().executeForPhone(phone, query, params);
 
     if (result.next()) {
         return result.value("count").toInt() > 0;
@@ -107,8 +494,9 @@ bool AuthService::isPhoneRegistered(const QString& phone) {
 }
 
 QPair<bool, QString> AuthService::validateUserInput(const QString& phone, const QString& password, const QString& username) {
-    // Validate phone format (simple validation for Chinese phone numbers)
-    QRegularExpression phoneRegex("^1[3-9]\\d{9}$");
+    // Validate phone format (simple validation for Chinese phone numbers).
+    // Compiled once per thread: registerUsers() validates on worker threads.
+    static thread_local const QRegularExpression phoneRegex("^1[3-9]\\d{9}$");
     if (!phoneRegex.match(phone).hasMatch()) {
         return qMakePair(false, "Invalid phone number format");
     }
@@ -127,29 +515,23 @@ QPair<bool, QString> AuthService::validateUserInput(const QString& phone, const
 }
 
 bool AuthService::isUserBanned(const QString& phone) {
-    DatabaseManager& db = DatabaseManager::getInstance();
-    QString query = "SELECT is_banned FROM users WHERE phone = ?";
-    QVariantList params = {phone};
-
-    QSqlQuery result = db.executeQueryWithResult(query, params);
-
-    if (result.next()) {
-        return result.value(0).toBool();
-    }
-
-    return false;
+    bool banned = false;
+    return readBanFlag(phone, -1, &banned, nullptr) && banned;
 }
 
 bool AuthService::isUserBannedById(int userId) {
-    DatabaseManager& db = DatabaseManager::getInstance();
-    QString query = "SELECT is_banned FROM users WHERE id = ?";
-    QVariantList params = {userId};
-
-    QSqlQuery result = db.executeQueryWithResult(query, params);
+    bool banned = false;
+    return readBanFlag(QString(), userId, &banned, nullptr) && banned;
+}
 
-    if (result.next()) {
-        return result.value(0).toBool();
-    }
+QPair<bool, User> AuthService::findUserById(int userId) {
+    User user;
+    bool found = fetchUser(QString(), userId, &user, nullptr);
+    return qMakePair(found, user);
+}
 
-    return false;
+QPair<bool, User> AuthService::findUserByPhone(const QString& phone) {
+    User user;
+    bool found = fetchUser(phone, -1, &user, nullptr);
+    return qMakePair(found, user);
 }
@@ -3,18 +3,60 @@
 #define AUTHSERVICE_H
 
 #include <QString>
+#include <QStringList>
+#include <QList>
 #include <QPair>
+#include <functional>
 #include "User.h"
 #include "DatabaseManager.h"
 
+// Column-oriented input for AuthService::registerUsers(): row i is
+// (phones[i], passwords[i], usernames[i]). usernames may be shorter than
+// phones, missing entries are treated as an empty username.
+struct RegistrationBatch {
+    QStringList phones;
+    QStringList passwords;
+    QStringList usernames;
+    // Optional. Runs on the insert transaction's connection just before it
+    // commits, so its writes commit or roll back with the rows; returning
+    // false rolls the batch back. Not called with ShardRouter enabled, where
+    // every shard commits on its own.
+    std::function<bool()> beforeCommit;
+
+    int size() const { return phones.size(); }
+};
+
+enum class RegistrationStatus {
+    Created,
+    InvalidInput,
+    DuplicateInBatch,
+    AlreadyRegistered,
+    DatabaseError
+};
+
+// Per-row outcome of AuthService::registerUsers(), indexed like the batch.
+struct RegistrationResult {
+    QList<RegistrationStatus> statuses;
+    QList<int> ids;          // assigned user id, or -1 when not created
+    QStringList messages;    // validation message for InvalidInput rows
+    int createdCount = 0;
+};
+
 class AuthService {
  public:
     static QPair<bool, User> registerUser(const QString& phone, const QString& password, const QString& username = "");
+    static RegistrationResult registerUsers(const RegistrationBatch& batch);
     static QPair<bool, User> loginUser(const QString& phone, const QString& password);
     static QString hashPassword(const QString& password);
     static bool isPhoneRegistered(const QString& phone);
     static QPair<bool, QString> validateUserInput(const QString& phone, const QString& password, const QString& username = "");
+    // Always read from the database, never the cache: a ban from another
+    // process counts at once.
     static bool isUserBanned(const QString& phone);
     static bool isUserBannedById(int userId);
+
+    // The stored row, password hash included, read through UserCache.
+    static QPair<bool, User> findUserById(int userId);
+    static QPair<bool, User> findUserByPhone(const QString& phone);
 };
 #endif  // AUTHSERVICE_H
@@ -0,0 +1,31 @@
+// Copyright 2025 MarketSystem
+#include "AutoBanPolicy.h"
+
+bool AutoBanRule::matches(const ReportStats& stats) const {
+    if (minDistinctReporters <= 0 && minPendingReports <= 0 && minTotalReports <= 0) {
+        return false;
+    }
+    return stats.distinctReporters >= minDistinctReporters
+        && stats.pendingReports >= minPendingReports
+        && stats.totalReports >= minTotalReports;
+}
+
+const AutoBanRule* AutoBanPolicy::evaluate(const ReportStats& stats) const {
+    for (const AutoBanRule& rule : m_rules) {
+        if (rule.matches(stats)) {
+            return &rule;
+        }
+    }
+    return nullptr;
+}
+
+AutoBanPolicy AutoBanPolicy::defaultPolicy() {
+    AutoBanRule rule;
+    rule.name = "Reported by many users";
+    rule.minDistinctReporters = 10;
+    rule.minPendingReports = 10;
+
+    AutoBanPolicy policy;
+    policy.addRule(rule);
+    return policy;
+}
@@ -0,0 +1,47 @@
+// Copyright 2025 MarketSystem
+#ifndef AUTOBANPOLICY_H
+#define AUTOBANPOLICY_H
+
+#include <QDateTime>
+#include <QList>
+#include <QString>
+
+// Running report counters of one reported user (user_report_stats row).
+struct ReportStats {
+    int userId = -1;
+    int totalReports = 0;
+    int pendingReports = 0;
+    int distinctReporters = 0;
+    QDateTime lastReportAt;
+};
+
+// One threshold rule; it fires when every non-zero minimum is reached.
+// A rule with all minimums at zero never fires.
+struct AutoBanRule {
+    QString name;
+    int minDistinctReporters = 0;
+    int minPendingReports = 0;
+    int minTotalReports = 0;
+
+    bool matches(const ReportStats& stats) const;
+};
+
+// Ordered list of rules checked against the counters of a freshly reported
+// user. Evaluation only looks at the counters, so it costs the same no
+// matter how many reports the user has.
+class AutoBanPolicy {
+ public:
+    void addRule(const AutoBanRule& rule) { m_rules.append(rule); }
+    const QList<AutoBanRule>& rules() const { return m_rules; }
+    bool isEmpty() const { return m_rules.isEmpty(); }
+
+    // First matching rule, or nullptr.
+    const AutoBanRule* evaluate(const ReportStats& stats) const;
+
+    // Ten different reporters with ten reports still pending.
+    static AutoBanPolicy defaultPolicy();
+
+ private:
+    QList<AutoBanRule> m_rules;
+};
+#endif  // AUTOBANPOLICY_H
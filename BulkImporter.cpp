@@ -0,0 +1,399 @@
+// Copyright 2025 MarketSystem
+#include "BulkImporter.h"
+#include "AuthService.h"
+#include "DatabaseManager.h"
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QtAlgorithms>
+#include <QtConcurrent>
+#include <cstring>
+#include <functional>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define MARKET_IMPORT_SSE2 1
+#endif
+
+namespace {
+const int kColumns = 3;
+
+// Next ',', '"', '\n' or '\r' at or after p, or end. Sixteen bytes per step
+// where SSE2 is available.
+const char* findSpecial(const char* p, const char* end) {
+#ifdef MARKET_IMPORT_SSE2
+    const __m128i comma = _mm_set1_epi8(',');
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i lf = _mm_set1_epi8('\n');
+    const __m128i cr = _mm_set1_epi8('\r');
+    while (end - p >= 16) {
+        __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        __m128i hits = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(block, comma), _mm_cmpeq_epi8(block, quote)),
+                                    _mm_or_si128(_mm_cmpeq_epi8(block, lf), _mm_cmpeq_epi8(block, cr)));
+        int mask = _mm_movemask_epi8(hits);
+        if (mask != 0) {
+            return p + qCountTrailingZeroBits(static_cast<quint32>(mask));
+        }
+        p += 16;
+    }
+#endif
+    while (p < end && *p != ',' && *p != '"' && *p != '\n' && *p != '\r') {
+        ++p;
+    }
+    return p;
+}
+
+// Splits the record at p into fields. *recordEnd is where the record stops
+// (before the line break); returns the start of the next record. Unquoted
+// fields point into the mapped file.
+const char* parseRecord(const char* p, const char* end, QList<QByteArray>* fields, const char** recordEnd) {
+    fields->clear();
+    while (true) {
+        if (p < end && *p == '"') {
+            QByteArray value;
+            ++p;
+            while (p < end) {
+                const char* q = static_cast<const char*>(std::memchr(p, '"', end - p));
+                if (!q) {
+                    value.append(p, end - p);  // unterminated: take the rest
+                    p = end;
+                    break;
+                }
+                value.append(p, q - p);
+                if (q + 1 < end && q[1] == '"') {
+                    value.append('"');
+                    p = q + 2;
+                } else {
+                    p = q + 1;
+                    break;
+                }
+            }
+            fields->append(value);
+            // Anything between the closing quote and the delimiter is dropped
+            p = findSpecial(p, end);
+            while (p < end && *p == '"') {
+                p = findSpecial(p + 1, end);
+            }
+        } else {
+            const char* start = p;
+            p = findSpecial(p, end);
+            // A quote inside an unquoted field is taken literally
+            while (p < end && *p == '"') {
+                p = findSpecial(p + 1, end);
+            }
+            fields->append(QByteArray::fromRawData(start, static_cast<int>(p - start)));
+        }
+
+        if (p < end && *p == ',') {
+            ++p;
+            continue;
+        }
+        *recordEnd = p;
+        if (p < end && *p == '\r') {
+            ++p;
+        }
+        if (p < end && *p == '\n') {
+            ++p;
+        }
+        return p;
+    }
+}
+
+struct Reject {
+    qint64 begin;
+    qint64 end;
+    QString reason;
+};
+
+// One transaction's worth of rows, parsed ahead of the writer.
+struct Chunk {
+    qint64 endOffset = 0;          // file offset after the last record
+    qint64 rowsRead = 0;           // data rows, including rejected ones
+    QStringList columns[kColumns]; // accepted rows, column-wise
+    std::vector<qint64> lineBegin; // source line of accepted row i
+    std::vector<qint64> lineEnd;
+    std::vector<Reject> rejects;   // rows with the wrong number of fields
+};
+
+Chunk parseChunk(ImportTable table, const char* data, qint64 size, qint64 offset, int maxRows) {
+    Chunk chunk;
+    const char* end = data + size;
+    const char* p = data + offset;
+    QList<QByteArray> fields;
+    const int minFields = table == ImportTable::Users ? 2 : 3;
+
+    while (p < end && chunk.rowsRead < maxRows) {
+        const char* recordEnd = p;
+        const char* begin = p;
+        p = parseRecord(p, end, &fields, &recordEnd);
+        if (recordEnd == begin && fields.size() == 1) {
+            continue;  // blank line
+        }
+
+        // Header row: only the first line can be one
+        if (begin == data) {
+            QByteArray first = fields.first().trimmed().toLower();
+            if (first == "phone" || first == "reporter_id") {
+                continue;
+            }
+        }
+
+        ++chunk.rowsRead;
+        if (fields.size() < minFields || fields.size() > kColumns) {
+            chunk.rejects.push_back({begin - data, recordEnd - data,
+                                     table == ImportTable::Users ? "Expected phone,password[,username]"
+                                                                 : "Expected reporter_id,reported_user_id,reason"});
+            continue;
+        }
+        for (int i = 0; i < kColumns; ++i) {
+            chunk.columns[i].append(i < fields.size() ? QString::fromUtf8(fields[i]) : QString());
+        }
+        chunk.lineBegin.push_back(begin - data);
+        chunk.lineEnd.push_back(recordEnd - data);
+    }
+    chunk.endOffset = p - data;
+    return chunk;
+}
+
+QString registrationReason(RegistrationStatus status, const QString& message) {
+    switch (status) {
+    case RegistrationStatus::InvalidInput:
+        return message;
+    case RegistrationStatus::DuplicateInBatch:
+        return "Duplicate phone in input";
+    case RegistrationStatus::AlreadyRegistered:
+        return "Phone already registered";
+    case RegistrationStatus::DatabaseError:
+        return "Database error";
+    case RegistrationStatus::Created:
+        break;
+    }
+    return QString();
+}
+
+void writeUsers(const Chunk& chunk, const std::function<bool()>& saveProgress,
+                std::vector<Reject>* rejects, qint64* imported) {
+    RegistrationBatch batch;
+    batch.phones = chunk.columns[0];
+    batch.passwords = chunk.columns[1];
+    batch.usernames = chunk.columns[2];
+    batch.beforeCommit = saveProgress;
+    RegistrationResult result = AuthService::registerUsers(batch);
+
+    *imported += result.createdCount;
+    for (int i = 0; i < result.statuses.size(); ++i) {
+        if (result.statuses[i] != RegistrationStatus::Created) {
+            rejects->push_back({chunk.lineBegin[i], chunk.lineEnd[i],
+                                registrationReason(result.statuses[i], result.messages.value(i))});
+        }
+    }
+}
+
+void writeReports(const Chunk& chunk, const std::function<bool()>& saveProgress,
+                  std::vector<Reject>* rejects, qint64* imported) {
+    DatabaseManager& db = DatabaseManager::getInstance();
+    const int n = chunk.columns[0].size();
+    std::vector<QString> reasons(n);
+    int inserted = 0;
+
+    if (!db.beginTransaction()) {
+        for (int i = 0; i < n; ++i) {
+            rejects->push_back({chunk.lineBegin[i], chunk.lineEnd[i], "Database error"});
+        }
+        return;
+    }
+
+    QSqlQuery insert(db.getDatabase());
+    bool prepared = insert.prepare("INSERT INTO reports (reporter_id, reported_user_id, reason) VALUES (?, ?, ?)");
+    for (int i = 0; i < n; ++i) {
+        bool reporterOk = false;
+        bool reportedOk = false;
+        int reporterId = chunk.columns[0][i].trimmed().toInt(&reporterOk);
+        int reportedId = chunk.columns[1][i].trimmed().toInt(&reportedOk);
+        const QString& reason = chunk.columns[2][i];
+        if (!reporterOk || !reportedOk) {
+            reasons[i] = "Invalid user id";
+        } else if (reporterId == reportedId) {
+            reasons[i] = "Users cannot report themselves";
+        } else if (reason.trimmed().isEmpty()) {
+            reasons[i] = "A reason is required";
+        } else if (!prepared) {
+            reasons[i] = "Database error";
+        } else {
+            insert.bindValue(0, reporterId);
+            insert.bindValue(1, reportedId);
+            insert.bindValue(2, reason);
+            // A failed statement (unknown user id) only rolls back itself
+            if (insert.exec()) {
+                ++inserted;
+            } else {
+                reasons[i] = insert.lastError().text();
+            }
+        }
+    }
+    insert.finish();
+
+    if (!saveProgress() || !db.commitTransaction()) {
+        db.rollbackTransaction();
+        inserted = 0;
+        for (int i = 0; i < n; ++i) {
+            if (reasons[i].isEmpty()) {
+                reasons[i] = "Database error";
+            }
+        }
+    }
+
+    *imported += inserted;
+    for (int i = 0; i < n; ++i) {
+        if (!reasons[i].isEmpty()) {
+            rejects->push_back({chunk.lineBegin[i], chunk.lineEnd[i], reasons[i]});
+        }
+    }
+}
+
+// Resume point: the offset reached in an input of the given size and mtime.
+struct Progress {
+    qint64 offset = 0;
+    qint64 size = -1;
+    qint64 modifiedMs = -1;
+};
+
+Progress readProgress(const QString& input) {
+    Progress progress;
+    QSqlQuery row = DatabaseManager::getInstance().executeQueryWithResult(
+        "SELECT offset, size, modified_ms FROM import_progress WHERE input = ?", {input});
+    if (row.next()) {
+        progress.offset = row.value(0).toLongLong();
+        progress.size = row.value(1).toLongLong();
+        progress.modifiedMs = row.value(2).toLongLong();
+    }
+    return progress;
+}
+
+// On the calling thread's connection, so inside its open transaction if
+// there is one
+bool saveProgress(const QString& input, const Progress& progress) {
+    return DatabaseManager::getInstance().executeQuery(
+        "INSERT OR REPLACE INTO import_progress (input, size, modified_ms, offset) VALUES (?, ?, ?, ?)",
+        {input, progress.size, progress.modifiedMs, progress.offset});
+}
+
+void appendRejects(QFile* file, const char* data, const std::vector<Reject>& rejects) {
+    QByteArray out;
+    for (const Reject& reject : rejects) {
+        out.append(data + reject.begin, static_cast<int>(reject.end - reject.begin));
+        out.append(",\"");
+        out.append(reject.reason.toUtf8().replace('"', "\"\""));
+        out.append("\"\n");
+    }
+    file->write(out);
+}
+}  // namespace
+
+ImportResult BulkImporter::importFile(ImportTable table, const QString& path, const ImportOptions& options) {
+    ImportResult result;
+    QElapsedTimer timer;
+    timer.start();
+
+    QFile input(path);
+    if (!input.open(QIODevice::ReadOnly)) {
+        result.error = "Cannot open " + path + ": " + input.errorString();
+        return result;
+    }
+    const qint64 size = input.size();
+    const qint64 modifiedMs = QFileInfo(input).lastModified().toMSecsSinceEpoch();
+
+    QString progressKey = options.progressKey.isEmpty() ? QFileInfo(path).absoluteFilePath() : options.progressKey;
+    QString rejectsPath = options.rejectsPath.isEmpty() ? path + ".rejects.csv" : options.rejectsPath;
+
+    // Progress only counts for the exact file it was saved for
+    Progress progress = readProgress(progressKey);
+    qint64 offset = 0;
+    if (progress.size == size && progress.modifiedMs == modifiedMs && progress.offset <= size) {
+        offset = progress.offset;
+        result.resumedFromOffset = offset;
+    }
+    if (offset >= size) {
+        result.ok = true;  // nothing left
+        return result;
+    }
+
+    const char* data = nullptr;
+    if (size > 0) {
+        data = reinterpret_cast<const char*>(input.map(0, size));
+        if (!data) {
+            result.error = "Cannot map " + path + ": " + input.errorString();
+            return result;
+        }
+    }
+
+    QFile rejectsFile(rejectsPath);
+    if (!rejectsFile.open(offset > 0 ? QIODevice::Append : QIODevice::WriteOnly | QIODevice::Truncate)) {
+        result.error = "Cannot open " + rejectsPath + ": " + rejectsFile.errorString();
+        return result;
+    }
+
+    // If this run is killed, the bulk load marker makes the next schema open
+    // rebuild the indexes and the search index.
+    DatabaseManager& db = DatabaseManager::getInstance();
+    bool deferred = table == ImportTable::Users && options.deferIndexes && db.beginBulkLoad();
+
+    const int chunkRows = qMax(1, options.chunkRows);
+    QFuture<Chunk> next = QtConcurrent::run(parseChunk, table, data, size, offset, chunkRows);
+    bool ok = true;
+    while (true) {
+        Chunk chunk = next.result();
+        if (chunk.rowsRead == 0) {
+            break;
+        }
+        bool last = chunk.endOffset >= size
+            || (options.maxRows >= 0 && result.rowsRead + chunk.rowsRead >= options.maxRows);
+        if (!last) {
+            next = QtConcurrent::run(parseChunk, table, data, size, chunk.endOffset, chunkRows);
+        }
+
+        // The resume point is written in the chunk's own transaction: a
+        // crash either keeps both or neither, so no chunk is imported twice
+        const Progress reached{chunk.endOffset, size, modifiedMs};
+        auto save = [&progressKey, &reached]() { return saveProgress(progressKey, reached); };
+        std::vector<Reject> rejects = std::move(chunk.rejects);
+        if (table == ImportTable::Users) {
+            writeUsers(chunk, save, &rejects, &result.imported);
+        } else {
+            writeReports(chunk, save, &rejects, &result.imported);
+        }
+        appendRejects(&rejectsFile, data, rejects);
+        result.rejected += static_cast<qint64>(rejects.size());
+        result.rowsRead += chunk.rowsRead;
+
+        // Chunks that committed nothing (all rows malformed, a failed
+        // transaction, shard files that commit on their own) move on here;
+        // repeating such a chunk adds no rows
+        bool saved = readProgress(progressKey).offset == chunk.endOffset || save();
+        if (!rejectsFile.flush() || !saved) {
+            result.error = "Cannot save progress for " + progressKey;
+            ok = false;
+            if (!last) {
+                next.waitForFinished();
+            }
+            break;
+        }
+        if (last) {
+            break;
+        }
+    }
+
+    if (deferred && !db.endBulkLoad()) {
+        result.error = "Failed to rebuild indexes after import";
+        ok = false;
+    }
+
+    input.unmap(reinterpret_cast<uchar*>(const_cast<char*>(data)));
+    result.ok = ok;
+    result.elapsedMs = timer.elapsed();
+    qDebug() << "Bulk import of" << path << ":" << result.imported << "imported," << result.rejected
+             << "rejected in" << result.elapsedMs << "ms";
+    return result;
+}
@@ -0,0 +1,57 @@
+// Copyright 2025 MarketSystem
+#ifndef BULKIMPORTER_H
+#define BULKIMPORTER_H
+
+#include <QString>
+
+enum class ImportTable {
+    Users,   // phone,password[,username]
+    Reports  // reporter_id,reported_user_id,reason
+};
+
+struct ImportOptions {
+    int chunkRows = 50000;    // rows per transaction
+    qint64 maxRows = -1;      // stop after about this many rows; -1 for all
+    QString progressKey;      // default the input's absolute path
+    QString rejectsPath;      // default <input>.rejects.csv
+    // Users only: drop the listing indexes and search triggers for the
+    // import and rebuild them once at the end. Worth it when the import is
+    // large compared to the table.
+    bool deferIndexes = true;
+};
+
+struct ImportResult {
+    bool ok = false;
+    qint64 rowsRead = 0;           // data rows read by this run
+    qint64 imported = 0;
+    qint64 rejected = 0;           // written to the rejects file
+    qint64 resumedFromOffset = 0;  // 0 when the input was started fresh
+    qint64 elapsedMs = 0;
+    QString error;
+
+    double rowsPerMinute() const {
+        return elapsedMs > 0 ? rowsRead * 60000.0 / elapsedMs : 0.0;
+    }
+};
+
+// Imports a CSV file (RFC 4180 quoting, optional header row) into users or
+// reports. The file is memory-mapped and split into records with a SIMD
+// delimiter scan on a parser thread, one chunk ahead of the writer. Users go
+// through AuthService::registerUsers(), which validates and hashes on worker
+// threads and inserts each chunk in one transaction; reports are inserted
+// the same way with a prepared statement.
+//
+// Every chunk's transaction also saves the byte offset reached in the
+// import_progress table, under progressKey, so an interrupted import
+// continues where it stopped when run again on the unchanged file. Rows that
+// cannot be imported are appended to the rejects file as the original line
+// plus a reason column, after the chunk commits: a crash in between can lose
+// that chunk's reject lines, never its rows. With ShardRouter enabled the
+// shards commit separately from the offset, and a resumed users chunk may
+// report rows it already imported as "Phone already registered".
+class BulkImporter {
+ public:
+    static ImportResult importFile(ImportTable table, const QString& path,
+                                   const ImportOptions& options = ImportOptions());
+};
+#endif  // BULKIMPORTER_H
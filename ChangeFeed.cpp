@@ -0,0 +1,240 @@
+// Copyright 2025 MarketSystem
+#include "ChangeFeed.h"
+#include "DatabaseManager.h"
+#include "ShardRouter.h"
+#include <QDebug>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QThread>
+#include <QTimer>
+#include <atomic>
+#include <vector>
+
+namespace {
+std::atomic<quint64> feedCounter{0};
+
+// Sorted ids to ranges of consecutive ids.
+QList<IdRange> toRanges(std::vector<qint64>* ids) {
+    std::sort(ids->begin(), ids->end());
+    QList<IdRange> ranges;
+    for (qint64 id : *ids) {
+        if (!ranges.isEmpty() && id <= ranges.last().last + 1) {
+            ranges.last().last = qMax(ranges.last().last, id);
+        } else {
+            ranges.append(IdRange{id, id});
+        }
+    }
+    return ranges;
+}
+}  // namespace
+
+ChangeFeed::ChangeFeed(QObject* parent)
+    : QObject(parent), m_connectionName(QString("market_feed_%1").arg(++feedCounter)) {
+    qRegisterMetaType<TableChanges>();
+}
+
+ChangeFeed::~ChangeFeed() {
+    stop();
+    closeConnection();
+}
+
+void ChangeFeed::start(int intervalMs) {
+    if (m_thread) {
+        return;
+    }
+
+    m_thread = new QThread;
+    QTimer* timer = new QTimer;
+    timer->setInterval(intervalMs);
+    timer->moveToThread(m_thread);
+    connect(m_thread, &QThread::started, timer, qOverload<>(&QTimer::start));
+    connect(timer, &QTimer::timeout, timer, [this]() { poll(); });
+    // The connection belongs to the watcher thread and is closed on it
+    connect(m_thread, &QThread::finished, timer, [this, timer]() {
+        closeConnection();
+        delete timer;
+    }, Qt::DirectConnection);
+    m_thread->start();
+}
+
+void ChangeFeed::stop() {
+    if (!m_thread) {
+        return;
+    }
+    m_thread->quit();
+    m_thread->wait();
+    delete m_thread;
+    m_thread = nullptr;
+}
+
+bool ChangeFeed::openConnection() {
+    QString path = DatabaseManager::databasePath();
+    if (m_database.isOpen() && path == m_databasePath) {
+        return true;
+    }
+
+    // New file: start over from its current state
+    closeConnection();
+    m_dataVersion = -1;
+    m_versions.clear();
+    m_lastSeq = -1;
+
+    m_database = QSqlDatabase::addDatabase("QSQLITE", m_connectionName);
+    m_database.setDatabaseName(path);
+    if (!m_database.open()) {
+        qWarning() << "ChangeFeed: failed to open database:" << m_database.lastError().text();
+        closeConnection();
+        return false;
+    }
+    m_databasePath = path;
+    return true;
+}
+
+void ChangeFeed::closeConnection() {
+    if (!m_database.isValid()) {
+        return;
+    }
+    m_database.close();
+    m_database = QSqlDatabase();
+    QSqlDatabase::removeDatabase(m_connectionName);
+}
+
+bool ChangeFeed::poll() {
+    // The change log is kept in the primary file only; rows written to
+    // shard files would never show up
+    if (ShardRouter::getInstance().isEnabled()) {
+        if (!m_refusedShards) {
+            qWarning() << "ChangeFeed: not available with sharding on";
+            m_refusedShards = true;
+        }
+        return false;
+    }
+    m_refusedShards = false;
+    if (!openConnection()) {
+        return false;
+    }
+
+    QSqlQuery query(m_database);
+    // Changes only when another connection commits
+    if (!query.exec("PRAGMA data_version") || !query.next()) {
+        qWarning() << "ChangeFeed: failed to read data_version:" << query.lastError().text();
+        return false;
+    }
+    qint64 dataVersion = query.value(0).toLongLong();
+    if (dataVersion == m_dataVersion) {
+        return true;
+    }
+    m_dataVersion = dataVersion;
+
+    // Everything below reads one snapshot
+    if (!m_database.transaction()) {
+        qWarning() << "ChangeFeed: failed to begin read:" << m_database.lastError().text();
+        return false;
+    }
+
+    QHash<QString, qint64> versions;
+    QStringList moved;
+    bool ok = query.exec("SELECT name, version FROM table_versions");
+    while (ok && query.next()) {
+        QString name = query.value(0).toString();
+        qint64 version = query.value(1).toLongLong();
+        versions.insert(name, version);
+        if (m_lastSeq >= 0 && m_versions.value(name, -1) != version) {
+            moved.append(name);
+        }
+    }
+
+    qint64 minSeq = 0;
+    qint64 maxSeq = 0;
+    if (ok) {
+        ok = query.exec("SELECT COALESCE(MIN(seq), 0), COALESCE(MAX(seq), 0) FROM change_log") && query.next();
+    }
+    if (ok) {
+        minSeq = query.value(0).toLongLong();
+        maxSeq = query.value(1).toLongLong();
+    } else {
+        qWarning() << "ChangeFeed: failed to read versions:" << query.lastError().text();
+        query.finish();
+        m_database.rollback();
+        m_dataVersion = -1;  // try again next time
+        return false;
+    }
+    query.finish();
+
+    QHash<QString, TableChanges> changes;
+    if (!moved.isEmpty()) {
+        // Trimmed past what this feed has seen, or too much to list
+        if (minSeq > m_lastSeq + 1 || maxSeq - m_lastSeq > kMaxChangesPerPoll) {
+            for (const QString& table : moved) {
+                changes[table].overflow = true;
+            }
+        } else if (!readChanges(m_lastSeq, maxSeq, &changes)) {
+            m_database.rollback();
+            m_dataVersion = -1;
+            return false;
+        }
+    }
+    m_database.commit();
+    m_versions = versions;
+    m_lastSeq = maxSeq;
+
+    // A version can move without listed rows when they were trimmed
+    for (const QString& table : moved) {
+        TableChanges tableChanges = changes.value(table);
+        if (tableChanges.isEmpty()) {
+            tableChanges.overflow = true;
+        }
+        if (table == "users") {
+            emit usersChanged(tableChanges);
+        } else if (table == "reports") {
+            emit reportsChanged(tableChanges);
+        }
+    }
+    return true;
+}
+
+bool ChangeFeed::readChanges(qint64 lastSeq, qint64 maxSeq, QHash<QString, TableChanges>* changes) {
+    QSqlQuery query(m_database);
+    query.setForwardOnly(true);
+    query.prepare("SELECT table_name, row_id, op FROM change_log WHERE seq > ? AND seq <= ?");
+    query.addBindValue(lastSeq);
+    query.addBindValue(maxSeq);
+    if (!query.exec()) {
+        qWarning() << "ChangeFeed: failed to read change log:" << query.lastError().text();
+        return false;
+    }
+
+    struct Ids {
+        std::vector<qint64> inserted;
+        std::vector<qint64> updated;
+        std::vector<qint64> deleted;
+        bool unlogged = false;
+    };
+    QHash<QString, Ids> ids;
+    while (query.next()) {
+        Ids& table = ids[query.value(0).toString()];
+        qint64 rowId = query.value(1).toLongLong();
+        QString op = query.value(2).toString();
+        if (op == "I") {
+            table.inserted.push_back(rowId);
+        } else if (op == "U") {
+            table.updated.push_back(rowId);
+        } else if (op == "O") {
+            table.unlogged = true;
+        } else {
+            table.deleted.push_back(rowId);
+        }
+    }
+
+    for (auto it = ids.begin(); it != ids.end(); ++it) {
+        TableChanges& table = (*changes)[it.key()];
+        if (it.value().unlogged) {
+            table.overflow = true;
+            continue;
+        }
+        table.inserted = toRanges(&it.value().inserted);
+        table.updated = toRanges(&it.value().updated);
+        table.deleted = toRanges(&it.value().deleted);
+    }
+    return true;
+}
@@ -0,0 +1,98 @@
+// Copyright 2025 MarketSystem
+#ifndef CHANGEFEED_H
+#define CHANGEFEED_H
+
+#include <QObject>
+#include <QHash>
+#include <QList>
+#include <QMetaType>
+#include <QSqlDatabase>
+#include <QString>
+#include <algorithm>
+
+class QThread;
+
+// Consecutive row ids first..last, both included.
+struct IdRange {
+    qint64 first = 0;
+    qint64 last = 0;
+};
+
+// Rows of one table written since the previous poll, as sorted,
+// non-overlapping ranges per kind of change. overflow means the feed fell
+// behind what change_log keeps, or rows changed unlogged (bulk load): the
+// lists are empty and any row may have changed.
+struct TableChanges {
+    QList<IdRange> inserted;
+    QList<IdRange> updated;
+    QList<IdRange> deleted;
+    bool overflow = false;
+
+    bool isEmpty() const { return !overflow && inserted.isEmpty() && updated.isEmpty() && deleted.isEmpty(); }
+
+    // True if row id may differ from what was read before the change.
+    bool touches(qint64 id) const {
+        return overflow || contains(inserted, id) || contains(updated, id) || contains(deleted, id);
+    }
+
+    static bool contains(const QList<IdRange>& ranges, qint64 id) {
+        auto it = std::upper_bound(ranges.begin(), ranges.end(), id,
+                                   [](qint64 value, const IdRange& range) { return value < range.first; });
+        return it != ranges.begin() && (it - 1)->last >= id;
+    }
+};
+Q_DECLARE_METATYPE(TableChanges)
+
+// Notices writes to users and reports from any connection or process, so
+// open views can refresh the rows that changed without reloading.
+//
+// The feed reads through a private connection. While nothing was committed
+// elsewhere a poll is a single PRAGMA data_version; otherwise the
+// trigger-maintained table_versions row shows which tables moved, and only
+// for those are the new change_log entries read and folded into id ranges.
+// ChangeNotifier covers in-process service calls synchronously; this covers
+// everything else, a poll interval later.
+class ChangeFeed : public QObject {
+    Q_OBJECT
+
+ public:
+    // A feed more than DatabaseManager::kRetainedChanges rows behind
+    // reports overflow. So do more new rows than this in one poll, since a
+    // reload is cheaper than patching that many.
+    static const int kMaxChangesPerPoll = 5000;
+
+    explicit ChangeFeed(QObject* parent = nullptr);
+    ~ChangeFeed();
+
+    // Polls every intervalMs on a watcher thread. Signals are then emitted
+    // from that thread; the default (auto) connection delivers them on the
+    // receiver's thread.
+    void start(int intervalMs = 500);
+    void stop();
+    bool isRunning() const { return m_thread != nullptr; }
+
+    // One poll on the calling thread; false on a database error or with
+    // ShardRouter enabled, which the feed cannot follow. The first poll only
+    // records where the tables are. Without start() every poll must come
+    // from the same thread.
+    bool poll();
+
+ signals:
+    void usersChanged(const TableChanges& changes);
+    void reportsChanged(const TableChanges& changes);
+
+ private:
+    QString m_connectionName;
+    QSqlDatabase m_database;
+    QString m_databasePath;          // file m_database was opened on
+    qint64 m_dataVersion = -1;
+    QHash<QString, qint64> m_versions;
+    qint64 m_lastSeq = -1;           // newest change_log row seen, -1 before the first poll
+    bool m_refusedShards = false;    // warned that sharding is on
+    QThread* m_thread = nullptr;
+
+    bool openConnection();
+    void closeConnection();
+    bool readChanges(qint64 lastSeq, qint64 maxSeq, QHash<QString, TableChanges>* changes);
+};
+#endif  // CHANGEFEED_H
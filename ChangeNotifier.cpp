@@ -0,0 +1,7 @@
+// Copyright 2025 MarketSystem
+#include "ChangeNotifier.h"
+
+ChangeNotifier& ChangeNotifier::getInstance() {
+    static ChangeNotifier instance;
+    return instance;
+}
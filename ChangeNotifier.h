@@ -0,0 +1,26 @@
+// Copyright 2025 MarketSystem
+#ifndef CHANGENOTIFIER_H
+#define CHANGENOTIFIER_H
+
+#include <QObject>
+#include <QString>
+#include "User.h"
+
+// Announces rows changed by the service layer so views can patch them in
+// place instead of reloading. Signals may be emitted from any thread; use
+// the default (auto) connection to receive them on the receiver's thread.
+class ChangeNotifier : public QObject {
+    Q_OBJECT
+
+ public:
+    static ChangeNotifier& getInstance();
+
+ signals:
+    // The stored row after the change (password left empty).
+    void userChanged(const User& user);
+    void reportStatusChanged(int reportId, const QString& status);
+
+ private:
+    ChangeNotifier() = default;
+};
+#endif  // CHANGENOTIFIER_H
@@ -0,0 +1,425 @@
+// Copyright 2025 MarketSystem
+#include "DataExporter.h"
+#include "DatabaseManager.h"
+#include <QByteArray>
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QSaveFile>
+#include <QtEndian>
+#include <memory>
+#include <vector>
+
+namespace {
+// Columnar file layout (integers little-endian):
+//   magic "MKTCOL1\n" | u8 table | u8 column count |
+//   per column: u8 type | u8 name length | name
+//   row groups: u32 rows (> 0) | per column: u32 byte length | column bytes
+//   end: u32 0 | u64 total rows
+// Column bytes per type, for each row of the group:
+//   Integer          zigzag varint of the difference to the previous row
+//                    (first row: to 0)
+//   NullableInteger  u8 present, then as Integer if present
+//   Text             varint byte length | UTF-8
+//   Boolean          u8 0/1
+const char kColumnarMagic[8] = {'M', 'K', 'T', 'C', 'O', 'L', '1', '\n'};
+
+enum class ColumnType : quint8 { Integer = 1, NullableInteger = 2, Text = 3, Boolean = 4 };
+
+struct Column {
+    const char* name;
+    ColumnType type;
+};
+
+// Timestamps are exported as Unix seconds (UTC).
+const std::vector<Column> kUserColumns = {
+    {"id", ColumnType::Integer},
+    {"phone", ColumnType::Text},
+    {"username", ColumnType::Text},
+    {"created_at", ColumnType::Integer},
+    {"is_admin", ColumnType::Boolean},
+    {"is_banned", ColumnType::Boolean}};
+
+const char* const kUserQuery =
+    "SELECT id, phone, username, CAST(strftime('%s', created_at) AS INTEGER), is_admin, is_banned "
+    "FROM users ORDER BY id";
+
+const std::vector<Column> kReportColumns = {
+    {"id", ColumnType::Integer},
+    {"reporter_id", ColumnType::Integer},
+    {"reported_user_id", ColumnType::Integer},
+    {"reason", ColumnType::Text},
+    {"status", ColumnType::Text},
+    {"created_at", ColumnType::Integer},
+    {"resolved_at", ColumnType::NullableInteger}};
+
+const char* const kReportQuery =
+    "SELECT id, reporter_id, reported_user_id, reason, status, "
+    "CAST(strftime('%s', created_at) AS INTEGER), CAST(strftime('%s', resolved_at) AS INTEGER) "
+    "FROM reports ORDER BY id";
+
+// Fixed-size staging buffer in front of the device.
+class OutputBuffer {
+ public:
+    explicit OutputBuffer(QIODevice* device) : m_device(device) {
+        m_data.reserve(DataExporter::kBufferBytes);
+    }
+
+    void append(const char* data, int size) {
+        m_data.append(data, size);
+        if (m_data.size() >= DataExporter::kBufferBytes) {
+            flush();
+        }
+    }
+    void append(const QByteArray& data) { append(data.constData(), data.size()); }
+    void append(char c) { append(&c, 1); }
+
+    bool flush() {
+        if (!m_data.isEmpty() && m_ok) {
+            m_ok = m_device->write(m_data) == m_data.size();
+            m_written += m_data.size();
+        }
+        m_data.resize(0);  // keeps the capacity
+        return m_ok;
+    }
+
+    bool ok() const { return m_ok; }
+    qint64 written() const { return m_written; }
+
+ private:
+    QIODevice* m_device;
+    QByteArray m_data;
+    qint64 m_written = 0;
+    bool m_ok = true;
+};
+
+void appendVarint(QByteArray* out, quint64 value) {
+    while (value >= 0x80) {
+        out->append(static_cast<char>((value & 0x7F) | 0x80));
+        value >>= 7;
+    }
+    out->append(static_cast<char>(value));
+}
+
+template <typename T>
+void appendLittleEndian(QByteArray* out, T value) {
+    char bytes[sizeof(T)];
+    qToLittleEndian(value, bytes);
+    out->append(bytes, sizeof(T));
+}
+
+// Text a spreadsheet would run as a formula (a username like
+// "=HYPERLINK(...)") gets a leading ' and is quoted, so it opens as text.
+void appendCsvField(OutputBuffer* out, const QByteArray& text) {
+    bool formula = !text.isEmpty() && QByteArray("=+-@\t\r").contains(text.at(0));
+    bool quote = formula;
+    for (char c : text) {
+        if (c == ',' || c == '"' || c == '\n' || c == '\r') {
+            quote = true;
+            break;
+        }
+    }
+    if (!quote) {
+        out->append(text);
+        return;
+    }
+    out->append('"');
+    if (formula) {
+        out->append('\'');
+    }
+    for (char c : text) {
+        if (c == '"') {
+            out->append('"');
+        }
+        out->append(c);
+    }
+    out->append('"');
+}
+
+void appendJsonString(OutputBuffer* out, const QByteArray& text) {
+    static const char hex[] = "0123456789abcdef";
+    out->append('"');
+    for (char c : text) {
+        unsigned char u = static_cast<unsigned char>(c);
+        if (c == '"' || c == '\\') {
+            out->append('\\');
+            out->append(c);
+        } else if (u < 0x20) {
+            char escaped[6] = {'\\', 'u', '0', '0', hex[u >> 4], hex[u & 0xF]};
+            out->append(escaped, 6);
+        } else {
+            out->append(c);  // UTF-8 passes through
+        }
+    }
+    out->append('"');
+}
+
+class RowEncoder {
+ public:
+    RowEncoder(const std::vector<Column>& columns, OutputBuffer* out) : m_columns(columns), m_out(out) {}
+    virtual ~RowEncoder() = default;
+
+    virtual void begin(ExportTable) {}
+    virtual void row(const QSqlQuery& query) = 0;
+    virtual void end(qint64) {}
+
+ protected:
+    const std::vector<Column>& m_columns;
+    OutputBuffer* m_out;
+};
+
+class CsvEncoder : public RowEncoder {
+ public:
+    using RowEncoder::RowEncoder;
+
+    void begin(ExportTable) override {
+        for (size_t i = 0; i < m_columns.size(); ++i) {
+            if (i > 0) {
+                m_out->append(',');
+            }
+            m_out->append(QByteArray(m_columns[i].name));
+        }
+        m_out->append("\r\n", 2);
+    }
+
+    void row(const QSqlQuery& query) override {
+        for (size_t i = 0; i < m_columns.size(); ++i) {
+            if (i > 0) {
+                m_out->append(',');
+            }
+            QVariant value = query.value(static_cast<int>(i));
+            switch (m_columns[i].type) {
+            case ColumnType::Integer:
+            case ColumnType::NullableInteger:
+                if (!value.isNull()) {
+                    m_out->append(QByteArray::number(value.toLongLong()));
+                }
+                break;
+            case ColumnType::Text:
+                appendCsvField(m_out, value.toString().toUtf8());
+                break;
+            case ColumnType::Boolean:
+                m_out->append(value.toBool() ? '1' : '0');
+                break;
+            }
+        }
+        m_out->append("\r\n", 2);
+    }
+};
+
+class NdJsonEncoder : public RowEncoder {
+ public:
+    NdJsonEncoder(const std::vector<Column>& columns, OutputBuffer* out) : RowEncoder(columns, out) {
+        // Keys never need escaping
+        for (size_t i = 0; i < columns.size(); ++i) {
+            m_keys.push_back((i > 0 ? ",\"" : "{\"") + QByteArray(columns[i].name) + "\":");
+        }
+    }
+
+    void row(const QSqlQuery& query) override {
+        for (size_t i = 0; i < m_columns.size(); ++i) {
+            m_out->append(m_keys[i]);
+            QVariant value = query.value(static_cast<int>(i));
+            if (value.isNull() && m_columns[i].type != ColumnType::Text) {
+                m_out->append("null", 4);
+                continue;
+            }
+            switch (m_columns[i].type) {
+            case ColumnType::Integer:
+            case ColumnType::NullableInteger:
+                m_out->append(QByteArray::number(value.toLongLong()));
+                break;
+            case ColumnType::Text:
+                appendJsonString(m_out, value.toString().toUtf8());
+                break;
+            case ColumnType::Boolean:
+                if (value.toBool()) {
+                    m_out->append("true", 4);
+                } else {
+                    m_out->append("false", 5);
+                }
+                break;
+            }
+        }
+        m_out->append("}\n", 2);
+    }
+
+ private:
+    std::vector<QByteArray> m_keys;  // {"id": / ,"phone": ...
+};
+
+// Collects kRowGroupRows rows per column, then writes the group.
+class ColumnarEncoder : public RowEncoder {
+ public:
+    ColumnarEncoder(const std::vector<Column>& columns, OutputBuffer* out)
+        : RowEncoder(columns, out), m_data(columns.size()), m_previous(columns.size(), 0) {}
+
+    void begin(ExportTable table) override {
+        QByteArray header(kColumnarMagic, sizeof(kColumnarMagic));
+        header.append(static_cast<char>(table == ExportTable::Users ? 0 : 1));
+        header.append(static_cast<char>(m_columns.size()));
+        for (const Column& column : m_columns) {
+            QByteArray name(column.name);
+            header.append(static_cast<char>(column.type));
+            header.append(static_cast<char>(name.size()));
+            header.append(name);
+        }
+        m_out->append(header);
+    }
+
+    void row(const QSqlQuery& query) override {
+        for (size_t i = 0; i < m_columns.size(); ++i) {
+            QVariant value = query.value(static_cast<int>(i));
+            QByteArray& data = m_data[i];
+            switch (m_columns[i].type) {
+            case ColumnType::NullableInteger:
+                data.append(static_cast<char>(value.isNull() ? 0 : 1));
+                if (value.isNull()) {
+                    break;
+                }
+                Q_FALLTHROUGH();
+            case ColumnType::Integer: {
+                qint64 current = value.toLongLong();
+                qint64 delta = current - m_previous[i];
+                appendVarint(&data, (static_cast<quint64>(delta) << 1) ^ static_cast<quint64>(delta >> 63));
+                m_previous[i] = current;
+                break;
+            }
+            case ColumnType::Text: {
+                QByteArray text = value.toString().toUtf8();
+                appendVarint(&data, static_cast<quint64>(text.size()));
+                data.append(text);
+                break;
+            }
+            case ColumnType::Boolean:
+                data.append(static_cast<char>(value.toBool() ? 1 : 0));
+                break;
+            }
+        }
+        if (++m_groupRows == DataExporter::kRowGroupRows) {
+            writeGroup();
+        }
+    }
+
+    void end(qint64 totalRows) override {
+        writeGroup();
+        QByteArray footer;
+        appendLittleEndian<quint32>(&footer, 0);
+        appendLittleEndian<quint64>(&footer, static_cast<quint64>(totalRows));
+        m_out->append(footer);
+    }
+
+ private:
+    std::vector<QByteArray> m_data;
+    std::vector<qint64> m_previous;
+    int m_groupRows = 0;
+
+    void writeGroup() {
+        if (m_groupRows == 0) {
+            return;
+        }
+        QByteArray length;
+        appendLittleEndian<quint32>(&length, static_cast<quint32>(m_groupRows));
+        m_out->append(length);
+        for (size_t i = 0; i < m_data.size(); ++i) {
+            length.resize(0);
+            appendLittleEndian<quint32>(&length, static_cast<quint32>(m_data[i].size()));
+            m_out->append(length);
+            m_out->append(m_data[i]);
+            m_data[i].resize(0);
+            m_previous[i] = 0;
+        }
+        m_groupRows = 0;
+    }
+};
+}  // namespace
+
+ExportResult DataExporter::exportTable(ExportTable table, ExportFormat format, QIODevice* out) {
+    ExportResult result;
+    QElapsedTimer timer;
+    timer.start();
+
+    const std::vector<Column>& columns = table == ExportTable::Users ? kUserColumns : kReportColumns;
+    OutputBuffer buffer(out);
+    std::unique_ptr<RowEncoder> encoder;
+    switch (format) {
+    case ExportFormat::Csv:
+        encoder.reset(new CsvEncoder(columns, &buffer));
+        break;
+    case ExportFormat::NdJson:
+        encoder.reset(new NdJsonEncoder(columns, &buffer));
+        break;
+    case ExportFormat::Columnar:
+        encoder.reset(new ColumnarEncoder(columns, &buffer));
+        break;
+    }
+
+    DatabaseManager& db = DatabaseManager::getInstance();
+    if (!db.beginTransaction(DatabaseManager::TransactionMode::Read)) {
+        result.error = "Cannot start read transaction: " + db.getLastError();
+        return result;
+    }
+
+    QSqlQuery query = db.executeQueryWithResult(table == ExportTable::Users ? kUserQuery : kReportQuery,
+                                                {}, true);
+    if (!query.isActive()) {
+        result.error = "Export query failed: " + query.lastError().text();
+        db.rollbackTransaction();
+        return result;
+    }
+
+    encoder->begin(table);
+    while (buffer.ok() && query.next()) {
+        encoder->row(query);
+        ++result.rows;
+    }
+    bool queryFailed = query.lastError().isValid();
+    query.finish();
+    encoder->end(result.rows);
+    buffer.flush();
+    db.commitTransaction();  // read-only, only ends the snapshot
+
+    result.bytes = buffer.written();
+    result.elapsedMs = timer.elapsed();
+    if (!buffer.ok()) {
+        result.error = "Write failed: " + out->errorString();
+    } else if (queryFailed) {
+        result.error = "Reading rows failed: " + query.lastError().text();
+    } else {
+        result.ok = true;
+    }
+    return result;
+}
+
+ExportResult DataExporter::exportToFile(ExportTable table, ExportFormat format, const QString& path) {
+    // The file only appears, complete, once the export has succeeded
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        ExportResult result;
+        result.error = "Cannot open " + path + ": " + file.errorString();
+        return result;
+    }
+
+    ExportResult result = exportTable(table, format, &file);
+    if (!result.ok) {
+        file.cancelWriting();
+        qWarning() << "Export to" << path << "failed:" << result.error;
+    } else if (!file.commit()) {
+        result.ok = false;
+        result.error = "Cannot write " + path + ": " + file.errorString();
+    }
+    return result;
+}
+
+bool DataExporter::parseFormat(const QString& name, ExportFormat* format) {
+    QString lower = name.toLower();
+    if (lower == "csv") {
+        *format = ExportFormat::Csv;
+    } else if (lower == "ndjson" || lower == "jsonl") {
+        *format = ExportFormat::NdJson;
+    } else if (lower == "columnar" || lower == "bin") {
+        *format = ExportFormat::Columnar;
+    } else {
+        return false;
+    }
+    return true;
+}
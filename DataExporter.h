@@ -0,0 +1,47 @@
+// Copyright 2025 MarketSystem
+#ifndef DATAEXPORTER_H
+#define DATAEXPORTER_H
+
+#include <QIODevice>
+#include <QString>
+
+enum class ExportTable { Users, Reports };
+
+enum class ExportFormat {
+    Csv,       // RFC 4180, header row first; see appendCsvField()
+    NdJson,    // one JSON object per line
+    Columnar   // binary row groups, see DataExporter.cpp
+};
+
+struct ExportResult {
+    bool ok = false;
+    qint64 rows = 0;
+    qint64 bytes = 0;      // written to the device
+    qint64 elapsedMs = 0;
+    QString error;
+
+    double megabytesPerSecond() const {
+        return elapsedMs > 0 ? bytes / (1024.0 * 1024.0) / (elapsedMs / 1000.0) : 0.0;
+    }
+};
+
+// Streams a whole table out without materializing it. Rows come from one
+// forward-only query inside a read transaction, so the export is a single
+// consistent snapshot. Writers carry on meanwhile, since DatabaseManager
+// keeps the file in WAL mode, but the log cannot be checkpointed past the
+// snapshot, so it grows until the export ends. Rows are encoded into a fixed kBufferBytes buffer that is written
+// out whenever it fills.
+// Memory use is the same for a thousand rows or a hundred million.
+// Password hashes are never exported.
+class DataExporter {
+ public:
+    static const int kBufferBytes = 64 * 1024;
+    static const int kRowGroupRows = 4096;  // Columnar only
+
+    static ExportResult exportTable(ExportTable table, ExportFormat format, QIODevice* out);
+    static ExportResult exportToFile(ExportTable table, ExportFormat format, const QString& path);
+
+    // "csv", "ndjson"/"jsonl", "columnar"/"bin"; false when unknown.
+    static bool parseFormat(const QString& name, ExportFormat* format);
+};
+#endif  // DATAEXPORTER_H
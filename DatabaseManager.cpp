@@ -1,21 +1,143 @@
 // Copyright 2025 MarketSystem
 #include "DatabaseManager.h"
+#include "Metrics.h"
+#include "UserCache.h"
 #include <QFile>
 #include <QTextStream>
 #include <QStandardPaths>
 #include <QVariantList>
+#include <QStringList>
 #include <QSqlDriver>
 #include <QDir>
 #include <QDebug>
 #include <QCryptographicHash>
+#include <QThreadStorage>
+#include <QMutexLocker>
+#include <QRandomGenerator>
+#include <QElapsedTimer>
+
+namespace {
+// Milliseconds SQLite retries internally before reporting SQLITE_BUSY.
+std::atomic<int> busyTimeoutMs{5000};
+
+QMutex retryPolicyMutex;
+DatabaseManager::RetryPolicy retryPolicySetting;
+
+std::atomic<quint64> busyErrorCount{0};
+std::atomic<quint64> retryCount{0};
+std::atomic<quint64> recoveredCount{0};
+std::atomic<quint64> exhaustedCount{0};
+std::atomic<quint64> backoffMsTotal{0};
+
+// Per thread, like the connections: transactions open on any connection
+// (the primary or thread connection and shard connections), and whether
+// the last statement gave up on a lock.
+thread_local int openTransactions = 0;
+thread_local bool lastStatementBusy = false;
+
+Metrics::Gauge& threadConnectionGauge() {
+    static Metrics::Gauge& gauge = Metrics::getInstance().gauge(
+        "market_db_thread_connections", "Open per-thread database connections.");
+    return gauge;
+}
+
+// Connection opened lazily for a non-owner thread and closed when the
+// thread exits (QThreadStorage deletes it).
+struct ThreadConnection {
+    QSqlDatabase database;
+    QString name;
+    int generation = -1;
+    int busyTimeout = -1;  // as last applied to database
+
+    void reset() {
+        if (name.isEmpty()) {
+            return;
+        }
+        if (database.isOpen()) {
+            threadConnectionGauge().add(-1);
+        }
+        database.close();
+        database = QSqlDatabase();
+        QSqlDatabase::removeDatabase(name);
+        name.clear();
+    }
+
+    ~ThreadConnection() {
+        reset();
+    }
+};
+
+QThreadStorage<ThreadConnection*> threadConnections;
+std::atomic<quint64> threadConnectionCounter{0};
+
+// Every statement of the process, shard files included, goes through
+// execWithRetry()
+struct StatementMetrics {
+    Metrics::Counter& statements;
+    Metrics::Counter& errors;
+    Metrics::Counter& busyRetries;
+    Metrics::Histogram& seconds;
+};
+
+StatementMetrics& statementMetrics() {
+    static Metrics& metrics = Metrics::getInstance();
+    static StatementMetrics instance{
+        metrics.counter("market_db_statements_total", "SQL statements executed."),
+        metrics.counter("market_db_statement_errors_total", "SQL statements that failed, after retries."),
+        metrics.counter("market_db_busy_retries_total", "Statement retries after SQLITE_BUSY or SQLITE_LOCKED."),
+        metrics.histogram("market_db_statement_seconds", "Time in SQL statements, retries included.")};
+    return instance;
+}
+
+// Newest-first user listings (AdminService::listUsersAfter); the only user
+// indexes dropped during a bulk load.
+const char* const kUserListIndexes[] = {
+    "CREATE INDEX IF NOT EXISTS idx_users_created ON users(created_at, id)",
+    "CREATE INDEX IF NOT EXISTS idx_users_banned_created ON users(is_banned, created_at, id)"};
+
+// Tells ChangeFeed that rows changed without being logged
+const char* const kLogOverflow =
+    "INSERT INTO change_log (table_name, row_id, op) VALUES ('users', 0, 'O'), ('reports', 0, 'O')";
+
+const int kSqliteBusy = 5;
+const int kSqliteLocked = 6;
+
+// Extended codes (SQLITE_BUSY_SNAPSHOT etc.) keep the primary code in the
+// low byte.
+int primaryErrorCode(const QSqlError& error) {
+    bool ok = false;
+    int code = error.nativeErrorCode().toInt(&ok) & 0xff;
+    return ok ? code : -1;
+}
+
+// Set by setDatabasePath(); empty means the default AppData location.
+QString databasePathOverride;
+QMutex databasePathMutex;
+}  // namespace
 
-DatabaseManager::DatabaseManager() {
+QString DatabaseManager::databasePath() {
+    {
+        QMutexLocker locker(&databasePathMutex);
+        if (!databasePathOverride.isEmpty()) {
+            return databasePathOverride;
+        }
+    }
     // 获取应用程序数据目录
     QString appDataPath = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
-    QDir().mkpath(appDataPath);  // 确保目录存在
+    return appDataPath + "/marketplace.db";
+}
 
+void DatabaseManager::setDatabasePath(const QString& path) {
+    QMutexLocker locker(&databasePathMutex);
+    databasePathOverride = path;
+}
+
+DatabaseManager::DatabaseManager()
+    : m_ownerThread(QThread::currentThread()) {
     // 数据库文件路径
-    QString dbPath = appDataPath + "/marketplace.db";
+    QString dbPath = databasePath();
+    QDir().mkpath(QFileInfo(dbPath).absolutePath());  // 确保目录存在
+    m_databasePath = dbPath;
 
     // INTENTIONAL: allocate a QFile on the heap and leave it open (resource leak)
     /*QFile* leakFile = new QFile(dbPath + ".lock");
@@ -34,18 +156,30 @@ DatabaseManager::DatabaseManager() {
 }
 
 DatabaseManager::~DatabaseManager() {
-    close();
+    // Static destruction runs on the main thread; when another thread owns
+    // the primary connection it has been closed there already
+    if (QThread::currentThread() == m_ownerThread.load()) {
+        close();
+    }
 }
 
 DatabaseManager& DatabaseManager::getInstance() {
     static DatabaseManager instance;
 
+    // Only the thread that owns the primary connection may replace it. Other
+    // threads never touch m_database; their connections follow a reopen via
+    // m_generation in connection().
+    if (QThread::currentThread() != instance.m_ownerThread.load()) {
+        return instance;
+    }
+
     // If the on-disk database file was removed by tests between suites, reinitialize
     // so each test suite can start with a clean database when using test mode.
-    QString appDataPath = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
-    QString dbPath = appDataPath + "/marketplace.db";
+    // A path switched with setDatabasePath() is picked up the same way.
+    QString dbPath = databasePath();
+    QMutexLocker locker(&instance.m_mutex);
 
-    if (!QFile::exists(dbPath) || !instance.m_database.isOpen()) {
+    if (!QFile::exists(dbPath) || !instance.m_database.isOpen() || dbPath != instance.m_databasePath) {
         // Close and remove the existing connection safely, then recreate and initialize.
         QString connName = instance.m_database.connectionName();
         instance.close();
@@ -53,9 +187,15 @@ DatabaseManager& DatabaseManager::getInstance() {
         instance.m_database = QSqlDatabase();
         QSqlDatabase::removeDatabase(connName);
 
+        QDir().mkpath(QFileInfo(dbPath).absolutePath());
+        removeStaleWal(dbPath);
         QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE");
         db.setDatabaseName(dbPath);
         instance.m_database = db;
+        instance.m_databasePath = dbPath;
+        ++instance.m_generation;
+        // Rows cached from the old file must not answer for the new one
+        UserCache::getInstance().clear();
         if (!instance.initializeDatabase()) {
             qCritical() << "Failed to reinitialize database in getInstance";
         }
@@ -71,9 +211,188 @@ bool DatabaseManager::initializeDatabase() {
     }
 
     qDebug() << "Database opened successfully";
+    configureConnection(m_database);
+    m_busyTimeout = busyTimeoutMs.load();
+    if (!enableWal(m_database)) {
+        return false;
+    }
     return executeSchema();
 }
 
+bool DatabaseManager::enableWal(QSqlDatabase& database) {
+    QSqlQuery query(database);
+    if (!query.exec("PRAGMA journal_mode = WAL") || !query.next()) {
+        qCritical() << "Failed to enable WAL:" << query.lastError().text();
+        return false;
+    }
+    // A file system without shared memory keeps the old mode
+    QString mode = query.value(0).toString();
+    if (mode.compare("wal", Qt::CaseInsensitive) != 0) {
+        qWarning() << "Database stays in" << mode << "journal mode; readers and writers block each other";
+    }
+    return true;
+}
+
+void DatabaseManager::removeStaleWal(const QString& path) {
+    if (!QFile::exists(path)) {
+        QFile::remove(path + "-wal");
+        QFile::remove(path + "-shm");
+    }
+}
+
+void DatabaseManager::configureConnection(QSqlDatabase& database) {
+    QSqlQuery query(database);
+    if (!query.exec(QString("PRAGMA busy_timeout = %1;").arg(busyTimeoutMs.load()))) {
+        qWarning() << "Failed to set busy timeout:" << query.lastError().text();
+    }
+}
+
+void DatabaseManager::setBusyTimeout(int ms) {
+    busyTimeoutMs = qMax(0, ms);
+}
+
+int DatabaseManager::busyTimeout() {
+    return busyTimeoutMs.load();
+}
+
+void DatabaseManager::setRetryPolicy(const RetryPolicy& policy) {
+    QMutexLocker locker(&retryPolicyMutex);
+    retryPolicySetting = policy;
+}
+
+DatabaseManager::RetryPolicy DatabaseManager::retryPolicy() {
+    QMutexLocker locker(&retryPolicyMutex);
+    return retryPolicySetting;
+}
+
+DatabaseManager::BusyStats DatabaseManager::busyStats() {
+    BusyStats stats;
+    stats.busyErrors = busyErrorCount.load();
+    stats.retries = retryCount.load();
+    stats.recovered = recoveredCount.load();
+    stats.exhausted = exhaustedCount.load();
+    stats.backoffMs = backoffMsTotal.load();
+    return stats;
+}
+
+void DatabaseManager::resetBusyStats() {
+    busyErrorCount = 0;
+    retryCount = 0;
+    recoveredCount = 0;
+    exhaustedCount = 0;
+    backoffMsTotal = 0;
+}
+
+bool DatabaseManager::isBusyError(const QSqlError& error) {
+    int code = primaryErrorCode(error);
+    return code == kSqliteBusy || code == kSqliteLocked;
+}
+
+bool DatabaseManager::lastErrorWasBusy() const {
+    return lastStatementBusy;
+}
+
+bool DatabaseManager::execWithRetry(QSqlQuery& query, bool retryInTransaction) {
+    StatementMetrics& metrics = statementMetrics();
+    QElapsedTimer timer;
+    timer.start();
+    metrics.statements.inc();
+
+    lastStatementBusy = false;
+    RetryPolicy policy;
+    for (int attempt = 1;; ++attempt) {
+        if (query.exec()) {
+            if (attempt > 1) {
+                ++recoveredCount;
+            }
+            metrics.seconds.observeNs(timer.nsecsElapsed());
+            UserCache::getInstance().noteStatement(query.lastQuery());
+            return true;
+        }
+        if (!isBusyError(query.lastError())) {
+            metrics.errors.inc();
+            metrics.seconds.observeNs(timer.nsecsElapsed());
+            return false;
+        }
+
+        ++busyErrorCount;
+        if (attempt == 1) {
+            policy = retryPolicy();
+        }
+        // SQLITE_LOCKED comes from a statement of this same connection and
+        // lasts until it finishes; waiting here cannot end it
+        bool lockedHere = primaryErrorCode(query.lastError()) == kSqliteLocked;
+        qint64 remainingMs = policy.deadlineMs - timer.elapsed();
+        if (lockedHere || (openTransactions > 0 && !retryInTransaction) || attempt >= policy.maxAttempts
+            || remainingMs <= 0) {
+            ++exhaustedCount;
+            lastStatementBusy = !lockedHere;
+            metrics.errors.inc();
+            metrics.seconds.observeNs(timer.nsecsElapsed());
+            return false;
+        }
+
+        // Full jitter: processes that collided once spread out instead of
+        // colliding again on the same schedule
+        int ceiling = qMin(policy.maxBackoffMs, policy.initialBackoffMs << qMin(attempt - 1, 20));
+        ceiling = static_cast<int>(qMin<qint64>(ceiling, remainingMs));
+        int pauseMs = static_cast<int>(QRandomGenerator::global()->bounded(ceiling + 1));
+        ++retryCount;
+        metrics.busyRetries.inc();
+        backoffMsTotal += pauseMs;
+        QThread::msleep(pauseMs);
+    }
+}
+
+QSqlDatabase& DatabaseManager::connection() {
+    if (QThread::currentThread() == m_ownerThread) {
+        if (m_busyTimeout != busyTimeoutMs.load() && m_database.isOpen()) {
+            m_busyTimeout = busyTimeoutMs.load();
+            configureConnection(m_database);
+        }
+        return m_database;
+    }
+
+    ThreadConnection* conn = threadConnections.localData();
+    if (!conn) {
+        conn = new ThreadConnection;
+        threadConnections.setLocalData(conn);
+    }
+
+    int generation = m_generation.load();
+    if (conn->generation != generation) {
+        QString path;
+        {
+            QMutexLocker locker(&m_mutex);
+            path = m_databasePath;
+            generation = m_generation.load();
+        }
+        conn->reset();
+        conn->name = QString("market_thread_%1").arg(++threadConnectionCounter);
+        conn->database = QSqlDatabase::addDatabase("QSQLITE", conn->name);
+        conn->database.setDatabaseName(path);
+        conn->generation = generation;
+
+        if (conn->database.open()) {
+            threadConnectionGauge().add(1);
+            QSqlQuery query(conn->database);
+            if (!query.exec("PRAGMA foreign_keys = ON;")) {
+                qWarning() << "Failed to enable foreign keys:" << query.lastError().text();
+            }
+            configureConnection(conn->database);
+            conn->busyTimeout = busyTimeoutMs.load();
+        } else {
+            qCritical() << "Failed to open thread connection:" << conn->database.lastError().text();
+        }
+    }
+
+    if (conn->busyTimeout != busyTimeoutMs.load() && conn->database.isOpen()) {
+        conn->busyTimeout = busyTimeoutMs.load();
+        configureConnection(conn->database);
+    }
+    return conn->database;
+}
+
 bool DatabaseManager::executeSchema() {
     QSqlQuery query(m_database);
 
@@ -124,6 +443,9 @@ bool DatabaseManager::executeSchema() {
         "reason TEXT NOT NULL, "
         "status TEXT CHECK(status IN ('pending', 'resolved', 'rejected')) DEFAULT 'pending', "
         "created_at TIMESTAMP DEFAULT CURRENT_TIMESTAMP, "
+        "resolved_at TIMESTAMP, "
+        "claimed_by INTEGER, "
+        "claimed_at TIMESTAMP, "
         "FOREIGN KEY (reporter_id) REFERENCES users(id), "
         "FOREIGN KEY (reported_user_id) REFERENCES users(id))";
 
@@ -134,6 +456,62 @@ bool DatabaseManager::executeSchema() {
 
     qDebug() << "Reports table created successfully";
 
+    // Databases created before the moderation queue lack these columns
+    if (!addColumnIfMissing("reports", "resolved_at", "TIMESTAMP")
+        || !addColumnIfMissing("reports", "claimed_by", "INTEGER")
+        || !addColumnIfMissing("reports", "claimed_at", "TIMESTAMP")) {
+        return false;
+    }
+
+    // Newest-first keyset listings (AdminService::listUsersAfter/getReportsAfter)
+    QStringList createIndexes = {
+        kUserListIndexes[0],
+        kUserListIndexes[1],
+        "CREATE INDEX IF NOT EXISTS idx_reports_created ON reports(created_at, id)",
+        // Moderation queue: only open reports are indexed, so dequeueing
+        // stays O(log n) however many resolved reports accumulate
+        "CREATE INDEX IF NOT EXISTS idx_reports_queue ON reports(created_at, id) "
+        "WHERE status = 'pending' AND claimed_by IS NULL",
+        "CREATE INDEX IF NOT EXISTS idx_reports_claimed ON reports(claimed_by) "
+        "WHERE claimed_by IS NOT NULL"};
+    for (const QString& createIndex : createIndexes) {
+        if (!query.exec(createIndex)) {
+            qCritical() << "Failed to create index:" << query.lastError().text();
+            return false;
+        }
+    }
+
+    // bulk_load holds a row from beginBulkLoad() to endBulkLoad(). Still
+    // there now means an import was killed in between: the listing indexes
+    // came back above, the search triggers and index are rebuilt below.
+    // import_progress is BulkImporter's resume point per input file.
+    QStringList createBookkeeping = {
+        "CREATE TABLE IF NOT EXISTS bulk_load (id INTEGER PRIMARY KEY CHECK(id = 1))",
+        "CREATE TABLE IF NOT EXISTS import_progress ("
+        "input TEXT PRIMARY KEY, "
+        "size INTEGER NOT NULL, "
+        "modified_ms INTEGER NOT NULL, "
+        "offset INTEGER NOT NULL) WITHOUT ROWID"};
+    for (const QString& statement : createBookkeeping) {
+        if (!query.exec(statement)) {
+            qCritical() << "Failed to create bulk load tables:" << query.lastError().text();
+            return false;
+        }
+    }
+    bool interruptedBulkLoad = query.exec("SELECT 1 FROM bulk_load") && query.next();
+
+    if (!createReportStats(m_database) || !createMarketStats(m_database) || !createChangeLog()) {
+        return false;
+    }
+
+    m_fullTextSearch = createSearchIndex(interruptedBulkLoad);
+    if (interruptedBulkLoad) {
+        qWarning() << "Rebuilt indexes left behind by an interrupted bulk load";
+        if (!query.exec(kLogOverflow) || !query.exec("DELETE FROM bulk_load")) {
+            qWarning() << "Failed to clear the bulk load marker:" << query.lastError().text();
+        }
+    }
+
     // 为 admin 用户创建 MD5 哈希密码
     QString adminPassword = "admin123";
     QByteArray hash = QCryptographicHash::hash(adminPassword.toUtf8(), QCryptographicHash::Md5);
@@ -175,12 +553,312 @@ bool DatabaseManager::executeSchema() {
     return true;
 }
 
+bool DatabaseManager::addColumnIfMissing(const QString& table, const QString& column,
+                                         const QString& definition) {
+    QSqlQuery query(m_database);
+    if (!query.exec(QString("PRAGMA table_info(%1)").arg(table))) {
+        qCritical() << "Failed to inspect table" << table << ":" << query.lastError().text();
+        return false;
+    }
+    while (query.next()) {
+        if (query.value(1).toString() == column) {
+            return true;
+        }
+    }
+
+    if (!query.exec(QString("ALTER TABLE %1 ADD COLUMN %2 %3").arg(table, column, definition))) {
+        qCritical() << "Failed to add column" << column << "to" << table << ":" << query.lastError().text();
+        return false;
+    }
+    qDebug() << "Added column" << column << "to" << table;
+    return true;
+}
+
+bool DatabaseManager::createReportStats(QSqlDatabase& database) {
+    QSqlQuery query(database);
+
+    // One write transaction, as in createMarketStats(): the check, the
+    // triggers and the backfill see the same reports, and another process
+    // creating the table at the same time cannot backfill it twice
+    if (!query.exec("BEGIN IMMEDIATE")) {
+        qCritical() << "Failed to create report statistics:" << query.lastError().text();
+        return false;
+    }
+    bool exists = query.exec("SELECT 1 FROM sqlite_master WHERE type = 'table' AND name = 'user_report_stats'")
+                  && query.next();
+
+    // Per reported user, kept exact by the triggers below so deciding on a
+    // new report is a primary-key lookup instead of an aggregate.
+    // last_report_at is the newest report ever filed, deletes keep it.
+    QStringList statements = {
+        "CREATE TABLE IF NOT EXISTS user_report_stats ("
+        "user_id INTEGER PRIMARY KEY, "
+        "total_reports INTEGER NOT NULL DEFAULT 0, "
+        "pending_reports INTEGER NOT NULL DEFAULT 0, "
+        "distinct_reporters INTEGER NOT NULL DEFAULT 0, "
+        "last_report_at TIMESTAMP)",
+        // Answers "has this reporter reported this user before" in O(log n)
+        "CREATE INDEX IF NOT EXISTS idx_reports_pair ON reports(reported_user_id, reporter_id)",
+        "CREATE TRIGGER IF NOT EXISTS report_stats_ai AFTER INSERT ON reports BEGIN "
+        "INSERT OR IGNORE INTO user_report_stats (user_id) VALUES (new.reported_user_id); "
+        "UPDATE user_report_stats SET "
+        "total_reports = total_reports + 1, "
+        "pending_reports = pending_reports + (new.status = 'pending'), "
+        "distinct_reporters = distinct_reporters + NOT EXISTS (SELECT 1 FROM reports "
+        "WHERE reported_user_id = new.reported_user_id AND reporter_id = new.reporter_id AND id <> new.id), "
+        "last_report_at = max(coalesce(last_report_at, new.created_at), new.created_at) "
+        "WHERE user_id = new.reported_user_id; END",
+        "CREATE TRIGGER IF NOT EXISTS report_stats_au AFTER UPDATE OF status ON reports "
+        "WHEN old.status IS NOT new.status BEGIN "
+        "UPDATE user_report_stats SET "
+        "pending_reports = pending_reports + (new.status = 'pending') - (old.status = 'pending') "
+        "WHERE user_id = new.reported_user_id; END",
+        "CREATE TRIGGER IF NOT EXISTS report_stats_ad AFTER DELETE ON reports BEGIN "
+        "UPDATE user_report_stats SET "
+        "total_reports = total_reports - 1, "
+        "pending_reports = pending_reports - (old.status = 'pending'), "
+        "distinct_reporters = distinct_reporters - NOT EXISTS (SELECT 1 FROM reports "
+        "WHERE reported_user_id = old.reported_user_id AND reporter_id = old.reporter_id) "
+        "WHERE user_id = old.reported_user_id; END"};
+    for (const QString& statement : statements) {
+        if (!query.exec(statement)) {
+            qCritical() << "Failed to create report statistics:" << query.lastError().text();
+            query.exec("ROLLBACK");
+            return false;
+        }
+    }
+
+    // Reports filed before the table existed
+    if (!exists && !query.exec("INSERT INTO user_report_stats "
+                               "(user_id, total_reports, pending_reports, distinct_reporters, last_report_at) "
+                               "SELECT reported_user_id, COUNT(*), SUM(status = 'pending'), "
+                               "COUNT(DISTINCT reporter_id), MAX(created_at) "
+                               "FROM reports GROUP BY reported_user_id")) {
+        qCritical() << "Failed to backfill report statistics:" << query.lastError().text();
+        query.exec("ROLLBACK");
+        return false;
+    }
+    if (!query.exec("COMMIT")) {
+        qCritical() << "Failed to create report statistics:" << query.lastError().text();
+        query.exec("ROLLBACK");
+        return false;
+    }
+
+    return true;
+}
+
+bool DatabaseManager::createMarketStats(QSqlDatabase& database) {
+    QSqlQuery query(database);
+
+    // Single-row summary for the admin dashboard, adjusted by the triggers
+    // below on every write so reading it never scans users or reports.
+    QStringList statements = {
+        "CREATE TABLE IF NOT EXISTS market_stats ("
+        "id INTEGER PRIMARY KEY CHECK(id = 1), "
+        "total_users INTEGER NOT NULL DEFAULT 0, "
+        "banned_users INTEGER NOT NULL DEFAULT 0, "
+        "admin_users INTEGER NOT NULL DEFAULT 0, "
+        "pending_reports INTEGER NOT NULL DEFAULT 0, "
+        "resolved_reports INTEGER NOT NULL DEFAULT 0, "
+        "rejected_reports INTEGER NOT NULL DEFAULT 0)",
+        "CREATE TRIGGER IF NOT EXISTS market_stats_users_ai AFTER INSERT ON users BEGIN "
+        "UPDATE market_stats SET total_users = total_users + 1, "
+        "banned_users = banned_users + (new.is_banned = 1), "
+        "admin_users = admin_users + (new.is_admin = 1) WHERE id = 1; END",
+        "CREATE TRIGGER IF NOT EXISTS market_stats_users_au AFTER UPDATE OF is_banned, is_admin ON users "
+        "WHEN old.is_banned IS NOT new.is_banned OR old.is_admin IS NOT new.is_admin BEGIN "
+        "UPDATE market_stats SET "
+        "banned_users = banned_users + (new.is_banned = 1) - (old.is_banned = 1), "
+        "admin_users = admin_users + (new.is_admin = 1) - (old.is_admin = 1) WHERE id = 1; END",
+        "CREATE TRIGGER IF NOT EXISTS market_stats_users_ad AFTER DELETE ON users BEGIN "
+        "UPDATE market_stats SET total_users = total_users - 1, "
+        "banned_users = banned_users - (old.is_banned = 1), "
+        "admin_users = admin_users - (old.is_admin = 1) WHERE id = 1; END",
+        "CREATE TRIGGER IF NOT EXISTS market_stats_reports_ai AFTER INSERT ON reports BEGIN "
+        "UPDATE market_stats SET "
+        "pending_reports = pending_reports + (new.status = 'pending'), "
+        "resolved_reports = resolved_reports + (new.status = 'resolved'), "
+        "rejected_reports = rejected_reports + (new.status = 'rejected') WHERE id = 1; END",
+        "CREATE TRIGGER IF NOT EXISTS market_stats_reports_au AFTER UPDATE OF status ON reports "
+        "WHEN old.status IS NOT new.status BEGIN "
+        "UPDATE market_stats SET "
+        "pending_reports = pending_reports + (new.status = 'pending') - (old.status = 'pending'), "
+        "resolved_reports = resolved_reports + (new.status = 'resolved') - (old.status = 'resolved'), "
+        "rejected_reports = rejected_reports + (new.status = 'rejected') - (old.status = 'rejected') "
+        "WHERE id = 1; END",
+        "CREATE TRIGGER IF NOT EXISTS market_stats_reports_ad AFTER DELETE ON reports BEGIN "
+        "UPDATE market_stats SET "
+        "pending_reports = pending_reports - (old.status = 'pending'), "
+        "resolved_reports = resolved_reports - (old.status = 'resolved'), "
+        "rejected_reports = rejected_reports - (old.status = 'rejected') WHERE id = 1; END",
+        // Counted whenever the row is missing, which also repairs a file
+        // whose first run stopped before it; the triggers take over from here
+        "INSERT OR IGNORE INTO market_stats (id, total_users, banned_users, admin_users, "
+        "pending_reports, resolved_reports, rejected_reports) SELECT 1, "
+        "(SELECT COUNT(*) FROM users), "
+        "(SELECT COUNT(*) FROM users WHERE is_banned = 1), "
+        "(SELECT COUNT(*) FROM users WHERE is_admin = 1), "
+        "(SELECT COUNT(*) FROM reports WHERE status = 'pending'), "
+        "(SELECT COUNT(*) FROM reports WHERE status = 'resolved'), "
+        "(SELECT COUNT(*) FROM reports WHERE status = 'rejected') "
+        "WHERE NOT EXISTS (SELECT 1 FROM market_stats WHERE id = 1)"};
+
+    // One write transaction: no other writer lands between the count and
+    // the triggers, and an interrupted run leaves nothing half made
+    if (!query.exec("BEGIN IMMEDIATE")) {
+        qCritical() << "Failed to create market statistics:" << query.lastError().text();
+        return false;
+    }
+    for (const QString& statement : statements) {
+        if (!query.exec(statement)) {
+            qCritical() << "Failed to create market statistics:" << query.lastError().text();
+            query.exec("ROLLBACK");
+            return false;
+        }
+    }
+    if (!query.exec("COMMIT")) {
+        qCritical() << "Failed to create market statistics:" << query.lastError().text();
+        query.exec("ROLLBACK");
+        return false;
+    }
+
+    return true;
+}
+
+bool DatabaseManager::createChangeLog() {
+    QSqlQuery query(m_database);
+
+    // Read by ChangeFeed. table_versions lets a poll tell in one lookup
+    // whether a table changed; change_log says which rows. Both are written
+    // by the triggers below, so changes from any connection or process
+    // are seen. Rows are not logged during a bulk load; op 'O' marks that
+    // changes went unlogged.
+    //
+    // Every 1024th row trims the log to the last kRetainedChanges rows in
+    // the writer's transaction, whichever process that is; the DELETE at
+    // startup catches up on logs grown before the trim trigger existed.
+    QStringList statements = {
+        "CREATE TABLE IF NOT EXISTS table_versions ("
+        "name TEXT PRIMARY KEY, "
+        "version INTEGER NOT NULL DEFAULT 0) WITHOUT ROWID",
+        "INSERT OR IGNORE INTO table_versions (name) VALUES ('users'), ('reports')",
+        "CREATE TABLE IF NOT EXISTS change_log ("
+        "seq INTEGER PRIMARY KEY AUTOINCREMENT, "
+        "table_name TEXT NOT NULL, "
+        "row_id INTEGER NOT NULL, "
+        "op TEXT NOT NULL CHECK(op IN ('I', 'U', 'D', 'O')))",
+        QString("DELETE FROM change_log WHERE seq <= (SELECT MAX(seq) FROM change_log) - %1")
+            .arg(kRetainedChanges),
+        QString("CREATE TRIGGER IF NOT EXISTS change_log_trim AFTER INSERT ON change_log "
+                "WHEN new.seq % 1024 = 0 BEGIN "
+                "DELETE FROM change_log WHERE seq <= new.seq - %1; END")
+            .arg(kRetainedChanges)};
+    for (const QString& table : {QString("users"), QString("reports")}) {
+        const QList<QPair<QString, QString>> events = {
+            {"ai", "AFTER INSERT"}, {"au", "AFTER UPDATE"}, {"ad", "AFTER DELETE"}};
+        for (const auto& event : events) {
+            QString op = event.first == "ai" ? "I" : event.first == "au" ? "U" : "D";
+            QString row = event.first == "ad" ? "old.id" : "new.id";
+            statements << QString("CREATE TRIGGER IF NOT EXISTS change_%1_%2 %3 ON %1 BEGIN "
+                                  "UPDATE table_versions SET version = version + 1 WHERE name = '%1'; "
+                                  "INSERT INTO change_log (table_name, row_id, op) "
+                                  "SELECT '%1', %4, '%5' WHERE NOT EXISTS (SELECT 1 FROM bulk_load); END")
+                              .arg(table, event.first, event.second, row, op);
+        }
+    }
+    for (const QString& statement : statements) {
+        if (!query.exec(statement)) {
+            qCritical() << "Failed to create change log:" << query.lastError().text();
+            return false;
+        }
+    }
+    return true;
+}
+
+bool DatabaseManager::createSearchIndex(bool rebuild) {
+    QSqlQuery query(connection());
+
+    bool exists = query.exec("SELECT 1 FROM sqlite_master WHERE type = 'table' AND name = 'users_fts'")
+                  && query.next();
+
+    // Trigram tokens match any substring of three or more characters, which
+    // is what phone fragments need. External content: only the index is
+    // stored, the text stays in users.
+    if (!query.exec("CREATE VIRTUAL TABLE IF NOT EXISTS users_fts USING fts5("
+                    "phone, username, content='users', content_rowid='id', tokenize='trigram')")) {
+        qWarning() << "Full-text search unavailable, using LIKE:" << query.lastError().text();
+        return false;
+    }
+
+    QStringList triggers = {
+        "CREATE TRIGGER IF NOT EXISTS users_fts_ai AFTER INSERT ON users BEGIN "
+        "INSERT INTO users_fts(rowid, phone, username) VALUES (new.id, new.phone, new.username); END",
+        "CREATE TRIGGER IF NOT EXISTS users_fts_ad AFTER DELETE ON users BEGIN "
+        "INSERT INTO users_fts(users_fts, rowid, phone, username) "
+        "VALUES ('delete', old.id, old.phone, old.username); END",
+        "CREATE TRIGGER IF NOT EXISTS users_fts_au AFTER UPDATE OF phone, username ON users BEGIN "
+        "INSERT INTO users_fts(users_fts, rowid, phone, username) "
+        "VALUES ('delete', old.id, old.phone, old.username); "
+        "INSERT INTO users_fts(rowid, phone, username) VALUES (new.id, new.phone, new.username); END"};
+    for (const QString& trigger : triggers) {
+        if (!query.exec(trigger)) {
+            qWarning() << "Failed to create search trigger:" << query.lastError().text();
+            return false;
+        }
+    }
+
+    // Index users that were stored before the table existed
+    if ((rebuild || !exists) && !query.exec("INSERT INTO users_fts(users_fts) VALUES ('rebuild')")) {
+        qWarning() << "Failed to build search index:" << query.lastError().text();
+        return false;
+    }
+
+    return true;
+}
+
+bool DatabaseManager::beginBulkLoad() {
+    QSqlQuery query(connection());
+    // The marker goes first: from here on a crash must lead to a rebuild
+    QStringList statements = {
+        "INSERT OR IGNORE INTO bulk_load (id) VALUES (1)",
+        "DROP INDEX IF EXISTS idx_users_created",
+        "DROP INDEX IF EXISTS idx_users_banned_created",
+        "DROP TRIGGER IF EXISTS users_fts_ai",
+        "DROP TRIGGER IF EXISTS users_fts_ad",
+        "DROP TRIGGER IF EXISTS users_fts_au"};
+    for (const QString& statement : statements) {
+        if (!query.exec(statement)) {
+            qWarning() << "Failed to prepare bulk load:" << query.lastError().text();
+            return false;
+        }
+    }
+    return true;
+}
+
+bool DatabaseManager::endBulkLoad() {
+    QSqlQuery query(connection());
+    for (const char* statement : kUserListIndexes) {
+        if (!query.exec(statement)) {
+            qWarning() << "Failed to rebuild index after bulk load:" << query.lastError().text();
+            return false;
+        }
+    }
+    if (m_fullTextSearch) {
+        m_fullTextSearch = createSearchIndex(true);
+    }
+    if (!query.exec(kLogOverflow) || !query.exec("DELETE FROM bulk_load")) {
+        qWarning() << "Failed to clear the bulk load marker:" << query.lastError().text();
+        return false;
+    }
+    return true;
+}
+
 QSqlDatabase& DatabaseManager::getDatabase() {
-    return m_database;
+    return connection();
 }
 
 bool DatabaseManager::isOpen() const {
-    return m_database.isOpen();
+    return const_cast<DatabaseManager*>(this)->connection().isOpen();
 }
 
 void DatabaseManager::close() {
@@ -191,11 +869,11 @@ void DatabaseManager::close() {
 }
 
 QString DatabaseManager::getLastError() const {
-    return m_database.lastError().text();
+    return const_cast<DatabaseManager*>(this)->connection().lastError().text();
 }
 
 bool DatabaseManager::executeQuery(const QString& query, const QVariantList& params) {
-    QSqlQuery sqlQuery(m_database);
+    QSqlQuery sqlQuery(connection());
     if (!sqlQuery.prepare(query)) {
         qWarning() << "Query preparation failed:" << query;
         qWarning() << "Error:" << sqlQuery.lastError().text();
@@ -206,7 +884,7 @@ bool DatabaseManager::executeQuery(const QString& query, const QVariantList& par
         sqlQuery.bindValue(i, params[i]);
     }
 
-    if (!sqlQuery.exec()) {
+    if (!execWithRetry(sqlQuery)) {
         qWarning() << "Query failed:" << query;
         qWarning() << "Error:" << sqlQuery.lastError().text();
         return false;
@@ -215,8 +893,12 @@ bool DatabaseManager::executeQuery(const QString& query, const QVariantList& par
     return true;
 }
 
-QSqlQuery DatabaseManager::executeQueryWithResult(const QString& query, const QVariantList& params) {
-    QSqlQuery sqlQuery(m_database);
+QSqlQuery DatabaseManager::executeQueryWithResult(const QString& query, const QVariantList& params,
+                                                  bool forwardOnly) {
+    QSqlQuery sqlQuery(connection());
+    // Forward-only results are not cached by the driver, which matters for
+    // listings that are read once into compact storage.
+    sqlQuery.setForwardOnly(forwardOnly);
     if (!sqlQuery.prepare(query)) {
         qWarning() << "Query preparation failed:" << query;
         qWarning() << "Error:" << sqlQuery.lastError().text();
@@ -227,7 +909,7 @@ QSqlQuery DatabaseManager::executeQueryWithResult(const QString& query, const QV
         sqlQuery.bindValue(i, params[i]);
     }
 
-    if (!sqlQuery.exec()) {
+    if (!execWithRetry(sqlQuery)) {
         qWarning() << "Query failed:" << query;
         qWarning() << "Error:" << sqlQuery.lastError().text();
     }
@@ -236,7 +918,7 @@ QSqlQuery DatabaseManager::executeQueryWithResult(const QString& query, const QV
 }
 
 int DatabaseManager::getLastInsertId() const {
-    QSqlQuery query(m_database);
+    QSqlQuery query(const_cast<DatabaseManager*>(this)->connection());
     if (query.exec("SELECT last_insert_rowid()")) {
         if (query.next()) {
             return query.value(0).toInt();
@@ -244,3 +926,44 @@ int DatabaseManager::getLastInsertId() const {
     }
     return -1;
 }
+
+void DatabaseManager::transactionBegun() {
+    ++openTransactions;
+}
+
+void DatabaseManager::transactionEnded() {
+    openTransactions = qMax(0, openTransactions - 1);
+}
+
+bool DatabaseManager::beginTransaction(TransactionMode mode) {
+    // Issued directly: QSqlDatabase::transaction() only knows plain BEGIN
+    QSqlQuery begin(connection());
+    begin.prepare(mode == TransactionMode::Write ? "BEGIN IMMEDIATE" : "BEGIN");
+    if (!execWithRetry(begin)) {
+        qWarning() << "Failed to begin transaction:" << begin.lastError().text();
+        return false;
+    }
+    transactionBegun();
+    return true;
+}
+
+bool DatabaseManager::commitTransaction() {
+    QSqlQuery commit(connection());
+    commit.prepare("COMMIT");
+    if (!execWithRetry(commit, true)) {
+        qWarning() << "Failed to commit transaction:" << commit.lastError().text();
+        return false;  // still open; the caller rolls back
+    }
+    transactionEnded();
+    return true;
+}
+
+bool DatabaseManager::rollbackTransaction() {
+    transactionEnded();
+    QSqlDatabase& database = connection();
+    if (!database.rollback()) {
+        qWarning() << "Failed to roll back transaction:" << database.lastError().text();
+        return false;
+    }
+    return true;
+}
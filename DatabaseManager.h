@@ -12,30 +12,148 @@
 #include <QStandardPaths>
 #include <QFile>
 #include <QFileInfo>
+#include <QThread>
+#include <QMutex>
+#include <atomic>
 
 class DatabaseManager {
+ public:
+    // Statements that still fail with SQLITE_BUSY after the busy timeout
+    // are retried after a randomized, exponentially growing pause, until
+    // deadlineMs after the first attempt. Files are kept in WAL mode
+    // (enableWal()), where readers never wait and writers queue on one lock
+    // in the busy handler. Each attempt can wait out the busy timeout, so
+    // with the defaults only statements that came back busy without waiting
+    // are retried: a write on a stale snapshot, or a connection meeting
+    // another one's WAL recovery. Such a statement made no
+    // change, so inserts are retried as safely as reads. Inside a
+    // transaction nothing is retried: only the whole transaction can be
+    // started over, which the caller must decide (it may not be
+    // idempotent). A busy COMMIT leaves the transaction open and is retried.
+    // SQLITE_LOCKED, a conflict within the same connection, is not retried.
+    struct RetryPolicy {
+        int maxAttempts = 5;        // including the first
+        int initialBackoffMs = 10;  // upper bound of the first pause, doubled per retry
+        int maxBackoffMs = 500;
+        int deadlineMs = 5000;      // no retry starts later than this
+    };
+
+    // Process-wide contention counters, see busyStats().
+    struct BusyStats {
+        quint64 busyErrors = 0;  // statements that came back busy
+        quint64 retries = 0;
+        quint64 recovered = 0;   // statements that succeeded on a retry
+        quint64 exhausted = 0;   // gave up: out of attempts or time, or inside a transaction
+        quint64 backoffMs = 0;   // time slept between retries
+    };
+
+    enum class TransactionMode {
+        Write,  // BEGIN IMMEDIATE: takes the write lock up front
+        Read    // BEGIN: a snapshot that does not hold off writers
+    };
+
  private:
-    QSqlDatabase m_database;
+    QSqlDatabase m_database;     // primary connection, used by m_ownerThread
+    std::atomic<QThread*> m_ownerThread;
+    mutable QMutex m_mutex;      // guards m_databasePath and reinitialization
+    QString m_databasePath;
+    std::atomic<int> m_generation{0};  // bumped whenever the primary is reopened
+    std::atomic<bool> m_fullTextSearch{false};
+    int m_busyTimeout = -1;      // as last applied to m_database
 
     DatabaseManager();
     ~DatabaseManager();
 
     bool initializeDatabase();
     bool executeSchema();  // 不再需要从文件读取
+    bool createSearchIndex(bool rebuild = false);
+    bool createChangeLog();
+    bool addColumnIfMissing(const QString& table, const QString& column, const QString& definition);
+    static void configureConnection(QSqlDatabase& database);
+
+    // QSqlDatabase handles may only be used by the thread that opened them, so
+    // other threads get their own connection to the same file.
+    QSqlDatabase& connection();
 
  public:
     static DatabaseManager& getInstance();
+
+    // change_log rows kept behind the newest one. Older rows are trimmed by
+    // the database itself, so the log stays bounded without a ChangeFeed.
+    static const int kRetainedChanges = 100000;
+
+    // Database file used by getInstance(); defaults to marketplace.db in the
+    // AppData location. Changing it makes the next getInstance() reopen.
+    static QString databasePath();
+    static void setDatabasePath(const QString& path);
     DatabaseManager(const DatabaseManager&) = delete;
     DatabaseManager& operator=(const DatabaseManager&) = delete;
 
     QSqlDatabase& getDatabase();
     bool isOpen() const;
+    // Closes the primary connection; call it on the owner thread.
     void close();
     QString getLastError() const;
 
     bool executeQuery(const QString& query, const QVariantList& params = {});
-    QSqlQuery executeQueryWithResult(const QString& query, const QVariantList& params = {});
+    QSqlQuery executeQueryWithResult(const QString& query, const QVariantList& params = {},
+                                     bool forwardOnly = false);
     int getLastInsertId() const;
+
+    // Milliseconds SQLite waits for a lock before reporting busy, for every
+    // connection of this process (applied to each on its next use).
+    static void setBusyTimeout(int ms);
+    static int busyTimeout();
+    static void setRetryPolicy(const RetryPolicy& policy);
+    static RetryPolicy retryPolicy();
+    static BusyStats busyStats();
+    static void resetBusyStats();
+    static bool isBusyError(const QSqlError& error);
+
+    // Executes a prepared query under the retry policy; also for queries on
+    // connections this class does not own (ShardRouter).
+    static bool execWithRetry(QSqlQuery& query, bool retryInTransaction = false);
+
+    // Marks a transaction begun or ended on such a connection, so that
+    // execWithRetry() does not retry the statements in between.
+    static void transactionBegun();
+    static void transactionEnded();
+
+    // Switches a database file to WAL, so readers (exports, listings) and a
+    // writer no longer block each other; the mode stays with the file.
+    static bool enableWal(QSqlDatabase& database);
+    // Removes the -wal and -shm files left at path when the database file
+    // itself was deleted, so a new file there does not adopt them.
+    static void removeStaleWal(const QString& path);
+
+    // user_report_stats and market_stats with their triggers, on the primary
+    // file or a shard file.
+    static bool createReportStats(QSqlDatabase& database);
+    static bool createMarketStats(QSqlDatabase& database);
+
+    // True if the calling thread's last statement failed because the
+    // database stayed locked by another connection or process.
+    bool lastErrorWasBusy() const;
+
+    // True when the users_fts trigram index exists; searches fall back to
+    // LIKE scans otherwise (SQLite built without FTS5 or older than 3.34).
+    bool hasFullTextSearch() const { return m_fullTextSearch.load(); }
+
+    // Bulk loading: beginBulkLoad() drops the user listing indexes and the
+    // search triggers so inserts only maintain the primary key and the phone
+    // uniqueness; endBulkLoad() recreates them and rebuilds the search index
+    // in one pass. Listings and search are slow or stale in between, and no
+    // row changes are logged for ChangeFeed: the end of the load logs an
+    // overflow instead. A load that never reached endBulkLoad() is finished
+    // the next time the schema is opened.
+    bool beginBulkLoad();
+    bool endBulkLoad();
+
+    // Write transactions take the lock in BEGIN, so two writers cannot both
+    // hold a read lock and deadlock upgrading it.
+    bool beginTransaction(TransactionMode mode = TransactionMode::Write);
+    bool commitTransaction();
+    bool rollbackTransaction();
 };
 
 #endif  // DATABASEMANAGER_H
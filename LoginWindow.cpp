@@ -1,5 +1,6 @@
 // Copyright 2025 MarketSystem
 #include "LoginWindow.h"
+#include "DatabaseManager.h"
 #include <QFont>
 #include <QIcon>
 #include <QApplication>
@@ -121,7 +122,49 @@ void LoginWindow::setupConnections() {
     connect(m_passwordInput, &QLineEdit::textChanged, this, &LoginWindow::onPasswordChanged);
 }
 
+void LoginWindow::setDatabaseReady(const QFuture<bool>& ready) {
+    m_databaseReady = ready;
+    if (!m_readyWatcher) {
+        m_readyWatcher = new QFutureWatcher<bool>(this);
+        connect(m_readyWatcher, &QFutureWatcher<bool>::finished, this, &LoginWindow::onDatabaseReady);
+    }
+    m_readyWatcher->setFuture(ready);
+}
+
+bool LoginWindow::databaseReady(void (LoginWindow::*action)()) {
+    if (!m_databaseReady.isValid() || m_databaseReady.isFinished()) {
+        if (m_databaseReady.isValid() && !m_databaseReady.result()) {
+            m_statusLabel->setText("The database could not be opened.");
+            m_statusLabel->setStyleSheet("color: #e74c3c; font-weight: bold;");
+            return false;
+        }
+        return true;
+    }
+
+    m_pendingAction = action;
+    m_statusLabel->setText("Opening database...");
+    m_statusLabel->setStyleSheet("color: #7f8c8d; font-weight: bold;");
+    m_loginButton->setEnabled(false);
+    m_registerButton->setEnabled(false);
+    return false;
+}
+
+void LoginWindow::onDatabaseReady() {
+    m_registerButton->setEnabled(true);
+    updateLoginButtonState();
+    void (LoginWindow::*action)() = m_pendingAction;
+    m_pendingAction = nullptr;
+    if (action) {
+        m_statusLabel->clear();
+        (this->*action)();
+    }
+}
+
 void LoginWindow::onLoginClicked() {
+    if (!databaseReady(&LoginWindow::onLoginClicked)) {
+        return;
+    }
+
     QString phone = m_phoneInput->text().trimmed();
     QString password = m_passwordInput->text();
 
@@ -142,6 +185,7 @@ void LoginWindow::onLoginClicked() {
     }
 
     QPair<bool, User> result = AuthService::loginUser(phone, password);
+    bool busy = !result.first && DatabaseManager::getInstance().lastErrorWasBusy();
 
     if (result.first) {
         m_currentUser = result.second;  // Store the logged in user
@@ -151,7 +195,10 @@ void LoginWindow::onLoginClicked() {
         accept();  // Close the dialog with Accepted result
     } else {
         // 检查是否是被Ban用户
-        if (AuthService::isUserBanned(phone)) {
+        if (busy) {
+            m_statusLabel->setText("The database is busy, please try again.");
+            m_statusLabel->setStyleSheet("color: #e67e22; font-weight: bold;");
+        } else if (AuthService::isUserBanned(phone)) {
             m_statusLabel->setText("Your account has been banned!\nPlease contact administrator for assistance.");
             m_statusLabel->setStyleSheet("color: #e74c3c; font-weight: bold;");
         } else {
@@ -164,6 +211,10 @@ void LoginWindow::onLoginClicked() {
 }
 
 void LoginWindow::onRegisterClicked() {
+    if (!databaseReady(&LoginWindow::onRegisterClicked)) {
+        return;
+    }
+
     QString phone = m_phoneInput->text().trimmed();
     QString password = m_passwordInput->text();
 
@@ -175,7 +226,12 @@ void LoginWindow::onRegisterClicked() {
 
     QPair<bool, User> result = AuthService::registerUser(phone, password);
 
-    if (result.first) {
+    if (!result.first && DatabaseManager::getInstance().lastErrorWasBusy()) {
+        QMessageBox::warning(this, "Registration Failed",
+                             "The database is busy with other instances. Please try again in a moment.");
+        m_statusLabel->setText("Database busy, please try again.");
+        m_statusLabel->setStyleSheet("color: #e67e22; font-weight: bold;");
+    } else if (result.first) {
         QMessageBox::information(this, "Registration Successful",
                                  "Your account has been created successfully!\nPlease login with your credentials.");
         m_statusLabel->setText("Registration successful. Please login.");
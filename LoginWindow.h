@@ -3,6 +3,8 @@
 #define LOGINWINDOW_H
 
 #include <QDialog>
+#include <QFuture>
+#include <QFutureWatcher>
 #include <QLineEdit>
 #include <QPushButton>
 #include <QLabel>
@@ -25,10 +27,17 @@ class LoginWindow : public QDialog {
     QLabel* m_statusLabel;
     User m_currentUser;  // Store the current logged in user
 
+    // Database opened in the background at startup; a click that arrives
+    // before it is ready is replayed once it is.
+    QFuture<bool> m_databaseReady;
+    QFutureWatcher<bool>* m_readyWatcher = nullptr;
+    void (LoginWindow::*m_pendingAction)() = nullptr;
+
     void setupUI();
     void setupValidators();
     void setupConnections();
     void updateLoginButtonState();
+    bool databaseReady(void (LoginWindow::*action)());
 
  public:
     explicit LoginWindow(QWidget* parent = nullptr);
@@ -38,11 +47,16 @@ class LoginWindow : public QDialog {
         return m_currentUser;
     }
 
+    // Login and registration wait for ready; its result is whether the
+    // database could be opened.
+    void setDatabaseReady(const QFuture<bool>& ready);
+
  private slots:
     void onLoginClicked();
     void onRegisterClicked();
     void onPhoneChanged(const QString& text);
     void onPasswordChanged(const QString& text);
+    void onDatabaseReady();
     // void updateLoginButtonState();
 
  signals:
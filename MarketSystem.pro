@@ -1,4 +1,4 @@
-QT       += core gui sql widgets
+QT       += core gui sql widgets concurrent
 
 greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
 
@@ -12,22 +12,49 @@ SOURCES += \
     Admin.cpp \
     AdminService.cpp \
     AdminWindow.cpp \
+    AuditLog.cpp \
     AuthService.cpp \
+    AutoBanPolicy.cpp \
+    ChangeFeed.cpp \
+    ChangeNotifier.cpp \
     DatabaseManager.cpp \
+    Metrics.cpp \
     LoginWindow.cpp \
+    Report.cpp \
+    ReportService.cpp \
+    ShardRouter.cpp \
+    StartupProfiler.cpp \
     User.cpp \
+    UserCache.cpp \
+    UserTable.cpp \
     main.cpp \
-    mainwindow.cpp
+    mainwindow.cpp \
+    ReportTableModel.cpp \
+    UserTableModel.cpp
 
 HEADERS += \
     Admin.h \
     AdminService.h \
     AdminWindow.h \
+    AuditLog.h \
     AuthService.h \
+    AutoBanPolicy.h \
+    ChangeFeed.h \
+    ChangeNotifier.h \
     DatabaseManager.h \
+    Metrics.h \
     LoginWindow.h \
+    Report.h \
+    ReportService.h \
+    ShardRouter.h \
+    StartupProfiler.h \
     User.h \
-    mainwindow.h
+    UserCache.h \
+    UserTable.h \
+    mainwindow.h \
+    PageCache.h \
+    ReportTableModel.h \
+    UserTableModel.h
 
 FORMS += \
     mainwindow.ui
@@ -0,0 +1,229 @@
+// Copyright 2025 MarketSystem
+#include "Metrics.h"
+#include <QDebug>
+#include <QMutexLocker>
+#include <QSaveFile>
+#include <algorithm>
+#include <functional>
+
+namespace {
+const char* typeName(int type) {
+    switch (type) {
+    case 0: return "counter";
+    case 1: return "gauge";
+    default: return "histogram";
+    }
+}
+
+QByteArray formatDouble(double value) {
+    return QByteArray::number(value, 'g', 12);
+}
+
+// name{labels} or name{labels,extra}
+QByteArray seriesName(const QString& name, const QString& labels, const QString& extra = QString()) {
+    QByteArray text = name.toUtf8();
+    if (labels.isEmpty() && extra.isEmpty()) {
+        return text;
+    }
+    text += '{';
+    text += labels.toUtf8();
+    if (!labels.isEmpty() && !extra.isEmpty()) {
+        text += ',';
+    }
+    text += extra.toUtf8();
+    text += '}';
+    return text;
+}
+
+QString escapeHelp(QString help) {
+    return help.replace('\\', "\\\\").replace('\n', "\\n");
+}
+}  // namespace
+
+quint64 Metrics::Counter::value() const {
+    quint64 total = 0;
+    for (const Slot& slot : m_slots) {
+        total += slot.value.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+Metrics::Histogram::Histogram(const QList<double>& bounds)
+    : m_bounds(bounds.mid(0, kMaxBuckets)), m_slots(new Slot[kSlots]) {
+    // Extra bounds would be dropped and unsorted ones count into the wrong
+    // buckets; release builds at least say so
+    bool ascending = std::is_sorted(bounds.begin(), bounds.end(), std::less_equal<double>());
+    Q_ASSERT_X(bounds.size() <= kMaxBuckets, "Metrics::Histogram", "more bounds than kMaxBuckets");
+    Q_ASSERT_X(ascending, "Metrics::Histogram", "bounds must be strictly ascending");
+    if (bounds.size() > kMaxBuckets) {
+        qWarning() << "Metrics: histogram bounds past" << kMaxBuckets << "dropped";
+    }
+    if (!ascending) {
+        qWarning() << "Metrics: histogram bounds not ascending:" << bounds;
+    }
+    m_boundsNs.reserve(m_bounds.size());
+    for (double bound : m_bounds) {
+        m_boundsNs.push_back(static_cast<qint64>(bound * 1e9));
+    }
+    for (int s = 0; s < kSlots; ++s) {
+        for (std::atomic<quint64>& bucket : m_slots[s].buckets) {
+            bucket.store(0, std::memory_order_relaxed);
+        }
+        m_slots[s].count.store(0, std::memory_order_relaxed);
+        m_slots[s].sumNs.store(0, std::memory_order_relaxed);
+    }
+}
+
+void Metrics::Histogram::observeNs(qint64 ns) {
+    // Counted in the first bucket that holds it; snapshot() accumulates
+    size_t bucket = 0;
+    while (bucket < m_boundsNs.size() && ns > m_boundsNs[bucket]) {
+        ++bucket;
+    }
+    Slot& slot = m_slots[Metrics::slot()];
+    slot.buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+    slot.count.fetch_add(1, std::memory_order_relaxed);
+    slot.sumNs.fetch_add(static_cast<quint64>(qMax<qint64>(0, ns)), std::memory_order_relaxed);
+}
+
+Metrics::Histogram::Snapshot Metrics::Histogram::snapshot() const {
+    Snapshot snapshot;
+    snapshot.bounds = m_bounds;
+    quint64 running = 0;
+    quint64 sumNs = 0;
+    for (int bucket = 0; bucket <= m_bounds.size(); ++bucket) {
+        for (int s = 0; s < kSlots; ++s) {
+            running += m_slots[s].buckets[bucket].load(std::memory_order_relaxed);
+        }
+        snapshot.cumulative.append(running);
+    }
+    for (int s = 0; s < kSlots; ++s) {
+        sumNs += m_slots[s].sumNs.load(std::memory_order_relaxed);
+    }
+    // The +Inf bucket is the count: slots are read one by one while
+    // threads keep observing, and the two must agree for a scraper
+    snapshot.count = running;
+    snapshot.sumSeconds = sumNs / 1e9;
+    return snapshot;
+}
+
+Metrics& Metrics::getInstance() {
+    static Metrics instance;
+    return instance;
+}
+
+QList<double> Metrics::latencyBounds() {
+    return {0.0001, 0.00025, 0.0005, 0.001, 0.0025, 0.005, 0.01, 0.025, 0.05, 0.1, 0.25, 0.5, 1, 2.5, 5, 10};
+}
+
+Metrics::Series& Metrics::series(const QString& name, const QString& help, Type type, const QString& labels) {
+    QMutexLocker locker(&m_mutex);
+    Family* family = nullptr;
+    for (const std::unique_ptr<Family>& existing : m_families) {
+        if (existing->name == name) {
+            family = existing.get();
+            break;
+        }
+    }
+    if (family && family->type != type) {
+        // Still hand out a working metric, but keep it out of the export
+        qWarning() << "Metric" << name << "is already registered as a" << typeName(static_cast<int>(family->type));
+        static std::vector<std::unique_ptr<Family>> mismatched;
+        mismatched.push_back(std::make_unique<Family>());
+        family = mismatched.back().get();
+        family->name = name;
+        family->type = type;
+    }
+    if (!family) {
+        m_families.push_back(std::make_unique<Family>());
+        family = m_families.back().get();
+        family->name = name;
+        family->help = help;
+        family->type = type;
+    }
+
+    for (const std::unique_ptr<Series>& existing : family->series) {
+        if (existing->labels == labels) {
+            return *existing;
+        }
+    }
+    family->series.push_back(std::make_unique<Series>());
+    Series& created = *family->series.back();
+    created.labels = labels;
+    return created;
+}
+
+Metrics::Counter& Metrics::counter(const QString& name, const QString& help, const QString& labels) {
+    Series& entry = series(name, help, Type::Counter, labels);
+    QMutexLocker locker(&m_mutex);
+    if (!entry.counter) {
+        entry.counter = std::make_unique<Counter>();
+    }
+    return *entry.counter;
+}
+
+Metrics::Gauge& Metrics::gauge(const QString& name, const QString& help, const QString& labels) {
+    Series& entry = series(name, help, Type::Gauge, labels);
+    QMutexLocker locker(&m_mutex);
+    if (!entry.gauge) {
+        entry.gauge = std::make_unique<Gauge>();
+    }
+    return *entry.gauge;
+}
+
+Metrics::Histogram& Metrics::histogram(const QString& name, const QString& help, const QList<double>& bounds,
+                                       const QString& labels) {
+    Series& entry = series(name, help, Type::Histogram, labels);
+    QMutexLocker locker(&m_mutex);
+    if (!entry.histogram) {
+        entry.histogram = std::make_unique<Histogram>(bounds);
+    }
+    return *entry.histogram;
+}
+
+QByteArray Metrics::exposition() const {
+    QByteArray text;
+    QMutexLocker locker(&m_mutex);
+    for (const std::unique_ptr<Family>& family : m_families) {
+        QByteArray name = family->name.toUtf8();
+        text += "# HELP " + name + ' ' + escapeHelp(family->help).toUtf8() + '\n';
+        text += "# TYPE " + name + ' ' + typeName(static_cast<int>(family->type)) + '\n';
+
+        for (const std::unique_ptr<Series>& series : family->series) {
+            if (series->counter) {
+                text += seriesName(family->name, series->labels) + ' ' +
+                        QByteArray::number(series->counter->value()) + '\n';
+            } else if (series->gauge) {
+                text += seriesName(family->name, series->labels) + ' ' +
+                        QByteArray::number(series->gauge->value()) + '\n';
+            } else if (series->histogram) {
+                Histogram::Snapshot snapshot = series->histogram->snapshot();
+                for (int bucket = 0; bucket < snapshot.cumulative.size(); ++bucket) {
+                    QString le = bucket < snapshot.bounds.size()
+                        ? QString::fromLatin1(formatDouble(snapshot.bounds[bucket])) : QString("+Inf");
+                    text += seriesName(family->name + "_bucket", series->labels, "le=\"" + le + "\"") + ' ' +
+                            QByteArray::number(snapshot.cumulative[bucket]) + '\n';
+                }
+                text += seriesName(family->name + "_sum", series->labels) + ' ' +
+                        formatDouble(snapshot.sumSeconds) + '\n';
+                text += seriesName(family->name + "_count", series->labels) + ' ' +
+                        QByteArray::number(snapshot.count) + '\n';
+            }
+        }
+    }
+    return text;
+}
+
+bool Metrics::writeFile(const QString& path) const {
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "Failed to write metrics file:" << file.errorString();
+        return false;
+    }
+    file.write(exposition());
+    if (!file.commit()) {
+        qWarning() << "Failed to write metrics file:" << file.errorString();
+        return false;
+    }
+    return true;
+}
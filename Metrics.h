@@ -0,0 +1,147 @@
+// Copyright 2025 MarketSystem
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QList>
+#include <QMutex>
+#include <QString>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+// Process-wide counters, gauges and histograms, exported in the Prometheus
+// text format.
+//
+// An update is one relaxed atomic add on a slot chosen by the calling
+// thread, so threads counting the same event do not fight over one cache
+// line; a scrape adds the slots up. Registration takes a lock, so a metric
+// is looked up once and the reference kept, usually in a function-local
+// static:
+//
+//   static Metrics::Counter& logins = Metrics::getInstance().counter(
+//       "market_logins_total", "Successful logins.");
+//   logins.inc();
+class Metrics {
+ public:
+    static const int kSlots = 16;
+
+    class Counter {
+     public:
+        void inc(quint64 n = 1) { m_slots[slot()].value.fetch_add(n, std::memory_order_relaxed); }
+        quint64 value() const;
+
+     private:
+        struct alignas(64) Slot {
+            std::atomic<quint64> value{0};
+        };
+        Slot m_slots[kSlots];
+    };
+
+    // A level that moves both ways. set() has no meaning per thread, so a
+    // gauge is a single atomic; keep it off hot paths.
+    class Gauge {
+     public:
+        void set(qint64 value) { m_value.store(value, std::memory_order_relaxed); }
+        void add(qint64 delta) { m_value.fetch_add(delta, std::memory_order_relaxed); }
+        qint64 value() const { return m_value.load(std::memory_order_relaxed); }
+
+     private:
+        std::atomic<qint64> m_value{0};
+    };
+
+    class Histogram {
+     public:
+        static const int kMaxBuckets = 16;
+
+        // Strictly ascending upper bounds in seconds, at most kMaxBuckets
+        // (asserted); +Inf is implied.
+        explicit Histogram(const QList<double>& bounds);
+        void observeNs(qint64 ns);
+        void observe(double seconds) { observeNs(static_cast<qint64>(seconds * 1e9)); }
+
+        struct Snapshot {
+            QList<double> bounds;
+            QList<quint64> cumulative;  // per bound, then +Inf
+            quint64 count = 0;
+            double sumSeconds = 0;
+        };
+        Snapshot snapshot() const;
+
+        // Observes the time from construction to destruction.
+        class Timer {
+         public:
+            explicit Timer(Histogram& histogram) : m_histogram(histogram) { m_timer.start(); }
+            ~Timer() { m_histogram.observeNs(m_timer.nsecsElapsed()); }
+            Timer(const Timer&) = delete;
+            Timer& operator=(const Timer&) = delete;
+
+         private:
+            Histogram& m_histogram;
+            QElapsedTimer m_timer;
+        };
+
+     private:
+        struct alignas(64) Slot {
+            std::atomic<quint64> buckets[kMaxBuckets + 1];
+            std::atomic<quint64> count;
+            std::atomic<quint64> sumNs;
+        };
+        QList<double> m_bounds;
+        std::vector<qint64> m_boundsNs;
+        std::unique_ptr<Slot[]> m_slots;
+    };
+
+    static Metrics& getInstance();
+    Metrics(const Metrics&) = delete;
+    Metrics& operator=(const Metrics&) = delete;
+
+    // labels is the inside of the braces, e.g. reason="banned". The same
+    // name and labels return the same metric; a name keeps the type it was
+    // first registered with.
+    Counter& counter(const QString& name, const QString& help, const QString& labels = QString());
+    Gauge& gauge(const QString& name, const QString& help, const QString& labels = QString());
+    Histogram& histogram(const QString& name, const QString& help,
+                         const QList<double>& bounds = latencyBounds(), const QString& labels = QString());
+
+    // 100 us to 10 s, for request and statement latencies.
+    static QList<double> latencyBounds();
+
+    // Text exposition format 0.0.4, families in registration order.
+    QByteArray exposition() const;
+    // Replaces path as a whole, so a reader never sees a partial scrape.
+    bool writeFile(const QString& path) const;
+
+    // The calling thread's slot.
+    static int slot() {
+        static std::atomic<int> nextSlot{0};
+        thread_local int mine = nextSlot.fetch_add(1, std::memory_order_relaxed) % kSlots;
+        return mine;
+    }
+
+ private:
+    enum class Type { Counter, Gauge, Histogram };
+
+    struct Series {
+        QString labels;
+        std::unique_ptr<Counter> counter;
+        std::unique_ptr<Gauge> gauge;
+        std::unique_ptr<Histogram> histogram;
+    };
+
+    struct Family {
+        QString name;
+        QString help;
+        Type type;
+        std::vector<std::unique_ptr<Series>> series;
+    };
+
+    mutable QMutex m_mutex;  // guards m_families; metrics themselves are lock-free
+    std::vector<std::unique_ptr<Family>> m_families;
+
+    Metrics() = default;
+
+    Series& series(const QString& name, const QString& help, Type type, const QString& labels);
+};
+#endif  // METRICS_H
@@ -0,0 +1,65 @@
+// Copyright 2025 MarketSystem
+#ifndef PAGECACHE_H
+#define PAGECACHE_H
+
+#include <list>
+#include <utility>
+
+// Small LRU of fetched pages keyed by page index, used by the virtualized
+// table models. Capacity is a handful of pages, so lookups are linear.
+// Page may be move-only (UserTable).
+template <typename Page>
+class PageCache {
+ public:
+    explicit PageCache(int capacity) : m_capacity(capacity < 1 ? 1 : capacity) {}
+
+    // Cached page or nullptr; a hit becomes the most recently used page.
+    Page* find(int index) {
+        for (auto it = m_pages.begin(); it != m_pages.end(); ++it) {
+            if (it->first == index) {
+                m_pages.splice(m_pages.begin(), m_pages, it);
+                return &m_pages.front().second;
+            }
+        }
+        return nullptr;
+    }
+
+    // Stores page, evicting the least recently used one when full.
+    Page* insert(int index, Page&& page) {
+        remove(index);
+        if (static_cast<int>(m_pages.size()) >= m_capacity) {
+            m_pages.pop_back();
+        }
+        m_pages.emplace_front(index, std::move(page));
+        return &m_pages.front().second;
+    }
+
+    void remove(int index) {
+        for (auto it = m_pages.begin(); it != m_pages.end(); ++it) {
+            if (it->first == index) {
+                m_pages.erase(it);
+                return;
+            }
+        }
+    }
+
+    // Calls visitor(index, page) for every cached page, without touching the
+    // LRU order; stops early when visitor returns true.
+    template <typename Visitor>
+    void visit(Visitor visitor) {
+        for (auto& entry : m_pages) {
+            if (visitor(entry.first, entry.second)) {
+                return;
+            }
+        }
+    }
+
+    void clear() { m_pages.clear(); }
+    int size() const { return static_cast<int>(m_pages.size()); }
+    int capacity() const { return m_capacity; }
+
+ private:
+    int m_capacity;
+    std::list<std::pair<int, Page>> m_pages;  // most recently used first
+};
+#endif  // PAGECACHE_H
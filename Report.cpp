@@ -0,0 +1,21 @@
+// Copyright 2025 MarketSystem
+#include "Report.h"
+
+Report::Report()
+    : m_id(0), m_reporterId(0), m_reportedUserId(0), m_claimedBy(0) {
+}
+
+Report::Report(int id, int reporterId, const QString& reporterName,
+               int reportedUserId, const QString& reportedName,
+               const QString& reason, const QString& status,
+               const QDateTime& createdAt, const QDateTime& resolvedAt,
+               int claimedBy)
+    : m_id(id), m_reporterId(reporterId), m_reporterName(reporterName),
+    m_reportedUserId(reportedUserId), m_reportedName(reportedName),
+    m_reason(reason), m_status(status), m_createdAt(createdAt),
+    m_resolvedAt(resolvedAt), m_claimedBy(claimedBy) {
+}
+
+QString Report::details() const {
+    return QString("Reported %1: %2 (Status: %3)").arg(m_reportedName, m_reason, m_status);
+}
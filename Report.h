@@ -0,0 +1,52 @@
+// Copyright 2025 MarketSystem
+#ifndef REPORT_H
+#define REPORT_H
+
+#include <QString>
+#include <QDateTime>
+
+// A row of the reports table with the reporter's and reported user's
+// names. Text for display is built only when asked for (details()).
+class Report {
+ private:
+    int m_id;
+    int m_reporterId;
+    QString m_reporterName;
+    int m_reportedUserId;
+    QString m_reportedName;
+    QString m_reason;
+    QString m_status;        // pending, resolved or rejected
+    QDateTime m_createdAt;
+    QDateTime m_resolvedAt;  // invalid while pending
+    int m_claimedBy;         // admin user id working on it, 0 if unclaimed
+
+ public:
+    Report();
+    Report(int id, int reporterId, const QString& reporterName,
+           int reportedUserId, const QString& reportedName,
+           const QString& reason, const QString& status,
+           const QDateTime& createdAt, const QDateTime& resolvedAt = QDateTime(),
+           int claimedBy = 0);
+
+    // Getters
+    int getId() const { return m_id; }
+    int getReporterId() const { return m_reporterId; }
+    QString getReporterName() const { return m_reporterName; }
+    int getReportedUserId() const { return m_reportedUserId; }
+    QString getReportedName() const { return m_reportedName; }
+    QString getReason() const { return m_reason; }
+    QString getStatus() const { return m_status; }
+    QDateTime getCreatedAt() const { return m_createdAt; }
+    QDateTime getResolvedAt() const { return m_resolvedAt; }
+    int getClaimedBy() const { return m_claimedBy; }
+    bool isPending() const { return m_status == "pending"; }
+
+    // Setters
+    void setStatus(const QString& status) { m_status = status; }
+    void setResolvedAt(const QDateTime& resolvedAt) { m_resolvedAt = resolvedAt; }
+    void setClaimedBy(int adminId) { m_claimedBy = adminId; }
+
+    // "Reported <name>: <reason> (Status: <status>)"
+    QString details() const;
+};
+#endif  // REPORT_H
@@ -0,0 +1,216 @@
+// Copyright 2025 MarketSystem
+#include "ReportService.h"
+#include "AdminService.h"
+#include "ShardRouter.h"
+#include <QDebug>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QSqlError>
+#include <QSqlQuery>
+
+namespace {
+
+QMutex policyMutex;
+AutoBanPolicy currentPolicy = AutoBanPolicy::defaultPolicy();
+
+const char* const kStatsQuery =
+    "SELECT user_id, total_reports, pending_reports, distinct_reporters, "
+    "CAST(strftime('%s', last_report_at) AS INTEGER) "
+    "FROM user_report_stats WHERE user_id = ?";
+
+ReportStats statsFromRow(const QSqlQuery& query) {
+    ReportStats stats;
+    stats.userId = query.value(0).toInt();
+    stats.totalReports = query.value(1).toInt();
+    stats.pendingReports = query.value(2).toInt();
+    stats.distinctReporters = query.value(3).toInt();
+    QVariant last = query.value(4);
+    if (!last.isNull()) {
+        stats.lastReportAt = QDateTime::fromSecsSinceEpoch(last.toLongLong(), Qt::UTC);
+    }
+    return stats;
+}
+
+// submitReport() with sharding on: files the report on the reported user's
+// shard. Shards have no foreign keys to each other, so both users are
+// looked up first.
+bool fileOnShard(int reporterId, int reportedUserId, const QString& reason, ReportSubmission* submission,
+                 bool* isAdmin) {
+    ShardRouter& shards = ShardRouter::getInstance();
+    QSqlQuery reporter = shards.executeForId(reporterId, "SELECT 1 FROM users WHERE id = ?", {reporterId});
+    if (!reporter.next()) {
+        submission->message = "Failed to submit report: unknown reporter";
+        return false;
+    }
+    reporter.finish();
+
+    int shard = shards.shardForId(reportedUserId);
+    if (!shards.beginTransaction(shard)) {
+        submission->message = "Failed to submit report: " + shards.connection(shard).lastError().text();
+        return false;
+    }
+
+    QSqlQuery query(shards.connection(shard));
+    query.prepare("SELECT is_admin FROM users WHERE id = ?");
+    query.addBindValue(reportedUserId);
+    if (!query.exec() || !query.next()) {
+        query.finish();
+        shards.rollbackTransaction(shard);
+        submission->message = "Failed to submit report: unknown user";
+        return false;
+    }
+    *isAdmin = query.value(0).toBool();
+
+    query.prepare(shards.insertStatement(shard, "reports", {"reporter_id", "reported_user_id", "reason"}));
+    query.addBindValue(reporterId);
+    query.addBindValue(reportedUserId);
+    query.addBindValue(reason);
+    if (!query.exec() || !query.next()) {
+        qWarning() << "submitReport: insert failed:" << query.lastError().text();
+        submission->message = "Failed to submit report: " + query.lastError().text();
+        query.finish();
+        shards.rollbackTransaction(shard);
+        return false;
+    }
+    submission->reportId = query.value(0).toInt();
+
+    // Same transaction, as on the primary file; the shard keeps its own
+    // stats table, and all of a user's reports are on the user's shard
+    query.prepare(kStatsQuery);
+    query.addBindValue(reportedUserId);
+    if (!query.exec() || !query.next()) {
+        qWarning() << "submitReport: no report stats for user" << reportedUserId << query.lastError().text();
+        query.finish();
+        shards.rollbackTransaction(shard);
+        submission->reportId = -1;
+        submission->message = "Failed to submit report";
+        return false;
+    }
+    submission->stats = statsFromRow(query);
+    query.finish();
+
+    if (!shards.commitTransaction(shard)) {
+        submission->message = "Failed to submit report: " + shards.connection(shard).lastError().text();
+        shards.rollbackTransaction(shard);
+        submission->reportId = -1;
+        return false;
+    }
+    return true;
+}
+
+}  // namespace
+
+ReportSubmission ReportService::submitReport(int reporterId, int reportedUserId, const QString& reason) {
+    ReportSubmission submission;
+    if (reporterId == reportedUserId) {
+        submission.message = "Users cannot report themselves";
+        return submission;
+    }
+    if (reason.trimmed().isEmpty()) {
+        submission.message = "A reason is required";
+        return submission;
+    }
+
+    bool isAdmin = false;
+    if (ShardRouter::getInstance().isEnabled()) {
+        if (fileOnShard(reporterId, reportedUserId, reason, &submission, &isAdmin)) {
+            submission.ok = true;
+            submission.message = "Report submitted";
+            if (!isAdmin) {
+                applyAutoBan(reportedUserId, &submission);
+            }
+        }
+        return submission;
+    }
+
+    DatabaseManager& db = DatabaseManager::getInstance();
+    if (!db.beginTransaction()) {
+        submission.message = "Failed to submit report: " + db.getLastError();
+        return submission;
+    }
+
+    {
+        QSqlQuery query(db.getDatabase());
+        query.prepare("INSERT INTO reports (reporter_id, reported_user_id, reason) VALUES (?, ?, ?)");
+        query.addBindValue(reporterId);
+        query.addBindValue(reportedUserId);
+        query.addBindValue(reason);
+        if (!query.exec()) {
+            // Unknown reporter or reported user fails the foreign keys
+            qWarning() << "submitReport: insert failed:" << query.lastError().text();
+            db.rollbackTransaction();
+            submission.message = "Failed to submit report: " + query.lastError().text();
+            return submission;
+        }
+        submission.reportId = query.lastInsertId().toInt();
+
+        // Read in the same transaction, so these counters include this report
+        // and nothing filed after it.
+        query.prepare(kStatsQuery);
+        query.addBindValue(reportedUserId);
+        if (!query.exec() || !query.next()) {
+            qWarning() << "submitReport: no report stats for user" << reportedUserId
+                       << query.lastError().text();
+            db.rollbackTransaction();
+            submission.reportId = -1;
+            submission.message = "Failed to submit report";
+            return submission;
+        }
+        submission.stats = statsFromRow(query);
+
+        query.prepare("SELECT is_admin FROM users WHERE id = ?");
+        query.addBindValue(reportedUserId);
+        isAdmin = query.exec() && query.next() && query.value(0).toBool();
+    }
+
+    if (!db.commitTransaction()) {
+        db.rollbackTransaction();
+        submission.reportId = -1;
+        submission.message = "Failed to submit report: " + db.getLastError();
+        return submission;
+    }
+
+    submission.ok = true;
+    submission.message = "Report submitted";
+    if (!isAdmin) {
+        applyAutoBan(reportedUserId, &submission);
+    }
+    return submission;
+}
+
+void ReportService::applyAutoBan(int reportedUserId, ReportSubmission* submission) {
+    const AutoBanPolicy policy = autoBanPolicy();
+    if (const AutoBanRule* rule = policy.evaluate(submission->stats)) {
+        // A user already banned by an earlier report is left as is
+        QPair<bool, QString> ban = AdminService::banUser(reportedUserId, "Auto-ban: " + rule->name);
+        submission->autoBanned = ban.first;
+        if (ban.first) {
+            qDebug() << "Auto-banned user" << reportedUserId << "by rule" << rule->name;
+            submission->message = "Report submitted; user auto-banned (" + rule->name + ")";
+        }
+    }
+}
+
+QPair<bool, ReportStats> ReportService::getReportStats(int userId) {
+    QSqlQuery query = ShardRouter::getInstance().executeForId(userId, kStatsQuery, {userId});
+    if (query.lastError().isValid()) {
+        return qMakePair(false, ReportStats());
+    }
+    if (!query.next()) {
+        // Never reported
+        ReportStats stats;
+        stats.userId = userId;
+        return qMakePair(true, stats);
+    }
+    return qMakePair(true, statsFromRow(query));
+}
+
+void ReportService::setAutoBanPolicy(const AutoBanPolicy& policy) {
+    QMutexLocker locker(&policyMutex);
+    currentPolicy = policy;
+}
+
+AutoBanPolicy ReportService::autoBanPolicy() {
+    QMutexLocker locker(&policyMutex);
+    return currentPolicy;
+}
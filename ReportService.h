@@ -0,0 +1,38 @@
+// Copyright 2025 MarketSystem
+#ifndef REPORTSERVICE_H
+#define REPORTSERVICE_H
+
+#include <QString>
+#include <QPair>
+#include "AutoBanPolicy.h"
+#include "DatabaseManager.h"
+
+// Outcome of ReportService::submitReport().
+struct ReportSubmission {
+    bool ok = false;
+    int reportId = -1;
+    ReportStats stats;        // counters of the reported user after this report
+    bool autoBanned = false;  // the policy fired and the ban went through
+    QString message;
+};
+
+class ReportService {
+ public:
+    // Files a pending report and runs the auto-ban policy on the reported
+    // user's counters. The counters come from user_report_stats, which the
+    // report triggers update in the same transaction as the insert. Admins
+    // are never auto-banned.
+    static ReportSubmission submitReport(int reporterId, int reportedUserId, const QString& reason);
+
+    static QPair<bool, ReportStats> getReportStats(int userId);
+
+    // Policy used by submitReport(); AutoBanPolicy::defaultPolicy() until
+    // replaced. An empty policy turns auto-banning off.
+    static void setAutoBanPolicy(const AutoBanPolicy& policy);
+    static AutoBanPolicy autoBanPolicy();
+
+ private:
+    // Bans the reported user if the policy fires on submission->stats.
+    static void applyAutoBan(int reportedUserId, ReportSubmission* submission);
+};
+#endif  // REPORTSERVICE_H
@@ -0,0 +1,250 @@
+// Copyright 2025 MarketSystem
+#include "ReportTableModel.h"
+#include "ChangeNotifier.h"
+#include <QCoreApplication>
+#include <QDebug>
+#include <QPointer>
+#include <QThreadPool>
+#include <memory>
+#include <utility>
+
+ReportTableModel::ReportTableModel(QObject* parent)
+    : QAbstractTableModel(parent), m_cache(kCachedPages) {
+    connect(&ChangeNotifier::getInstance(), &ChangeNotifier::reportStatusChanged,
+            this, &ReportTableModel::applyStatusChange);
+}
+
+void ReportTableModel::reload() {
+    beginResetModel();
+    invalidatePrefetch();
+    m_atEnd = false;
+    m_rowCount = 0;
+    m_nextCursor = ListCursor();
+    m_pageStarts.clear();
+    m_cache.clear();
+    endResetModel();
+}
+
+int ReportTableModel::rowCount(const QModelIndex& parent) const {
+    return parent.isValid() ? 0 : m_rowCount;
+}
+
+int ReportTableModel::columnCount(const QModelIndex& parent) const {
+    return parent.isValid() ? 0 : ColumnCount;
+}
+
+bool ReportTableModel::canFetchMore(const QModelIndex& parent) const {
+    return !parent.isValid() && !m_atEnd;
+}
+
+void ReportTableModel::fetchMore(const QModelIndex& parent) {
+    if (parent.isValid() || m_atEnd) {
+        return;
+    }
+
+    if (m_prefetchedNext) {
+        QList<Report> reports = std::move(*m_prefetchedNext);
+        m_prefetchedNext.reset();
+        appendPage(std::move(reports));
+        return;
+    }
+
+    QPair<bool, QList<Report>> result = AdminService::getReportsAfter(m_nextCursor, kPageSize);
+    if (!result.first) {
+        qWarning() << "ReportTableModel: failed to fetch page" << m_pageStarts.size();
+        m_atEnd = true;
+        return;
+    }
+    appendPage(std::move(result.second));
+}
+
+void ReportTableModel::appendPage(QList<Report>&& reports) {
+    int count = reports.size();
+    if (count < kPageSize) {
+        m_atEnd = true;
+    }
+    if (count == 0) {
+        return;
+    }
+
+    beginInsertRows(QModelIndex(), m_rowCount, m_rowCount + count - 1);
+    int pageIndex = static_cast<int>(m_pageStarts.size());
+    m_pageStarts.push_back(m_nextCursor);
+    m_nextCursor.createdAtSecs = reports.last().getCreatedAt().toSecsSinceEpoch();
+    m_nextCursor.id = reports.last().getId();
+    m_cache.insert(pageIndex, std::move(reports));
+    m_rowCount += count;
+    endInsertRows();
+}
+
+const Report* ReportTableModel::rowAt(int row) const {
+    int pageIndex = row / kPageSize;
+    int offset = row % kPageSize;
+    if (row < 0 || pageIndex >= static_cast<int>(m_pageStarts.size())) {
+        return nullptr;
+    }
+
+    QList<Report>* page = m_cache.find(pageIndex);
+    if (!page) {
+        QPair<bool, QList<Report>> result = AdminService::getReportsAfter(m_pageStarts[pageIndex], kPageSize);
+        if (!result.first) {
+            return nullptr;
+        }
+        page = m_cache.insert(pageIndex, std::move(result.second));
+    }
+    return offset < page->size() ? &page->at(offset) : nullptr;
+}
+
+void ReportTableModel::invalidatePrefetch() {
+    ++m_generation;
+    m_prefetching.clear();
+    m_prefetchedNext.reset();
+}
+
+void ReportTableModel::prefetchAround(int row) {
+    if (row < 0 || row >= m_rowCount) {
+        return;
+    }
+    int pageIndex = row / kPageSize;
+    if (pageIndex > 0) {
+        prefetchPage(pageIndex - 1);
+    }
+    prefetchPage(pageIndex + 1);
+}
+
+void ReportTableModel::prefetchPage(int pageIndex) {
+    int loadedPages = static_cast<int>(m_pageStarts.size());
+    if (pageIndex > loadedPages || m_prefetching.contains(pageIndex)) {
+        return;
+    }
+    if (pageIndex == loadedPages ? (m_atEnd || m_prefetchedNext) : m_cache.find(pageIndex) != nullptr) {
+        return;
+    }
+
+    ListCursor after = pageIndex == loadedPages ? m_nextCursor : m_pageStarts[pageIndex];
+    int generation = m_generation;
+    m_prefetching.insert(pageIndex);
+
+    QPointer<ReportTableModel> self(this);
+    QThreadPool::globalInstance()->start([self, generation, pageIndex, after]() {
+        auto result = std::make_shared<QPair<bool, QList<Report>>>(AdminService::getReportsAfter(after, kPageSize));
+        QMetaObject::invokeMethod(qApp, [self, generation, pageIndex, result]() {
+            if (self) {
+                self->storePrefetched(generation, pageIndex, result->first, std::move(result->second));
+            }
+        }, Qt::QueuedConnection);
+    });
+}
+
+void ReportTableModel::storePrefetched(int generation, int pageIndex, bool ok, QList<Report>&& reports) {
+    if (generation != m_generation) {
+        return;
+    }
+    m_prefetching.remove(pageIndex);
+    if (!ok) {
+        return;
+    }
+
+    int loadedPages = static_cast<int>(m_pageStarts.size());
+    if (pageIndex == loadedPages) {
+        if (!m_atEnd) {
+            m_prefetchedNext = std::move(reports);
+        }
+    } else if (pageIndex < loadedPages && !m_cache.find(pageIndex)) {
+        m_cache.insert(pageIndex, std::move(reports));
+    }
+}
+
+void ReportTableModel::refreshRows(const TableChanges& changes) {
+    if (changes.isEmpty()) {
+        return;
+    }
+    invalidatePrefetch();
+
+    std::vector<int> stale;
+    m_cache.visit([&](int pageIndex, QList<Report>& page) {
+        for (int offset = 0; offset < page.size(); ++offset) {
+            if (changes.touches(page[offset].getId())) {
+                stale.push_back(pageIndex);
+                break;
+            }
+        }
+        return false;
+    });
+
+    for (int pageIndex : stale) {
+        m_cache.remove(pageIndex);
+        int first = pageIndex * kPageSize;
+        int last = qMin(first + kPageSize, m_rowCount) - 1;
+        emit dataChanged(index(first, 0), index(last, ColumnCount - 1));
+    }
+}
+
+void ReportTableModel::applyStatusChange(int reportId, const QString& status) {
+    invalidatePrefetch();
+    // Same approach as UserTableModel::applyUserChange()
+    int changedRow = -1;
+    m_cache.visit([&](int pageIndex, QList<Report>& page) {
+        for (int offset = 0; offset < page.size(); ++offset) {
+            if (page[offset].getId() == reportId) {
+                page[offset].setStatus(status);
+                changedRow = pageIndex * kPageSize + offset;
+                return true;
+            }
+        }
+        return false;
+    });
+
+    if (changedRow >= 0) {
+        emit dataChanged(index(changedRow, 0), index(changedRow, ColumnCount - 1));
+    }
+}
+
+int ReportTableModel::reportId(int row) const {
+    const Report* report = rowAt(row);
+    return report ? report->getId() : -1;
+}
+
+QString ReportTableModel::details(int row) const {
+    const Report* report = rowAt(row);
+    return report ? report->details() : QString();
+}
+
+QVariant ReportTableModel::data(const QModelIndex& index, int role) const {
+    if (!index.isValid() || role != Qt::DisplayRole) {
+        return QVariant();
+    }
+
+    const Report* report = rowAt(index.row());
+    if (!report) {
+        return QVariant();
+    }
+
+    switch (index.column()) {
+    case IdColumn:
+        return report->getId();
+    case ReporterColumn:
+        return report->getReporterName();
+    case DetailsColumn:
+        return report->details();
+    default:
+        return QVariant();
+    }
+}
+
+QVariant ReportTableModel::headerData(int section, Qt::Orientation orientation, int role) const {
+    if (role != Qt::DisplayRole || orientation != Qt::Horizontal) {
+        return QAbstractTableModel::headerData(section, orientation, role);
+    }
+
+    switch (section) {
+    case IdColumn:
+        return QString("ID");
+    case ReporterColumn:
+        return QString("Reporter");
+    case DetailsColumn:
+        return QString("Report Details");
+    default:
+        return QVariant();
+    }
+}
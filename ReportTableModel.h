@@ -0,0 +1,67 @@
+// Copyright 2025 MarketSystem
+#ifndef REPORTTABLEMODEL_H
+#define REPORTTABLEMODEL_H
+
+#include <QAbstractTableModel>
+#include <QList>
+#include <QSet>
+#include <optional>
+#include <vector>
+#include "AdminService.h"
+#include "ChangeFeed.h"
+#include "PageCache.h"
+
+// Reports listing for the admin window, paged the same way as
+// UserTableModel: keyset pages on demand, cursors kept, pages in an LRU.
+class ReportTableModel : public QAbstractTableModel {
+    Q_OBJECT
+
+ public:
+    enum Column { IdColumn, ReporterColumn, DetailsColumn, ColumnCount };
+
+    static const int kPageSize = 128;
+    static const int kCachedPages = 16;
+
+    explicit ReportTableModel(QObject* parent = nullptr);
+
+    void reload();
+
+    // Report id and details text of a row; -1 / empty when unavailable.
+    int reportId(int row) const;
+    QString details(int row) const;
+
+    // Background read-ahead, as UserTableModel::prefetchAround().
+    void prefetchAround(int row);
+    bool hasPrefetchedNext() const { return m_prefetchedNext.has_value(); }
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+    bool canFetchMore(const QModelIndex& parent) const override;
+    void fetchMore(const QModelIndex& parent) override;
+
+ public slots:
+    void applyStatusChange(int reportId, const QString& status);
+
+    // As UserTableModel::refreshRows().
+    void refreshRows(const TableChanges& changes);
+
+ private:
+    bool m_atEnd = false;
+    int m_rowCount = 0;
+    ListCursor m_nextCursor;
+    std::vector<ListCursor> m_pageStarts;
+    mutable PageCache<QList<Report>> m_cache;
+
+    int m_generation = 0;
+    QSet<int> m_prefetching;
+    std::optional<QList<Report>> m_prefetchedNext;
+
+    void appendPage(QList<Report>&& reports);
+    void invalidatePrefetch();
+    void prefetchPage(int pageIndex);
+    void storePrefetched(int generation, int pageIndex, bool ok, QList<Report>&& reports);
+    const Report* rowAt(int row) const;
+};
+#endif  // REPORTTABLEMODEL_H
@@ -0,0 +1,337 @@
+// Copyright 2025 MarketSystem
+#include "ShardRouter.h"
+#include "DatabaseManager.h"
+#include "UserCache.h"
+#include <QCryptographicHash>
+#include <QDebug>
+#include <QDir>
+#include <QFileInfo>
+#include <QMutexLocker>
+#include <QSqlError>
+#include <QThreadStorage>
+#include <QtConcurrent>
+#include <numeric>
+#include <vector>
+
+namespace {
+// One thread's connections to every shard, reopened after configure().
+struct ShardConnections {
+    std::vector<QSqlDatabase> databases;
+    QStringList names;
+    int generation = -1;
+    QSqlDatabase invalid;  // returned for a shard that does not exist
+
+    void reset() {
+        for (QSqlDatabase& database : databases) {
+            database.close();
+        }
+        databases.clear();
+        for (const QString& name : names) {
+            QSqlDatabase::removeDatabase(name);
+        }
+        names.clear();
+    }
+
+    ~ShardConnections() {
+        reset();
+    }
+};
+
+QThreadStorage<ShardConnections*> threadShards;
+std::atomic<quint64> shardConnectionCounter{0};
+
+const char* const kAdminPhone = "13800138000";
+
+// The primary file's users and reports columns. Reports have no foreign
+// keys: the reporter usually lives on another shard.
+const char* const kShardSchema[] = {
+    "CREATE TABLE IF NOT EXISTS shard_info ("
+    "id INTEGER PRIMARY KEY CHECK (id = 1), "
+    "shard INTEGER NOT NULL, "
+    "shard_count INTEGER NOT NULL)",
+    "CREATE TABLE IF NOT EXISTS users ("
+    "id INTEGER PRIMARY KEY AUTOINCREMENT, "
+    "phone TEXT UNIQUE NOT NULL, "
+    "password TEXT NOT NULL, "
+    "username TEXT, "
+    "created_at TIMESTAMP DEFAULT CURRENT_TIMESTAMP, "
+    "is_admin BOOLEAN DEFAULT 0, "
+    "is_banned BOOLEAN DEFAULT 0)",
+    "CREATE TABLE IF NOT EXISTS reports ("
+    "id INTEGER PRIMARY KEY AUTOINCREMENT, "
+    "reporter_id INTEGER NOT NULL, "
+    "reported_user_id INTEGER NOT NULL, "
+    "reason TEXT NOT NULL, "
+    "status TEXT CHECK(status IN ('pending', 'resolved', 'rejected')) DEFAULT 'pending', "
+    "created_at TIMESTAMP DEFAULT CURRENT_TIMESTAMP, "
+    "resolved_at TIMESTAMP, "
+    "claimed_by INTEGER, "
+    "claimed_at TIMESTAMP)",
+    "CREATE INDEX IF NOT EXISTS idx_users_created ON users(created_at, id)",
+    "CREATE INDEX IF NOT EXISTS idx_users_banned_created ON users(is_banned, created_at, id)",
+    "CREATE INDEX IF NOT EXISTS idx_reports_created ON reports(created_at, id)",
+    // Each shard holds its part of the moderation queue (AdminService)
+    "CREATE INDEX IF NOT EXISTS idx_reports_queue ON reports(created_at, id) "
+    "WHERE status = 'pending' AND claimed_by IS NULL",
+    "CREATE INDEX IF NOT EXISTS idx_reports_claimed ON reports(claimed_by) "
+    "WHERE claimed_by IS NOT NULL"};
+
+// Next id of shard's residue class. Read inside the INSERT, so the write
+// lock covers reading the sequence and taking the id.
+QString nextIdExpression(const QString& table, int shard, int count) {
+    return QString("COALESCE((SELECT seq FROM sqlite_sequence WHERE name = '%1'), %2) + %3")
+        .arg(table).arg(shard).arg(count);
+}
+}  // namespace
+
+ShardRouter& ShardRouter::getInstance() {
+    static ShardRouter instance;
+    return instance;
+}
+
+QString ShardRouter::shardPath(int shard) {
+    QFileInfo primary(DatabaseManager::databasePath());
+    QString suffix = primary.suffix().isEmpty() ? QString() : "." + primary.suffix();
+    return primary.dir().filePath(QString("%1.shard%2%3").arg(primary.completeBaseName()).arg(shard).arg(suffix));
+}
+
+int ShardRouter::phoneShard(const QString& phone, int count) {
+    if (count <= 1) {
+        return 0;
+    }
+    // FNV-1a: unlike qHash() the same in every process and Qt version,
+    // which a row's placement has to be
+    quint64 hash = 14695981039346656037ULL;
+    for (char byte : phone.toUtf8()) {
+        hash ^= static_cast<quint8>(byte);
+        hash *= 1099511628211ULL;
+    }
+    // Its low bits only see the low bits of each byte; mix the high bits
+    // down before taking the remainder (MurmurHash3's finalizer)
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdULL;
+    hash ^= hash >> 33;
+    hash *= 0xc4ceb9fe1a85ec53ULL;
+    hash ^= hash >> 33;
+    return static_cast<int>(hash % static_cast<quint64>(count));
+}
+
+int ShardRouter::shardForId(qint64 id) const {
+    int count = shardCount();
+    return count > 0 && id > 0 ? static_cast<int>(id % count) : 0;
+}
+
+bool ShardRouter::prepareShard(const QString& path, int shard, int count) {
+    const QString name = QString("market_shard_setup_%1").arg(++shardConnectionCounter);
+    bool ok = true;
+    DatabaseManager::removeStaleWal(path);
+    {
+        QSqlDatabase database = QSqlDatabase::addDatabase("QSQLITE", name);
+        database.setDatabaseName(path);
+        if (!database.open()) {
+            qCritical() << "Failed to open shard" << path << ":" << database.lastError().text();
+            ok = false;
+        }
+
+        QSqlQuery query(database);
+        // Journal mode as on the primary file; switching it waits for the lock
+        if (ok && !query.exec(QString("PRAGMA busy_timeout = %1;").arg(DatabaseManager::busyTimeout()))) {
+            qWarning() << "Failed to set busy timeout:" << query.lastError().text();
+        }
+        ok = ok && DatabaseManager::enableWal(database);
+        for (const char* statement : kShardSchema) {
+            if (ok && !query.exec(statement)) {
+                qCritical() << "Failed to create shard schema:" << query.lastError().text();
+                ok = false;
+            }
+        }
+        // Report counters and dashboard totals kept per shard, as on the
+        // primary file
+        ok = ok && DatabaseManager::createReportStats(database) && DatabaseManager::createMarketStats(database);
+
+        // A file made for another count holds rows this count would not find
+        if (ok) {
+            query.prepare("INSERT OR IGNORE INTO shard_info (id, shard, shard_count) VALUES (1, ?, ?)");
+            query.addBindValue(shard);
+            query.addBindValue(count);
+            ok = query.exec() && query.exec("SELECT shard, shard_count FROM shard_info") && query.next();
+            if (ok && (query.value(0).toInt() != shard || query.value(1).toInt() != count)) {
+                qCritical() << "Shard" << path << "belongs to shard" << query.value(0).toInt() << "of"
+                            << query.value(1).toInt() << ", not" << shard << "of" << count;
+                ok = false;
+            }
+            query.finish();
+        }
+
+        // The default admin account, on the shard its phone maps to
+        if (ok && phoneShard(kAdminPhone, count) == shard) {
+            QByteArray hash = QCryptographicHash::hash(QByteArray("admin123"), QCryptographicHash::Md5);
+            query.prepare("INSERT OR IGNORE INTO users (id, phone, password, username, is_admin, is_banned) "
+                          "SELECT " + nextIdExpression("users", shard, count) + ", ?, ?, 'Administrator', 1, 0");
+            query.addBindValue(kAdminPhone);
+            query.addBindValue(QString(hash.toHex()));
+            if (!query.exec()) {
+                qWarning() << "Failed to create admin account on shard:" << query.lastError().text();
+                ok = false;
+            }
+        }
+        database.close();
+    }
+    QSqlDatabase::removeDatabase(name);
+    return ok;
+}
+
+bool ShardRouter::configure(int count) {
+    count = qMax(0, count);
+    QStringList paths;
+    for (int shard = 0; shard < count; ++shard) {
+        paths.append(shardPath(shard));
+        QDir().mkpath(QFileInfo(paths.last()).absolutePath());
+        if (!prepareShard(paths.last(), shard, count)) {
+            return false;
+        }
+    }
+
+    {
+        QMutexLocker locker(&m_mutex);
+        m_paths = paths;
+        m_count = count;
+        ++m_generation;
+    }
+    // Ids and files change meaning with the layout
+    UserCache::getInstance().clear();
+    qDebug() << "Sharding" << (count > 0 ? QString("over %1 files").arg(count) : QString("off"));
+    return true;
+}
+
+QSqlDatabase& ShardRouter::connection(int shard) {
+    ShardConnections* conns = threadShards.localData();
+    if (!conns) {
+        conns = new ShardConnections;
+        threadShards.setLocalData(conns);
+    }
+
+    int generation = m_generation.load();
+    if (conns->generation != generation) {
+        QStringList paths;
+        {
+            QMutexLocker locker(&m_mutex);
+            paths = m_paths;
+            generation = m_generation.load();
+        }
+        conns->reset();
+        for (const QString& path : paths) {
+            QString name = QString("market_shard_%1").arg(++shardConnectionCounter);
+            QSqlDatabase database = QSqlDatabase::addDatabase("QSQLITE", name);
+            database.setDatabaseName(path);
+            if (database.open()) {
+                QSqlQuery query(database);
+                if (!query.exec(QString("PRAGMA busy_timeout = %1;").arg(DatabaseManager::busyTimeout()))) {
+                    qWarning() << "Failed to set busy timeout:" << query.lastError().text();
+                }
+            } else {
+                qCritical() << "Failed to open shard connection:" << database.lastError().text();
+            }
+            conns->databases.push_back(database);
+            conns->names.append(name);
+        }
+        conns->generation = generation;
+    }
+
+    if (shard < 0 || shard >= static_cast<int>(conns->databases.size())) {
+        qWarning() << "No shard" << shard;
+        return conns->invalid;
+    }
+    return conns->databases[shard];
+}
+
+bool ShardRouter::executeQuery(int shard, const QString& query, const QVariantList& params) {
+    QSqlQuery result = executeQueryWithResult(shard, query, params, true);
+    return !result.lastError().isValid();
+}
+
+QSqlQuery ShardRouter::executeQueryWithResult(int shard, const QString& query, const QVariantList& params,
+                                              bool forwardOnly) {
+    QSqlQuery sqlQuery(connection(shard));
+    sqlQuery.setForwardOnly(forwardOnly);
+    if (!sqlQuery.prepare(query)) {
+        qWarning() << "Query preparation failed on shard" << shard << ":" << query;
+        qWarning() << "Error:" << sqlQuery.lastError().text();
+        return sqlQuery;
+    }
+
+    for (int i = 0; i < params.size(); ++i) {
+        sqlQuery.bindValue(i, params[i]);
+    }
+
+    if (!DatabaseManager::execWithRetry(sqlQuery)) {
+        qWarning() << "Query failed on shard" << shard << ":" << query;
+        qWarning() << "Error:" << sqlQuery.lastError().text();
+    }
+    return sqlQuery;
+}
+
+bool ShardRouter::beginTransaction(int shard) {
+    QSqlQuery begin(connection(shard));
+    begin.prepare("BEGIN IMMEDIATE");
+    if (!DatabaseManager::execWithRetry(begin)) {
+        qWarning() << "Failed to begin transaction on shard" << shard << ":" << begin.lastError().text();
+        return false;
+    }
+    DatabaseManager::transactionBegun();
+    return true;
+}
+
+bool ShardRouter::commitTransaction(int shard) {
+    QSqlQuery commit(connection(shard));
+    commit.prepare("COMMIT");
+    if (!DatabaseManager::execWithRetry(commit, true)) {
+        qWarning() << "Failed to commit transaction on shard" << shard << ":" << commit.lastError().text();
+        return false;
+    }
+    DatabaseManager::transactionEnded();
+    return true;
+}
+
+bool ShardRouter::rollbackTransaction(int shard) {
+    DatabaseManager::transactionEnded();
+    QSqlDatabase& database = connection(shard);
+    if (!database.rollback()) {
+        qWarning() << "Failed to roll back transaction on shard" << shard << ":" << database.lastError().text();
+        return false;
+    }
+    return true;
+}
+
+QSqlQuery ShardRouter::executeForPhone(const QString& phone, const QString& query, const QVariantList& params) {
+    if (!isEnabled()) {
+        return DatabaseManager::getInstance().executeQueryWithResult(query, params);
+    }
+    return executeQueryWithResult(shardForPhone(phone), query, params);
+}
+
+QSqlQuery ShardRouter::executeForId(qint64 id, const QString& query, const QVariantList& params) {
+    if (!isEnabled()) {
+        return DatabaseManager::getInstance().executeQueryWithResult(query, params);
+    }
+    return executeQueryWithResult(shardForId(id), query, params);
+}
+
+QString ShardRouter::insertStatement(int shard, const QString& table, const QStringList& columns) const {
+    QStringList placeholders;
+    for (int i = 0; i < columns.size(); ++i) {
+        placeholders.append("?");
+    }
+    return QString("INSERT INTO %1 (id, %2) SELECT %3, %4 RETURNING id, CAST(strftime('%s', created_at) AS INTEGER)")
+        .arg(table, columns.join(", "), nextIdExpression(table, shard, shardCount()), placeholders.join(", "));
+}
+
+void ShardRouter::forEachShard(const std::function<void(int)>& work) const {
+    std::vector<int> shards(shardCount());
+    std::iota(shards.begin(), shards.end(), 0);
+    if (shards.size() == 1) {
+        work(0);
+        return;
+    }
+    QtConcurrent::blockingMap(shards, [&work](int shard) { work(shard); });
+}
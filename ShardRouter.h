@@ -0,0 +1,84 @@
+// Copyright 2025 MarketSystem
+#ifndef SHARDROUTER_H
+#define SHARDROUTER_H
+
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QString>
+#include <QStringList>
+#include <QVariantList>
+#include <QMutex>
+#include <atomic>
+#include <functional>
+
+// Spreads the users and reports tables over N SQLite files, so N writers
+// can commit at once where one file admits a single writer.
+//
+// A user lives on shard hash(phone) mod N. Ids are allocated per shard from
+// the residue class of the shard (id mod N == shard), so they never collide
+// and shardForId() finds a row from its id alone. A report lives with the
+// user it reports, which keeps a user's report counters a shard-local
+// query. Point operations go to one shard; listings ask every shard for a
+// page in parallel and merge the pages (AdminService).
+//
+// Only users and reports are sharded; each shard keeps its own report
+// counters and market_stats row. The moderation queue and statistics are
+// merged over the shards, search falls back to LIKE scans on every shard,
+// and ChangeFeed refuses to run, since the change log and the full-text
+// index exist only in the primary file. Rows are not moved when the shard
+// count changes; configure() refuses files created for another count.
+class ShardRouter {
+ public:
+    static ShardRouter& getInstance();
+    ShardRouter(const ShardRouter&) = delete;
+    ShardRouter& operator=(const ShardRouter&) = delete;
+
+    // Uses count shard files next to DatabaseManager::databasePath()
+    // (marketplace.shard0.db, ...), creating their schema and the default
+    // admin account as needed. 0 turns sharding off; 1 keeps users in one
+    // shard file. Call before other threads use the router.
+    bool configure(int count);
+    int shardCount() const { return m_count.load(); }
+    bool isEnabled() const { return shardCount() > 0; }
+
+    // File of shard for the current database path.
+    static QString shardPath(int shard);
+
+    int shardForPhone(const QString& phone) const { return phoneShard(phone, shardCount()); }
+    int shardForId(qint64 id) const;
+
+    // The calling thread's connection to shard, opened on first use.
+    QSqlDatabase& connection(int shard);
+    bool executeQuery(int shard, const QString& query, const QVariantList& params = {});
+    QSqlQuery executeQueryWithResult(int shard, const QString& query, const QVariantList& params = {},
+                                     bool forwardOnly = false);
+    bool beginTransaction(int shard);
+    bool commitTransaction(int shard);
+    bool rollbackTransaction(int shard);
+
+    // Statements about one user (or report) row: on the row's shard when
+    // sharding is on, on the primary file otherwise.
+    QSqlQuery executeForPhone(const QString& phone, const QString& query, const QVariantList& params = {});
+    QSqlQuery executeForId(qint64 id, const QString& query, const QVariantList& params = {});
+
+    // "INSERT INTO table (id, columns...) ... RETURNING id, created_at" that
+    // takes the next id of shard; bind one value per column.
+    QString insertStatement(int shard, const QString& table, const QStringList& columns) const;
+
+    // Runs work(shard) for every shard in parallel on the global thread
+    // pool and waits for all of them. Each call uses the connections of the
+    // pool thread it runs on.
+    void forEachShard(const std::function<void(int)>& work) const;
+
+ private:
+    std::atomic<int> m_count{0};
+    std::atomic<int> m_generation{0};  // bumped by configure(); connections follow
+    mutable QMutex m_mutex;            // guards m_paths
+    QStringList m_paths;
+
+    ShardRouter() = default;
+
+    static int phoneShard(const QString& phone, int count);
+    static bool prepareShard(const QString& path, int shard, int count);
+};
+#endif  // SHARDROUTER_H
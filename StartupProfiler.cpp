@@ -0,0 +1,131 @@
+// Copyright 2025 MarketSystem
+#include "StartupProfiler.h"
+#include <QCoreApplication>
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QThread>
+#include <algorithm>
+
+namespace {
+QMutex profilerMutex;
+QElapsedTimer startupClock;  // started by start()
+QList<StartupProfiler::Phase> recorded;
+quint64 mainThreadId = 0;
+
+quint64 currentThreadId() {
+    return static_cast<quint64>(reinterpret_cast<quintptr>(QThread::currentThreadId()));
+}
+}  // namespace
+
+void StartupProfiler::start() {
+    QMutexLocker locker(&profilerMutex);
+    recorded.clear();
+    mainThreadId = currentThreadId();
+    startupClock.start();
+}
+
+qint64 StartupProfiler::elapsedUs() {
+    return startupClock.isValid() ? startupClock.nsecsElapsed() / 1000 : 0;
+}
+
+void StartupProfiler::record(const QString& name, qint64 startUs, qint64 endUs) {
+    Phase phase;
+    phase.name = name;
+    phase.startUs = startUs;
+    phase.durationUs = qMax<qint64>(0, endUs - startUs);
+    phase.threadId = currentThreadId();
+    QMutexLocker locker(&profilerMutex);
+    recorded.append(phase);
+}
+
+void StartupProfiler::mark(const QString& name) {
+    Phase phase;
+    phase.name = name;
+    phase.startUs = elapsedUs();
+    phase.threadId = currentThreadId();
+    phase.isMark = true;
+    QMutexLocker locker(&profilerMutex);
+    recorded.append(phase);
+}
+
+QList<StartupProfiler::Phase> StartupProfiler::phases() {
+    QList<Phase> sorted;
+    {
+        QMutexLocker locker(&profilerMutex);
+        sorted = recorded;
+    }
+    std::stable_sort(sorted.begin(), sorted.end(),
+                     [](const Phase& a, const Phase& b) { return a.startUs < b.startUs; });
+    return sorted;
+}
+
+QString StartupProfiler::summary() {
+    QString text;
+    for (const Phase& phase : phases()) {
+        QString thread = phase.threadId == mainThreadId ? "main" : "background";
+        if (phase.isMark) {
+            text += QString("%1 ms  %2  (%3)\n").arg(phase.startUs / 1000.0, 8, 'f', 1).arg(phase.name, thread);
+        } else {
+            text += QString("%1 ms  %2  %3 ms (%4)\n")
+                        .arg(phase.startUs / 1000.0, 8, 'f', 1)
+                        .arg(phase.name)
+                        .arg(phase.durationUs / 1000.0, 0, 'f', 1)
+                        .arg(thread);
+        }
+    }
+    return text;
+}
+
+bool StartupProfiler::writeTrace(const QString& path) {
+    // Trace event format: "X" complete events and "i" instant events,
+    // timestamps in microseconds
+    QJsonArray events;
+    const qint64 pid = QCoreApplication::applicationPid();
+    for (const Phase& phase : phases()) {
+        QJsonObject event;
+        event["name"] = phase.name;
+        event["cat"] = "startup";
+        event["ph"] = phase.isMark ? "i" : "X";
+        event["ts"] = phase.startUs;
+        if (phase.isMark) {
+            event["s"] = "g";
+        } else {
+            event["dur"] = phase.durationUs;
+        }
+        event["pid"] = pid;
+        event["tid"] = static_cast<qint64>(phase.threadId);
+        events.append(event);
+    }
+
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qWarning() << "Failed to write startup trace:" << file.errorString();
+        return false;
+    }
+    QJsonObject trace;
+    trace["traceEvents"] = events;
+    trace["displayTimeUnit"] = "ms";
+    file.write(QJsonDocument(trace).toJson(QJsonDocument::Compact));
+    return true;
+}
+
+StartupProfiler::Scope::Scope(const QString& name)
+    : m_name(name), m_startUs(elapsedUs()) {
+}
+
+StartupProfiler::Scope::~Scope() {
+    end();
+}
+
+void StartupProfiler::Scope::end() {
+    if (m_open) {
+        m_open = false;
+        record(m_name, m_startUs, elapsedUs());
+    }
+}
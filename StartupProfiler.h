@@ -0,0 +1,52 @@
+// Copyright 2025 MarketSystem
+#ifndef STARTUPPROFILER_H
+#define STARTUPPROFILER_H
+
+#include <QList>
+#include <QString>
+
+// Timeline of the startup phases, from main() to the first usable window.
+// Phases may be recorded from any thread, e.g. the database being opened
+// in the background while the login window is shown. The timeline can be
+// printed as a table or written as a Chrome trace (chrome://tracing,
+// Perfetto) with one row per thread.
+class StartupProfiler {
+ public:
+    struct Phase {
+        QString name;
+        qint64 startUs = 0;     // since start()
+        qint64 durationUs = 0;  // 0 for marks
+        quint64 threadId = 0;
+        bool isMark = false;
+    };
+
+    // Times phases from the call on; the first call in main().
+    static void start();
+    static qint64 elapsedUs();
+
+    static void record(const QString& name, qint64 startUs, qint64 endUs);
+    // A point in time, e.g. "login window shown".
+    static void mark(const QString& name);
+
+    static QList<Phase> phases();
+    // One line per phase and mark, in start order.
+    static QString summary();
+    static bool writeTrace(const QString& path);
+
+    // Records the time from construction to end() or destruction.
+    class Scope {
+     public:
+        explicit Scope(const QString& name);
+        ~Scope();
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+        void end();
+
+     private:
+        QString m_name;
+        qint64 m_startUs;
+        bool m_open = true;
+    };
+};
+#endif  // STARTUPPROFILER_H
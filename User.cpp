@@ -3,7 +3,7 @@
 #include <QDebug>
 
 User::User()
-    : m_id(0), m_isAdmin(false) {
+    : m_id(0), m_isAdmin(false), m_isBanned(false) {
 }
 
 User::User(int id, const QString& phone, const QString& password,
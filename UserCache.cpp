@@ -0,0 +1,346 @@
+// Copyright 2025 MarketSystem
+#include "UserCache.h"
+#include <QMutexLocker>
+#include <QStringView>
+#include <chrono>
+#include "ChangeFeed.h"
+#include "Metrics.h"
+
+namespace {
+// Depth of ServiceWrite scopes on this thread.
+thread_local int serviceWriteDepth = 0;
+
+qint64 nowMs() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+struct CacheMetrics {
+    Metrics::Counter& hits;
+    Metrics::Counter& misses;
+    Metrics::Counter& evictions;
+    Metrics::Counter& invalidations;
+    Metrics::Gauge& entries;
+};
+
+CacheMetrics& cacheMetrics() {
+    static Metrics& metrics = Metrics::getInstance();
+    static CacheMetrics instance{
+        metrics.counter("market_user_cache_hits_total", "User lookups answered from the cache."),
+        metrics.counter("market_user_cache_misses_total", "User lookups that read the database."),
+        metrics.counter("market_user_cache_evictions_total", "Cached users evicted for capacity."),
+        metrics.counter("market_user_cache_invalidations_total", "Cached users dropped after a write."),
+        metrics.gauge("market_user_cache_entries", "Users currently cached.")};
+    return instance;
+}
+
+bool isWordChar(QChar c) {
+    return c.isLetterOrNumber() || c == '_';
+}
+
+// Keywords of statements that can change or drop existing rows; REPLACE
+// covers INSERT OR REPLACE, UPDATE covers upserts
+bool isRowChangingKeyword(QStringView word) {
+    for (QStringView keyword : {u"UPDATE", u"DELETE", u"REPLACE", u"DROP", u"ALTER"}) {
+        if (word.compare(keyword, Qt::CaseInsensitive) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+}  // namespace
+
+UserCache::ServiceWrite::ServiceWrite() {
+    ++serviceWriteDepth;
+}
+
+UserCache::ServiceWrite::~ServiceWrite() {
+    --serviceWriteDepth;
+}
+
+UserCache& UserCache::getInstance() {
+    static UserCache instance;
+    return instance;
+}
+
+int UserCache::shardOf(int id) {
+    // The ids of one ShardRouter shard share a residue; mix them first
+    return static_cast<int>(((static_cast<quint32>(id) * 2654435761u) >> 16) % kShards);
+}
+
+int UserCache::phoneShardOf(const QString& phone) {
+    return static_cast<int>(qHash(phone) % kShards);
+}
+
+void UserCache::setCapacity(int capacity) {
+    m_capacity = qMax(kShards, capacity);
+    Removed removed;
+    for (Shard& shard : m_shards) {
+        QMutexLocker locker(&shard.mutex);
+        reclaim(shard, &removed);
+    }
+    unindex(removed);
+}
+
+void UserCache::setMaxAgeMs(int ms) {
+    m_maxAgeMs = qMax(0, ms);
+    if (ms <= 0) {
+        clear();
+    }
+}
+
+bool UserCache::lookup(int id, const QString& phone, User* user) {
+    int maxAge = m_maxAgeMs.load();
+    if (maxAge <= 0) {
+        return false;
+    }
+
+    CacheMetrics& metrics = cacheMetrics();
+    Shard& shard = m_shards[shardOf(id)];
+    QMutexLocker locker(&shard.mutex);
+    auto it = shard.entries.find(id);
+    if (it == shard.entries.end() || (!phone.isEmpty() && it->user.getPhone() != phone)) {
+        metrics.misses.inc();
+        return false;
+    }
+
+    // Hits in recent leave the FIFO order alone; that is what keeps a
+    // one-off scan from looking hot
+    if (it->queue == Queue::Frequent) {
+        shard.frequent.splice(shard.frequent.begin(), shard.frequent, it->position);
+    }
+    // An expired row stays where it is and is refilled in place by the
+    // caller's insert(): dropping it would send a hot row back through
+    // recent every maxAgeMs()
+    if (nowMs() - it->filledMs >= maxAge) {
+        metrics.misses.inc();
+        return false;
+    }
+    *user = it->user;
+    metrics.hits.inc();
+    return true;
+}
+
+bool UserCache::findById(int id, User* user) {
+    return lookup(id, QString(), user);
+}
+
+bool UserCache::findByPhone(const QString& phone, User* user) {
+    if (m_maxAgeMs.load() <= 0) {
+        return false;
+    }
+    int id = -1;
+    {
+        PhoneShard& phones = m_phones[phoneShardOf(phone)];
+        QMutexLocker locker(&phones.mutex);
+        id = phones.ids.value(phone, -1);
+    }
+    if (id < 0) {
+        cacheMetrics().misses.inc();
+        return false;
+    }
+    return lookup(id, phone, user);
+}
+
+void UserCache::insert(const User& user, quint64 token) {
+    const int id = user.getId();
+    if (id <= 0 || m_maxAgeMs.load() <= 0) {
+        return;
+    }
+
+    Shard& shard = m_shards[shardOf(id)];
+    Removed removed;
+    {
+        QMutexLocker locker(&shard.mutex);
+        // Under the lock: invalidations bump the version before taking it,
+        // so either this sees the bump or the invalidation sees this row
+        if (token != m_version.load()) {
+            return;
+        }
+
+        auto it = shard.entries.find(id);
+        if (it != shard.entries.end()) {
+            // A refill keeps the row where it is in recent or frequent
+            if (it->user.getPhone() != user.getPhone()) {
+                removed.append(qMakePair(it->user.getPhone(), id));
+            }
+            it->user = user;
+            it->filledMs = nowMs();
+        } else {
+            Entry entry;
+            entry.user = user;
+            entry.filledMs = nowMs();
+            auto ghost = shard.ghostIndex.find(id);
+            if (ghost != shard.ghostIndex.end()) {
+                // Read again after it left recent: the second access 2Q waits for
+                shard.ghosts.erase(ghost.value());
+                shard.ghostIndex.erase(ghost);
+                shard.frequent.push_front(id);
+                entry.queue = Queue::Frequent;
+                entry.position = shard.frequent.begin();
+            } else {
+                shard.recent.push_front(id);
+                entry.position = shard.recent.begin();
+            }
+            shard.entries.insert(id, entry);
+            cacheMetrics().entries.add(1);
+            reclaim(shard, &removed);
+        }
+    }
+    unindex(removed);
+
+    PhoneShard& phones = m_phones[phoneShardOf(user.getPhone())];
+    QMutexLocker locker(&phones.mutex);
+    phones.ids.insert(user.getPhone(), id);
+}
+
+void UserCache::reclaim(Shard& shard, Removed* removed) {
+    const int perShard = qMax(1, m_capacity.load() / kShards);
+    const size_t recentShare = static_cast<size_t>(qMax(1, perShard / 4));
+    const size_t ghostShare = static_cast<size_t>(qMax(1, perShard / 2));
+
+    while (shard.entries.size() > perShard) {
+        int victim;
+        if (shard.recent.size() > recentShare || shard.frequent.empty()) {
+            victim = shard.recent.back();
+            shard.ghosts.push_front(victim);
+            shard.ghostIndex.insert(victim, shard.ghosts.begin());
+            while (shard.ghosts.size() > ghostShare) {
+                shard.ghostIndex.remove(shard.ghosts.back());
+                shard.ghosts.pop_back();
+            }
+        } else {
+            victim = shard.frequent.back();
+        }
+        removeEntry(shard, shard.entries.find(victim), removed);
+        cacheMetrics().evictions.inc();
+    }
+}
+
+void UserCache::removeEntry(Shard& shard, QHash<int, Entry>::iterator it, Removed* removed) {
+    (it->queue == Queue::Recent ? shard.recent : shard.frequent).erase(it->position);
+    removed->append(qMakePair(it->user.getPhone(), it.key()));
+    shard.entries.erase(it);
+    cacheMetrics().entries.add(-1);
+}
+
+void UserCache::unindex(const Removed& removed) {
+    for (const QPair<QString, int>& entry : removed) {
+        PhoneShard& phones = m_phones[phoneShardOf(entry.first)];
+        QMutexLocker locker(&phones.mutex);
+        auto it = phones.ids.find(entry.first);
+        if (it != phones.ids.end() && it.value() == entry.second) {
+            phones.ids.erase(it);
+        }
+    }
+}
+
+void UserCache::invalidate(int id) {
+    ++m_version;
+    Shard& shard = m_shards[shardOf(id)];
+    Removed removed;
+    {
+        QMutexLocker locker(&shard.mutex);
+        auto it = shard.entries.find(id);
+        if (it != shard.entries.end()) {
+            removeEntry(shard, it, &removed);
+            cacheMetrics().invalidations.inc();
+        }
+    }
+    unindex(removed);
+}
+
+void UserCache::invalidate(const TableChanges& changes) {
+    if (changes.isEmpty()) {
+        return;
+    }
+    if (changes.overflow) {
+        clear();
+        return;
+    }
+
+    ++m_version;
+    Removed removed;
+    for (Shard& shard : m_shards) {
+        QMutexLocker locker(&shard.mutex);
+        QList<int> touched;
+        for (auto it = shard.entries.cbegin(); it != shard.entries.cend(); ++it) {
+            if (changes.touches(it.key())) {
+                touched.append(it.key());
+            }
+        }
+        for (int id : touched) {
+            removeEntry(shard, shard.entries.find(id), &removed);
+        }
+        cacheMetrics().invalidations.inc(touched.size());
+    }
+    unindex(removed);
+}
+
+void UserCache::clear() {
+    ++m_version;
+    for (Shard& shard : m_shards) {
+        QMutexLocker locker(&shard.mutex);
+        int dropped = shard.entries.size();
+        shard.entries.clear();
+        shard.recent.clear();
+        shard.frequent.clear();
+        shard.ghosts.clear();
+        shard.ghostIndex.clear();
+        cacheMetrics().invalidations.inc(dropped);
+        cacheMetrics().entries.add(-dropped);
+    }
+    for (PhoneShard& phones : m_phones) {
+        QMutexLocker locker(&phones.mutex);
+        phones.ids.clear();
+    }
+}
+
+bool UserCache::changesUsers(const QString& statement) {
+    // Most statements never mention the table; skip the word scan for them
+    if (!statement.contains(u"users", Qt::CaseInsensitive)) {
+        return false;
+    }
+
+    bool changes = false;
+    bool namesUsers = false;
+    const qsizetype length = statement.size();
+    for (qsizetype start = 0; start < length && !(changes && namesUsers);) {
+        if (!isWordChar(statement[start])) {
+            ++start;
+            continue;
+        }
+        qsizetype end = start;
+        while (end < length && isWordChar(statement[end])) {
+            ++end;
+        }
+        QStringView word = QStringView(statement).mid(start, end - start);
+        if (word.compare(u"users", Qt::CaseInsensitive) == 0) {
+            namesUsers = true;
+        } else if (isRowChangingKeyword(word)) {
+            changes = true;
+        }
+        start = end;
+    }
+    return changes && namesUsers;
+}
+
+void UserCache::noteStatement(const QString& statement) {
+    if (serviceWriteDepth == 0 && changesUsers(statement)) {
+        clear();
+    }
+}
+
+UserCache::Stats UserCache::stats() const {
+    CacheMetrics& metrics = cacheMetrics();
+    Stats stats;
+    stats.hits = metrics.hits.value();
+    stats.misses = metrics.misses.value();
+    stats.evictions = metrics.evictions.value();
+    stats.invalidations = metrics.invalidations.value();
+    for (const Shard& shard : m_shards) {
+        QMutexLocker locker(&shard.mutex);
+        stats.size += shard.entries.size();
+    }
+    return stats;
+}
@@ -0,0 +1,142 @@
+// Copyright 2025 MarketSystem
+#ifndef USERCACHE_H
+#define USERCACHE_H
+
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QPair>
+#include <QString>
+#include <atomic>
+#include <list>
+#include "User.h"
+
+struct TableChanges;
+
+// Bounded cache of full user rows (password hash included) by id, with a
+// phone -> id index, read through by AuthService::findUserById() and
+// findUserByPhone(). Ids are unique across shard files, so one cache serves
+// every ShardRouter layout; configure() clears it.
+//
+// Eviction is 2Q: a row read once waits in a small FIFO and leaves without
+// displacing anything; a row read again after leaving it (remembered as a
+// ghost id) moves to an LRU of hot rows. A listing or import touching many
+// users once therefore cannot flush the users who log in all the time.
+//
+// The cache is split into shards by id, each with its own lock and its own
+// share of the capacity. Service writes invalidate the rows they changed
+// once they are committed; registrations only add rows, which nothing
+// cached can contradict. Statements that update or delete users rows
+// elsewhere in the process (tests, tools, raw SQL) cannot say which rows
+// they touched, so execWithRetry() clears the whole cache for them. Writes
+// from other processes are only seen when a row expires after maxAgeMs(),
+// or through invalidate(const TableChanges&) from a ChangeFeed; that is why
+// logins and ban checks read is_banned from the database, not from here.
+class UserCache {
+ public:
+    static const int kShards = 16;
+
+    struct Stats {
+        quint64 hits = 0;
+        quint64 misses = 0;
+        quint64 evictions = 0;
+        quint64 invalidations = 0;
+        int size = 0;
+
+        double hitRate() const { return hits + misses > 0 ? double(hits) / double(hits + misses) : 0.0; }
+    };
+
+    // Marks the calling thread's writes to users as invalidated by the
+    // caller, so execWithRetry() does not clear the cache for them.
+    class ServiceWrite {
+     public:
+        ServiceWrite();
+        ~ServiceWrite();
+        ServiceWrite(const ServiceWrite&) = delete;
+        ServiceWrite& operator=(const ServiceWrite&) = delete;
+    };
+
+    static UserCache& getInstance();
+    UserCache(const UserCache&) = delete;
+    UserCache& operator=(const UserCache&) = delete;
+
+    // Rows kept across all shards; shrinking evicts at once.
+    void setCapacity(int capacity);
+    int capacity() const { return m_capacity.load(); }
+    // Rows older than this are read again; 0 turns the cache off.
+    void setMaxAgeMs(int ms);
+    int maxAgeMs() const { return m_maxAgeMs.load(); }
+
+    bool findById(int id, User* user);
+    bool findByPhone(const QString& phone, User* user);
+
+    // Take a token before reading a row and pass it to insert(): a row read
+    // while it was being invalidated is then not stored.
+    quint64 fillToken() const { return m_version.load(); }
+    void insert(const User& user, quint64 token);
+
+    void invalidate(int id);
+    void invalidate(const TableChanges& changes);
+    void clear();
+
+    // True for statements that may update, delete or replace users rows:
+    // any UPDATE, DELETE, REPLACE, DROP or ALTER that names users anywhere,
+    // whatever the spacing, prefix (WITH ..., OR IGNORE) or upsert form.
+    // It errs towards yes ("UPDATE reports ... (SELECT id FROM users)"
+    // counts), which only costs a cache clear. What it cannot see are
+    // changes made under another name: triggers fired by writes to other
+    // tables, views, and the table reached through an ATTACH alias.
+    static bool changesUsers(const QString& statement);
+    // Clears the cache for such a statement unless it runs in a
+    // ServiceWrite scope; called by DatabaseManager::execWithRetry().
+    void noteStatement(const QString& statement);
+
+    Stats stats() const;
+
+ private:
+    enum class Queue { Recent, Frequent };
+
+    struct Entry {
+        User user;
+        qint64 filledMs = 0;
+        Queue queue = Queue::Recent;
+        std::list<int>::iterator position;
+    };
+
+    struct Shard {
+        mutable QMutex mutex;
+        QHash<int, Entry> entries;
+        std::list<int> recent;    // A1in: read once, newest first
+        std::list<int> frequent;  // Am: read again, most recently used first
+        std::list<int> ghosts;    // A1out: ids recently dropped from recent
+        QHash<int, std::list<int>::iterator> ghostIndex;
+    };
+
+    struct PhoneShard {
+        QMutex mutex;
+        QHash<QString, int> ids;
+    };
+
+    Shard m_shards[kShards];
+    PhoneShard m_phones[kShards];
+    std::atomic<int> m_capacity{10000};
+    std::atomic<int> m_maxAgeMs{5000};
+    std::atomic<quint64> m_version{0};  // bumped by every invalidation
+
+    UserCache() = default;
+
+    // (phone, id) of removed entries, unindexed once the shard lock is
+    // released: the two kinds of locks are never held together.
+    using Removed = QList<QPair<QString, int>>;
+
+    static int shardOf(int id);
+    static int phoneShardOf(const QString& phone);
+    // Row id if cached and fresh, and if phone is given, still that phone's.
+    // Expired rows are left in place for insert() to refill.
+    bool lookup(int id, const QString& phone, User* user);
+    // Evicts from shard down to its share of the capacity.
+    void reclaim(Shard& shard, Removed* removed);
+    void removeEntry(Shard& shard, QHash<int, Entry>::iterator it, Removed* removed);
+    void unindex(const Removed& removed);
+};
+#endif  // USERCACHE_H
@@ -0,0 +1,125 @@
+// Copyright 2025 MarketSystem
+#include "UserTable.h"
+#include <QtEndian>
+
+namespace {
+// Up to 18 digits always fit in a quint64 without overflow.
+const int kMaxPackedPhoneDigits = 18;
+}
+
+UserTable::UserTable() {
+    // Offset 0 is a zero-length entry so empty usernames cost nothing.
+    m_arena.append(2, '\0');
+}
+
+void UserTable::reserve(int rows, int arenaBytes) {
+    m_rows.reserve(rows);
+    if (arenaBytes > 0) {
+        m_arena.reserve(arenaBytes);
+    }
+}
+
+void UserTable::clear() {
+    m_rows.clear();
+    m_arena.resize(2);
+}
+
+bool UserTable::packPhone(const QString& phone, quint64* packed) {
+    // A leading zero would be lost by the integer form.
+    if (phone.isEmpty() || phone.size() > kMaxPackedPhoneDigits || phone[0] == QLatin1Char('0')) {
+        return false;
+    }
+
+    quint64 value = 0;
+    for (QChar c : phone) {
+        if (c < QLatin1Char('0') || c > QLatin1Char('9')) {
+            return false;
+        }
+        value = value * 10 + (c.unicode() - '0');
+    }
+    *packed = value;
+    return true;
+}
+
+quint32 UserTable::storeString(const QString& text) {
+    if (text.isEmpty()) {
+        return 0;
+    }
+
+    QByteArray utf8 = text.toUtf8();
+    quint16 length = static_cast<quint16>(qMin<qsizetype>(utf8.size(), 0xFFFF));
+    quint32 offset = static_cast<quint32>(m_arena.size());
+
+    char prefix[2];
+    qToLittleEndian(length, prefix);
+    m_arena.append(prefix, 2);
+    m_arena.append(utf8.constData(), length);
+    return offset;
+}
+
+QString UserTable::loadString(quint32 offset) const {
+    const char* entry = m_arena.constData() + offset;
+    quint16 length = qFromLittleEndian<quint16>(entry);
+    return QString::fromUtf8(entry + 2, length);
+}
+
+void UserTable::append(int id, const QString& phone, const QString& username,
+                       qint64 createdAtSecs, bool isAdmin, bool isBanned) {
+    CompactUser record;
+    record.id = id;
+    record.username = storeString(username);
+    record.createdAt = static_cast<quint32>(qMax<qint64>(createdAtSecs, 0));
+    record.flags = 0;
+    if (isAdmin) {
+        record.flags |= CompactUser::Admin;
+    }
+    if (isBanned) {
+        record.flags |= CompactUser::Banned;
+    }
+
+    if (!packPhone(phone, &record.phone)) {
+        record.phone = storeString(phone);
+        record.flags |= CompactUser::PhoneInArena;
+    }
+
+    m_rows.push_back(record);
+}
+
+void UserTable::append(const User& user) {
+    append(user.getId(), user.getPhone(), user.getUsername(),
+           user.getCreatedAt().isValid() ? user.getCreatedAt().toSecsSinceEpoch() : 0,
+           user.isAdmin(), user.isBanned());
+}
+
+QString UserTable::phone(int row) const {
+    const CompactUser& record = m_rows[row];
+    if (record.flags & CompactUser::PhoneInArena) {
+        return loadString(static_cast<quint32>(record.phone));
+    }
+    return QString::number(record.phone);
+}
+
+QString UserTable::username(int row) const {
+    return loadString(m_rows[row].username);
+}
+
+QDateTime UserTable::createdAt(int row) const {
+    return QDateTime::fromSecsSinceEpoch(m_rows[row].createdAt, Qt::UTC);
+}
+
+void UserTable::setBanned(int row, bool banned) {
+    if (banned) {
+        m_rows[row].flags |= CompactUser::Banned;
+    } else {
+        m_rows[row].flags &= ~CompactUser::Banned;
+    }
+}
+
+User UserTable::at(int row) const {
+    return User(id(row), phone(row), "", username(row), createdAt(row),
+                isAdmin(row), isBanned(row));
+}
+
+qsizetype UserTable::memoryBytes() const {
+    return static_cast<qsizetype>(m_rows.capacity() * sizeof(CompactUser)) + m_arena.capacity();
+}
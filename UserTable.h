@@ -0,0 +1,71 @@
+// Copyright 2025 MarketSystem
+#ifndef USERTABLE_H
+#define USERTABLE_H
+
+#include <QString>
+#include <QByteArray>
+#include <QDateTime>
+#include <vector>
+#include "User.h"
+
+// Packed per-user record, 24 bytes. Strings live in the owning UserTable's
+// arena; phones made only of digits are stored as an integer instead.
+struct CompactUser {
+    enum Flag : quint8 {
+        Admin = 0x01,
+        Banned = 0x02,
+        PhoneInArena = 0x04  // phone is not a plain number, m_phone is an arena offset
+    };
+
+    quint64 phone;
+    qint32 id;
+    quint32 username;   // arena offset, 0 is the empty string
+    quint32 createdAt;  // seconds since epoch (UTC)
+    quint8 flags;
+};
+
+// Column of CompactUser records plus the arena backing their strings.
+// Move-only so listings are handed over without copying millions of rows;
+// at() materializes the regular User API for a single row.
+class UserTable {
+ public:
+    UserTable();
+    UserTable(UserTable&&) noexcept = default;
+    UserTable& operator=(UserTable&&) noexcept = default;
+    UserTable(const UserTable&) = delete;
+    UserTable& operator=(const UserTable&) = delete;
+
+    void reserve(int rows, int arenaBytes = 0);
+    void clear();
+    void append(int id, const QString& phone, const QString& username,
+                qint64 createdAtSecs, bool isAdmin, bool isBanned);
+    void append(const User& user);
+
+    int size() const { return static_cast<int>(m_rows.size()); }
+    bool isEmpty() const { return m_rows.empty(); }
+    const CompactUser& record(int row) const { return m_rows[row]; }
+
+    int id(int row) const { return m_rows[row].id; }
+    QString phone(int row) const;
+    QString username(int row) const;
+    qint64 createdAtSecs(int row) const { return m_rows[row].createdAt; }
+    QDateTime createdAt(int row) const;
+    bool isAdmin(int row) const { return m_rows[row].flags & CompactUser::Admin; }
+    bool isBanned(int row) const { return m_rows[row].flags & CompactUser::Banned; }
+    void setBanned(int row, bool banned);
+
+    User at(int row) const;
+
+    // Heap bytes owned by the table (records plus string arena).
+    qsizetype memoryBytes() const;
+
+    static bool packPhone(const QString& phone, quint64* packed);
+
+ private:
+    std::vector<CompactUser> m_rows;
+    QByteArray m_arena;
+
+    quint32 storeString(const QString& text);
+    QString loadString(quint32 offset) const;
+};
+#endif  // USERTABLE_H
@@ -0,0 +1,310 @@
+// Copyright 2025 MarketSystem
+#include "UserTableModel.h"
+#include "ChangeNotifier.h"
+#include <QColor>
+#include <QCoreApplication>
+#include <QDebug>
+#include <QPointer>
+#include <QThreadPool>
+#include <memory>
+#include <utility>
+
+UserTableModel::UserTableModel(QObject* parent)
+    : QAbstractTableModel(parent), m_cache(kCachedPages) {
+    connect(&ChangeNotifier::getInstance(), &ChangeNotifier::userChanged,
+            this, &UserTableModel::applyUserChange);
+}
+
+void UserTableModel::setBannedOnly(bool bannedOnly) {
+    m_bannedOnly = bannedOnly;
+    m_searchText.clear();
+    reload();
+}
+
+void UserTableModel::setSearchText(const QString& text) {
+    m_searchText = text.trimmed();
+    reload();
+}
+
+void UserTableModel::showSearchResults(const QString& text, UserListResult&& firstPage) {
+    m_searchText = text.trimmed();
+    reload();
+    if (!firstPage.ok) {
+        m_atEnd = true;
+        return;
+    }
+    appendPage(std::move(firstPage));
+}
+
+UserListResult UserTableModel::fetchPage(const QString& searchText, bool bannedOnly, const ListCursor& after) {
+    if (!searchText.isEmpty()) {
+        return AdminService::searchUsers(searchText, after, kPageSize, bannedOnly);
+    }
+    return AdminService::listUsersAfter(after, kPageSize, bannedOnly);
+}
+
+UserListResult UserTableModel::fetchPage(const ListCursor& after) const {
+    return fetchPage(m_searchText, m_bannedOnly, after);
+}
+
+void UserTableModel::reload() {
+    beginResetModel();
+    invalidatePrefetch();
+    m_atEnd = false;
+    m_rowCount = 0;
+    m_nextCursor = ListCursor();
+    m_pageStarts.clear();
+    m_cache.clear();
+    endResetModel();
+}
+
+int UserTableModel::rowCount(const QModelIndex& parent) const {
+    return parent.isValid() ? 0 : m_rowCount;
+}
+
+int UserTableModel::columnCount(const QModelIndex& parent) const {
+    return parent.isValid() ? 0 : ColumnCount;
+}
+
+bool UserTableModel::canFetchMore(const QModelIndex& parent) const {
+    return !parent.isValid() && !m_atEnd;
+}
+
+void UserTableModel::fetchMore(const QModelIndex& parent) {
+    if (parent.isValid() || m_atEnd) {
+        return;
+    }
+
+    if (m_prefetchedNext) {
+        UserListResult listing = std::move(*m_prefetchedNext);
+        m_prefetchedNext.reset();
+        appendPage(std::move(listing));
+        return;
+    }
+
+    UserListResult listing = fetchPage(m_nextCursor);
+    if (!listing.ok) {
+        qWarning() << "UserTableModel: failed to fetch page" << m_pageStarts.size();
+        m_atEnd = true;
+        return;
+    }
+    appendPage(std::move(listing));
+}
+
+void UserTableModel::appendPage(UserListResult&& listing) {
+    int count = listing.users.size();
+    if (count < kPageSize) {
+        m_atEnd = true;
+    }
+    if (count == 0) {
+        return;
+    }
+
+    beginInsertRows(QModelIndex(), m_rowCount, m_rowCount + count - 1);
+    int pageIndex = static_cast<int>(m_pageStarts.size());
+    m_pageStarts.push_back(m_nextCursor);
+    m_nextCursor = listing.next;
+    m_cache.insert(pageIndex, std::move(listing.users));
+    m_rowCount += count;
+    endInsertRows();
+}
+
+const UserTable* UserTableModel::pageForRow(int row, int* offset) const {
+    int pageIndex = row / kPageSize;
+    *offset = row % kPageSize;
+    if (row < 0 || pageIndex >= static_cast<int>(m_pageStarts.size())) {
+        return nullptr;
+    }
+
+    if (UserTable* page = m_cache.find(pageIndex)) {
+        return page;
+    }
+
+    UserListResult listing = fetchPage(m_pageStarts[pageIndex]);
+    if (!listing.ok) {
+        return nullptr;
+    }
+    return m_cache.insert(pageIndex, std::move(listing.users));
+}
+
+void UserTableModel::invalidatePrefetch() {
+    ++m_generation;
+    m_prefetching.clear();
+    m_prefetchedNext.reset();
+}
+
+void UserTableModel::prefetchAround(int row) {
+    if (row < 0 || row >= m_rowCount) {
+        return;
+    }
+    int pageIndex = row / kPageSize;
+    if (pageIndex > 0) {
+        prefetchPage(pageIndex - 1);
+    }
+    prefetchPage(pageIndex + 1);
+}
+
+void UserTableModel::prefetchPage(int pageIndex) {
+    int loadedPages = static_cast<int>(m_pageStarts.size());
+    if (pageIndex > loadedPages || m_prefetching.contains(pageIndex)) {
+        return;
+    }
+    if (pageIndex == loadedPages ? (m_atEnd || m_prefetchedNext) : m_cache.find(pageIndex) != nullptr) {
+        return;
+    }
+
+    ListCursor after = pageIndex == loadedPages ? m_nextCursor : m_pageStarts[pageIndex];
+    int generation = m_generation;
+    QString searchText = m_searchText;
+    bool bannedOnly = m_bannedOnly;
+    m_prefetching.insert(pageIndex);
+
+    QPointer<UserTableModel> self(this);
+    QThreadPool::globalInstance()->start([self, generation, pageIndex, after, searchText, bannedOnly]() {
+        auto listing = std::make_shared<UserListResult>(fetchPage(searchText, bannedOnly, after));
+        QMetaObject::invokeMethod(qApp, [self, generation, pageIndex, listing]() {
+            if (self) {
+                self->storePrefetched(generation, pageIndex, std::move(*listing));
+            }
+        }, Qt::QueuedConnection);
+    });
+}
+
+void UserTableModel::storePrefetched(int generation, int pageIndex, UserListResult&& listing) {
+    if (generation != m_generation) {
+        return;
+    }
+    m_prefetching.remove(pageIndex);
+    if (!listing.ok) {
+        return;  // the page is read again on demand and reports its own error
+    }
+
+    int loadedPages = static_cast<int>(m_pageStarts.size());
+    if (pageIndex == loadedPages) {
+        if (!m_atEnd) {
+            m_prefetchedNext = std::move(listing);
+        }
+    } else if (pageIndex < loadedPages && !m_cache.find(pageIndex)) {
+        // Possibly fetchMore() read the next page itself in the meantime;
+        // the prefetched copy then just lands in the cache
+        m_cache.insert(pageIndex, std::move(listing.users));
+    }
+}
+
+void UserTableModel::refreshRows(const TableChanges& changes) {
+    if (changes.isEmpty()) {
+        return;
+    }
+    invalidatePrefetch();
+
+    std::vector<int> stale;
+    m_cache.visit([&](int pageIndex, UserTable& page) {
+        for (int offset = 0; offset < page.size(); ++offset) {
+            if (changes.touches(page.id(offset))) {
+                stale.push_back(pageIndex);
+                break;
+            }
+        }
+        return false;
+    });
+
+    for (int pageIndex : stale) {
+        m_cache.remove(pageIndex);
+        int first = pageIndex * kPageSize;
+        int last = qMin(first + kPageSize, m_rowCount) - 1;
+        emit dataChanged(index(first, 0), index(last, ColumnCount - 1));
+    }
+}
+
+void UserTableModel::applyUserChange(const User& user) {
+    // Anything being read ahead may predate this change
+    invalidatePrefetch();
+
+    // Only cached pages need patching; an evicted page is re-read with the
+    // new values anyway. At most kCachedPages * kPageSize rows are scanned.
+    int changedRow = -1;
+    m_cache.visit([&](int pageIndex, UserTable& page) {
+        for (int offset = 0; offset < page.size(); ++offset) {
+            if (page.id(offset) == user.getId()) {
+                // Still listed under the banned-only filter until the next reload
+                page.setBanned(offset, user.isBanned());
+                changedRow = pageIndex * kPageSize + offset;
+                return true;
+            }
+        }
+        return false;
+    });
+
+    if (changedRow >= 0) {
+        emit dataChanged(index(changedRow, 0), index(changedRow, ColumnCount - 1));
+    }
+}
+
+int UserTableModel::userId(int row) const {
+    int offset = 0;
+    const UserTable* page = pageForRow(row, &offset);
+    return page && offset < page->size() ? page->id(offset) : -1;
+}
+
+bool UserTableModel::isBanned(int row) const {
+    int offset = 0;
+    const UserTable* page = pageForRow(row, &offset);
+    return page && offset < page->size() && page->isBanned(offset);
+}
+
+QVariant UserTableModel::data(const QModelIndex& index, int role) const {
+    if (!index.isValid()) {
+        return QVariant();
+    }
+
+    int offset = 0;
+    const UserTable* page = pageForRow(index.row(), &offset);
+    // A re-read page can come back shorter if rows left the listing meanwhile
+    if (!page || offset >= page->size()) {
+        return QVariant();
+    }
+
+    if (role == Qt::DisplayRole) {
+        switch (index.column()) {
+        case IdColumn:
+            return page->id(offset);
+        case PhoneColumn:
+            return page->phone(offset);
+        case UsernameColumn:
+            return page->username(offset);
+        case CreatedColumn:
+            return page->createdAt(offset).toString("yyyy-MM-dd hh:mm:ss");
+        case StatusColumn:
+            return page->isBanned(offset) ? QString("Banned") : QString("Active");
+        default:
+            return QVariant();
+        }
+    }
+
+    if (role == Qt::BackgroundRole && index.column() == StatusColumn) {
+        return page->isBanned(offset) ? QColor(255, 150, 150) : QColor(200, 255, 200);
+    }
+
+    return QVariant();
+}
+
+QVariant UserTableModel::headerData(int section, Qt::Orientation orientation, int role) const {
+    if (role != Qt::DisplayRole || orientation != Qt::Horizontal) {
+        return QAbstractTableModel::headerData(section, orientation, role);
+    }
+
+    switch (section) {
+    case IdColumn:
+        return QString("ID");
+    case PhoneColumn:
+        return QString("Phone");
+    case UsernameColumn:
+        return QString("Username");
+    case CreatedColumn:
+        return QString("Created");
+    case StatusColumn:
+        return QString("Status");
+    default:
+        return QVariant();
+    }
+}
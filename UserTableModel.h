@@ -0,0 +1,102 @@
+// Copyright 2025 MarketSystem
+#ifndef USERTABLEMODEL_H
+#define USERTABLEMODEL_H
+
+#include <QAbstractTableModel>
+#include <QSet>
+#include <optional>
+#include <vector>
+#include "AdminService.h"
+#include "ChangeFeed.h"
+#include "PageCache.h"
+#include "UserTable.h"
+
+// Users listing for the admin window. Rows are fetched in keyset pages as
+// the view scrolls (canFetchMore/fetchMore); only the cursor in front of
+// each page is kept for good, the pages themselves live in a small LRU and
+// are re-read on demand. Cell values are produced in data() from the
+// compact UserTable rows. Pages next to the one in view can be read ahead on
+// the thread pool with prefetchAround().
+class UserTableModel : public QAbstractTableModel {
+    Q_OBJECT
+
+ public:
+    enum Column { IdColumn, PhoneColumn, UsernameColumn, CreatedColumn, StatusColumn, ColumnCount };
+
+    static const int kPageSize = 256;
+    static const int kCachedPages = 16;
+
+    explicit UserTableModel(QObject* parent = nullptr);
+
+    // Switches between all users and banned users only; reloads and ends
+    // any search.
+    void setBannedOnly(bool bannedOnly);
+    bool bannedOnly() const { return m_bannedOnly; }
+
+    // Lists AdminService::searchUsers() matches instead, best first; an
+    // empty text goes back to the plain listing. showSearchResults() takes a
+    // first page that was already fetched (e.g. on a worker thread) with
+    // searchUsers(text, ListCursor(), kPageSize, bannedOnly()).
+    void setSearchText(const QString& text);
+    void showSearchResults(const QString& text, UserListResult&& firstPage);
+    QString searchText() const { return m_searchText; }
+
+    // Drops everything fetched so far and starts again from the top.
+    void reload();
+
+    // Row accessors for the window; -1 / false when the row is unavailable.
+    int userId(int row) const;
+    bool isBanned(int row) const;
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+    bool canFetchMore(const QModelIndex& parent) const override;
+    void fetchMore(const QModelIndex& parent) override;
+
+    // Reads the pages before and after row's page in the background unless
+    // cached; past the last fetched page that is the next keyset page, which
+    // the following fetchMore() then takes without a query. Results that
+    // arrive after a reload or a user change are dropped.
+    void prefetchAround(int row);
+    bool hasPrefetchedNext() const { return m_prefetchedNext.has_value(); }
+
+    int cachedPageCount() const { return m_cache.size(); }
+
+ public slots:
+    // Patches a changed user in place if its row is loaded; no reload, so
+    // selection and scroll position stay put.
+    void applyUserChange(const User& user);
+
+    // Drops every cached page holding a row in changes (ChangeFeed), so the
+    // view re-reads just those pages. New users are not inserted; being
+    // newest first they would go above the rows on display until reload().
+    void refreshRows(const TableChanges& changes);
+
+ private:
+    bool m_bannedOnly = false;
+    QString m_searchText;
+    bool m_atEnd = false;
+    int m_rowCount = 0;
+    ListCursor m_nextCursor;              // after the last fetched row
+    std::vector<ListCursor> m_pageStarts; // cursor in front of page i
+    mutable PageCache<UserTable> m_cache;
+
+    // Read-ahead state. m_generation is bumped whenever fetched rows may be
+    // out of date; a prefetch started under an older one is discarded.
+    int m_generation = 0;
+    QSet<int> m_prefetching;                       // page indexes in flight
+    std::optional<UserListResult> m_prefetchedNext; // page m_pageStarts.size()
+
+    static UserListResult fetchPage(const QString& searchText, bool bannedOnly, const ListCursor& after);
+    UserListResult fetchPage(const ListCursor& after) const;
+    void appendPage(UserListResult&& listing);
+    void invalidatePrefetch();
+    void prefetchPage(int pageIndex);
+    void storePrefetched(int generation, int pageIndex, UserListResult&& listing);
+
+    // Page holding row, re-read from its cursor if evicted; nullptr on error.
+    const UserTable* pageForRow(int row, int* offset) const;
+};
+#endif  // USERTABLEMODEL_H
@@ -0,0 +1,84 @@
+// Copyright 2025 MarketSystem
+#include "ApiToken.h"
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QRandomGenerator>
+#include <QStandardPaths>
+#include <QThread>
+
+namespace ApiToken {
+
+namespace {
+const int kTokenBytes = 32;
+// How long a daemon that lost the creation race waits for the winner to
+// finish writing the token
+const int kCreatorWriteWaitMs = 100;
+
+QByteArray loadExisting(const QString& path, QString* error) {
+    for (int attempt = 0; attempt < 2; ++attempt) {
+        QFile file(path);
+        if (!file.open(QIODevice::ReadOnly)) {
+            *error = "Cannot read token file " + path + ": " + file.errorString();
+            return QByteArray();
+        }
+        QByteArray token = file.readAll().trimmed();
+        if (token.size() >= kTokenBytes) {
+            return token;
+        }
+        // A concurrent creator may have made the file but not written it yet
+        if (attempt == 0) {
+            QThread::msleep(kCreatorWriteWaitMs);
+        }
+    }
+    *error = "Token file " + path + " is too short";
+    return QByteArray();
+}
+}  // namespace
+
+QString defaultPath() {
+    return QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/daemon.token";
+}
+
+QByteArray loadOrCreate(const QString& path, QString* error) {
+    QFile file(path);
+    if (file.exists()) {
+        return loadExisting(path, error);
+    }
+
+    QDir().mkpath(QFileInfo(path).absolutePath());
+    // NewOnly: two daemons starting together must not overwrite each
+    // other's token after one of them has handed it out
+    if (!file.open(QIODevice::WriteOnly | QIODevice::NewOnly)) {
+        if (file.exists()) {
+            return loadExisting(path, error);
+        }
+        *error = "Cannot create token file " + path + ": " + file.errorString();
+        return QByteArray();
+    }
+    // Restrict before the secret is written, not after
+    file.setPermissions(QFileDevice::ReadOwner | QFileDevice::WriteOwner);
+
+    quint32 words[kTokenBytes / 4];
+    QRandomGenerator::system()->fillRange(words);
+    QByteArray token = QByteArray(reinterpret_cast<const char*>(words), sizeof(words)).toHex();
+    if (file.write(token + '\n') != token.size() + 1 || !file.flush()) {
+        *error = "Cannot write token file " + path + ": " + file.errorString();
+        file.remove();
+        return QByteArray();
+    }
+    return token;
+}
+
+bool matches(const QByteArray& expected, const QByteArray& presented) {
+    if (expected.isEmpty() || expected.size() != presented.size()) {
+        return false;
+    }
+    unsigned char difference = 0;
+    for (qsizetype i = 0; i < expected.size(); ++i) {
+        difference |= static_cast<unsigned char>(expected[i] ^ presented[i]);
+    }
+    return difference == 0;
+}
+
+}  // namespace ApiToken
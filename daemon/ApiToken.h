@@ -0,0 +1,29 @@
+// Copyright 2025 MarketSystem
+#ifndef APITOKEN_H
+#define APITOKEN_H
+
+#include <QByteArray>
+#include <QString>
+
+// Per-install secret that local clients present before the daemon lets them
+// moderate users: the Authenticate request on the local socket, and
+// "Authorization: Bearer <token>" on the HTTP API. The token lives in a file
+// only the owner can read, so it proves the caller runs as the account that
+// owns the database rather than as some other process (or web page) that can
+// merely reach the socket or port.
+namespace ApiToken {
+
+// <AppDataLocation>/daemon.token
+QString defaultPath();
+
+// Reads the token at path, creating it with a fresh random value (owner
+// read/write only) on first use. Returns an empty token and sets *error on
+// failure.
+QByteArray loadOrCreate(const QString& path, QString* error);
+
+// Compares in time independent of where the inputs first differ.
+bool matches(const QByteArray& expected, const QByteArray& presented);
+
+}  // namespace ApiToken
+
+#endif  // APITOKEN_H
@@ -0,0 +1,401 @@
+// Copyright 2025 MarketSystem
+#include "HttpApiServer.h"
+#include <QHostAddress>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QUrlQuery>
+#include <QDebug>
+#include <limits>
+#include "ApiToken.h"
+#include "JsonWriter.h"
+#include "AuthService.h"
+#include "AdminService.h"
+
+namespace {
+
+const char* reasonPhrase(int status) {
+    switch (status) {
+    case 200: return "OK";
+    case 400: return "Bad Request";
+    case 401: return "Unauthorized";
+    case 403: return "Forbidden";
+    case 404: return "Not Found";
+    case 409: return "Conflict";
+    case 413: return "Payload Too Large";
+    case 415: return "Unsupported Media Type";
+    case 503: return "Service Unavailable";
+    default: return "Internal Server Error";
+    }
+}
+
+HttpApiServer::Response message(int status, bool ok, const QString& text) {
+    HttpApiServer::Response response;
+    response.status = status;
+    JsonWriter json(response.body);
+    json.beginObject().key("ok").value(ok).key("message").value(text).endObject();
+    return response;
+}
+
+void writeUser(JsonWriter& json, const User& user) {
+    json.beginObject()
+        .key("id").value(user.getId())
+        .key("phone").value(user.getPhone())
+        .key("username").value(user.getUsername())
+        .key("createdAt").value(user.getCreatedAt().isValid() ? user.getCreatedAt().toSecsSinceEpoch() : 0)
+        .key("isAdmin").value(user.isAdmin())
+        .key("isBanned").value(user.isBanned())
+        .endObject();
+}
+
+HttpApiServer::Response userResponse(const QPair<bool, User>& result, int failureStatus,
+                                     const QString& failure) {
+    if (!result.first) {
+        return message(failureStatus, false, failure);
+    }
+    HttpApiServer::Response response;
+    JsonWriter json(response.body);
+    json.beginObject().key("ok").value(true).key("user");
+    writeUser(json, result.second);
+    json.endObject();
+    return response;
+}
+
+HttpApiServer::Response listingResponse(const UserListResult& listing) {
+    if (!listing.ok) {
+        return message(500, false, "Failed to load users");
+    }
+
+    HttpApiServer::Response response;
+    // Rows are small and fixed-shape; reserving up front avoids regrowth.
+    response.body.reserve(32 + listing.users.size() * 112);
+    JsonWriter json(response.body);
+    json.beginObject().key("ok").value(true).key("users").beginArray();
+    for (int row = 0; row < listing.users.size(); ++row) {
+        json.beginObject()
+            .key("id").value(listing.users.id(row))
+            .key("phone").value(listing.users.phone(row))
+            .key("username").value(listing.users.username(row))
+            .key("createdAt").value(listing.users.createdAtSecs(row))
+            .key("isAdmin").value(listing.users.isAdmin(row))
+            .key("isBanned").value(listing.users.isBanned(row))
+            .endObject();
+    }
+    json.endArray().endObject();
+    return response;
+}
+
+bool pageArguments(const QByteArray& query, int* page, int* pageSize) {
+    QUrlQuery params(QString::fromUtf8(query));
+    bool pageOk = true;
+    bool sizeOk = true;
+    *page = params.hasQueryItem("page") ? params.queryItemValue("page").toInt(&pageOk) : 0;
+    *pageSize = params.hasQueryItem("pageSize") ? params.queryItemValue("pageSize").toInt(&sizeOk) : 10;
+    // The listing's row offset, page * pageSize, must fit an int
+    return pageOk && sizeOk && *page >= 0 && *pageSize > 0 && *pageSize <= 10000 &&
+           *page <= std::numeric_limits<int>::max() / *pageSize;
+}
+
+bool isLoopbackHost(const QByteArray& host, quint16 port) {
+    QByteArray suffix = ':' + QByteArray::number(port);
+    return host == "127.0.0.1" + suffix || host.toLower() == "localhost" + suffix;
+}
+
+// Media type without parameters, lower case
+QByteArray mediaType(const QByteArray& contentType) {
+    int semicolon = contentType.indexOf(';');
+    return (semicolon < 0 ? contentType : contentType.left(semicolon)).trimmed().toLower();
+}
+
+}  // namespace
+
+HttpApiServer::HttpApiServer(int workerCount, int maxQueued, const QByteArray& token, QObject* parent)
+    : QObject(parent), m_server(new QTcpServer(this)), m_token(token), m_maxQueued(maxQueued),
+      m_queued(0), m_nextConnectionId(1) {
+    m_pool.setMaxThreadCount(workerCount);
+    m_pool.setExpiryTimeout(-1);
+    connect(m_server, &QTcpServer::newConnection, this, &HttpApiServer::onNewConnection);
+}
+
+HttpApiServer::~HttpApiServer() {
+    m_server->close();
+    m_pool.waitForDone();
+}
+
+bool HttpApiServer::listen(quint16 port) {
+    return m_server->listen(QHostAddress::LocalHost, port);
+}
+
+quint16 HttpApiServer::serverPort() const {
+    return m_server->serverPort();
+}
+
+QString HttpApiServer::errorString() const {
+    return m_server->errorString();
+}
+
+void HttpApiServer::onNewConnection() {
+    while (QTcpSocket* socket = m_server->nextPendingConnection()) {
+        quint64 connectionId = m_nextConnectionId++;
+        Connection& connection = m_connections[connectionId];
+        connection.socket = socket;
+        // Bounds what Qt reads ahead while a request runs; the rest waits in
+        // the kernel and the client's window closes
+        socket->setReadBufferSize(kMaxHeaderBytes + kMaxRequestBytes);
+        connection.idleTimer = new QTimer(socket);
+        connection.idleTimer->setSingleShot(true);
+        connection.idleTimer->start(kIdleTimeoutMs);
+
+        connect(connection.idleTimer, &QTimer::timeout, this, [this, connectionId]() {
+            auto it = m_connections.find(connectionId);
+            if (it != m_connections.end() && !it->busy) {
+                it->socket->disconnectFromHost();
+            }
+        });
+        connect(socket, &QTcpSocket::readyRead, this, [this, connectionId]() {
+            auto it = m_connections.find(connectionId);
+            if (it == m_connections.end()) {
+                return;
+            }
+            it->idleTimer->start(kIdleTimeoutMs);
+            if (it->busy) {
+                return;  // picked up by sendResponse()
+            }
+            readSocket(connectionId);
+            processBuffer(connectionId);
+        });
+        connect(socket, &QTcpSocket::disconnected, this, [this, connectionId]() {
+            dropConnection(connectionId);
+        });
+    }
+}
+
+void HttpApiServer::dropConnection(quint64 connectionId) {
+    auto it = m_connections.find(connectionId);
+    if (it != m_connections.end()) {
+        it->socket->deleteLater();
+        m_connections.erase(it);
+    }
+}
+
+void HttpApiServer::readSocket(quint64 connectionId) {
+    auto it = m_connections.find(connectionId);
+    if (it != m_connections.end()) {
+        it->buffer.append(it->socket->readAll());
+    }
+}
+
+void HttpApiServer::processBuffer(quint64 connectionId) {
+    auto it = m_connections.find(connectionId);
+    if (it == m_connections.end() || it->busy) {
+        return;  // one request at a time keeps responses in order
+    }
+    Connection& connection = *it;
+
+    int headerEnd = connection.buffer.indexOf("\r\n\r\n");
+    if (headerEnd < 0 || headerEnd > kMaxHeaderBytes) {
+        if (connection.buffer.size() > kMaxHeaderBytes) {
+            connection.closeAfterResponse = true;
+            sendResponse(connectionId, message(413, false, "Request headers too large"));
+        }
+        return;
+    }
+
+    QList<QByteArray> lines = connection.buffer.left(headerEnd).split('\n');
+    QList<QByteArray> requestLine = lines.value(0).trimmed().split(' ');
+    if (requestLine.size() != 3) {
+        connection.closeAfterResponse = true;
+        sendResponse(connectionId, message(400, false, "Malformed request line"));
+        return;
+    }
+
+    Request request;
+    request.method = requestLine[0];
+    QByteArray target = requestLine[1];
+    int queryStart = target.indexOf('?');
+    request.path = queryStart < 0 ? target : target.left(queryStart);
+    request.query = queryStart < 0 ? QByteArray() : target.mid(queryStart + 1);
+    request.keepAlive = requestLine[2] == "HTTP/1.1";
+
+    qsizetype contentLength = 0;
+    for (int i = 1; i < lines.size(); ++i) {
+        QByteArray line = lines[i].trimmed();
+        int colon = line.indexOf(':');
+        if (colon <= 0) {
+            continue;
+        }
+        QByteArray name = line.left(colon).trimmed().toLower();
+        QByteArray value = line.mid(colon + 1).trimmed();
+        if (name == "content-length") {
+            contentLength = value.toLongLong();
+        } else if (name == "host") {
+            request.host = value;
+        } else if (name == "origin") {
+            request.origin = value;
+            request.hasOrigin = true;
+        } else if (name == "content-type") {
+            request.contentType = value;
+        } else if (name == "authorization") {
+            request.authorization = value;
+        } else if (name == "connection") {
+            request.keepAlive = value.toLower() != "close";
+        }
+    }
+
+    if (contentLength < 0 || contentLength > kMaxRequestBytes) {
+        connection.closeAfterResponse = true;
+        sendResponse(connectionId, message(413, false, "Request body too large"));
+        return;
+    }
+
+    qsizetype total = headerEnd + 4 + contentLength;
+    if (connection.buffer.size() < total) {
+        return;  // wait for the rest of the body
+    }
+    request.body = connection.buffer.mid(headerEnd + 4, contentLength);
+    connection.buffer.remove(0, total);
+    connection.closeAfterResponse = !request.keepAlive;
+
+    // Backpressure: shed load instead of growing an unbounded queue.
+    if (m_queued.load() >= m_maxQueued) {
+        Response busy = message(503, false, "Server busy");
+        sendResponse(connectionId, busy);
+        return;
+    }
+
+    connection.busy = true;
+    ++m_queued;
+    QByteArray token = m_token;
+    quint16 port = m_server->serverPort();
+    m_pool.start([this, connectionId, request, token, port]() {
+        Response response = handle(request, token, port);
+        --m_queued;
+        QMetaObject::invokeMethod(this, [this, connectionId, response]() {
+            sendResponse(connectionId, response);
+        }, Qt::QueuedConnection);
+    });
+}
+
+void HttpApiServer::sendResponse(quint64 connectionId, const Response& response) {
+    auto it = m_connections.find(connectionId);
+    if (it == m_connections.end()) {
+        return;
+    }
+    Connection& connection = *it;
+
+    QByteArray header;
+    header.reserve(160);
+    header.append("HTTP/1.1 ").append(QByteArray::number(response.status)).append(' ')
+          .append(reasonPhrase(response.status))
+          .append("\r\nContent-Type: application/json\r\nContent-Length: ")
+          .append(QByteArray::number(response.body.size()));
+    if (response.status == 503) {
+        header.append("\r\nRetry-After: 1");
+    }
+    header.append(connection.closeAfterResponse ? "\r\nConnection: close\r\n\r\n"
+                                                : "\r\nConnection: keep-alive\r\n\r\n");
+
+    connection.socket->write(header);
+    connection.socket->write(response.body);
+    connection.busy = false;
+
+    if (connection.closeAfterResponse) {
+        connection.socket->disconnectFromHost();
+        return;
+    }
+
+    // Pipelined requests may already be buffered, or held back in the socket.
+    // Picked up from the event loop: requests answered on the spot (503)
+    // would otherwise nest one sendResponse() per pipelined request.
+    QMetaObject::invokeMethod(this, [this, connectionId]() {
+        readSocket(connectionId);
+        processBuffer(connectionId);
+    }, Qt::QueuedConnection);
+}
+
+HttpApiServer::Response HttpApiServer::handle(const Request& request, const QByteArray& token, quint16 port) {
+    // Browsers always send Origin on cross-origin requests, and a rebound
+    // DNS name still shows up in Host
+    if (!isLoopbackHost(request.host, port)) {
+        return message(403, false, "Host must be 127.0.0.1 or localhost with the port");
+    }
+    if (request.hasOrigin) {
+        return message(403, false, "Cross-origin requests are not accepted");
+    }
+
+    bool isPing = request.method == "GET" && request.path == "/ping";
+    QByteArray presented = request.authorization.startsWith("Bearer ")
+                               ? request.authorization.mid(7).trimmed() : QByteArray();
+    if (!isPing && !ApiToken::matches(token, presented)) {
+        return message(401, false, "Missing or invalid bearer token");
+    }
+    if (request.method == "POST" && mediaType(request.contentType) != "application/json") {
+        return message(415, false, "POST bodies must be application/json");
+    }
+
+    QJsonObject body;
+    if (!request.body.isEmpty()) {
+        QJsonParseError error;
+        QJsonDocument document = QJsonDocument::fromJson(request.body, &error);
+        if (error.error != QJsonParseError::NoError || !document.isObject()) {
+            return message(400, false, "Request body must be a JSON object");
+        }
+        body = document.object();
+    }
+
+    const QByteArray& path = request.path;
+    bool isGet = request.method == "GET";
+    bool isPost = request.method == "POST";
+
+    if (isPing) {
+        return message(200, true, "pong");
+    }
+
+    if (isPost && path == "/login") {
+        return userResponse(AuthService::loginUser(body.value("phone").toString(),
+                                                   body.value("password").toString()),
+                            401, "Invalid phone number or password");
+    }
+
+    if (isPost && path == "/register") {
+        QString phone = body.value("phone").toString();
+        QString password = body.value("password").toString();
+        QString username = body.value("username").toString();
+        QPair<bool, QString> validation = AuthService::validateUserInput(phone, password, username);
+        if (!validation.first) {
+            return message(400, false, validation.second);
+        }
+        return userResponse(AuthService::registerUser(phone, password, username),
+                            409, "Phone number may already be registered");
+    }
+
+    if (isGet && (path == "/users" || path == "/users/banned")) {
+        int page = 0;
+        int pageSize = 0;
+        if (!pageArguments(request.query, &page, &pageSize)) {
+            return message(400, false, "Invalid page arguments");
+        }
+        return listingResponse(path == "/users" ? AdminService::listUsers(page, pageSize)
+                                                : AdminService::listBannedUsers(page, pageSize));
+    }
+
+    // POST /users/<id>/ban and /users/<id>/unban
+    QList<QByteArray> segments = path.split('/');
+    if (isPost && segments.size() == 4 && segments[1] == "users") {
+        bool idOk = false;
+        int userId = segments[2].toInt(&idOk);
+        if (!idOk) {
+            return message(400, false, "Invalid user id");
+        }
+        QPair<bool, QString> result;
+        if (segments[3] == "ban") {
+            result = AdminService::banUser(userId, body.value("reason").toString());
+        } else if (segments[3] == "unban") {
+            result = AdminService::unbanUser(userId);
+        } else {
+            return message(404, false, "Not found");
+        }
+        return message(result.first ? 200 : 409, result.first, result.second);
+    }
+
+    return message(404, false, "Not found");
+}
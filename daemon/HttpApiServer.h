@@ -0,0 +1,100 @@
+// Copyright 2025 MarketSystem
+#ifndef HTTPAPISERVER_H
+#define HTTPAPISERVER_H
+
+#include <QObject>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QThreadPool>
+#include <QTimer>
+#include <QHash>
+#include <QByteArray>
+#include <atomic>
+
+// HTTP/1.1 + JSON front end for the same operations as ServiceProtocol,
+// bound to 127.0.0.1 only.
+//
+//   GET  /ping
+//   POST /login              {"phone", "password"}
+//   POST /register           {"phone", "password", "username"}
+//   POST /users/<id>/ban     {"reason"}
+//   POST /users/<id>/unban
+//   GET  /users?page=&pageSize=
+//   GET  /users/banned?page=&pageSize=
+//
+// Binding to loopback does not keep browsers out: any web page can send
+// requests here, and a rebound DNS name lets it read the answers. So every
+// request must name 127.0.0.1:<port> or localhost:<port> as its Host and
+// carry no Origin, every endpoint but /ping needs "Authorization: Bearer
+// <token>" (see ApiToken), and POSTs must be application/json, which a page
+// cannot send cross-origin without a preflight.
+//
+// Connections are kept alive and handled one request at a time; requests run
+// on a fixed worker pool. When the pool already has maxQueued requests
+// waiting, new ones are answered with 503 and Retry-After instead of queueing.
+// While a connection's request runs, its socket is not read, so a pipelining
+// client buffers at most one read buffer of requests here.
+class HttpApiServer : public QObject {
+    Q_OBJECT
+
+ public:
+    HttpApiServer(int workerCount, int maxQueued, const QByteArray& token, QObject* parent = nullptr);
+    ~HttpApiServer();
+
+    bool listen(quint16 port);
+    quint16 serverPort() const;
+    QString errorString() const;
+
+    struct Request {
+        QByteArray method;
+        QByteArray path;
+        QByteArray query;
+        QByteArray body;
+        QByteArray host;
+        QByteArray origin;
+        QByteArray contentType;
+        QByteArray authorization;
+        bool hasOrigin = false;
+        bool keepAlive = true;
+    };
+
+    struct Response {
+        int status = 200;
+        QByteArray body;
+    };
+
+    // Checks and routes one parsed request for a server on port whose token
+    // is token; runs on worker threads.
+    static Response handle(const Request& request, const QByteArray& token, quint16 port);
+
+ private:
+    struct Connection {
+        QTcpSocket* socket = nullptr;
+        QTimer* idleTimer = nullptr;
+        QByteArray buffer;
+        bool busy = false;
+        bool closeAfterResponse = false;
+    };
+
+    static const int kIdleTimeoutMs = 30000;
+    static const int kMaxHeaderBytes = 16 << 10;
+    static const int kMaxRequestBytes = 1 << 20;
+
+    QTcpServer* m_server;
+    QByteArray m_token;
+    QThreadPool m_pool;
+    int m_maxQueued;
+    std::atomic<int> m_queued;
+    QHash<quint64, Connection> m_connections;
+    quint64 m_nextConnectionId;
+
+    // Moves whatever the socket holds into the connection's buffer.
+    void readSocket(quint64 connectionId);
+    void processBuffer(quint64 connectionId);
+    void sendResponse(quint64 connectionId, const Response& response);
+    void dropConnection(quint64 connectionId);
+
+ private slots:
+    void onNewConnection();
+};
+#endif  // HTTPAPISERVER_H
@@ -0,0 +1,102 @@
+// Copyright 2025 MarketSystem
+#include "JsonWriter.h"
+
+void JsonWriter::separate() {
+    if (m_needComma) {
+        m_out.append(',');
+    }
+}
+
+JsonWriter& JsonWriter::beginObject() {
+    separate();
+    m_out.append('{');
+    m_needComma = false;
+    return *this;
+}
+
+JsonWriter& JsonWriter::endObject() {
+    m_out.append('}');
+    m_needComma = true;
+    return *this;
+}
+
+JsonWriter& JsonWriter::beginArray() {
+    separate();
+    m_out.append('[');
+    m_needComma = false;
+    return *this;
+}
+
+JsonWriter& JsonWriter::endArray() {
+    m_out.append(']');
+    m_needComma = true;
+    return *this;
+}
+
+JsonWriter& JsonWriter::key(const char* name) {
+    separate();
+    m_out.append('"').append(name).append("\":");
+    m_needComma = false;
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(const QString& text) {
+    separate();
+    appendEscaped(text.toUtf8());
+    m_needComma = true;
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(const char* text) {
+    separate();
+    appendEscaped(QByteArray::fromRawData(text, static_cast<int>(qstrlen(text))));
+    m_needComma = true;
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(qint64 number) {
+    separate();
+    m_out.append(QByteArray::number(number));
+    m_needComma = true;
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(bool flag) {
+    separate();
+    m_out.append(flag ? "true" : "false");
+    m_needComma = true;
+    return *this;
+}
+
+void JsonWriter::appendEscaped(const QByteArray& utf8) {
+    static const char kHex[] = "0123456789abcdef";
+
+    m_out.append('"');
+    const char* begin = utf8.constData();
+    const char* end = begin + utf8.size();
+    const char* run = begin;
+
+    // Copy unescaped runs in one append; only control characters, quotes
+    // and backslashes need rewriting (UTF-8 passes through untouched).
+    for (const char* p = begin; p != end; ++p) {
+        unsigned char c = static_cast<unsigned char>(*p);
+        if (c >= 0x20 && c != '"' && c != '\\') {
+            continue;
+        }
+        m_out.append(run, static_cast<int>(p - run));
+        switch (c) {
+        case '"': m_out.append("\\\""); break;
+        case '\\': m_out.append("\\\\"); break;
+        case '\n': m_out.append("\\n"); break;
+        case '\r': m_out.append("\\r"); break;
+        case '\t': m_out.append("\\t"); break;
+        default: {
+            char escape[] = {'\\', 'u', '0', '0', kHex[c >> 4], kHex[c & 0xF]};
+            m_out.append(escape, sizeof(escape));
+        }
+        }
+        run = p + 1;
+    }
+    m_out.append(run, static_cast<int>(end - run));
+    m_out.append('"');
+}
@@ -0,0 +1,35 @@
+// Copyright 2025 MarketSystem
+#ifndef JSONWRITER_H
+#define JSONWRITER_H
+
+#include <QByteArray>
+#include <QString>
+
+// Streams JSON straight into a caller-owned buffer. There is no document
+// tree: values are escaped and appended as they are written, so building a
+// response costs one pass over the data and no intermediate allocations.
+// Callers are responsible for well-formed nesting.
+class JsonWriter {
+ public:
+    explicit JsonWriter(QByteArray& out) : m_out(out), m_needComma(false) {}
+
+    JsonWriter& beginObject();
+    JsonWriter& endObject();
+    JsonWriter& beginArray();
+    JsonWriter& endArray();
+    JsonWriter& key(const char* name);
+
+    JsonWriter& value(const QString& text);
+    JsonWriter& value(const char* text);
+    JsonWriter& value(qint64 number);
+    JsonWriter& value(int number) { return value(static_cast<qint64>(number)); }
+    JsonWriter& value(bool flag);
+
+ private:
+    QByteArray& m_out;
+    bool m_needComma;
+
+    void separate();
+    void appendEscaped(const QByteArray& utf8);
+};
+#endif  // JSONWRITER_H
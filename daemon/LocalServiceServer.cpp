@@ -0,0 +1,119 @@
+// Copyright 2025 MarketSystem
+#include "LocalServiceServer.h"
+#include <QDebug>
+
+LocalServiceServer::LocalServiceServer(int workerCount, const QByteArray& token, QObject* parent)
+    : QObject(parent), m_server(new QLocalServer(this)), m_token(token), m_nextSessionId(1) {
+    m_pool.setMaxThreadCount(workerCount);
+    // Never retire idle workers: each one holds an open database connection.
+    m_pool.setExpiryTimeout(-1);
+
+    connect(m_server, &QLocalServer::newConnection, this, &LocalServiceServer::onNewConnection);
+}
+
+LocalServiceServer::~LocalServiceServer() {
+    m_server->close();
+    m_pool.waitForDone();
+}
+
+bool LocalServiceServer::listen(const QString& name) {
+    m_errorString.clear();
+    m_server->setSocketOptions(QLocalServer::UserAccessOption);
+    if (m_server->listen(name)) {
+        return true;
+    }
+    if (m_server->serverError() != QAbstractSocket::AddressInUseError) {
+        return false;
+    }
+
+    // Either a running daemon or a stale socket file from a crashed one;
+    // only the second may be removed.
+    QLocalSocket probe;
+    probe.connectToServer(name);
+    if (probe.waitForConnected(1000)) {
+        probe.abort();
+        m_errorString = "Another daemon is already listening";
+        return false;
+    }
+    QLocalServer::removeServer(name);
+    return m_server->listen(name);
+}
+
+QString LocalServiceServer::errorString() const {
+    return m_errorString.isEmpty() ? m_server->errorString() : m_errorString;
+}
+
+void LocalServiceServer::onNewConnection() {
+    while (QLocalSocket* socket = m_server->nextPendingConnection()) {
+        quint64 sessionId = m_nextSessionId++;
+        Session& session = m_sessions[sessionId];
+        session.socket = socket;
+
+        connect(socket, &QLocalSocket::readyRead, this, [this, sessionId]() {
+            readRequests(sessionId);
+        });
+        connect(socket, &QLocalSocket::disconnected, this, [this, sessionId]() {
+            auto it = m_sessions.find(sessionId);
+            if (it != m_sessions.end()) {
+                it->socket->deleteLater();
+                m_sessions.erase(it);
+            }
+        });
+    }
+}
+
+void LocalServiceServer::readRequests(quint64 sessionId) {
+    auto it = m_sessions.find(sessionId);
+    if (it == m_sessions.end()) {
+        return;
+    }
+    Session& session = *it;
+
+    // Backpressure: leave bytes in the socket until responses drain.
+    if (session.inFlight >= kMaxInFlightPerSession) {
+        return;
+    }
+
+    session.buffer.append(session.socket->readAll());
+
+    QByteArray payload;
+    bool malformed = false;
+    while (session.inFlight < kMaxInFlightPerSession
+           && ServiceProtocol::takeFrame(session.buffer, &payload, &malformed)) {
+        QByteArray answer;
+        if (ServiceProtocol::authenticate(payload, m_token, &session.caller, &answer)) {
+            session.socket->write(ServiceProtocol::frame(answer));
+            continue;
+        }
+
+        ++session.inFlight;
+        ServiceProtocol::Caller caller = session.caller;
+        m_pool.start([this, sessionId, payload, caller]() {
+            QByteArray response = ServiceProtocol::handleRequest(payload, caller);
+            QMetaObject::invokeMethod(this, [this, sessionId, response]() {
+                deliverResponse(sessionId, response);
+            }, Qt::QueuedConnection);
+        });
+    }
+
+    if (malformed) {
+        qWarning() << "Closing session" << sessionId << "after an oversized frame";
+        session.socket->abort();
+    }
+}
+
+void LocalServiceServer::deliverResponse(quint64 sessionId, const QByteArray& response) {
+    auto it = m_sessions.find(sessionId);
+    if (it == m_sessions.end()) {
+        return;  // client went away while the request was running
+    }
+
+    it->socket->write(ServiceProtocol::frame(response));
+    --it->inFlight;
+
+    // Pick up anything that was held back by the in-flight limit.
+    if (it->inFlight == kMaxInFlightPerSession - 1
+        && (!it->buffer.isEmpty() || it->socket->bytesAvailable() > 0)) {
+        readRequests(sessionId);
+    }
+}
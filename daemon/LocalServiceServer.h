@@ -0,0 +1,55 @@
+// Copyright 2025 MarketSystem
+#ifndef LOCALSERVICESERVER_H
+#define LOCALSERVICESERVER_H
+
+#include <QObject>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QThreadPool>
+#include <QHash>
+#include <QByteArray>
+#include "ServiceProtocol.h"
+
+// Serves ServiceProtocol requests over a QLocalServer. Sockets are owned by
+// the server's thread; decoded requests run on a fixed pool of workers, each
+// keeping its own warm database connection for the life of the daemon.
+//
+// The socket is only accessible to the owning user, and moderation requests
+// additionally need the connection to have authenticated with token.
+class LocalServiceServer : public QObject {
+    Q_OBJECT
+
+ public:
+    LocalServiceServer(int workerCount, const QByteArray& token, QObject* parent = nullptr);
+    ~LocalServiceServer();
+
+    // Fails, leaving the socket alone, if another daemon already answers on
+    // name; a leftover socket file nobody answers on is replaced.
+    bool listen(const QString& name);
+    QString errorString() const;
+
+ private:
+    struct Session {
+        QLocalSocket* socket = nullptr;
+        QByteArray buffer;
+        int inFlight = 0;
+        ServiceProtocol::Caller caller;
+    };
+
+    // Requests a single client may have queued before we stop reading from it.
+    static const int kMaxInFlightPerSession = 256;
+
+    QLocalServer* m_server;
+    QByteArray m_token;
+    QString m_errorString;
+    QThreadPool m_pool;
+    QHash<quint64, Session> m_sessions;
+    quint64 m_nextSessionId;
+
+    void readRequests(quint64 sessionId);
+    void deliverResponse(quint64 sessionId, const QByteArray& response);
+
+ private slots:
+    void onNewConnection();
+};
+#endif  // LOCALSERVICESERVER_H
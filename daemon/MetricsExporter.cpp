@@ -0,0 +1,80 @@
+// Copyright 2025 MarketSystem
+#include "MetricsExporter.h"
+#include <QHostAddress>
+#include <QTcpSocket>
+#include <QDebug>
+#include "Metrics.h"
+
+namespace {
+void reply(QTcpSocket* socket, const QByteArray& status, const QByteArray& contentType, const QByteArray& body) {
+    QByteArray header;
+    header.append("HTTP/1.1 ").append(status)
+          .append("\r\nContent-Type: ").append(contentType)
+          .append("\r\nContent-Length: ").append(QByteArray::number(body.size()))
+          .append("\r\nConnection: close\r\n\r\n");
+    socket->write(header);
+    socket->write(body);
+    socket->disconnectFromHost();
+}
+}  // namespace
+
+MetricsExporter::MetricsExporter(QObject* parent)
+    : QObject(parent), m_server(new QTcpServer(this)), m_fileTimer(new QTimer(this)) {
+    connect(m_server, &QTcpServer::newConnection, this, &MetricsExporter::onNewConnection);
+    connect(m_fileTimer, &QTimer::timeout, this, &MetricsExporter::writeFile);
+}
+
+MetricsExporter::~MetricsExporter() {
+    m_server->close();
+    // Leave the final counts behind for whoever reads the file next
+    if (!m_filePath.isEmpty()) {
+        writeFile();
+    }
+}
+
+void MetricsExporter::startFile(const QString& path, int intervalMs) {
+    m_filePath = path;
+    writeFile();
+    m_fileTimer->start(qMax(100, intervalMs));
+}
+
+bool MetricsExporter::listen(quint16 port) {
+    return m_server->listen(QHostAddress::LocalHost, port);
+}
+
+quint16 MetricsExporter::serverPort() const {
+    return m_server->serverPort();
+}
+
+QString MetricsExporter::errorString() const {
+    return m_server->errorString();
+}
+
+void MetricsExporter::writeFile() {
+    Metrics::getInstance().writeFile(m_filePath);
+}
+
+void MetricsExporter::onNewConnection() {
+    while (QTcpSocket* socket = m_server->nextPendingConnection()) {
+        connect(socket, &QTcpSocket::disconnected, socket, &QObject::deleteLater);
+        connect(socket, &QTcpSocket::readyRead, this, [socket]() {
+            // One request per connection; only the request line matters
+            if (!socket->canReadLine()) {
+                if (socket->bytesAvailable() > kMaxRequestBytes) {
+                    socket->abort();
+                }
+                return;
+            }
+            QList<QByteArray> requestLine = socket->readLine().trimmed().split(' ');
+            disconnect(socket, &QTcpSocket::readyRead, nullptr, nullptr);
+            if (requestLine.size() != 3 || requestLine[0] != "GET") {
+                reply(socket, "405 Method Not Allowed", "text/plain", "Only GET is supported\n");
+            } else if (requestLine[1] != "/metrics") {
+                reply(socket, "404 Not Found", "text/plain", "Not found\n");
+            } else {
+                reply(socket, "200 OK", "text/plain; version=0.0.4; charset=utf-8",
+                      Metrics::getInstance().exposition());
+            }
+        });
+    }
+}
@@ -0,0 +1,38 @@
+// Copyright 2025 MarketSystem
+#ifndef METRICSEXPORTER_H
+#define METRICSEXPORTER_H
+
+#include <QObject>
+#include <QTcpServer>
+#include <QTimer>
+#include <QString>
+
+// Publishes the Metrics registry for Prometheus: as a text file rewritten
+// every interval (for the node_exporter textfile collector), and as
+// GET /metrics on 127.0.0.1:<port>. Scrapes are rendered on the daemon's
+// main thread; they only read atomics and never touch the database.
+class MetricsExporter : public QObject {
+    Q_OBJECT
+
+ public:
+    explicit MetricsExporter(QObject* parent = nullptr);
+    ~MetricsExporter();
+
+    // Writes path now and then every intervalMs.
+    void startFile(const QString& path, int intervalMs);
+    bool listen(quint16 port);
+    quint16 serverPort() const;
+    QString errorString() const;
+
+ private:
+    static const int kMaxRequestBytes = 8192;
+
+    QTcpServer* m_server;
+    QTimer* m_fileTimer;
+    QString m_filePath;
+
+ private slots:
+    void onNewConnection();
+    void writeFile();
+};
+#endif  // METRICSEXPORTER_H
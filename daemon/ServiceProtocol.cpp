@@ -0,0 +1,236 @@
+// Copyright 2025 MarketSystem
+#include "ServiceProtocol.h"
+#include <QtEndian>
+#include <limits>
+#include "ApiToken.h"
+#include "AuthService.h"
+#include "AdminService.h"
+
+namespace ServiceProtocol {
+
+namespace {
+
+QDataStream& configure(QDataStream& stream) {
+    stream.setVersion(QDataStream::Qt_6_0);
+    stream.setByteOrder(QDataStream::BigEndian);
+    return stream;
+}
+
+QByteArray respond(quint32 requestId, Status status, const QString& message) {
+    QByteArray response;
+    QDataStream out(&response, QIODevice::WriteOnly);
+    configure(out) << requestId << static_cast<quint8>(status);
+    writeString(out, message);
+    return response;
+}
+
+quint8 userFlags(bool isAdmin, bool isBanned) {
+    return (isAdmin ? 0x01 : 0x00) | (isBanned ? 0x02 : 0x00);
+}
+
+void writeUser(QDataStream& out, const User& user) {
+    out << static_cast<qint32>(user.getId());
+    writeString(out, user.getPhone());
+    writeString(out, user.getUsername());
+    out << static_cast<qint64>(user.getCreatedAt().isValid() ? user.getCreatedAt().toSecsSinceEpoch() : 0)
+        << userFlags(user.isAdmin(), user.isBanned());
+}
+
+QByteArray respondUser(quint32 requestId, const QPair<bool, User>& result, const QString& failure) {
+    if (!result.first) {
+        return respond(requestId, Failed, failure);
+    }
+    QByteArray response;
+    QDataStream out(&response, QIODevice::WriteOnly);
+    configure(out) << requestId << static_cast<quint8>(Ok);
+    writeUser(out, result.second);
+    return response;
+}
+
+QByteArray respondUsers(quint32 requestId, const UserListResult& listing) {
+    if (!listing.ok) {
+        return respond(requestId, Failed, "Failed to load users");
+    }
+    QByteArray response;
+    QDataStream out(&response, QIODevice::WriteOnly);
+    configure(out) << requestId << static_cast<quint8>(Ok)
+                   << static_cast<quint32>(listing.users.size());
+    for (int row = 0; row < listing.users.size(); ++row) {
+        out << static_cast<qint32>(listing.users.id(row));
+        writeString(out, listing.users.phone(row));
+        writeString(out, listing.users.username(row));
+        out << static_cast<qint64>(listing.users.createdAtSecs(row))
+            << userFlags(listing.users.isAdmin(row), listing.users.isBanned(row));
+    }
+    return response;
+}
+
+}  // namespace
+
+void writeString(QDataStream& out, const QString& value) {
+    QByteArray utf8 = value.toUtf8();
+    out << static_cast<quint32>(utf8.size());
+    out.writeRawData(utf8.constData(), utf8.size());
+}
+
+QString readString(QDataStream& in) {
+    quint32 length = 0;
+    in >> length;
+    if (in.status() != QDataStream::Ok || length > kMaxFrameSize) {
+        in.setStatus(QDataStream::ReadCorruptData);
+        return QString();
+    }
+    QByteArray utf8(static_cast<int>(length), Qt::Uninitialized);
+    if (in.readRawData(utf8.data(), static_cast<int>(length)) != static_cast<int>(length)) {
+        in.setStatus(QDataStream::ReadPastEnd);
+        return QString();
+    }
+    return QString::fromUtf8(utf8);
+}
+
+QByteArray frame(const QByteArray& payload) {
+    QByteArray framed;
+    framed.reserve(kFrameHeaderSize + payload.size());
+    char header[kFrameHeaderSize];
+    qToBigEndian(static_cast<quint32>(payload.size()), header);
+    framed.append(header, kFrameHeaderSize);
+    framed.append(payload);
+    return framed;
+}
+
+bool takeFrame(QByteArray& buffer, QByteArray* payload, bool* malformed) {
+    *malformed = false;
+    if (buffer.size() < kFrameHeaderSize) {
+        return false;
+    }
+
+    quint32 length = qFromBigEndian<quint32>(buffer.constData());
+    if (length > kMaxFrameSize) {
+        *malformed = true;
+        return false;
+    }
+    if (buffer.size() < kFrameHeaderSize + static_cast<qsizetype>(length)) {
+        return false;
+    }
+
+    *payload = buffer.mid(kFrameHeaderSize, length);
+    buffer.remove(0, kFrameHeaderSize + length);
+    return true;
+}
+
+bool authenticate(const QByteArray& request, const QByteArray& token, Caller* caller,
+                  QByteArray* response) {
+    QDataStream in(request);
+    configure(in);
+
+    quint32 requestId = 0;
+    quint8 opcode = 0;
+    in >> requestId >> opcode;
+    if (in.status() != QDataStream::Ok || opcode != Authenticate) {
+        return false;
+    }
+
+    QString presented = readString(in);
+    if (in.status() != QDataStream::Ok) {
+        *response = respond(requestId, BadRequest, "Malformed arguments");
+    } else if (ApiToken::matches(token, presented.toUtf8())) {
+        caller->authorized = true;
+        *response = respond(requestId, Ok, "Authenticated");
+    } else {
+        // A wrong guess also drops whatever an earlier one established
+        caller->authorized = false;
+        *response = respond(requestId, Unauthorized, "Invalid token");
+    }
+    return true;
+}
+
+QByteArray handleRequest(const QByteArray& request, const Caller& caller) {
+    QDataStream in(request);
+    configure(in);
+
+    quint32 requestId = 0;
+    quint8 opcode = 0;
+    in >> requestId >> opcode;
+    if (in.status() != QDataStream::Ok) {
+        return respond(requestId, BadRequest, "Truncated request header");
+    }
+    if ((opcode == BanUser || opcode == UnbanUser) && !caller.authorized) {
+        return respond(requestId, Unauthorized, "Authenticate before moderating users");
+    }
+
+    switch (opcode) {
+    case Ping:
+        return respond(requestId, Ok, "pong");
+
+    case Login: {
+        QString phone = readString(in);
+        QString password = readString(in);
+        if (in.status() != QDataStream::Ok) {
+            break;
+        }
+        return respondUser(requestId, AuthService::loginUser(phone, password),
+                           "Invalid phone number or password");
+    }
+
+    case Register: {
+        QString phone = readString(in);
+        QString password = readString(in);
+        QString username = readString(in);
+        if (in.status() != QDataStream::Ok) {
+            break;
+        }
+        QPair<bool, QString> validation = AuthService::validateUserInput(phone, password, username);
+        if (!validation.first) {
+            return respond(requestId, Failed, validation.second);
+        }
+        return respondUser(requestId, AuthService::registerUser(phone, password, username),
+                           "Phone number may already be registered");
+    }
+
+    case BanUser: {
+        qint32 userId = 0;
+        in >> userId;
+        QString reason = readString(in);
+        if (in.status() != QDataStream::Ok) {
+            break;
+        }
+        QPair<bool, QString> result = AdminService::banUser(userId, reason);
+        return respond(requestId, result.first ? Ok : Failed, result.second);
+    }
+
+    case UnbanUser: {
+        qint32 userId = 0;
+        in >> userId;
+        if (in.status() != QDataStream::Ok) {
+            break;
+        }
+        QPair<bool, QString> result = AdminService::unbanUser(userId);
+        return respond(requestId, result.first ? Ok : Failed, result.second);
+    }
+
+    case ListUsers:
+    case ListBannedUsers: {
+        qint32 page = 0;
+        qint32 pageSize = 0;
+        in >> page >> pageSize;
+        if (in.status() != QDataStream::Ok || page < 0 || pageSize <= 0 || pageSize > 10000 ||
+            page > std::numeric_limits<qint32>::max() / pageSize) {
+            return respond(requestId, BadRequest, "Invalid page arguments");
+        }
+        return respondUsers(requestId, opcode == ListUsers
+                                           ? AdminService::listUsers(page, pageSize)
+                                           : AdminService::listBannedUsers(page, pageSize));
+    }
+
+    case Authenticate:
+        // Only reaches here when the server did not route it to authenticate()
+        return respond(requestId, BadRequest, "Authenticate is handled per connection");
+
+    default:
+        return respond(requestId, BadRequest, "Unknown opcode");
+    }
+
+    return respond(requestId, BadRequest, "Malformed arguments");
+}
+
+}  // namespace ServiceProtocol
@@ -0,0 +1,75 @@
+// Copyright 2025 MarketSystem
+#ifndef SERVICEPROTOCOL_H
+#define SERVICEPROTOCOL_H
+
+#include <QByteArray>
+#include <QDataStream>
+#include <QString>
+
+// Binary protocol spoken by the service daemon over QLocalSocket.
+//
+// Every message is a frame: quint32 payload length (big-endian) followed by
+// the payload. Requests carry quint32 requestId, quint8 opcode and the
+// opcode's arguments; responses carry the same requestId, a quint8 status
+// and the result body. Clients may pipeline any number of requests; the
+// daemon answers each one as soon as a worker finishes it, so responses can
+// arrive out of order and are matched by requestId.
+//
+// Strings are encoded as quint32 byte length + UTF-8. User rows are
+// qint32 id, phone, username, qint64 created_at (epoch seconds), quint8 flags
+// (bit 0 admin, bit 1 banned).
+//
+// BanUser and UnbanUser are refused with Unauthorized until the connection
+// has sent Authenticate with the daemon's token (see ApiToken).
+namespace ServiceProtocol {
+
+const quint32 kMaxFrameSize = 1 << 20;
+const int kFrameHeaderSize = 4;
+
+enum Opcode : quint8 {
+    Ping = 0,
+    Login = 1,            // phone, password -> user row
+    Register = 2,         // phone, password, username -> user row
+    BanUser = 3,          // qint32 userId, reason -> message
+    UnbanUser = 4,        // qint32 userId -> message
+    ListUsers = 5,        // qint32 page, qint32 pageSize -> quint32 count, rows
+    ListBannedUsers = 6,  // qint32 page, qint32 pageSize -> quint32 count, rows
+    Authenticate = 7      // token -> message
+};
+
+enum Status : quint8 {
+    Ok = 0,
+    Failed = 1,       // body: message
+    BadRequest = 2,   // body: message
+    Unauthorized = 3  // body: message
+};
+
+// What a connection has proven so far; the server keeps one per session.
+struct Caller {
+    bool authorized = false;
+};
+
+void writeString(QDataStream& out, const QString& value);
+QString readString(QDataStream& in);
+
+// Prepends the length header to a finished payload.
+QByteArray frame(const QByteArray& payload);
+
+// Pops one complete frame payload off the front of buffer. Returns false when
+// more bytes are needed; sets *malformed when the header is unusable.
+bool takeFrame(QByteArray& buffer, QByteArray* payload, bool* malformed);
+
+// Answers an Authenticate request by checking it against token and updating
+// *caller. Returns false, touching nothing, for every other opcode. The
+// server runs it on its own thread, before dispatching anything pipelined
+// behind it, so those requests already see the new state.
+bool authenticate(const QByteArray& request, const QByteArray& token, Caller* caller,
+                  QByteArray* response);
+
+// Decodes one request payload and runs it against AuthService/AdminService.
+// Called on worker threads; returns the response payload (unframed).
+QByteArray handleRequest(const QByteArray& request, const Caller& caller);
+
+}  // namespace ServiceProtocol
+
+#endif  // SERVICEPROTOCOL_H
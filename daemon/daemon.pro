@@ -0,0 +1,41 @@
+TEMPLATE = app
+TARGET = marketsystemd
+CONFIG += console c++17
+CONFIG -= app_bundle
+QT = core sql network concurrent
+
+SOURCES += \
+    ApiToken.cpp \
+    HttpApiServer.cpp \
+    JsonWriter.cpp \
+    LocalServiceServer.cpp \
+    MetricsExporter.cpp \
+    ServiceProtocol.cpp \
+    daemon_main.cpp
+
+HEADERS += \
+    ApiToken.h \
+    HttpApiServer.h \
+    JsonWriter.h \
+    LocalServiceServer.h \
+    MetricsExporter.h \
+    ServiceProtocol.h
+
+# Service layer shared with the GUI application
+SOURCES += ../AdminService.cpp \
+           ../AuditLog.cpp \
+           ../AuthService.cpp \
+           ../AutoBanPolicy.cpp \
+           ../ChangeNotifier.cpp \
+           ../DatabaseManager.cpp \
+           ../Metrics.cpp \
+           ../Report.cpp \
+           ../ReportService.cpp \
+           ../ShardRouter.cpp \
+           ../User.cpp \
+           ../UserCache.cpp \
+           ../UserTable.cpp
+
+HEADERS += ../ChangeNotifier.h
+
+INCLUDEPATH += ../
@@ -0,0 +1,104 @@
+// Copyright 2025 MarketSystem
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QThread>
+#include <QScopedPointer>
+#include <QDebug>
+#include "ApiToken.h"
+#include "DatabaseManager.h"
+#include "LocalServiceServer.h"
+#include "HttpApiServer.h"
+#include "MetricsExporter.h"
+#include "ShardRouter.h"
+
+int main(int argc, char* argv[]) {
+    QCoreApplication app(argc, argv);
+    // Share the GUI application's data directory and database file.
+    QCoreApplication::setApplicationName("MarketSystem");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Headless MarketSystem service daemon");
+    parser.addHelpOption();
+    QCommandLineOption nameOption("name", "Local socket name.", "name", "marketsystem");
+    QCommandLineOption workersOption("workers", "Request worker threads.", "count",
+                                     QString::number(QThread::idealThreadCount()));
+    QCommandLineOption httpPortOption("http-port", "Serve the HTTP/JSON API on 127.0.0.1:<port> (0 disables).",
+                                      "port", "0");
+    QCommandLineOption httpQueueOption("http-queue", "HTTP requests allowed to wait for a worker before 503.",
+                                       "count", "256");
+    QCommandLineOption shardsOption("shards", "Spread users and reports over this many database files "
+                                    "(0 keeps them in the main file).", "count", "0");
+    QCommandLineOption metricsFileOption("metrics-file", "Rewrite Prometheus metrics to this file periodically.",
+                                         "path");
+    QCommandLineOption metricsIntervalOption("metrics-interval", "Milliseconds between metrics file writes.",
+                                             "ms", "10000");
+    QCommandLineOption tokenFileOption("token-file", "File holding the token clients present before "
+                                       "moderating users (created on first run).", "path",
+                                       ApiToken::defaultPath());
+    QCommandLineOption metricsPortOption("metrics-port", "Serve GET /metrics on 127.0.0.1:<port> (0 disables).",
+                                         "port", "0");
+    parser.addOption(nameOption);
+    parser.addOption(workersOption);
+    parser.addOption(httpPortOption);
+    parser.addOption(httpQueueOption);
+    parser.addOption(shardsOption);
+    parser.addOption(metricsFileOption);
+    parser.addOption(metricsIntervalOption);
+    parser.addOption(metricsPortOption);
+    parser.addOption(tokenFileOption);
+    parser.process(app);
+
+    // Open and migrate the database before accepting clients.
+    DatabaseManager& dbManager = DatabaseManager::getInstance();
+    if (!dbManager.isOpen()) {
+        qCritical() << "Database is not available:" << dbManager.getLastError();
+        return 1;
+    }
+    if (!ShardRouter::getInstance().configure(parser.value(shardsOption).toInt())) {
+        qCritical() << "Shard files are not available";
+        return 1;
+    }
+
+    QString tokenError;
+    QByteArray token = ApiToken::loadOrCreate(parser.value(tokenFileOption), &tokenError);
+    if (token.isEmpty()) {
+        qCritical() << tokenError;
+        return 1;
+    }
+
+    int workers = qMax(1, parser.value(workersOption).toInt());
+    LocalServiceServer server(workers, token);
+    if (!server.listen(parser.value(nameOption))) {
+        qCritical() << "Failed to listen on" << parser.value(nameOption) << ":" << server.errorString();
+        return 1;
+    }
+
+    qDebug() << "Service daemon listening on" << parser.value(nameOption)
+             << "with" << workers << "workers; token in" << parser.value(tokenFileOption);
+
+    QScopedPointer<HttpApiServer> httpServer;
+    quint16 httpPort = static_cast<quint16>(parser.value(httpPortOption).toUInt());
+    if (httpPort != 0) {
+        httpServer.reset(new HttpApiServer(workers, qMax(1, parser.value(httpQueueOption).toInt()), token));
+        if (!httpServer->listen(httpPort)) {
+            qCritical() << "Failed to listen on 127.0.0.1:" << httpPort << ":" << httpServer->errorString();
+            return 1;
+        }
+        qDebug() << "HTTP API listening on 127.0.0.1:" << httpServer->serverPort();
+    }
+
+    MetricsExporter metrics;
+    if (parser.isSet(metricsFileOption)) {
+        metrics.startFile(parser.value(metricsFileOption), parser.value(metricsIntervalOption).toInt());
+    }
+    quint16 metricsPort = static_cast<quint16>(parser.value(metricsPortOption).toUInt());
+    if (metricsPort != 0) {
+        if (!metrics.listen(metricsPort)) {
+            qCritical() << "Failed to listen on 127.0.0.1:" << metricsPort << ":" << metrics.errorString();
+            return 1;
+        }
+        qDebug() << "Metrics on http://127.0.0.1:" << metrics.serverPort() << "/metrics";
+    }
+
+    return app.exec();
+}
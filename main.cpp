@@ -1,27 +1,67 @@
 // Copyright 2025 MarketSystem
 #include <QApplication>
+#include <QCommandLineParser>
+#include <QFuture>
+#include <QScopeGuard>
 #include <QMessageBox>
 #include <QFontDatabase>
 #include <QFile>
 #include <QTextStream>
+#include <QThreadPool>
+#include <QTimer>
+#include <QtConcurrent>
 #include <QDebug>
 #include "LoginWindow.h"
 #include "mainwindow.h"
 #include "AdminWindow.h"
+#include "AdminService.h"
 #include "DatabaseManager.h"
+#include "Metrics.h"
+#include "StartupProfiler.h"
 #include "User.h"
 
 
 int main(int argc, char* argv[]) {
+    StartupProfiler::start();
+
+    StartupProfiler::Scope appPhase("create application");
     QApplication app(argc, argv);
+    appPhase.end();
+
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    QCommandLineOption profileOption("startup-profile", "Print the startup phases when the login window closes.");
+    QCommandLineOption traceOption("startup-trace", "Write the startup phases as a Chrome trace to file.", "file");
+    QCommandLineOption metricsFileOption("metrics-file", "Rewrite Prometheus metrics to this file periodically.",
+                                         "path");
+    parser.addOptions({profileOption, traceOption, metricsFileOption});
+    parser.process(app);
+
+    // Same textfile as the daemon's --metrics-file, for node_exporter; the
+    // GUI serves no HTTP endpoint. Rewritten every 10 s and once at exit.
+    QString metricsPath = parser.value(metricsFileOption);
+    QTimer metricsTimer;
+    QObject::connect(&metricsTimer, &QTimer::timeout, [metricsPath]() {
+        Metrics::getInstance().writeFile(metricsPath);
+    });
+    auto writeFinalMetrics = qScopeGuard([metricsPath]() {
+        if (!metricsPath.isEmpty()) {
+            Metrics::getInstance().writeFile(metricsPath);
+        }
+    });
+    if (!metricsPath.isEmpty()) {
+        metricsTimer.start(10000);
+    }
 
     // Set application style
+    StartupProfiler::Scope stylePhase("style and fonts");
     app.setStyle("Fusion");
 
     // Set application font
     QFont defaultFont = QApplication::font();
     defaultFont.setPointSize(10);
     QApplication::setFont(defaultFont);
+    stylePhase.end();
 
     // Debug: Show database file location
     // QString dbPath = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/marketplace.db";
@@ -34,27 +74,57 @@ int main(int argc, char* argv[]) {
         appDataDir.mkpath(".");
     }
 
-    // Initialize database
-    DatabaseManager& dbManager = DatabaseManager::getInstance();
-    qDebug() << "Database initialized:" << dbManager.isOpen();
+    // Open, migrate and warm the database behind the login window. The
+    // thread that constructs DatabaseManager owns the primary connection, so
+    // it is a pool thread of its own that lives until main() returns. The GUI
+    // thread reads through its own per-thread connection.
+    QThreadPool databasePool;
+    databasePool.setMaxThreadCount(1);
+    databasePool.setExpiryTimeout(-1);
+    // On every return path, close the primary on that thread before the
+    // pool (declared first, destroyed last) lets it go
+    struct CloseOnDatabaseThread {
+        QThreadPool* pool;
+        ~CloseOnDatabaseThread() {
+            QtConcurrent::run(pool, []() { DatabaseManager::getInstance().close(); }).waitForFinished();
+        }
+    } closeDatabase{&databasePool};
+    QFuture<bool> databaseReady = QtConcurrent::run(&databasePool, []() {
+        StartupProfiler::Scope openPhase("open and migrate database");
+        DatabaseManager& dbManager = DatabaseManager::getInstance();
+        openPhase.end();
+        qDebug() << "Database initialized:" << dbManager.isOpen();
 
-    // Test database connection using the correct method
-    if (dbManager.isOpen()) {
-        QSqlQuery query(dbManager.getDatabase());
-        if (query.exec("SELECT COUNT(*) as count FROM users")) {
-            if (query.next()) {
-                qDebug() << "User count in database:" << query.value("count").toInt();
+        // Test database connection; the summary row avoids a COUNT(*) scan
+        if (dbManager.isOpen()) {
+            StartupProfiler::Scope warmPhase("warm database");
+            QPair<bool, MarketStats> stats = AdminService::getStats();
+            if (stats.first) {
+                qDebug() << "User count in database:" << stats.second.totalUsers;
             } else {
-                qDebug() << "No rows returned from query";
+                qDebug() << "Failed to read market statistics:" << dbManager.getLastError();
             }
-        } else {
-            qDebug() << "Failed to query users:" << query.lastError().text();
         }
-    }
+        return dbManager.isOpen();
+    });
 
     // Show login window
+    StartupProfiler::Scope loginPhase("create login window");
     LoginWindow loginWindow;
-    if (loginWindow.exec() == QDialog::Accepted) {
+    loginWindow.setDatabaseReady(databaseReady);
+    loginPhase.end();
+    // First turn of the event loop: the window is on screen
+    QTimer::singleShot(0, []() { StartupProfiler::mark("login window shown"); });
+
+    int loginResult = loginWindow.exec();
+    if (parser.isSet(profileOption)) {
+        QTextStream(stderr) << StartupProfiler::summary();
+    }
+    if (parser.isSet(traceOption)) {
+        StartupProfiler::writeTrace(parser.value(traceOption));
+    }
+
+    if (loginResult == QDialog::Accepted) {
         User currentUser = loginWindow.getCurrentUser();
 
         qDebug() << "Logged in user:" << currentUser.getUsername()
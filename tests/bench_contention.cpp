@@ -0,0 +1,215 @@
+// Multi-process write contention benchmark.
+//
+//   bench_contention --processes 1,2,4,8 --duration 5
+//
+// Like several MarketSystem instances sharing one marketplace.db: for each
+// process count, starts that many copies of itself in --worker mode against
+// one database file. Each worker runs a write-heavy mix (registrations, bans
+// and unbans, listings) on its own connection for the given time and prints
+// one JSON line with its counts and DatabaseManager::busyStats(). Per round
+// one JSON line goes to stdout with the summed throughput, failures and
+// busy/retry counters, so scaling and lock waits can be compared across
+// --busy-timeout and --max-attempts settings. The file is in WAL mode, as
+// DatabaseManager opens it: listings run beside the one writer at a time,
+// so added processes mostly show up as writers queueing for that lock.
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QLoggingCategory>
+#include <QProcess>
+#include <QTextStream>
+#include <QThread>
+#include <QDebug>
+#include <chrono>
+#include <memory>
+#include <random>
+#include <vector>
+#include "AdminService.h"
+#include "AuthService.h"
+#include "DatabaseManager.h"
+
+using Clock = std::chrono::steady_clock;
+
+static const char* kBenchPassword = "contend123";
+static const int kUsersPerWorker = 50;
+
+// 16x numbers with a two-digit worker prefix cannot collide across workers.
+static QString workerPhone(int worker, int sequence) {
+    return QString("16%1%2").arg(worker, 2, 10, QChar('0')).arg(sequence, 7, 10, QChar('0'));
+}
+
+// One worker process: returns its JSON summary line.
+static QJsonObject runWorker(int worker, double durationSec, qint64 startAtMs, quint64 seed) {
+    QJsonObject summary;
+    DatabaseManager& db = DatabaseManager::getInstance();
+    if (!db.isOpen()) {
+        summary["error"] = "database not available";
+        return summary;
+    }
+
+    // Accounts this worker bans and unbans; registered before the clock starts
+    RegistrationBatch batch;
+    for (int i = 0; i < kUsersPerWorker; ++i) {
+        batch.phones.append(workerPhone(worker, i));
+        batch.passwords.append(kBenchPassword);
+    }
+    QList<int> userIds = AuthService::registerUsers(batch).ids;
+    userIds.removeAll(-1);
+
+    qint64 waitMs = startAtMs - QDateTime::currentMSecsSinceEpoch();
+    if (waitMs > 0) {
+        QThread::msleep(static_cast<unsigned long>(waitMs));
+    }
+    DatabaseManager::resetBusyStats();
+
+    std::mt19937_64 rng(seed * 7919 + worker);
+    std::uniform_int_distribution<int> pickOp(0, 99);
+    std::uniform_int_distribution<int> pickUser(0, qMax(0, userIds.size() - 1));
+    int sequence = kUsersPerWorker;
+    qint64 ops = 0;
+    qint64 writes = 0;
+    qint64 failures = 0;
+
+    Clock::time_point start = Clock::now();
+    Clock::time_point end = start + std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double>(durationSec));
+    while (Clock::now() < end) {
+        int roll = pickOp(rng);
+        bool ok = true;
+        if (roll < 40) {
+            ok = AuthService::registerUser(workerPhone(worker, sequence++), kBenchPassword, "contend").first;
+            ++writes;
+        } else if (roll < 80 && !userIds.isEmpty()) {
+            // Own users only, so a false result is a database failure
+            int userId = userIds[pickUser(rng)];
+            ok = AdminService::banUser(userId, "contention").first || AdminService::unbanUser(userId).first;
+            ++writes;
+        } else {
+            ok = AdminService::listUsersAfter(ListCursor(), 50).ok;
+        }
+        ++ops;
+        if (!ok) {
+            ++failures;
+        }
+    }
+    double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+
+    DatabaseManager::BusyStats busy = DatabaseManager::busyStats();
+    summary["worker"] = worker;
+    summary["seconds"] = elapsed;
+    summary["ops"] = ops;
+    summary["writes"] = writes;
+    summary["failures"] = failures;
+    summary["busyErrors"] = static_cast<qint64>(busy.busyErrors);
+    summary["retries"] = static_cast<qint64>(busy.retries);
+    summary["recovered"] = static_cast<qint64>(busy.recovered);
+    summary["exhausted"] = static_cast<qint64>(busy.exhausted);
+    summary["backoffMs"] = static_cast<qint64>(busy.backoffMs);
+    return summary;
+}
+
+int main(int argc, char** argv) {
+    QCoreApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("MarketSystem multi-process contention benchmark");
+    parser.addHelpOption();
+    QCommandLineOption processesOption("processes", "Comma-separated process counts, one round each.",
+                                       "list", "1,2,4,8");
+    QCommandLineOption durationOption("duration", "Seconds per round.", "seconds", "5");
+    QCommandLineOption busyTimeoutOption("busy-timeout", "SQLite busy timeout in ms.", "ms",
+                                         QString::number(DatabaseManager::busyTimeout()));
+    QCommandLineOption attemptsOption("max-attempts", "Attempts per busy statement, 1 disables retries.",
+                                      "count", QString::number(DatabaseManager::retryPolicy().maxAttempts));
+    QCommandLineOption seedOption("seed", "Random seed.", "seed", "1");
+    QCommandLineOption dbOption("db", "Database file, recreated on start.", "path",
+                                QDir::temp().filePath("market_contention.db"));
+    QCommandLineOption workerOption("worker", "Internal: run as worker number n.", "n");
+    QCommandLineOption startAtOption("start-at", "Internal: epoch ms to start at.", "ms");
+    parser.addOptions({processesOption, durationOption, busyTimeoutOption, attemptsOption, seedOption, dbOption,
+                       workerOption, startAtOption});
+    parser.process(app);
+
+    QLoggingCategory::setFilterRules("*.debug=false\n*.warning=false");
+
+    DatabaseManager::setBusyTimeout(parser.value(busyTimeoutOption).toInt());
+    DatabaseManager::RetryPolicy policy = DatabaseManager::retryPolicy();
+    policy.maxAttempts = qMax(1, parser.value(attemptsOption).toInt());
+    DatabaseManager::setRetryPolicy(policy);
+    double durationSec = qMax(0.1, parser.value(durationOption).toDouble());
+    quint64 seed = parser.value(seedOption).toULongLong();
+    QString path = parser.value(dbOption);
+    DatabaseManager::setDatabasePath(path);
+
+    QTextStream out(stdout);
+    if (parser.isSet(workerOption)) {
+        QJsonObject summary = runWorker(parser.value(workerOption).toInt(), durationSec,
+                                        parser.value(startAtOption).toLongLong(), seed);
+        out << QJsonDocument(summary).toJson(QJsonDocument::Compact) << "\n";
+        return summary.contains("error") ? 1 : 0;
+    }
+
+    // Schema created once here, not raced by the workers
+    QFile::remove(path);
+    if (!DatabaseManager::getInstance().isOpen()) {
+        qCritical() << "Database is not available:" << path;
+        return 1;
+    }
+    DatabaseManager::getInstance().close();
+
+    int nextWorker = 0;
+    const QStringList counts = parser.value(processesOption).split(',', Qt::SkipEmptyParts);
+    for (const QString& count : counts) {
+        if (nextWorker >= 99) {
+            break;  // out of phone prefixes
+        }
+        int processes = qBound(1, count.trimmed().toInt(), 99 - nextWorker);
+
+        // Started together once every process is up
+        qint64 startAt = QDateTime::currentMSecsSinceEpoch() + 1000 + 100 * processes;
+        std::vector<std::unique_ptr<QProcess>> workers;
+        for (int i = 0; i < processes; ++i) {
+            auto process = std::make_unique<QProcess>();
+            process->setProcessChannelMode(QProcess::ForwardedErrorChannel);
+            process->start(QCoreApplication::applicationFilePath(),
+                           {"--worker", QString::number(nextWorker++), "--start-at", QString::number(startAt),
+                            "--duration", QString::number(durationSec), "--db", path,
+                            "--busy-timeout", parser.value(busyTimeoutOption),
+                            "--max-attempts", QString::number(policy.maxAttempts),
+                            "--seed", QString::number(seed)});
+            workers.push_back(std::move(process));
+        }
+
+        QJsonObject round;
+        round["processes"] = processes;
+        qint64 totals[7] = {};
+        const char* keys[7] = {"ops", "writes", "failures", "busyErrors", "retries", "exhausted", "backoffMs"};
+        double slowest = 0;
+        int crashed = 0;
+        for (auto& process : workers) {
+            process->waitForFinished(static_cast<int>(durationSec * 1000) + 60000);
+            QJsonObject summary = QJsonDocument::fromJson(process->readAllStandardOutput().trimmed()).object();
+            if (process->exitCode() != 0 || summary.isEmpty()) {
+                ++crashed;
+                continue;
+            }
+            for (int k = 0; k < 7; ++k) {
+                totals[k] += summary[keys[k]].toVariant().toLongLong();
+            }
+            slowest = qMax(slowest, summary["seconds"].toDouble());
+        }
+        for (int k = 0; k < 7; ++k) {
+            round[keys[k]] = totals[k];
+        }
+        round["opsPerSec"] = slowest > 0 ? totals[0] / slowest : 0.0;
+        round["writesPerSec"] = slowest > 0 ? totals[1] / slowest : 0.0;
+        round["failedWorkers"] = crashed;
+        out << QJsonDocument(round).toJson(QJsonDocument::Compact) << "\n";
+        out.flush();
+    }
+    return 0;
+}
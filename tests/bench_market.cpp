@@ -0,0 +1,151 @@
+// Google Benchmark microbenchmarks for the service layer.
+//
+// Row-count parameterized benchmarks run against databases generated once per
+// size (1K/100K/1M users, a tenth as many reports, see dataset_generator) and
+// kept in the temp directory, so reruns skip seeding. Compare commits with
+//   bench_market --benchmark_format=json --benchmark_out=results.json
+// or the bench_json CMake target.
+#include <benchmark/benchmark.h>
+#include <QCoreApplication>
+#include <QDir>
+#include <QFile>
+#include <QLoggingCategory>
+#include <random>
+#include "AdminService.h"
+#include "AuthService.h"
+#include "DatabaseManager.h"
+#include "dataset_generator.h"
+
+static const char* kBenchPassword = "benchpwd1";
+
+// Points DatabaseManager at a database holding exactly `rows` seeded users,
+// creating it on first use.
+static void useSeededDatabase(qint64 rows) {
+    QString path = QDir::temp().filePath(QString("marketsystem_bench_%1.db").arg(rows));
+    QString readyMarker = path + ".ready";
+    if (!QFile::exists(readyMarker)) {
+        QFile::remove(path);
+    }
+    DatabaseManager::setDatabasePath(path);
+    DatabaseManager::getInstance();
+    if (QFile::exists(readyMarker)) {
+        return;
+    }
+
+    DatasetOptions options;
+    options.users = rows;
+    options.reports = rows / 10;
+    options.bannedRatio = 0;  // LoginUser picks arbitrary seeded accounts
+    DatasetStats stats;
+    if (!DatasetGenerator(options).run(&stats)) {
+        qFatal("Failed to seed %s", qPrintable(path));
+    }
+
+    QFile marker(readyMarker);
+    marker.open(QIODevice::WriteOnly);
+}
+
+class SeededDatabase : public benchmark::Fixture {
+ public:
+    void SetUp(const benchmark::State& state) override {
+        rows = state.range(0);
+        useSeededDatabase(rows);
+    }
+
+    qint64 rows = 0;
+};
+
+#define SEEDED_SIZES ->Arg(1000)->Arg(100000)->Arg(1000000)->Unit(benchmark::kMicrosecond)
+
+static void BM_HashPassword(benchmark::State& state) {
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(AuthService::hashPassword(kBenchPassword));
+    }
+}
+BENCHMARK(BM_HashPassword);
+
+static void BM_ValidateUserInput(benchmark::State& state) {
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(AuthService::validateUserInput("13512345678", kBenchPassword, "bench"));
+    }
+}
+BENCHMARK(BM_ValidateUserInput);
+
+static void BM_GetInstance(benchmark::State& state) {
+    useSeededDatabase(1000);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(&DatabaseManager::getInstance());
+    }
+}
+BENCHMARK(BM_GetInstance);
+
+BENCHMARK_DEFINE_F(SeededDatabase, IsPhoneRegistered)(benchmark::State& state) {
+    std::mt19937_64 rng(1);
+    std::uniform_int_distribution<qint64> pick(0, rows - 1);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(AuthService::isPhoneRegistered(DatasetGenerator::phoneForIndex(pick(rng))));
+    }
+}
+BENCHMARK_REGISTER_F(SeededDatabase, IsPhoneRegistered) SEEDED_SIZES;
+
+BENCHMARK_DEFINE_F(SeededDatabase, LoginUser)(benchmark::State& state) {
+    std::mt19937_64 rng(2);
+    std::uniform_int_distribution<qint64> pick(0, rows - 1);
+    for (auto _ : state) {
+        qint64 index = pick(rng);
+        auto result = AuthService::loginUser(DatasetGenerator::phoneForIndex(index),
+                                             DatasetGenerator::passwordForIndex(index));
+        if (!result.first) {
+            state.SkipWithError("login failed");
+            break;
+        }
+    }
+}
+BENCHMARK_REGISTER_F(SeededDatabase, LoginUser) SEEDED_SIZES;
+
+BENCHMARK_DEFINE_F(SeededDatabase, RegisterUser)(benchmark::State& state) {
+    // Fresh 136x phones; rows added here are removed again after the run.
+    static qint64 sequence = 0;
+    for (auto _ : state) {
+        QString phone = QString("136%1").arg(sequence++, 8, 10, QChar('0'));
+        benchmark::DoNotOptimize(AuthService::registerUser(phone, kBenchPassword, "new"));
+    }
+    DatabaseManager::getInstance().executeQuery("DELETE FROM users WHERE phone LIKE '136%'");
+}
+BENCHMARK_REGISTER_F(SeededDatabase, RegisterUser) SEEDED_SIZES;
+
+BENCHMARK_DEFINE_F(SeededDatabase, GetAllUsersFirstPage)(benchmark::State& state) {
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(AdminService::getAllUsers(0, 100));
+    }
+}
+BENCHMARK_REGISTER_F(SeededDatabase, GetAllUsersFirstPage) SEEDED_SIZES;
+
+BENCHMARK_DEFINE_F(SeededDatabase, GetAllUsersLastPage)(benchmark::State& state) {
+    int lastPage = static_cast<int>(rows / 100) - 1;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(AdminService::getAllUsers(lastPage, 100));
+    }
+}
+BENCHMARK_REGISTER_F(SeededDatabase, GetAllUsersLastPage) SEEDED_SIZES;
+
+BENCHMARK_DEFINE_F(SeededDatabase, GetReports)(benchmark::State& state) {
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(AdminService::getReports(0, 100));
+    }
+}
+BENCHMARK_REGISTER_F(SeededDatabase, GetReports) SEEDED_SIZES;
+
+int main(int argc, char** argv) {
+    QCoreApplication app(argc, argv);
+    // Per-call debug logging would dominate the measurements.
+    QLoggingCategory::setFilterRules("*.debug=false");
+
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+        return 1;
+    }
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
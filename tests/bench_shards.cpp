@@ -0,0 +1,131 @@
+// Write throughput across shard files.
+//
+//   bench_shards --shards 0,1,2,4,8 --threads 8 --duration 5
+//
+// For each shard count, worker threads register new users through
+// AuthService for the given time; 0 keeps them in the main database file.
+// Every registration is its own commit, so with one file the threads take
+// turns on its write lock, while with N shards up to N commit at once. One
+// JSON line per round goes to stdout with the registrations per second,
+// failures, busy/retry counters and the time of one fan-out listing page
+// (AdminService::listUsersAfter) over everything registered so far.
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QLoggingCategory>
+#include <QTextStream>
+#include <QDebug>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include "AdminService.h"
+#include "AuthService.h"
+#include "DatabaseManager.h"
+#include "ShardRouter.h"
+
+using Clock = std::chrono::steady_clock;
+
+static const char* kBenchPassword = "shards123";
+static const int kMaxShards = 64;
+
+// 17 + round + two-digit thread + sequence: unique across rounds and threads.
+static QString benchPhone(int round, int thread, int sequence) {
+    return QString("17%1%2%3").arg(round % 10).arg(thread, 2, 10, QChar('0')).arg(sequence, 6, 10, QChar('0'));
+}
+
+int main(int argc, char** argv) {
+    QCoreApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("MarketSystem shard write benchmark");
+    parser.addHelpOption();
+    QCommandLineOption shardsOption("shards", "Comma-separated shard counts, one round each (0 = no sharding).",
+                                    "list", "0,1,2,4,8");
+    QCommandLineOption threadsOption("threads", "Registering threads.", "count", "8");
+    QCommandLineOption durationOption("duration", "Seconds per round.", "seconds", "5");
+    QCommandLineOption dbOption("db", "Main database file; it and its shard files are recreated.", "path",
+                                QDir::temp().filePath("market_shards.db"));
+    parser.addOptions({shardsOption, threadsOption, durationOption, dbOption});
+    parser.process(app);
+
+    QLoggingCategory::setFilterRules("*.debug=false\n*.warning=false");
+
+    int threads = qBound(1, parser.value(threadsOption).toInt(), 99);
+    double durationSec = qMax(0.1, parser.value(durationOption).toDouble());
+    QString path = parser.value(dbOption);
+    DatabaseManager::setDatabasePath(path);
+    QFile::remove(path);
+    for (int shard = 0; shard < kMaxShards; ++shard) {
+        QFile::remove(ShardRouter::shardPath(shard));
+    }
+    if (!DatabaseManager::getInstance().isOpen()) {
+        qCritical() << "Database is not available:" << path;
+        return 1;
+    }
+
+    QTextStream out(stdout);
+    ShardRouter& router = ShardRouter::getInstance();
+    const QStringList counts = parser.value(shardsOption).split(',', Qt::SkipEmptyParts);
+    for (int round = 0; round < counts.size(); ++round) {
+        int shards = qBound(0, counts[round].trimmed().toInt(), kMaxShards);
+
+        // Files made for another count are refused, so every round starts over
+        router.configure(0);
+        for (int shard = 0; shard < kMaxShards; ++shard) {
+            QFile::remove(ShardRouter::shardPath(shard));
+        }
+        if (!router.configure(shards)) {
+            qCritical() << "Failed to create" << shards << "shard files";
+            return 1;
+        }
+        DatabaseManager::resetBusyStats();
+
+        std::atomic<qint64> writes{0};
+        std::atomic<qint64> failures{0};
+        Clock::time_point end = Clock::now() + std::chrono::duration_cast<Clock::duration>(
+            std::chrono::duration<double>(durationSec));
+        Clock::time_point start = Clock::now();
+        std::vector<std::thread> workers;
+        for (int t = 0; t < threads; ++t) {
+            workers.emplace_back([&, t]() {
+                for (int sequence = 0; Clock::now() < end; ++sequence) {
+                    if (AuthService::registerUser(benchPhone(round, t, sequence), kBenchPassword).first) {
+                        ++writes;
+                    } else {
+                        ++failures;
+                    }
+                }
+            });
+        }
+        for (std::thread& worker : workers) {
+            worker.join();
+        }
+        double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+
+        QElapsedTimer listing;
+        listing.start();
+        bool listed = AdminService::listUsersAfter(ListCursor(), 50).ok;
+        qint64 listingUs = listing.nsecsElapsed() / 1000;
+
+        DatabaseManager::BusyStats busy = DatabaseManager::busyStats();
+        QJsonObject result;
+        result["shards"] = shards;
+        result["threads"] = threads;
+        result["seconds"] = elapsed;
+        result["writes"] = writes.load();
+        result["failures"] = failures.load();
+        result["writesPerSec"] = elapsed > 0 ? writes.load() / elapsed : 0.0;
+        result["busyErrors"] = static_cast<qint64>(busy.busyErrors);
+        result["retries"] = static_cast<qint64>(busy.retries);
+        result["listingUs"] = listed ? listingUs : -1;
+        out << QJsonDocument(result).toJson(QJsonDocument::Compact) << "\n";
+        out.flush();
+    }
+    router.configure(0);
+    return 0;
+}
@@ -0,0 +1,301 @@
+#include "dataset_generator.h"
+#include <QElapsedTimer>
+#include <QSqlQuery>
+#include <QSqlError>
+#include <QStringList>
+#include <QDebug>
+#include <cmath>
+#include <numeric>
+#include <random>
+#include "AuthService.h"
+#include "DatabaseManager.h"
+
+namespace {
+
+const int kRowsPerStatement = 64;  // 64 rows x 7 columns stays under 999 parameters
+const int kPasswordVariants = 256;
+// Second digit 4-9 then nine digits; 13x is left out so generated phones can
+// never collide with the default admin account (13800138000).
+const quint64 kPhoneSpace = 6000000000ULL;
+const quint64 kPhoneMultiplier = 2654435761ULL;  // coprime with kPhoneSpace
+const quint64 kPhoneOffset = 1234567891ULL;
+
+const char* const kReasons[] = {
+    "Spam", "Fraudulent listing", "Harassment", "Counterfeit goods",
+    "Payment not received", "Item not as described", "Abusive language", "Other"
+};
+const char* const kStatuses[] = {"pending", "resolved", "rejected"};
+
+// Days since 1970-01-01 to a civil date (H. Hinnant's algorithm); avoids a
+// QDateTime per generated row.
+void civilFromDays(qint64 days, int* year, unsigned* month, unsigned* day) {
+    days += 719468;
+    qint64 era = (days >= 0 ? days : days - 146096) / 146097;
+    unsigned doe = static_cast<unsigned>(days - era * 146097);
+    unsigned yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    unsigned doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    unsigned mp = (5 * doy + 2) / 153;
+    *day = doy - (153 * mp + 2) / 5 + 1;
+    *month = mp < 10 ? mp + 3 : mp - 9;
+    *year = static_cast<int>(yoe + era * 400 + (*month <= 2));
+}
+
+QString sqliteTimestamp(qint64 secs) {
+    int year;
+    unsigned month;
+    unsigned day;
+    civilFromDays(secs / 86400, &year, &month, &day);
+    qint64 rem = secs % 86400;
+    char text[20];
+    qsnprintf(text, sizeof(text), "%04d-%02u-%02u %02d:%02d:%02d", year, month, day,
+              static_cast<int>(rem / 3600), static_cast<int>(rem / 60 % 60), static_cast<int>(rem % 60));
+    return QString::fromLatin1(text, 19);
+}
+
+// Recent-heavy account ages: squaring a uniform variate puts half of the
+// accounts in the most recent ~29% of the span.
+qint64 skewedTimestamp(const DatasetOptions& options, std::mt19937_64& rng) {
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    double u = unit(rng);
+    qint64 ageSecs = static_cast<qint64>(u * u * options.spanDays * 86400.0);
+    return options.nowSecs - ageSecs;
+}
+
+// Rejection-inversion Zipf sampler (Hormann & Derflinger 1996): O(1) memory
+// and expected O(1) time per sample for any number of elements.
+class ZipfSampler {
+ public:
+    ZipfSampler(qint64 elements, double exponent)
+        : m_n(elements), m_s(exponent) {
+        m_hIntegralX1 = hIntegral(1.5) - 1.0;
+        m_hIntegralN = hIntegral(m_n + 0.5);
+        m_cutoff = 2.0 - hIntegralInverse(hIntegral(2.5) - h(2.0));
+    }
+
+    // Returns a rank in [1, elements]; rank 1 is the most frequent.
+    qint64 sample(std::mt19937_64& rng) const {
+        std::uniform_real_distribution<double> unit(0.0, 1.0);
+        while (true) {
+            double u = m_hIntegralN + unit(rng) * (m_hIntegralX1 - m_hIntegralN);
+            double x = hIntegralInverse(u);
+            qint64 k = static_cast<qint64>(x + 0.5);
+            k = qBound<qint64>(1, k, m_n);
+            if (k - x <= m_cutoff || u >= hIntegral(k + 0.5) - h(static_cast<double>(k))) {
+                return k;
+            }
+        }
+    }
+
+ private:
+    qint64 m_n;
+    double m_s;
+    double m_hIntegralX1;
+    double m_hIntegralN;
+    double m_cutoff;
+
+    double h(double x) const { return std::exp(-m_s * std::log(x)); }
+
+    double hIntegral(double x) const {
+        double logX = std::log(x);
+        return helper2((1.0 - m_s) * logX) * logX;
+    }
+
+    double hIntegralInverse(double x) const {
+        double t = qMax(-1.0, x * (1.0 - m_s));
+        return std::exp(helper1(t) * x);
+    }
+
+    static double helper1(double x) {
+        return std::fabs(x) > 1e-8 ? std::log1p(x) / x : 1.0 - x * (0.5 - x * (1.0 / 3.0 - 0.25 * x));
+    }
+
+    static double helper2(double x) {
+        return std::fabs(x) > 1e-8 ? std::expm1(x) / x : 1.0 + x * 0.5 * (1.0 + x * (1.0 / 3.0) * (1.0 + 0.25 * x));
+    }
+};
+
+QString valuesClause(int rows, int columns) {
+    QStringList placeholders;
+    for (int i = 0; i < columns; ++i) {
+        placeholders.append("?");
+    }
+    QString row = "(" + placeholders.join(", ") + ")";
+    QStringList all;
+    all.reserve(rows);
+    for (int i = 0; i < rows; ++i) {
+        all.append(row);
+    }
+    return all.join(", ");
+}
+
+}  // namespace
+
+QString DatasetGenerator::phoneForIndex(qint64 index) {
+    // Affine permutation of the phone space: unique per index, scattered
+    // like real numbers instead of sequential.
+    quint64 value = (static_cast<quint64>(index) * kPhoneMultiplier + kPhoneOffset) % kPhoneSpace;
+    char text[12];
+    qsnprintf(text, sizeof(text), "1%u%09llu", static_cast<unsigned>(4 + value / 1000000000ULL),
+              static_cast<unsigned long long>(value % 1000000000ULL));
+    return QString::fromLatin1(text, 11);
+}
+
+QString DatasetGenerator::passwordForIndex(qint64 index) {
+    return QString("password%1").arg(index % kPasswordVariants);
+}
+
+bool DatasetGenerator::run(DatasetStats* stats) {
+    QElapsedTimer timer;
+    timer.start();
+    DatabaseManager& db = DatabaseManager::getInstance();
+
+    // Bulk-load settings; the file is only trusted once the load completes.
+    QSqlQuery pragma(db.getDatabase());
+    pragma.exec("PRAGMA journal_mode = OFF");
+    pragma.exec("PRAGMA synchronous = OFF");
+    pragma.exec("PRAGMA cache_size = -262144");  // 256 MiB
+
+    QSqlQuery firstId = db.executeQueryWithResult("SELECT IFNULL(MAX(id), 0) + 1 FROM users");
+    qint64 minUserId = firstId.next() ? firstId.value(0).toLongLong() : 1;
+    firstId.finish();
+
+    qint64 users = 0;
+    if (!insertUsers(&users)) {
+        return false;
+    }
+
+    qint64 reports = 0;
+    if (m_options.reports > 0 && users > 0
+        && !insertReports(minUserId, minUserId + users - 1, &reports)) {
+        return false;
+    }
+
+    db.executeQuery("INSERT OR IGNORE INTO admins (user_id) SELECT id FROM users WHERE is_admin = 1");
+    pragma.exec("PRAGMA synchronous = FULL");
+    pragma.exec("PRAGMA journal_mode = WAL");  // as DatabaseManager opens it
+
+    stats->users = users;
+    stats->reports = reports;
+    stats->seconds = timer.nsecsElapsed() / 1e9;
+    return true;
+}
+
+bool DatasetGenerator::insertUsers(qint64* inserted) {
+    DatabaseManager& db = DatabaseManager::getInstance();
+    std::mt19937_64 rng(m_options.seed);
+    std::bernoulli_distribution banned(m_options.bannedRatio);
+    std::bernoulli_distribution admin(m_options.adminRatio);
+
+    QString passwordHashes[kPasswordVariants];
+    for (int i = 0; i < kPasswordVariants; ++i) {
+        passwordHashes[i] = AuthService::hashPassword(passwordForIndex(i));
+    }
+
+    const QString prefix = "INSERT OR IGNORE INTO users "
+        "(phone, password, username, created_at, is_admin, is_banned, id) VALUES ";
+    QSqlQuery full(db.getDatabase());
+    if (!full.prepare(prefix + valuesClause(kRowsPerStatement, 7))) {
+        qWarning() << "Failed to prepare user insert:" << full.lastError().text();
+        return false;
+    }
+
+    // Explicit ids keep users contiguous so reports can pick ids arithmetically.
+    QSqlQuery nextId = db.executeQueryWithResult("SELECT IFNULL(MAX(id), 0) + 1 FROM users");
+    qint64 id = nextId.next() ? nextId.value(0).toLongLong() : 1;
+    nextId.finish();
+
+    qint64 index = 0;
+    db.beginTransaction();
+    while (index < m_options.users) {
+        int rows = static_cast<int>(qMin<qint64>(kRowsPerStatement, m_options.users - index));
+        QSqlQuery partial(db.getDatabase());
+        QSqlQuery& insert = rows == kRowsPerStatement ? full : partial;
+        if (rows != kRowsPerStatement) {
+            partial.prepare(prefix + valuesClause(rows, 7));
+        }
+
+        int param = 0;
+        for (int r = 0; r < rows; ++r, ++index) {
+            insert.bindValue(param++, phoneForIndex(index));
+            insert.bindValue(param++, passwordHashes[index % kPasswordVariants]);
+            insert.bindValue(param++, QString("user%1").arg(index));
+            insert.bindValue(param++, sqliteTimestamp(skewedTimestamp(m_options, rng)));
+            insert.bindValue(param++, admin(rng) ? 1 : 0);
+            insert.bindValue(param++, banned(rng) ? 1 : 0);
+            insert.bindValue(param++, id + index);
+        }
+        if (!insert.exec()) {
+            qWarning() << "User insert failed:" << insert.lastError().text();
+            db.rollbackTransaction();
+            return false;
+        }
+        *inserted += insert.numRowsAffected();
+
+        if (index % m_options.transactionRows < kRowsPerStatement) {
+            db.commitTransaction();
+            db.beginTransaction();
+        }
+    }
+    full.finish();
+    return db.commitTransaction();
+}
+
+bool DatasetGenerator::insertReports(qint64 minUserId, qint64 maxUserId, qint64* inserted) {
+    DatabaseManager& db = DatabaseManager::getInstance();
+    std::mt19937_64 rng(m_options.seed ^ 0x9E3779B97F4A7C15ULL);
+    qint64 userCount = maxUserId - minUserId + 1;
+    std::uniform_int_distribution<qint64> reporter(minUserId, maxUserId);
+    std::discrete_distribution<int> status({60, 30, 10});
+    std::uniform_int_distribution<int> reason(0, static_cast<int>(sizeof(kReasons) / sizeof(kReasons[0])) - 1);
+    ZipfSampler zipf(userCount, m_options.zipfExponent);
+
+    // Scatter Zipf ranks over ids so the most reported users are not simply
+    // the oldest ones.
+    quint64 multiplier = 2246822519ULL % static_cast<quint64>(userCount);
+    while (userCount > 1 && std::gcd(multiplier, static_cast<quint64>(userCount)) != 1) {
+        ++multiplier;
+    }
+
+    const QString prefix = "INSERT INTO reports "
+        "(reporter_id, reported_user_id, reason, status, created_at) VALUES ";
+    QSqlQuery full(db.getDatabase());
+    if (!full.prepare(prefix + valuesClause(kRowsPerStatement, 5))) {
+        qWarning() << "Failed to prepare report insert:" << full.lastError().text();
+        return false;
+    }
+
+    qint64 index = 0;
+    db.beginTransaction();
+    while (index < m_options.reports) {
+        int rows = static_cast<int>(qMin<qint64>(kRowsPerStatement, m_options.reports - index));
+        QSqlQuery partial(db.getDatabase());
+        QSqlQuery& insert = rows == kRowsPerStatement ? full : partial;
+        if (rows != kRowsPerStatement) {
+            partial.prepare(prefix + valuesClause(rows, 5));
+        }
+
+        int param = 0;
+        for (int r = 0; r < rows; ++r, ++index) {
+            quint64 rank = static_cast<quint64>(zipf.sample(rng) - 1);
+            qint64 reported = minUserId + static_cast<qint64>((rank * multiplier) % userCount);
+            insert.bindValue(param++, reporter(rng));
+            insert.bindValue(param++, reported);
+            insert.bindValue(param++, kReasons[reason(rng)]);
+            insert.bindValue(param++, kStatuses[status(rng)]);
+            insert.bindValue(param++, sqliteTimestamp(skewedTimestamp(m_options, rng)));
+        }
+        if (!insert.exec()) {
+            qWarning() << "Report insert failed:" << insert.lastError().text();
+            db.rollbackTransaction();
+            return false;
+        }
+        *inserted += rows;
+
+        if (index % m_options.transactionRows < kRowsPerStatement) {
+            db.commitTransaction();
+            db.beginTransaction();
+        }
+    }
+    full.finish();
+    return db.commitTransaction();
+}
@@ -0,0 +1,47 @@
+// Deterministic synthetic users/reports for benchmarks and scaling tests.
+#ifndef DATASET_GENERATOR_H
+#define DATASET_GENERATOR_H
+
+#include <QString>
+#include <QtGlobal>
+
+struct DatasetOptions {
+    qint64 users = 100000;
+    qint64 reports = 10000;
+    quint64 seed = 42;
+    double bannedRatio = 0.02;
+    double adminRatio = 0.001;
+    double zipfExponent = 1.1;   // skew of the reported-user choice
+    int spanDays = 730;          // created_at range ending at nowSecs
+    qint64 nowSecs = 1735689600; // 2025-01-01 00:00:00 UTC, fixed for reproducibility
+    int transactionRows = 200000;
+};
+
+struct DatasetStats {
+    qint64 users = 0;
+    qint64 reports = 0;
+    double seconds = 0;
+};
+
+// Fills the database DatabaseManager currently points at. Rows are written
+// with multi-row prepared INSERTs in large transactions, with journaling and
+// fsync disabled for the duration of the load.
+class DatasetGenerator {
+ public:
+    explicit DatasetGenerator(const DatasetOptions& options) : m_options(options) {}
+
+    bool run(DatasetStats* stats);
+
+    // Unique, valid (^1[4-9]\d{9}$) phone of the index-th generated user.
+    static QString phoneForIndex(qint64 index);
+    // Every generated user can log in with passwordForIndex(index).
+    static QString passwordForIndex(qint64 index);
+
+ private:
+    DatasetOptions m_options;
+
+    bool insertUsers(qint64* inserted);
+    bool insertReports(qint64 minUserId, qint64 maxUserId, qint64* inserted);
+};
+
+#endif  // DATASET_GENERATOR_H
@@ -4,44 +4,14 @@
 #include <QTextStream>
 #include <QVariantList>
 #include <iostream>
-#include "../src/AuthService.h"
-#include "../src/DatabaseManager.h"
+#include "AuthService.h"
+#include "DatabaseManager.h"
+#include "market_commands.h"
 
 static void processLine(const QString &line) {
-    QStringList parts = line.split(' ', Qt::SkipEmptyParts);
-    if (parts.isEmpty()) return;
-    QString cmd = parts[0].toUpper();
-
-    if (cmd == "REGISTER") {
-        QString phone = parts.value(1);
-        QString pass = parts.value(2);
-        QString user = parts.value(3);
-        AuthService::registerUser(phone, pass, user);
-    } else if (cmd == "LOGIN") {
-        QString phone = parts.value(1);
-        QString pass = parts.value(2);
-        AuthService::loginUser(phone, pass);
-    } else if (cmd == "HASH") {
-        QString pass = parts.value(1);
-        (void)AuthService::hashPassword(pass);
-    } else if (cmd == "VALIDATE") {
-        QString phone = parts.value(1);
-        QString pass = parts.value(2);
-        QString user = parts.value(3);
-        (void)AuthService::validateUserInput(phone, pass, user);
-    } else if (cmd == "ISBANNED") {
-        QString phone = parts.value(1);
-        (void)AuthService::isUserBanned(phone);
-    } else if (cmd == "ISBANNEDID") {
-        int id = parts.value(1).toInt();
-        (void)AuthService::isUserBannedById(id);
-    } else if (cmd == "SQL") {
-        // join remaining as a single SQL
-        QString sql = line.mid(cmd.length()).trimmed();
-        DatabaseManager::getInstance().executeQuery(sql, {});
-    } else if (cmd == "LASTID") {
-        (void)DatabaseManager::getInstance().getLastInsertId();
-    }
+    ParsedCommand command = parseCommand(line);
+    if (command.kind == MarketCommand::Unknown) return;
+    executeCommand(command);
 }
 
 int main(int argc, char **argv) {
@@ -0,0 +1,169 @@
+// Closed-loop benchmark client for the daemon's HTTP/JSON API.
+//
+//   http_bench --port 8080 --connections 16 --duration 10 --path /ping
+//   http_bench --port 8080 --method POST --path /login --token-file ~/.local/share/MarketSystem/daemon.token \
+//              --body '{"phone":"13800138000","password":"admin123"}'
+//
+// Everything but /ping needs the daemon's token (--token-file).
+//
+// Every connection is a keep-alive socket on its own thread that sends the
+// next request as soon as the previous response arrives. Prints one JSON
+// object with throughput and latency percentiles.
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QFile>
+#include <QTcpSocket>
+#include <QElapsedTimer>
+#include <QTextStream>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+struct WorkerStats {
+    std::vector<qint64> latenciesNs;
+    qint64 errors = 0;
+    qint64 rejected = 0;  // 503 from server backpressure
+};
+
+static bool readResponse(QTcpSocket& socket, QByteArray& buffer, int* status) {
+    int headerEnd = -1;
+    while ((headerEnd = buffer.indexOf("\r\n\r\n")) < 0) {
+        if (!socket.waitForReadyRead(5000)) {
+            return false;
+        }
+        buffer.append(socket.readAll());
+    }
+
+    QByteArray headers = buffer.left(headerEnd);
+    *status = headers.mid(9, 3).toInt();
+    qsizetype contentLength = 0;
+    for (const QByteArray& line : headers.split('\n')) {
+        if (line.toLower().startsWith("content-length:")) {
+            contentLength = line.mid(15).trimmed().toLongLong();
+        }
+    }
+
+    qsizetype total = headerEnd + 4 + contentLength;
+    while (buffer.size() < total) {
+        if (!socket.waitForReadyRead(5000)) {
+            return false;
+        }
+        buffer.append(socket.readAll());
+    }
+    buffer.remove(0, total);
+    return true;
+}
+
+static void runConnection(quint16 port, const QByteArray& request, qint64 deadlineNs,
+                          WorkerStats* stats) {
+    QTcpSocket socket;
+    socket.connectToHost("127.0.0.1", port);
+    if (!socket.waitForConnected(5000)) {
+        ++stats->errors;
+        return;
+    }
+
+    QByteArray buffer;
+    QElapsedTimer clock;
+    clock.start();
+    while (clock.nsecsElapsed() < deadlineNs) {
+        qint64 start = clock.nsecsElapsed();
+        socket.write(request);
+        int status = 0;
+        if (!socket.waitForBytesWritten(5000) || !readResponse(socket, buffer, &status)) {
+            ++stats->errors;
+            return;
+        }
+        if (status == 503) {
+            ++stats->rejected;
+        } else if (status >= 500) {
+            ++stats->errors;
+        }
+        stats->latenciesNs.push_back(clock.nsecsElapsed() - start);
+    }
+}
+
+static double percentileUs(const std::vector<qint64>& sorted, double p) {
+    if (sorted.empty()) {
+        return 0.0;
+    }
+    size_t index = std::min(sorted.size() - 1, static_cast<size_t>(p * sorted.size()));
+    return sorted[index] / 1000.0;
+}
+
+int main(int argc, char** argv) {
+    QCoreApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    QCommandLineOption portOption("port", "Server port on 127.0.0.1.", "port", "8080");
+    QCommandLineOption connectionsOption("connections", "Concurrent keep-alive connections.", "count", "8");
+    QCommandLineOption durationOption("duration", "Seconds to run.", "seconds", "10");
+    QCommandLineOption methodOption("method", "HTTP method.", "method", "GET");
+    QCommandLineOption pathOption("path", "Request target.", "path", "/ping");
+    QCommandLineOption bodyOption("body", "JSON request body.", "json", "");
+    QCommandLineOption tokenFileOption("token-file", "Daemon token file to send as a bearer token.", "path");
+    parser.addOptions({portOption, connectionsOption, durationOption, methodOption, pathOption, bodyOption,
+                       tokenFileOption});
+    parser.process(app);
+
+    quint16 port = static_cast<quint16>(parser.value(portOption).toUInt());
+    int connections = qMax(1, parser.value(connectionsOption).toInt());
+    qint64 durationNs = qMax(1, parser.value(durationOption).toInt()) * 1000000000LL;
+    QByteArray body = parser.value(bodyOption).toUtf8();
+
+    QByteArray method = parser.value(methodOption).toUtf8();
+    QByteArray request = method + ' ' + parser.value(pathOption).toUtf8()
+                         + " HTTP/1.1\r\nHost: 127.0.0.1:" + QByteArray::number(port)
+                         + "\r\nConnection: keep-alive\r\n";
+    if (parser.isSet(tokenFileOption)) {
+        QFile tokenFile(parser.value(tokenFileOption));
+        if (!tokenFile.open(QIODevice::ReadOnly)) {
+            QTextStream(stderr) << "Cannot read " << tokenFile.fileName() << '\n';
+            return 1;
+        }
+        request += "Authorization: Bearer " + tokenFile.readAll().trimmed() + "\r\n";
+    }
+    if (!body.isEmpty() || method == "POST") {
+        request += "Content-Type: application/json\r\nContent-Length: "
+                   + QByteArray::number(body.size()) + "\r\n";
+    }
+    request += "\r\n" + body;
+
+    std::vector<WorkerStats> stats(connections);
+    std::vector<std::thread> threads;
+    QElapsedTimer wall;
+    wall.start();
+    for (int i = 0; i < connections; ++i) {
+        threads.emplace_back(runConnection, port, request, durationNs, &stats[i]);
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    double elapsedSec = wall.nsecsElapsed() / 1e9;
+
+    std::vector<qint64> latencies;
+    qint64 errors = 0;
+    qint64 rejected = 0;
+    for (const WorkerStats& s : stats) {
+        latencies.insert(latencies.end(), s.latenciesNs.begin(), s.latenciesNs.end());
+        errors += s.errors;
+        rejected += s.rejected;
+    }
+    std::sort(latencies.begin(), latencies.end());
+
+    QTextStream out(stdout);
+    out << "{\"connections\":" << connections
+        << ",\"requests\":" << static_cast<qint64>(latencies.size())
+        << ",\"errors\":" << errors
+        << ",\"rejected\":" << rejected
+        << ",\"seconds\":" << elapsedSec
+        << ",\"requestsPerSec\":" << latencies.size() / elapsedSec
+        << ",\"p50Us\":" << percentileUs(latencies, 0.50)
+        << ",\"p99Us\":" << percentileUs(latencies, 0.99)
+        << ",\"p999Us\":" << percentileUs(latencies, 0.999)
+        << "}\n";
+    return errors == 0 ? 0 : 1;
+}
@@ -0,0 +1,363 @@
+// Multi-threaded load generator for the fuzz_market command language.
+//
+//   loadgen --threads 8 --rate 20000 --warmup 5 --duration 30 \
+//           --mix LOGIN=60,ISBANNED=20,REGISTER=10,HASH=10
+//   loadgen --threads 4 --script commands.txt --duration 10
+//
+// With --rate each thread follows a fixed open-loop schedule and latency is
+// measured from a command's intended start time, so a stalled database shows
+// up as queueing delay instead of silently lowering the offered load. With
+// --rate 0 every thread runs closed-loop as fast as it can. Results for the
+// measured window (after warmup) are printed as one JSON object.
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QFile>
+#include <QTextStream>
+#include <QThread>
+#include <QDebug>
+#include <QtAlgorithms>
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <random>
+#include <thread>
+#include <vector>
+#include "AuthService.h"
+#include "DatabaseManager.h"
+#include "market_commands.h"
+
+using Clock = std::chrono::steady_clock;
+
+// Log-linear latency histogram: 64 sub-buckets per power of two of
+// nanoseconds, about 1.5% relative error, fixed 4K counters.
+class LatencyHistogram {
+ public:
+    static const int kSubBits = 6;
+    static const int kSubBuckets = 1 << kSubBits;
+
+    void record(qint64 ns) {
+        ++m_counts[index(ns < 1 ? 1 : ns)];
+        ++m_total;
+    }
+
+    void merge(const LatencyHistogram& other) {
+        for (size_t i = 0; i < m_counts.size(); ++i) {
+            m_counts[i] += other.m_counts[i];
+        }
+        m_total += other.m_total;
+    }
+
+    qint64 count() const { return m_total; }
+
+    double percentileUs(double p) const {
+        if (m_total == 0) {
+            return 0.0;
+        }
+        qint64 rank = static_cast<qint64>(std::ceil(p * m_total));
+        qint64 seen = 0;
+        for (size_t i = 0; i < m_counts.size(); ++i) {
+            seen += m_counts[i];
+            if (seen >= rank) {
+                return upperBound(static_cast<int>(i)) / 1000.0;
+            }
+        }
+        return upperBound(static_cast<int>(m_counts.size()) - 1) / 1000.0;
+    }
+
+ private:
+    std::array<qint64, 64 * kSubBuckets> m_counts{};
+    qint64 m_total = 0;
+
+    static int index(qint64 ns) {
+        int magnitude = 63 - static_cast<int>(qCountLeadingZeroBits(static_cast<quint64>(ns)));
+        if (magnitude < kSubBits) {
+            return static_cast<int>(ns);
+        }
+        int shift = magnitude - kSubBits;
+        int sub = static_cast<int>((ns >> shift) & (kSubBuckets - 1));
+        return (shift + 1) * kSubBuckets + sub;
+    }
+
+    static qint64 upperBound(int bucket) {
+        int group = bucket / kSubBuckets;
+        if (group == 0) {
+            return bucket;
+        }
+        int shift = group - 1;
+        qint64 sub = bucket % kSubBuckets;
+        return ((kSubBuckets + sub + 1) << shift) - 1;
+    }
+};
+
+struct CommandStats {
+    LatencyHistogram latency;
+    qint64 errors = 0;
+};
+
+struct ThreadResult {
+    std::array<CommandStats, kMarketCommandCount> commands;
+    qint64 late = 0;  // commands that started behind schedule
+};
+
+struct Options {
+    int threads = 4;
+    double rate = 0;  // total commands per second, 0 = closed loop
+    double warmupSec = 2;
+    double durationSec = 10;
+    quint64 seed = 1;
+    QList<ParsedCommand> script;
+    std::array<int, kMarketCommandCount> mix{};
+    int mixTotal = 0;
+    QStringList knownPhones;
+};
+
+static const char* kLoadPassword = "loadgen123";
+
+// Builds a random command for the configured mix. REGISTER uses fresh
+// phones, lookups target the accounts seeded before the run.
+static ParsedCommand randomCommand(const Options& options, std::mt19937_64& rng, quint64* registerSeq,
+                                   int threadIndex) {
+    std::uniform_int_distribution<int> pick(0, options.mixTotal - 1);
+    int roll = pick(rng);
+    int kind = 0;
+    while (roll >= options.mix[kind]) {
+        roll -= options.mix[kind];
+        ++kind;
+    }
+
+    std::uniform_int_distribution<int> phoneIndex(0, options.knownPhones.size() - 1);
+    const QString& known = options.knownPhones[phoneIndex(rng)];
+
+    ParsedCommand command;
+    command.kind = static_cast<MarketCommand>(kind);
+    switch (command.kind) {
+    case MarketCommand::Register:
+        // 15x numbers are never used by the seed set; thread and sequence keep them unique.
+        command.args = {QString("15%1%2").arg(threadIndex, 2, 10, QChar('0'))
+                            .arg((*registerSeq)++ % 10000000, 7, 10, QChar('0')),
+                        kLoadPassword, "load"};
+        break;
+    case MarketCommand::Login:
+        command.args = {known, kLoadPassword};
+        break;
+    case MarketCommand::Hash:
+        command.args = {kLoadPassword};
+        break;
+    case MarketCommand::Validate:
+        command.args = {known, kLoadPassword, "load"};
+        break;
+    case MarketCommand::IsBanned:
+        command.args = {known};
+        break;
+    case MarketCommand::IsBannedId:
+        command.args = {QString::number(phoneIndex(rng) + 1)};
+        break;
+    case MarketCommand::Sql:
+        command.sql = "SELECT COUNT(*) FROM users WHERE is_banned = 1";
+        break;
+    default:
+        break;
+    }
+    return command;
+}
+
+static void runThread(const Options& options, int threadIndex, Clock::time_point start,
+                      ThreadResult* result) {
+    std::mt19937_64 rng(options.seed * 7919 + threadIndex);
+    quint64 registerSeq = 0;
+    int scriptPos = threadIndex;
+
+    const Clock::time_point measureFrom = start + std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double>(options.warmupSec));
+    const Clock::time_point end = measureFrom + std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double>(options.durationSec));
+
+    // Each thread owns an equal share of the offered rate, phase-shifted so
+    // the threads do not fire in lockstep.
+    Clock::duration interval{0};
+    Clock::time_point intended = start;
+    if (options.rate > 0) {
+        interval = std::chrono::duration_cast<Clock::duration>(
+            std::chrono::duration<double>(options.threads / options.rate));
+        intended += interval * threadIndex / options.threads;
+    }
+
+    while (true) {
+        Clock::time_point now = Clock::now();
+        if (now >= end) {
+            break;
+        }
+        if (options.rate > 0) {
+            if (intended > now) {
+                std::this_thread::sleep_until(intended);
+            } else if (now - intended > interval) {
+                ++result->late;
+            }
+        } else {
+            intended = now;
+        }
+
+        ParsedCommand command;
+        if (!options.script.isEmpty()) {
+            command = options.script[scriptPos % options.script.size()];
+            scriptPos += options.threads;
+        } else {
+            command = randomCommand(options, rng, &registerSeq, threadIndex);
+        }
+
+        bool ok = executeCommand(command);
+        Clock::time_point done = Clock::now();
+
+        if (intended >= measureFrom && command.kind != MarketCommand::Unknown) {
+            CommandStats& stats = result->commands[static_cast<int>(command.kind)];
+            stats.latency.record(std::chrono::duration_cast<std::chrono::nanoseconds>(done - intended).count());
+            if (!ok) {
+                ++stats.errors;
+            }
+        }
+
+        if (options.rate > 0) {
+            intended += interval;
+        }
+    }
+}
+
+static bool parseMix(const QString& spec, Options* options) {
+    for (const QString& entry : spec.split(',', Qt::SkipEmptyParts)) {
+        QStringList pair = entry.split('=');
+        MarketCommand kind = commandFromName(pair.value(0).trimmed());
+        int weight = pair.value(1).toInt();
+        if (kind == MarketCommand::Unknown || weight < 0) {
+            return false;
+        }
+        options->mix[static_cast<int>(kind)] = weight;
+        options->mixTotal += weight;
+    }
+    return options->mixTotal > 0;
+}
+
+static void writeStats(QTextStream& out, const CommandStats& stats, double seconds) {
+    out << "{\"count\":" << stats.latency.count()
+        << ",\"errors\":" << stats.errors
+        << ",\"throughput\":" << stats.latency.count() / seconds
+        << ",\"p50Us\":" << stats.latency.percentileUs(0.50)
+        << ",\"p99Us\":" << stats.latency.percentileUs(0.99)
+        << ",\"p999Us\":" << stats.latency.percentileUs(0.999)
+        << "}";
+}
+
+int main(int argc, char** argv) {
+    QCoreApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("MarketSystem load generator");
+    parser.addHelpOption();
+    QCommandLineOption threadsOption("threads", "Worker threads.", "count", "4");
+    QCommandLineOption rateOption("rate", "Total commands/sec (open loop); 0 runs closed loop.", "rate", "0");
+    QCommandLineOption warmupOption("warmup", "Warmup seconds, not measured.", "seconds", "2");
+    QCommandLineOption durationOption("duration", "Measured seconds.", "seconds", "10");
+    QCommandLineOption scriptOption("script", "Replay commands from this file.", "file");
+    QCommandLineOption mixOption("mix", "Random mix as COMMAND=weight,...", "mix",
+                                 "LOGIN=60,ISBANNED=20,REGISTER=10,HASH=10");
+    QCommandLineOption seedOption("seed", "Random seed.", "seed", "1");
+    QCommandLineOption usersOption("seed-users", "Accounts registered before the run.", "count", "10000");
+    QCommandLineOption appNameOption("app-name", "Application name selecting the data directory.", "name");
+    parser.addOptions({threadsOption, rateOption, warmupOption, durationOption, scriptOption,
+                       mixOption, seedOption, usersOption, appNameOption});
+    parser.process(app);
+
+    if (parser.isSet(appNameOption)) {
+        QCoreApplication::setApplicationName(parser.value(appNameOption));
+    }
+
+    Options options;
+    // Two digits of the thread index go into registered phone numbers
+    options.threads = qBound(1, parser.value(threadsOption).toInt(), 99);
+    options.rate = qMax(0.0, parser.value(rateOption).toDouble());
+    options.warmupSec = qMax(0.0, parser.value(warmupOption).toDouble());
+    options.durationSec = qMax(0.1, parser.value(durationOption).toDouble());
+    options.seed = parser.value(seedOption).toULongLong();
+
+    if (parser.isSet(scriptOption)) {
+        QFile file(parser.value(scriptOption));
+        if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+            qCritical() << "Cannot open script" << file.fileName();
+            return 1;
+        }
+        QTextStream in(&file);
+        while (!in.atEnd()) {
+            ParsedCommand command = parseCommand(in.readLine());
+            if (command.kind != MarketCommand::Unknown) {
+                options.script.append(command);
+            }
+        }
+        if (options.script.isEmpty()) {
+            qCritical() << "Script has no commands";
+            return 1;
+        }
+    } else if (!parseMix(parser.value(mixOption), &options)) {
+        qCritical() << "Invalid --mix" << parser.value(mixOption);
+        return 1;
+    }
+
+    DatabaseManager& db = DatabaseManager::getInstance();
+    if (!db.isOpen()) {
+        qCritical() << "Database is not available:" << db.getLastError();
+        return 1;
+    }
+
+    // Seed accounts for LOGIN/ISBANNED in one bulk call; existing ones are reused.
+    int seedUsers = qMax(1, parser.value(usersOption).toInt());
+    RegistrationBatch batch;
+    for (int i = 0; i < seedUsers; ++i) {
+        batch.phones.append(QString("139%1").arg(i, 8, 10, QChar('0')));
+        batch.passwords.append(kLoadPassword);
+    }
+    AuthService::registerUsers(batch);
+    options.knownPhones = batch.phones;
+
+    std::vector<ThreadResult> results(options.threads);
+    std::vector<std::thread> threads;
+    Clock::time_point start = Clock::now();
+    for (int i = 0; i < options.threads; ++i) {
+        threads.emplace_back(runThread, std::cref(options), i, start, &results[i]);
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+
+    ThreadResult total;
+    for (const ThreadResult& result : results) {
+        for (int kind = 0; kind < kMarketCommandCount; ++kind) {
+            total.commands[kind].latency.merge(result.commands[kind].latency);
+            total.commands[kind].errors += result.commands[kind].errors;
+        }
+        total.late += result.late;
+    }
+
+    CommandStats overall;
+    QTextStream out(stdout);
+    out << "{\"threads\":" << options.threads
+        << ",\"rate\":" << options.rate
+        << ",\"warmupSec\":" << options.warmupSec
+        << ",\"durationSec\":" << options.durationSec
+        << ",\"lateStarts\":" << total.late
+        << ",\"commands\":{";
+    bool first = true;
+    for (int kind = 0; kind < kMarketCommandCount; ++kind) {
+        const CommandStats& stats = total.commands[kind];
+        if (stats.latency.count() == 0) {
+            continue;
+        }
+        overall.latency.merge(stats.latency);
+        overall.errors += stats.errors;
+        out << (first ? "" : ",") << "\"" << commandName(static_cast<MarketCommand>(kind)) << "\":";
+        writeStats(out, stats, options.durationSec);
+        first = false;
+    }
+    out << "},\"total\":";
+    writeStats(out, overall, options.durationSec);
+    out << "}\n";
+    return 0;
+}
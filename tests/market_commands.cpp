@@ -0,0 +1,66 @@
+#include "market_commands.h"
+#include "AuthService.h"
+#include "DatabaseManager.h"
+
+static const char* const kCommandNames[] = {
+    "REGISTER", "LOGIN", "HASH", "VALIDATE", "ISBANNED", "ISBANNEDID", "SQL", "LASTID"
+};
+
+const char* commandName(MarketCommand kind) {
+    int index = static_cast<int>(kind);
+    return index < kMarketCommandCount ? kCommandNames[index] : "UNKNOWN";
+}
+
+MarketCommand commandFromName(const QString& name) {
+    QString upper = name.toUpper();
+    for (int i = 0; i < kMarketCommandCount; ++i) {
+        if (upper == QLatin1String(kCommandNames[i])) {
+            return static_cast<MarketCommand>(i);
+        }
+    }
+    return MarketCommand::Unknown;
+}
+
+ParsedCommand parseCommand(const QString& line) {
+    ParsedCommand command;
+    QStringList parts = line.split(' ', Qt::SkipEmptyParts);
+    if (parts.isEmpty()) return command;
+
+    QString word = parts.takeFirst();
+    command.kind = commandFromName(word);
+    command.args = parts;
+    if (command.kind == MarketCommand::Sql) {
+        // join remaining as a single SQL
+        command.sql = line.trimmed().mid(word.length()).trimmed();
+    }
+    return command;
+}
+
+bool executeCommand(const ParsedCommand& command) {
+    const QStringList& args = command.args;
+
+    switch (command.kind) {
+    case MarketCommand::Register:
+        return AuthService::registerUser(args.value(0), args.value(1), args.value(2)).first;
+    case MarketCommand::Login:
+        return AuthService::loginUser(args.value(0), args.value(1)).first;
+    case MarketCommand::Hash:
+        return !AuthService::hashPassword(args.value(0)).isEmpty();
+    case MarketCommand::Validate:
+        (void)AuthService::validateUserInput(args.value(0), args.value(1), args.value(2));
+        return true;
+    case MarketCommand::IsBanned:
+        (void)AuthService::isUserBanned(args.value(0));
+        return true;
+    case MarketCommand::IsBannedId:
+        (void)AuthService::isUserBannedById(args.value(0).toInt());
+        return true;
+    case MarketCommand::Sql:
+        return DatabaseManager::getInstance().executeQuery(command.sql, {});
+    case MarketCommand::LastId:
+        return DatabaseManager::getInstance().getLastInsertId() >= 0;
+    case MarketCommand::Unknown:
+        break;
+    }
+    return false;
+}
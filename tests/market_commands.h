@@ -0,0 +1,47 @@
+// Command language shared by fuzz_market and loadgen.
+//
+// One command per line, arguments separated by spaces:
+//   REGISTER <phone> <password> [username]
+//   LOGIN <phone> <password>
+//   HASH <password>
+//   VALIDATE <phone> <password> [username]
+//   ISBANNED <phone>
+//   ISBANNEDID <id>
+//   SQL <statement...>
+//   LASTID
+#ifndef MARKET_COMMANDS_H
+#define MARKET_COMMANDS_H
+
+#include <QString>
+#include <QStringList>
+
+enum class MarketCommand {
+    Register,
+    Login,
+    Hash,
+    Validate,
+    IsBanned,
+    IsBannedId,
+    Sql,
+    LastId,
+    Unknown
+};
+
+const int kMarketCommandCount = static_cast<int>(MarketCommand::Unknown);
+
+struct ParsedCommand {
+    MarketCommand kind = MarketCommand::Unknown;
+    QStringList args;  // arguments after the command word
+    QString sql;       // full statement text for SQL
+};
+
+ParsedCommand parseCommand(const QString& line);
+
+// Runs the command against AuthService/DatabaseManager. Returns false when
+// the operation reported failure (rejected login, duplicate phone, SQL error).
+bool executeCommand(const ParsedCommand& command);
+
+const char* commandName(MarketCommand kind);
+MarketCommand commandFromName(const QString& name);
+
+#endif  // MARKET_COMMANDS_H
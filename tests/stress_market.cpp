@@ -0,0 +1,320 @@
+// Concurrency stress test for the service layer.
+//
+//   stress_market --threads 8 --duration 30
+//
+// Worker threads run a random mix of registrations, logins, bans, unbans and
+// listings against one database file for the given time. Every reported
+// success is counted, and afterwards the database must agree with the
+// counters:
+//   - no phone is stored twice, and a phone raced by several threads was
+//     created by exactly one successful registration;
+//   - a registration that reported success is stored, one that failed is not;
+//   - per user, successful bans and unbans alternate (no two concurrent bans
+//     both won), and the stored ban flag matches the last one.
+// Exits non-zero if any invariant is broken. Build with -DMARKET_TSAN=ON to
+// run it under ThreadSanitizer (see tsan.supp).
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QDir>
+#include <QFile>
+#include <QSet>
+#include <QLoggingCategory>
+#include <QTextStream>
+#include <QDebug>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <random>
+#include <thread>
+#include <vector>
+#include "AdminService.h"
+#include "AuthService.h"
+#include "DatabaseManager.h"
+
+using Clock = std::chrono::steady_clock;
+
+static const char* kStressPassword = "stress123";
+
+enum class StressOp { RegisterContested, RegisterUnique, RegisterBatch, Login, Ban, Unban, ListUsers,
+                      ListBanned, Count };
+
+static const int kOpWeights[] = {15, 10, 5, 25, 15, 15, 10, 5};
+static const char* kOpNames[] = {"registerContested", "registerUnique", "registerBatch", "login", "ban",
+                                 "unban", "listUsers", "listBanned"};
+static const int kOpCount = static_cast<int>(StressOp::Count);
+
+struct Options {
+    int threads = 8;
+    double durationSec = 10;
+    int users = 200;       // accounts banned/unbanned and logged into
+    int contested = 500;   // phones every thread races to register
+    quint64 seed = 1;
+};
+
+// Shared by all workers: the lists are read only, through const access so
+// no worker detaches them, and the counters are only touched through atomics.
+struct SharedState {
+    QStringList userPhones;
+    QList<int> userIds;
+    std::unique_ptr<std::atomic<int>[]> bans;
+    std::unique_ptr<std::atomic<int>[]> unbans;
+
+    QStringList contestedPhones;
+    std::unique_ptr<std::atomic<int>[]> contestedCreated;
+};
+
+struct ThreadResult {
+    qint64 ops[kOpCount] = {};
+    qint64 failures[kOpCount] = {};  // operations that should not have failed
+    QStringList uniqueCreated;
+    QStringList uniqueFailed;
+};
+
+static QString contestedPhone(int index) {
+    return QString("135%1").arg(index, 8, 10, QChar('0'));
+}
+
+// 15x numbers with a two-digit thread prefix cannot collide across threads.
+static QString uniquePhone(int threadIndex, int sequence) {
+    return QString("15%1%2").arg(threadIndex, 2, 10, QChar('0')).arg(sequence, 7, 10, QChar('0'));
+}
+
+static void runThread(const Options& options, const SharedState& shared, int threadIndex, Clock::time_point end,
+                      ThreadResult* result) {
+    std::mt19937_64 rng(options.seed * 7919 + threadIndex);
+    std::uniform_int_distribution<int> pickWeight(0, 99);
+    std::uniform_int_distribution<int> pickUser(0, shared.userIds.size() - 1);
+    std::uniform_int_distribution<int> pickContested(0, shared.contestedPhones.size() - 1);
+    int uniqueSeq = 0;
+
+    while (Clock::now() < end) {
+        int roll = pickWeight(rng);
+        int op = 0;
+        while (roll >= kOpWeights[op]) {
+            roll -= kOpWeights[op];
+            ++op;
+        }
+        ++result->ops[op];
+
+        switch (static_cast<StressOp>(op)) {
+        case StressOp::RegisterContested: {
+            int index = pickContested(rng);
+            if (AuthService::registerUser(shared.contestedPhones[index], kStressPassword, "stress").first) {
+                ++shared.contestedCreated[index];
+            }
+            break;
+        }
+        case StressOp::RegisterUnique: {
+            QString phone = uniquePhone(threadIndex, uniqueSeq++);
+            if (AuthService::registerUser(phone, kStressPassword, "stress").first) {
+                result->uniqueCreated.append(phone);
+            } else {
+                result->uniqueFailed.append(phone);
+                ++result->failures[op];
+            }
+            break;
+        }
+        case StressOp::RegisterBatch: {
+            RegistrationBatch batch;
+            QList<int> indexes;
+            for (int i = 0; i < 16; ++i) {
+                int index = pickContested(rng);
+                indexes.append(index);
+                batch.phones.append(shared.contestedPhones[index]);
+                batch.passwords.append(kStressPassword);
+            }
+            // Rows lost to a concurrent insert come back as DatabaseError
+            RegistrationResult outcome = AuthService::registerUsers(batch);
+            for (int i = 0; i < outcome.statuses.size(); ++i) {
+                if (outcome.statuses[i] == RegistrationStatus::Created) {
+                    ++shared.contestedCreated[indexes[i]];
+                }
+            }
+            break;
+        }
+        case StressOp::Login:
+            // Fails legitimately while the account is banned
+            AuthService::loginUser(shared.userPhones[pickUser(rng)], kStressPassword);
+            break;
+        case StressOp::Ban: {
+            int user = pickUser(rng);
+            if (AdminService::banUser(shared.userIds[user], "stress").first) {
+                ++shared.bans[user];
+            }
+            break;
+        }
+        case StressOp::Unban: {
+            int user = pickUser(rng);
+            if (AdminService::unbanUser(shared.userIds[user]).first) {
+                ++shared.unbans[user];
+            }
+            break;
+        }
+        case StressOp::ListUsers:
+            if (!AdminService::listUsers(0, 50).ok) {
+                ++result->failures[op];
+            }
+            break;
+        case StressOp::ListBanned:
+            if (!AdminService::listBannedUsers(0, 50).ok) {
+                ++result->failures[op];
+            }
+            break;
+        default:
+            break;
+        }
+    }
+}
+
+// Compares the database against the counters; returns the number of violations.
+static int verify(const SharedState& shared, const std::vector<ThreadResult>& results, QTextStream& err) {
+    DatabaseManager& db = DatabaseManager::getInstance();
+    int violations = 0;
+
+    QSqlQuery duplicates = db.executeQueryWithResult(
+        "SELECT phone, COUNT(*) FROM users GROUP BY phone HAVING COUNT(*) > 1");
+    while (duplicates.next()) {
+        err << "duplicate phone " << duplicates.value(0).toString() << " x" << duplicates.value(1).toInt() << "\n";
+        ++violations;
+    }
+
+    QSet<QString> stored;
+    QSqlQuery phones = db.executeQueryWithResult("SELECT phone FROM users", {}, true);
+    while (phones.next()) {
+        stored.insert(phones.value(0).toString());
+    }
+
+    for (int i = 0; i < shared.contestedPhones.size(); ++i) {
+        int created = shared.contestedCreated[i].load();
+        bool exists = stored.contains(shared.contestedPhones[i]);
+        if (created > 1 || exists != (created == 1)) {
+            err << "contested phone " << shared.contestedPhones[i] << ": " << created
+                << " successful registrations, stored=" << exists << "\n";
+            ++violations;
+        }
+    }
+
+    for (const ThreadResult& result : results) {
+        for (const QString& phone : result.uniqueCreated) {
+            if (!stored.contains(phone)) {
+                err << "registration of " << phone << " reported success but was lost\n";
+                ++violations;
+            }
+        }
+        for (const QString& phone : result.uniqueFailed) {
+            if (stored.contains(phone)) {
+                err << "registration of " << phone << " reported failure but was stored\n";
+                ++violations;
+            }
+        }
+    }
+
+    for (int i = 0; i < shared.userIds.size(); ++i) {
+        int net = shared.bans[i].load() - shared.unbans[i].load();
+        bool banned = AuthService::isUserBannedById(shared.userIds[i]);
+        if (net < 0 || net > 1 || banned != (net == 1)) {
+            err << "user " << shared.userIds[i] << ": " << shared.bans[i].load() << " bans, "
+                << shared.unbans[i].load() << " unbans, stored banned=" << banned << "\n";
+            ++violations;
+        }
+    }
+
+    return violations;
+}
+
+int main(int argc, char** argv) {
+    QCoreApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("MarketSystem concurrency stress test");
+    parser.addHelpOption();
+    QCommandLineOption threadsOption("threads", "Worker threads.", "count", "8");
+    QCommandLineOption durationOption("duration", "Seconds to run.", "seconds", "10");
+    QCommandLineOption usersOption("users", "Accounts targeted by ban/unban/login.", "count", "200");
+    QCommandLineOption contestedOption("contested", "Phones raced by concurrent registrations.", "count", "500");
+    QCommandLineOption seedOption("seed", "Random seed.", "seed", "1");
+    QCommandLineOption dbOption("db", "Database file, recreated on start.", "path",
+                                QDir::temp().filePath("market_stress.db"));
+    parser.addOptions({threadsOption, durationOption, usersOption, contestedOption, seedOption, dbOption});
+    parser.process(app);
+
+    // Per-call debug logging would dominate the run
+    QLoggingCategory::setFilterRules("*.debug=false");
+
+    Options options;
+    options.threads = qBound(1, parser.value(threadsOption).toInt(), 99);
+    options.durationSec = qMax(0.1, parser.value(durationOption).toDouble());
+    options.users = qMax(1, parser.value(usersOption).toInt());
+    options.contested = qMax(1, parser.value(contestedOption).toInt());
+    options.seed = parser.value(seedOption).toULongLong();
+
+    QString path = parser.value(dbOption);
+    QFile::remove(path);
+    DatabaseManager::setDatabasePath(path);
+    DatabaseManager& db = DatabaseManager::getInstance();
+    if (!db.isOpen()) {
+        qCritical() << "Database is not available:" << db.getLastError();
+        return 1;
+    }
+
+    SharedState shared;
+    RegistrationBatch batch;
+    for (int i = 0; i < options.users; ++i) {
+        batch.phones.append(QString("137%1").arg(i, 8, 10, QChar('0')));
+        batch.passwords.append(kStressPassword);
+    }
+    RegistrationResult seeded = AuthService::registerUsers(batch);
+    if (seeded.createdCount != options.users || seeded.ids.size() != options.users) {
+        qCritical() << "Seeding failed:" << seeded.createdCount << "of" << options.users << "users created";
+        return 1;
+    }
+    // Own copies: the workers' reads must not share data with batch and seeded
+    shared.userPhones = batch.phones;
+    shared.userPhones.detach();
+    shared.userIds = seeded.ids;
+    shared.userIds.detach();
+    shared.bans.reset(new std::atomic<int>[options.users]());
+    shared.unbans.reset(new std::atomic<int>[options.users]());
+    for (int i = 0; i < options.contested; ++i) {
+        shared.contestedPhones.append(contestedPhone(i));
+    }
+    shared.contestedCreated.reset(new std::atomic<int>[options.contested]());
+
+    std::vector<ThreadResult> results(options.threads);
+    std::vector<std::thread> threads;
+    Clock::time_point end = Clock::now() + std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double>(options.durationSec));
+    for (int i = 0; i < options.threads; ++i) {
+        threads.emplace_back(runThread, std::cref(options), std::cref(shared), i, end, &results[i]);
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+    int violations = verify(shared, results, err);
+
+    qint64 totalFailures = 0;
+    out << "{\"threads\":" << options.threads << ",\"durationSec\":" << options.durationSec << ",\"ops\":{";
+    for (int op = 0; op < kOpCount; ++op) {
+        qint64 count = 0;
+        qint64 failures = 0;
+        for (const ThreadResult& result : results) {
+            count += result.ops[op];
+            failures += result.failures[op];
+        }
+        totalFailures += failures;
+        out << (op ? "," : "") << "\"" << kOpNames[op] << "\":{\"count\":" << count
+            << ",\"failures\":" << failures << "}";
+    }
+    out << "},\"violations\":" << violations << "}\n";
+    out.flush();
+
+    // Unexpected failures (e.g. SQLITE_BUSY past the busy timeout) are
+    // reported but only broken invariants fail the run.
+    if (totalFailures > 0) {
+        err << totalFailures << " operations failed unexpectedly\n";
+    }
+    return violations == 0 ? 0 : 1;
+}
@@ -0,0 +1,251 @@
+#include <QtTest>
+#include <QStandardPaths>
+#include <QTemporaryDir>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSet>
+#include <thread>
+#include <vector>
+#include <memory>
+
+#include "AdminService.h"
+#include "AuditLog.h"
+#include "AuthService.h"
+#include "DatabaseManager.h"
+
+class AuditLogTest : public QObject {
+    Q_OBJECT
+
+private:
+    static AuditLog::Options smallSegments() {
+        AuditLog::Options options;
+        options.maxSegmentBytes = 4096;  // a few dozen records per segment
+        return options;
+    }
+
+    static AuditRecord ban(int userId, const QString& reason) {
+        AuditRecord record;
+        record.event = AuditEvent::UserBanned;
+        record.actorId = 1;
+        record.userId = userId;
+        record.detail = reason;
+        return record;
+    }
+
+private slots:
+    void initTestCase() {
+        QStandardPaths::setTestModeEnabled(true);
+    }
+
+    void testConcurrentAppendsShareSyncs() {
+        QTemporaryDir dir;
+        QVERIFY(dir.isValid());
+        const int threads = 4;
+        const int perThread = 500;
+        {
+            AuditLog log(dir.path(), smallSegments());
+            std::vector<std::thread> writers;
+            for (int t = 0; t < threads; ++t) {
+                writers.emplace_back([&log, t]() {
+                    for (int i = 0; i < perThread; ++i) {
+                        log.append(ban(t * perThread + i, QString("reason %1").arg(i)));
+                    }
+                });
+            }
+            for (std::thread& writer : writers) {
+                writer.join();
+            }
+            log.flush();
+            QCOMPARE(log.failedRecords(), quint64(0));
+            QVERIFY2(log.syncCount() < quint64(threads * perThread / 4),
+                     qPrintable(QString::number(log.syncCount())));
+        }
+
+        // Rotated, and every sealed segment has its index
+        QStringList segments = QDir(dir.path()).entryList({"audit-*.log"}, QDir::Files);
+        QStringList indexes = QDir(dir.path()).entryList({"audit-*.idx"}, QDir::Files);
+        QVERIFY(segments.size() > 10);
+        QCOMPARE(indexes.size(), segments.size() - 1);
+
+        AuditLogReader reader(dir.path());
+        QList<AuditRecord> all = reader.readRange(0, std::numeric_limits<qint64>::max());
+        QCOMPARE(all.size(), threads * perThread);
+        QCOMPARE(reader.corruptRecords(), 0);
+        QSet<int> users;
+        for (int i = 0; i < all.size(); ++i) {
+            QCOMPARE(all[i].sequence, quint64(i + 1));
+            QCOMPARE(all[i].event, AuditEvent::UserBanned);
+            users.insert(all[i].userId);
+        }
+        QCOMPARE(users.size(), threads * perThread);
+
+        QList<AuditRecord> one = reader.readUser(1234);
+        QCOMPARE(one.size(), 1);
+        QCOMPARE(one.first().detail, QString("reason %1").arg(1234 % perThread));
+
+        // A time range returns exactly the records inside it
+        qint64 middle = all[all.size() / 2].timestampMs;
+        QList<AuditRecord> later = reader.readRange(middle, std::numeric_limits<qint64>::max());
+        int expected = 0;
+        for (const AuditRecord& record : all) {
+            expected += record.timestampMs >= middle;
+        }
+        QCOMPARE(later.size(), expected);
+    }
+
+    void testTornTailAndCorruptRecord() {
+        QTemporaryDir dir;
+        QVERIFY(dir.isValid());
+        {
+            AuditLog log(dir.path(), smallSegments());
+            for (int i = 0; i < 200; ++i) {
+                log.append(ban(i, "spam"));
+            }
+        }
+
+        QStringList segments = QDir(dir.path()).entryList({"audit-*.log"}, QDir::Files, QDir::Name);
+        QVERIFY(segments.size() > 2);
+
+        // Flip a byte inside the first record of a sealed segment
+        QFile sealed(dir.filePath(segments.first()));
+        QVERIFY(sealed.open(QIODevice::ReadWrite));
+        QVERIFY(sealed.seek(8 + 8 + 4));
+        char byte = 0;
+        QVERIFY(sealed.getChar(&byte));
+        QVERIFY(sealed.seek(8 + 8 + 4));
+        QVERIFY(sealed.putChar(char(byte ^ 0x5a)));
+        sealed.close();
+
+        // Half a record at the end of the active segment, as after a crash
+        QFile active(dir.filePath(segments.last()));
+        QVERIFY(active.open(QIODevice::Append));
+        QVERIFY(active.write(QByteArray("\x30\x00\x00\x00\x12\x34", 6)) == 6);
+        active.close();
+
+        AuditLogReader reader(dir.path());
+        QCOMPARE(reader.readRange(0, std::numeric_limits<qint64>::max()).size(), 199);
+        QCOMPARE(reader.corruptRecords(), 1);
+        QVERIFY(reader.readUser(0).isEmpty());
+
+        // Reopening cuts the torn tail and continues the sequence
+        {
+            AuditLog log(dir.path(), smallSegments());
+            QCOMPARE(log.append(ban(5000, "after restart")), quint64(201));
+            log.flush();
+        }
+        QList<AuditRecord> after = reader.readUser(5000);
+        QCOMPARE(after.size(), 1);
+        QCOMPARE(after.first().sequence, quint64(201));
+        QCOMPARE(reader.corruptRecords(), 1);
+    }
+
+    void testCorruptRecordInActiveSegmentIsKept() {
+        QTemporaryDir dir;
+        QVERIFY(dir.isValid());
+        {
+            AuditLog log(dir.path());
+            for (int i = 0; i < 10; ++i) {
+                log.append(ban(i, "spam"));
+            }
+        }
+
+        // Damage the first record's payload; the nine after it stay valid
+        QFile active(dir.filePath("audit-00000001.log"));
+        QVERIFY(active.open(QIODevice::ReadWrite));
+        qint64 size = active.size();
+        QVERIFY(active.seek(8 + 8 + 4));
+        QVERIFY(active.putChar('\xff'));
+        active.close();
+
+        {
+            AuditLog log(dir.path());
+            QCOMPARE(log.append(ban(5000, "after restart")), quint64(11));
+            log.flush();
+        }
+        QVERIFY(QFileInfo(dir.filePath("audit-00000001.log")).size() > size);
+
+        AuditLogReader reader(dir.path());
+        QCOMPARE(reader.readRange(0, std::numeric_limits<qint64>::max()).size(), 10);
+        QCOMPARE(reader.corruptRecords(), 1);
+        QCOMPARE(reader.readUser(5000).size(), 1);
+    }
+
+    void testTwoWritersKeepSeparateStreams() {
+        QTemporaryDir dir;
+        QVERIFY(dir.isValid());
+        const int perWriter = 300;
+        {
+            // As the GUI and the daemon would, on one directory at once
+            AuditLog first(dir.path(), smallSegments());
+            AuditLog second(dir.path(), smallSegments());
+            QCOMPARE(first.stream(), 0);
+            QCOMPARE(second.stream(), 1);
+            std::thread a([&first]() {
+                for (int i = 0; i < perWriter; ++i) {
+                    first.append(ban(i, "first"));
+                }
+            });
+            std::thread b([&second]() {
+                for (int i = 0; i < perWriter; ++i) {
+                    second.append(ban(10000 + i, "second"));
+                }
+            });
+            a.join();
+            b.join();
+            first.flush();
+            second.flush();
+            QCOMPARE(first.failedRecords(), quint64(0));
+            QCOMPARE(second.failedRecords(), quint64(0));
+        }
+        QVERIFY(!QDir(dir.path()).entryList({"audit-w1-*.log"}, QDir::Files).isEmpty());
+
+        AuditLogReader reader(dir.path());
+        QList<AuditRecord> all = reader.readRange(0, std::numeric_limits<qint64>::max());
+        QCOMPARE(all.size(), 2 * perWriter);
+        QCOMPARE(reader.corruptRecords(), 0);
+        quint64 next[2] = {1, 1};
+        for (int i = 0; i < all.size(); ++i) {
+            const AuditRecord& record = all[i];
+            QVERIFY(record.stream == 0 || record.stream == 1);
+            QCOMPARE(record.detail, QString(record.stream == 0 ? "first" : "second"));
+            QCOMPARE(record.sequence, next[record.stream]++);
+            QVERIFY(i == 0 || all[i - 1].timestampMs <= record.timestampMs);
+        }
+
+        // Stream 0 is free again and continues where it left off
+        {
+            AuditLog log(dir.path());
+            QCOMPARE(log.stream(), 0);
+            QCOMPARE(log.append(ban(5000, "reopened")), quint64(perWriter + 1));
+        }
+        QCOMPARE(reader.readUser(5000).size(), 1);
+    }
+
+    void testServicesRecordModeration() {
+        QString appData = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+        QFile::remove(appData + "/marketplace.db");
+        DatabaseManager::getInstance();
+        qint64 start = QDateTime::currentMSecsSinceEpoch();
+
+        auto user = AuthService::registerUser("19800000001", "auditpwd", "audited");
+        QVERIFY(user.first);
+        int userId = user.second.getId();
+        QVERIFY(AdminService::banUser(userId, "fraud", 1).first);
+        QVERIFY(!AdminService::banUser(userId, "again", 1).first);  // not recorded
+        QVERIFY(AdminService::unbanUser(userId, 1).first);
+
+        AuditLog& log = AuditLog::getInstance();
+        log.flush();
+        QList<AuditRecord> records = AuditLogReader(log.directory()).readUser(userId, start);
+        QCOMPARE(records.size(), 3);
+        QCOMPARE(records[0].event, AuditEvent::UserRegistered);
+        QCOMPARE(records[1].event, AuditEvent::UserBanned);
+        QCOMPARE(records[1].actorId, 1);
+        QCOMPARE(records[1].detail, QString("fraud"));
+        QCOMPARE(records[2].event, AuditEvent::UserUnbanned);
+    }
+};
+
+// main provided by tests_runner.cpp
+#include "test_auditlog_qt.moc"
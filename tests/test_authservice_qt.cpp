@@ -85,6 +85,33 @@ private slots:
         QVERIFY(db.executeQuery(q, params));
         QVERIFY(AuthService::isUserBanned(phone));
     }
+
+    void testRegisterUsersBatch() {
+        AuthService::registerUser("13900000010", "existing", "old");
+
+        RegistrationBatch batch;
+        batch.phones = {"13900000011", "123", "13900000012", "13900000011", "13900000010"};
+        batch.passwords = {"batchpwd", "batchpwd", "batchpwd", "batchpwd", "batchpwd"};
+        batch.usernames = {"b1", "b2", "b3"};
+
+        RegistrationResult result = AuthService::registerUsers(batch);
+        QCOMPARE(result.statuses.size(), 5);
+        QCOMPARE(result.createdCount, 2);
+        QCOMPARE(result.statuses[0], RegistrationStatus::Created);
+        QCOMPARE(result.statuses[1], RegistrationStatus::InvalidInput);
+        QVERIFY(!result.messages[1].isEmpty());
+        QCOMPARE(result.statuses[2], RegistrationStatus::Created);
+        QCOMPARE(result.statuses[3], RegistrationStatus::DuplicateInBatch);
+        QCOMPARE(result.statuses[4], RegistrationStatus::AlreadyRegistered);
+        QVERIFY(result.ids[0] > 0);
+        QVERIFY(result.ids[2] > result.ids[0]);
+        QCOMPARE(result.ids[3], -1);
+
+        auto login = AuthService::loginUser("13900000012", "batchpwd");
+        QVERIFY(login.first);
+        QCOMPARE(login.second.getId(), result.ids[2]);
+        QCOMPARE(login.second.getUsername(), QString("b3"));
+    }
 };
 
 // QTEST_MAIN removed: main is provided by tests_runner.cpp
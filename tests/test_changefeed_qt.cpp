@@ -0,0 +1,181 @@
+#include <QtTest>
+#include <QStandardPaths>
+#include <QFile>
+
+#include "AdminService.h"
+#include "AuthService.h"
+#include "ChangeFeed.h"
+#include "DatabaseManager.h"
+#include "UserTableModel.h"
+
+static void removeTestDatabaseChangeFeed()
+{
+    QString appData = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+    QString dbPath = appData + "/marketplace.db";
+    QFile f(dbPath);
+    if (f.exists()) f.remove();
+}
+
+static int userIdForPhone(const QString& phone)
+{
+    QSqlQuery result = DatabaseManager::getInstance().executeQueryWithResult(
+        "SELECT id FROM users WHERE phone = ?", {phone});
+    return result.next() ? result.value(0).toInt() : -1;
+}
+
+class ChangeFeedTest : public QObject {
+    Q_OBJECT
+
+private slots:
+    void initTestCase() {
+        QStandardPaths::setTestModeEnabled(true);
+        removeTestDatabaseChangeFeed();
+        DatabaseManager::getInstance();
+
+        RegistrationBatch batch;
+        for (int i = 0; i < 20; ++i) {
+            batch.phones.append(QString("134%1").arg(i, 8, 10, QChar('0')));
+            batch.passwords.append("feedpwd");
+        }
+        QCOMPARE(AuthService::registerUsers(batch).createdCount, 20);
+    }
+
+    void testRanges() {
+        TableChanges changes;
+        changes.updated = {IdRange{3, 5}, IdRange{9, 9}};
+        QVERIFY(!changes.isEmpty());
+        QVERIFY(changes.touches(3));
+        QVERIFY(changes.touches(5));
+        QVERIFY(changes.touches(9));
+        QVERIFY(!changes.touches(2));
+        QVERIFY(!changes.touches(6));
+        QVERIFY(!changes.touches(10));
+
+        TableChanges overflow;
+        overflow.overflow = true;
+        QVERIFY(overflow.touches(12345));
+    }
+
+    void testPollReportsChangedRows() {
+        ChangeFeed feed;
+        QSignalSpy users(&feed, &ChangeFeed::usersChanged);
+        QSignalSpy reports(&feed, &ChangeFeed::reportsChanged);
+
+        // The first poll only sets the baseline; an idle poll finds nothing
+        QVERIFY(feed.poll());
+        QVERIFY(feed.poll());
+        QCOMPARE(users.count(), 0);
+
+        int first = userIdForPhone("13400000003");
+        int second = userIdForPhone("13400000004");
+        int third = userIdForPhone("13400000010");
+        QVERIFY(AdminService::banUser(first, "feed test").first);
+        QVERIFY(AdminService::banUser(second, "feed test").first);
+        QVERIFY(AdminService::banUser(third, "feed test").first);
+        QVERIFY(feed.poll());
+
+        QCOMPARE(users.count(), 1);
+        QCOMPARE(reports.count(), 0);
+        TableChanges changes = users.first().first().value<TableChanges>();
+        QVERIFY(!changes.overflow);
+        QVERIFY(changes.inserted.isEmpty());
+        // Registered one after another, so the first two ids are adjacent
+        QCOMPARE(changes.updated.size(), 2);
+        QCOMPARE(changes.updated[0].first, qint64(first));
+        QCOMPARE(changes.updated[0].last, qint64(second));
+        QVERIFY(changes.touches(third));
+
+        QVERIFY(DatabaseManager::getInstance().executeQuery(
+            "INSERT INTO reports (reporter_id, reported_user_id, reason) VALUES (?, ?, 'feed')", {first, third}));
+        QVERIFY(feed.poll());
+        QCOMPARE(users.count(), 1);
+        QCOMPARE(reports.count(), 1);
+        TableChanges filed = reports.first().first().value<TableChanges>();
+        QCOMPARE(filed.inserted.size(), 1);
+        QVERIFY(filed.touches(DatabaseManager::getInstance().getLastInsertId()));
+
+        for (int id : {first, second, third}) {
+            QVERIFY(AdminService::unbanUser(id).first);
+        }
+    }
+
+    void testTooManyChangesOverflow() {
+        ChangeFeed feed;
+        QSignalSpy users(&feed, &ChangeFeed::usersChanged);
+        QVERIFY(feed.poll());
+
+        QVERIFY(DatabaseManager::getInstance().executeQuery(
+            "INSERT INTO users (phone, password) "
+            "WITH RECURSIVE n(i) AS (SELECT 1 UNION ALL SELECT i + 1 FROM n WHERE i < ?) "
+            "SELECT '135' || printf('%08d', i), 'x' FROM n", {ChangeFeed::kMaxChangesPerPoll + 1}));
+        QVERIFY(feed.poll());
+        QCOMPARE(users.count(), 1);
+        QVERIFY(users.first().first().value<TableChanges>().overflow);
+
+        // Back in step afterwards
+        QVERIFY(AdminService::banUser(userIdForPhone("13400000001"), "feed test").first);
+        QVERIFY(feed.poll());
+        QCOMPARE(users.count(), 2);
+        QVERIFY(!users.last().first().value<TableChanges>().overflow);
+        QVERIFY(AdminService::unbanUser(userIdForPhone("13400000001")).first);
+    }
+
+    void testLogStaysBoundedWithoutFeed() {
+        // Only the trim trigger runs here; no ChangeFeed exists
+        QVERIFY(DatabaseManager::getInstance().executeQuery(
+            "INSERT INTO change_log (table_name, row_id, op) "
+            "WITH RECURSIVE n(i) AS (SELECT 1 UNION ALL SELECT i + 1 FROM n WHERE i < ?) "
+            "SELECT 'reports', i, 'U' FROM n", {DatabaseManager::kRetainedChanges + 5000}));
+        QSqlQuery count = DatabaseManager::getInstance().executeQueryWithResult(
+            "SELECT COUNT(*) FROM change_log");
+        QVERIFY(count.next());
+        QVERIFY(count.value(0).toInt() <= DatabaseManager::kRetainedChanges + 1024);
+    }
+
+    void testBulkLoadReportsOverflow() {
+        ChangeFeed feed;
+        QSignalSpy users(&feed, &ChangeFeed::usersChanged);
+        QVERIFY(feed.poll());
+
+        DatabaseManager& db = DatabaseManager::getInstance();
+        QVERIFY(db.beginBulkLoad());
+        QVERIFY(db.executeQuery("INSERT INTO users (phone, password) VALUES ('13300000001', 'x')"));
+        QVERIFY(db.endBulkLoad());
+        QSqlQuery logged = db.executeQueryWithResult(
+            "SELECT COUNT(*) FROM change_log WHERE table_name = 'users' AND row_id = ?",
+            {userIdForPhone("13300000001")});
+        QVERIFY(logged.next());
+        QCOMPARE(logged.value(0).toInt(), 0);
+
+        QVERIFY(feed.poll());
+        QCOMPARE(users.count(), 1);
+        QVERIFY(users.first().first().value<TableChanges>().overflow);
+    }
+
+    void testWatcherThreadDropsStalePages() {
+        UserTableModel model;
+        model.fetchMore(QModelIndex());
+        QVERIFY(model.cachedPageCount() > 0);
+        int userId = model.userId(0);
+
+        // Signals come from the watcher thread and are queued to the model
+        ChangeFeed feed;
+        connect(&feed, &ChangeFeed::usersChanged, &model, &UserTableModel::refreshRows);
+        QSignalSpy refreshed(&model, &QAbstractItemModel::dataChanged);
+        feed.start(20);
+        QTest::qWait(100);  // baseline poll
+        QCOMPARE(refreshed.count(), 0);
+
+        // Written behind the model's back, not through AdminService
+        QVERIFY(DatabaseManager::getInstance().executeQuery(
+            "UPDATE users SET username = 'fromelsewhere' WHERE id = ?", {userId}));
+        QTRY_COMPARE(refreshed.count(), 1);
+        QCOMPARE(refreshed.first().first().toModelIndex().row(), 0);
+        feed.stop();
+
+        QCOMPARE(model.data(model.index(0, UserTableModel::UsernameColumn)).toString(), QString("fromelsewhere"));
+    }
+};
+
+// main provided by tests_runner.cpp
+#include "test_changefeed_qt.moc"
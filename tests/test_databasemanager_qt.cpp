@@ -4,6 +4,11 @@
 #include <QDir>
 #include <QFile>
 
+#include <QElapsedTimer>
+#include <QThread>
+#include <atomic>
+#include <thread>
+
 #include "DatabaseManager.h"
 
 static void removeTestDatabaseDB()
@@ -27,6 +32,11 @@ private slots:
     void testDatabaseOpens() {
         DatabaseManager& db = DatabaseManager::getInstance();
         QVERIFY(db.isOpen());
+
+        // Readers and writers do not block each other
+        QSqlQuery mode = db.executeQueryWithResult("PRAGMA journal_mode");
+        QVERIFY(mode.next());
+        QCOMPARE(mode.value(0).toString(), QString("wal"));
     }
 
     void testExecuteQueryInsertAndLastId() {
@@ -50,6 +60,102 @@ private slots:
         int cnt = result.value("count").toInt();
         QVERIFY(cnt >= 0);
     }
+
+    void testBusyStatementsAreRetried() {
+        DatabaseManager& db = DatabaseManager::getInstance();
+        int savedTimeout = DatabaseManager::busyTimeout();
+        DatabaseManager::RetryPolicy savedPolicy = DatabaseManager::retryPolicy();
+        DatabaseManager::setBusyTimeout(0);
+        DatabaseManager::RetryPolicy policy;
+        policy.maxAttempts = 3;
+        policy.initialBackoffMs = 1;
+        policy.maxBackoffMs = 2;
+        DatabaseManager::setRetryPolicy(policy);
+        DatabaseManager::resetBusyStats();
+        QString insert = "INSERT INTO users (phone, password) VALUES (?, 'x')";
+
+        // Another connection, as another process would, holds the write lock
+        {
+            QSqlDatabase other = QSqlDatabase::addDatabase("QSQLITE", "busy_holder");
+            other.setDatabaseName(DatabaseManager::databasePath());
+            QVERIFY(other.open());
+            QSqlQuery hold(other);
+            QVERIFY(hold.exec("BEGIN IMMEDIATE"));
+
+            QVERIFY(!db.executeQuery(insert, {"15000000001"}));
+            QVERIFY(db.lastErrorWasBusy());
+            DatabaseManager::BusyStats stats = DatabaseManager::busyStats();
+            QCOMPARE(stats.busyErrors, quint64(3));
+            QCOMPARE(stats.retries, quint64(2));
+            QCOMPARE(stats.exhausted, quint64(1));
+            QCOMPARE(stats.recovered, quint64(0));
+
+            // BEGIN IMMEDIATE waits for the lock as well
+            QVERIFY(!db.beginTransaction());
+            QVERIFY(hold.exec("COMMIT"));
+            hold.finish();
+            other.close();
+        }
+        QSqlDatabase::removeDatabase("busy_holder");
+        QVERIFY(db.executeQuery(insert, {"15000000001"}));
+        QVERIFY(!db.lastErrorWasBusy());
+
+        // Released while backing off: the statement succeeds on a retry
+        policy.maxAttempts = 100;
+        policy.initialBackoffMs = 5;
+        policy.maxBackoffMs = 20;
+        DatabaseManager::setRetryPolicy(policy);
+        DatabaseManager::resetBusyStats();
+        std::atomic<bool> locked{false};
+        std::thread holder([&locked]() {
+            {
+                QSqlDatabase other = QSqlDatabase::addDatabase("QSQLITE", "busy_thread_holder");
+                other.setDatabaseName(DatabaseManager::databasePath());
+                other.open();
+                QSqlQuery hold(other);
+                hold.exec("BEGIN IMMEDIATE");
+                locked = true;
+                QThread::msleep(100);
+                hold.exec("COMMIT");
+                hold.finish();
+                other.close();
+            }
+            QSqlDatabase::removeDatabase("busy_thread_holder");
+        });
+        while (!locked) {
+            QThread::msleep(1);
+        }
+        bool inserted = db.executeQuery(insert, {"15000000002"});
+        holder.join();
+        QVERIFY(inserted);
+        QCOMPARE(DatabaseManager::busyStats().recovered, quint64(1));
+        QVERIFY(DatabaseManager::busyStats().retries >= 1);
+
+        // Every attempt waits out the busy timeout; the deadline caps the sum
+        DatabaseManager::setBusyTimeout(200);
+        policy.deadlineMs = 300;
+        DatabaseManager::setRetryPolicy(policy);
+        {
+            QSqlDatabase other = QSqlDatabase::addDatabase("QSQLITE", "busy_deadline_holder");
+            other.setDatabaseName(DatabaseManager::databasePath());
+            QVERIFY(other.open());
+            QSqlQuery hold(other);
+            QVERIFY(hold.exec("BEGIN IMMEDIATE"));
+
+            QElapsedTimer waited;
+            waited.start();
+            QVERIFY(!db.executeQuery(insert, {"15000000003"}));
+            QVERIFY(db.lastErrorWasBusy());
+            QVERIFY2(waited.elapsed() < 1000, qPrintable(QString::number(waited.elapsed())));
+            QVERIFY(hold.exec("ROLLBACK"));
+            hold.finish();
+            other.close();
+        }
+        QSqlDatabase::removeDatabase("busy_deadline_holder");
+
+        DatabaseManager::setBusyTimeout(savedTimeout);
+        DatabaseManager::setRetryPolicy(savedPolicy);
+    }
 };
 
 // QTEST_MAIN removed: main is provided by tests_runner.cpp
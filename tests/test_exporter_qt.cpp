@@ -0,0 +1,188 @@
+#include <QtTest>
+#include <QStandardPaths>
+#include <QBuffer>
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QtEndian>
+#include <vector>
+
+#include "AuthService.h"
+#include "DatabaseManager.h"
+#include "DataExporter.h"
+#include "ReportService.h"
+
+static void removeTestDatabaseExporter()
+{
+    QString appData = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+    QString dbPath = appData + "/marketplace.db";
+    QFile f(dbPath);
+    if (f.exists()) f.remove();
+}
+
+static int countRowsExporter(const QString& query)
+{
+    QSqlQuery result = DatabaseManager::getInstance().executeQueryWithResult(query);
+    return result.next() ? result.value(0).toInt() : -1;
+}
+
+static quint64 readVarintExporter(const char** p)
+{
+    quint64 value = 0;
+    for (int shift = 0;; shift += 7) {
+        quint8 byte = static_cast<quint8>(*(*p)++);
+        value |= quint64(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) return value;
+    }
+}
+
+class ExporterTest : public QObject {
+    Q_OBJECT
+
+private:
+    int m_trickyId = 0;
+
+    static QByteArray exportTo(ExportTable table, ExportFormat format, ExportResult* result) {
+        QBuffer buffer;
+        buffer.open(QIODevice::WriteOnly);
+        *result = DataExporter::exportTable(table, format, &buffer);
+        return buffer.data();
+    }
+
+private slots:
+    void initTestCase() {
+        QStandardPaths::setTestModeEnabled(true);
+        removeTestDatabaseExporter();
+        DatabaseManager::getInstance();
+
+        // More rows than one columnar row group
+        RegistrationBatch batch;
+        for (int i = 0; i < DataExporter::kRowGroupRows + 500; ++i) {
+            batch.phones.append(QString("134%1").arg(i, 8, 10, QChar('0')));
+            batch.passwords.append("exportpwd");
+        }
+        QCOMPARE(AuthService::registerUsers(batch).createdCount, batch.size());
+
+        auto tricky = AuthService::registerUser("13500000001", "exportpwd", "a,b \"c\"\nd é");
+        QVERIFY(tricky.first);
+        m_trickyId = tricky.second.getId();
+        QVERIFY(ReportService::submitReport(m_trickyId, 1, "said \"hi\"").ok);
+        QVERIFY(AuthService::registerUser("13500000002", "exportpwd", "=1+2").first);
+        QVERIFY(AuthService::registerUser("13500000003", "exportpwd", "-5").first);
+    }
+
+    void testCsv() {
+        ExportResult result;
+        QByteArray csv = exportTo(ExportTable::Users, ExportFormat::Csv, &result);
+        QVERIFY2(result.ok, qPrintable(result.error));
+        QCOMPARE(result.rows, qint64(countRowsExporter("SELECT COUNT(*) FROM users")));
+        QCOMPARE(result.bytes, qint64(csv.size()));
+        QVERIFY(csv.startsWith("id,phone,username,created_at,is_admin,is_banned\r\n"));
+        QVERIFY(!csv.contains("exportpwd"));
+        QVERIFY(!csv.contains(AuthService::hashPassword("exportpwd").toUtf8()));
+        QVERIFY(csv.contains(QString("%1,13500000001,\"a,b \"\"c\"\"\nd é\",").arg(m_trickyId).toUtf8()));
+
+        // Formula-like text opens as text in a spreadsheet
+        QVERIFY(csv.contains(",13500000002,\"'=1+2\","));
+        QVERIFY(csv.contains(",13500000003,\"'-5\","));
+    }
+
+    void testNdJson() {
+        ExportResult result;
+        QByteArray json = exportTo(ExportTable::Reports, ExportFormat::NdJson, &result);
+        QVERIFY2(result.ok, qPrintable(result.error));
+        QCOMPARE(result.rows, qint64(1));
+
+        QList<QByteArray> lines = json.split('\n');
+        QCOMPARE(lines.size(), 2);  // trailing newline
+        QJsonParseError error;
+        QJsonObject report = QJsonDocument::fromJson(lines.first(), &error).object();
+        QCOMPARE(error.error, QJsonParseError::NoError);
+        QCOMPARE(report.value("reporter_id").toInt(), m_trickyId);
+        QCOMPARE(report.value("reason").toString(), QString("said \"hi\""));
+        QCOMPARE(report.value("status").toString(), QString("pending"));
+        QVERIFY(report.value("resolved_at").isNull());
+        QVERIFY(report.value("created_at").toDouble() > 0);
+    }
+
+    void testColumnarRowGroups() {
+        ExportResult result;
+        QByteArray data = exportTo(ExportTable::Users, ExportFormat::Columnar, &result);
+        QVERIFY2(result.ok, qPrintable(result.error));
+        QVERIFY(data.startsWith("MKTCOL1\n"));
+
+        // Header: table, column count, then (type, name length, name) each
+        const char* p = data.constData() + 8;
+        QCOMPARE(int(p[0]), 0);
+        int columns = p[1];
+        QCOMPARE(columns, 6);
+        p += 2;
+        QList<int> types;
+        for (int i = 0; i < columns; ++i) {
+            types.append(p[0]);
+            p += 2 + static_cast<unsigned char>(p[1]);
+        }
+        QCOMPARE(types, QList<int>({1, 3, 3, 1, 4, 4}));
+
+        // Row groups up to the zero terminator, then the total; every
+        // column is decoded back into rows
+        std::vector<QVariantList> decoded;
+        int groups = 0;
+        const char* end = data.constData() + data.size();
+        while (p + 4 <= end) {
+            quint32 groupRows = qFromLittleEndian<quint32>(p);
+            p += 4;
+            if (groupRows == 0) {
+                break;
+            }
+            QVERIFY(groupRows <= quint32(DataExporter::kRowGroupRows));
+            size_t first = decoded.size();
+            decoded.resize(first + groupRows);
+            ++groups;
+            for (int i = 0; i < columns; ++i) {
+                const char* columnEnd = p + 4 + qFromLittleEndian<quint32>(p);
+                p += 4;
+                qint64 previous = 0;
+                for (quint32 row = 0; row < groupRows; ++row) {
+                    QVariantList& values = decoded[first + row];
+                    if (types[i] == 3) {
+                        int size = static_cast<int>(readVarintExporter(&p));
+                        values.append(QString::fromUtf8(p, size));
+                        p += size;
+                    } else if (types[i] == 4) {
+                        values.append(*p++ != 0);
+                    } else {
+                        quint64 zigzag = readVarintExporter(&p);
+                        previous += static_cast<qint64>(zigzag >> 1) ^ -static_cast<qint64>(zigzag & 1);
+                        values.append(previous);
+                    }
+                }
+                QCOMPARE(p, columnEnd);
+            }
+        }
+        QCOMPARE(groups, 2);
+        QCOMPARE(qint64(decoded.size()), result.rows);
+        QCOMPARE(qint64(qFromLittleEndian<quint64>(p)), result.rows);
+        QCOMPARE(p + 8, end);
+
+        // Same values as the table, in id order
+        QSqlQuery users = DatabaseManager::getInstance().executeQueryWithResult(
+            "SELECT id, phone, username, CAST(strftime('%s', created_at) AS INTEGER), is_admin, is_banned "
+            "FROM users ORDER BY id");
+        size_t row = 0;
+        while (users.next()) {
+            QVERIFY(row < decoded.size());
+            const QVariantList& values = decoded[row++];
+            QCOMPARE(values[0].toLongLong(), users.value(0).toLongLong());
+            QCOMPARE(values[1].toString(), users.value(1).toString());
+            QCOMPARE(values[2].toString(), users.value(2).toString());
+            QCOMPARE(values[3].toLongLong(), users.value(3).toLongLong());
+            QCOMPARE(values[4].toBool(), users.value(4).toBool());
+            QCOMPARE(values[5].toBool(), users.value(5).toBool());
+        }
+        QCOMPARE(row, decoded.size());
+    }
+};
+
+// main provided by tests_runner.cpp
+#include "test_exporter_qt.moc"
@@ -0,0 +1,172 @@
+#include <QtTest>
+#include <QStandardPaths>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+#include "AuthService.h"
+#include "DatabaseManager.h"
+#include "HttpApiServer.h"
+#include "JsonWriter.h"
+
+static const quint16 kHttpTestPort = 8080;
+static const QByteArray kHttpTestToken(64, 'b');
+
+static void removeTestDatabaseHttp()
+{
+    QString appData = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+    QString dbPath = appData + "/marketplace.db";
+    QFile f(dbPath);
+    if (f.exists()) f.remove();
+}
+
+// A request as a well-behaved local client sends it
+static HttpApiServer::Request httpRequest(const QByteArray& method, const QByteArray& target,
+                                          const QByteArray& body = QByteArray())
+{
+    HttpApiServer::Request request;
+    request.method = method;
+    int queryStart = target.indexOf('?');
+    request.path = queryStart < 0 ? target : target.left(queryStart);
+    request.query = queryStart < 0 ? QByteArray() : target.mid(queryStart + 1);
+    request.body = body;
+    request.host = "127.0.0.1:" + QByteArray::number(kHttpTestPort);
+    request.authorization = "Bearer " + kHttpTestToken;
+    if (method == "POST") {
+        request.contentType = "application/json";
+    }
+    return request;
+}
+
+static HttpApiServer::Response httpHandle(const HttpApiServer::Request& request)
+{
+    return HttpApiServer::handle(request, kHttpTestToken, kHttpTestPort);
+}
+
+static QJsonObject httpJson(const HttpApiServer::Response& response)
+{
+    return QJsonDocument::fromJson(response.body).object();
+}
+
+class HttpApiTest : public QObject {
+    Q_OBJECT
+
+private slots:
+    void initTestCase() {
+        QStandardPaths::setTestModeEnabled(true);
+        removeTestDatabaseHttp();
+        DatabaseManager::getInstance();
+    }
+
+    void cleanupTestCase() {
+        removeTestDatabaseHttp();
+    }
+
+    void testForeignRequestsAreRejected() {
+        HttpApiServer::Request request = httpRequest("GET", "/users");
+        QCOMPARE(httpHandle(request).status, 200);
+
+        request.host = "localhost:" + QByteArray::number(kHttpTestPort);
+        QCOMPARE(httpHandle(request).status, 200);
+
+        // DNS rebinding keeps the attacker's name in Host
+        request.host = "attacker.example:" + QByteArray::number(kHttpTestPort);
+        QCOMPARE(httpHandle(request).status, 403);
+        request.host = "127.0.0.1:1";
+        QCOMPARE(httpHandle(request).status, 403);
+        request.host.clear();
+        QCOMPARE(httpHandle(request).status, 403);
+
+        request = httpRequest("GET", "/users");
+        request.origin = "null";
+        request.hasOrigin = true;
+        QCOMPARE(httpHandle(request).status, 403);
+
+        request = httpRequest("GET", "/users");
+        request.authorization.clear();
+        QCOMPARE(httpHandle(request).status, 401);
+        request.authorization = "Bearer " + QByteArray(64, 'c');
+        QCOMPARE(httpHandle(request).status, 401);
+        request.authorization = "Basic " + kHttpTestToken;
+        QCOMPARE(httpHandle(request).status, 401);
+
+        // Health checks need no token, but still a local Host
+        request = httpRequest("GET", "/ping");
+        request.authorization.clear();
+        QCOMPARE(httpHandle(request).status, 200);
+
+        // What an HTML form can send without a preflight
+        request = httpRequest("POST", "/login", "{\"phone\":\"13800138000\",\"password\":\"admin123\"}");
+        request.contentType = "text/plain";
+        QCOMPARE(httpHandle(request).status, 415);
+        request.contentType = "application/JSON; charset=utf-8";
+        QCOMPARE(httpHandle(request).status, 200);
+    }
+
+    void testRouting() {
+        QCOMPARE(httpHandle(httpRequest("GET", "/nowhere")).status, 404);
+        QCOMPARE(httpHandle(httpRequest("POST", "/login", "[1, 2]")).status, 400);
+        QCOMPARE(httpHandle(httpRequest("POST", "/login", "{\"phone\":\"13800138000\",\"password\":\"nope\"}")).status,
+                 401);
+        QCOMPARE(httpHandle(httpRequest("POST", "/register", "{\"phone\":\"12\",\"password\":\"secret1\"}")).status,
+                 400);
+
+        HttpApiServer::Response created = httpHandle(httpRequest(
+            "POST", "/register", "{\"phone\":\"13700000001\",\"password\":\"httppwd\",\"username\":\"http\"}"));
+        QCOMPARE(created.status, 200);
+        int userId = httpJson(created).value("user").toObject().value("id").toInt();
+        QVERIFY(userId > 0);
+        QCOMPARE(httpHandle(httpRequest(
+            "POST", "/register", "{\"phone\":\"13700000001\",\"password\":\"httppwd\"}")).status, 409);
+
+        QByteArray userPath = "/users/" + QByteArray::number(userId);
+        QCOMPARE(httpHandle(httpRequest("POST", userPath + "/ban", "{\"reason\":\"spam\"}")).status, 200);
+        QVERIFY(AuthService::isUserBannedById(userId));
+        QCOMPARE(httpHandle(httpRequest("POST", userPath + "/frob")).status, 404);
+        QCOMPARE(httpHandle(httpRequest("POST", "/users/abc/ban")).status, 400);
+
+        HttpApiServer::Response banned = httpHandle(httpRequest("GET", "/users/banned?page=0&pageSize=50"));
+        QCOMPARE(banned.status, 200);
+        QJsonArray users = httpJson(banned).value("users").toArray();
+        bool listed = false;
+        for (const QJsonValue& user : users) {
+            listed = listed || user.toObject().value("id").toInt() == userId;
+        }
+        QVERIFY(listed);
+        QCOMPARE(httpHandle(httpRequest("GET", "/users?pageSize=0")).status, 400);
+        // page * pageSize would overflow the row offset
+        QCOMPARE(httpHandle(httpRequest("GET", "/users?page=2147483647&pageSize=10000")).status, 400);
+
+        QCOMPARE(httpHandle(httpRequest("POST", userPath + "/unban")).status, 200);
+        QVERIFY(!AuthService::isUserBannedById(userId));
+    }
+
+    void testJsonWriterEscaping() {
+        QString text = QString::fromUtf8("say \"hi\" \\ back\nline\ttab\rret \x01\x1f caf\xc3\xa9 \xe4\xb8\xad");
+        QByteArray out;
+        JsonWriter json(out);
+        json.beginObject()
+            .key("text").value(text)
+            .key("raw").value("a\"b")
+            .key("n").value(qint64(-42))
+            .key("list").beginArray().value(true).value(false).value(7).endArray()
+            .endObject();
+
+        QVERIFY(out.contains("\\\"hi\\\""));
+        QVERIFY(out.contains("\\\\ back\\nline\\ttab\\rret \\u0001\\u001f"));
+        // Non-ASCII stays UTF-8
+        QVERIFY(out.contains("caf\xc3\xa9 \xe4\xb8\xad"));
+
+        QJsonParseError error;
+        QJsonObject parsed = QJsonDocument::fromJson(out, &error).object();
+        QCOMPARE(error.error, QJsonParseError::NoError);
+        QCOMPARE(parsed.value("text").toString(), text);
+        QCOMPARE(parsed.value("raw").toString(), QString("a\"b"));
+        QCOMPARE(parsed.value("n").toInt(), -42);
+        QCOMPARE(parsed.value("list").toArray(), QJsonArray({true, false, 7}));
+    }
+};
+
+// main provided by tests_runner.cpp
+#include "test_httpapi_qt.moc"
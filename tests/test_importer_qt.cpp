@@ -0,0 +1,176 @@
+#include <QtTest>
+#include <QStandardPaths>
+#include <QTemporaryDir>
+#include <QFile>
+#include <QFileInfo>
+
+#include "AdminService.h"
+#include "AuthService.h"
+#include "BulkImporter.h"
+#include "DatabaseManager.h"
+
+static void removeTestDatabaseImporter()
+{
+    QString appData = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+    QString dbPath = appData + "/marketplace.db";
+    QFile f(dbPath);
+    if (f.exists()) f.remove();
+}
+
+static int countRowsImporter(const QString& query, const QVariantList& params = {})
+{
+    QSqlQuery result = DatabaseManager::getInstance().executeQueryWithResult(query, params);
+    return result.next() ? result.value(0).toInt() : -1;
+}
+
+static bool writeFile(const QString& path, const QByteArray& data)
+{
+    QFile file(path);
+    return file.open(QIODevice::WriteOnly | QIODevice::Truncate) && file.write(data) == data.size();
+}
+
+static QList<QByteArray> readLines(const QString& path)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return {};
+    }
+    QList<QByteArray> lines = file.readAll().split('\n');
+    if (!lines.isEmpty() && lines.last().isEmpty()) {
+        lines.removeLast();
+    }
+    return lines;
+}
+
+class ImporterTest : public QObject {
+    Q_OBJECT
+
+private:
+    QTemporaryDir m_dir;
+
+private slots:
+    void initTestCase() {
+        QStandardPaths::setTestModeEnabled(true);
+        removeTestDatabaseImporter();
+        DatabaseManager::getInstance();
+        QVERIFY(m_dir.isValid());
+    }
+
+    void testUsersWithRejects() {
+        QString path = m_dir.filePath("accounts.csv");
+        QByteArray csv = "phone,password,username\r\n"
+                         "13600000001,secret1,plain\r\n"
+                         "13600000002,secret2,\"Lee, \"\"Jo\"\"\"\r\n"
+                         "\r\n"
+                         "12345,secret3,badphone\r\n"
+                         "13600000003,short\r\n"
+                         "13600000001,secret4,dupe\r\n"
+                         "13800138000,secret5,admin phone\r\n"
+                         "onlyonefield\r\n"
+                         "13600000004,secret6";  // no final line break
+        QVERIFY(writeFile(path, csv));
+
+        ImportResult result = BulkImporter::importFile(ImportTable::Users, path);
+        QVERIFY2(result.ok, qPrintable(result.error));
+        QCOMPARE(result.rowsRead, qint64(8));
+        QCOMPARE(result.imported, qint64(3));
+        QCOMPARE(result.rejected, qint64(5));
+        QCOMPARE(result.resumedFromOffset, qint64(0));
+
+        QCOMPARE(countRowsImporter("SELECT COUNT(*) FROM users WHERE phone LIKE '136%'"), 3);
+        QCOMPARE(countRowsImporter("SELECT COUNT(*) FROM users WHERE username = ?", {"Lee, \"Jo\""}), 1);
+        QVERIFY(AuthService::loginUser("13600000004", "secret6").first);
+
+        QList<QByteArray> rejects = readLines(path + ".rejects.csv");
+        QCOMPARE(rejects.size(), 5);
+        // Malformed rows are rejected while parsing, ahead of validation
+        QVERIFY(rejects[0].startsWith("onlyonefield,\"Expected"));
+        QVERIFY(rejects[1].startsWith("12345,secret3,badphone,\"Invalid phone"));
+        QVERIFY(rejects[2].startsWith("13600000003,short,"));
+        QVERIFY(rejects[3].endsWith(",\"Duplicate phone in input\""));
+        QVERIFY(rejects[4].endsWith(",\"Phone already registered\""));
+
+        // Indexes and search are back after the deferred-index import
+        QCOMPARE(countRowsImporter("SELECT COUNT(*) FROM sqlite_master WHERE name IN "
+                                   "('idx_users_created', 'idx_users_banned_created')"), 2);
+        UserListResult found = AdminService::searchUsers("Lee, ");
+        QVERIFY(found.ok);
+        QCOMPARE(found.users.size(), 1);
+        QVERIFY(DatabaseManager::getInstance().executeQuery(
+            "UPDATE users SET username = 'nightjar' WHERE id = ?", {found.users.id(0)}));
+        QCOMPARE(AdminService::searchUsers("ghtja").users.size(), 1);
+
+        // The saved progress covers the whole file; a rerun does nothing
+        ImportResult again = BulkImporter::importFile(ImportTable::Users, path);
+        QVERIFY(again.ok);
+        QCOMPARE(again.rowsRead, qint64(0));
+    }
+
+    void testResumeFromCheckpoint() {
+        QString path = m_dir.filePath("many.csv");
+        QByteArray csv;
+        for (int i = 0; i < 250; ++i) {
+            csv += QString("137%1,password%2\n").arg(i, 8, 10, QChar('0')).arg(i).toUtf8();
+        }
+        QVERIFY(writeFile(path, csv));
+
+        ImportOptions options;
+        options.chunkRows = 100;
+        options.maxRows = 100;
+        ImportResult first = BulkImporter::importFile(ImportTable::Users, path, options);
+        QVERIFY2(first.ok, qPrintable(first.error));
+        QCOMPARE(first.imported, qint64(100));
+
+        options.maxRows = -1;
+        ImportResult rest = BulkImporter::importFile(ImportTable::Users, path, options);
+        QVERIFY2(rest.ok, qPrintable(rest.error));
+        QVERIFY(rest.resumedFromOffset > 0);
+        QCOMPARE(rest.rowsRead, qint64(150));
+        QCOMPARE(rest.imported, qint64(150));
+        QCOMPARE(rest.rejected, qint64(0));
+        QCOMPARE(countRowsImporter("SELECT COUNT(*) FROM users WHERE phone LIKE '137%'"), 250);
+        QCOMPARE(countRowsImporter("SELECT offset FROM import_progress WHERE input = ?",
+                                   {QFileInfo(path).absoluteFilePath()}),
+                 csv.size());
+    }
+
+    void testInterruptedBulkLoadIsFinished() {
+        DatabaseManager& db = DatabaseManager::getInstance();
+        QVERIFY(db.beginBulkLoad());
+        // Inserted while the search triggers are gone, then the process dies
+        QVERIFY(db.executeQuery("INSERT INTO users (phone, password, username) VALUES (?, ?, ?)",
+                                {"13500000009", "x", "wren"}));
+        QCOMPARE(AdminService::searchUsers("wren").users.size(), 0);
+
+        db.close();
+        DatabaseManager::getInstance();
+        QCOMPARE(countRowsImporter("SELECT COUNT(*) FROM bulk_load"), 0);
+        QCOMPARE(countRowsImporter("SELECT COUNT(*) FROM sqlite_master WHERE name IN "
+                                   "('idx_users_created', 'idx_users_banned_created', 'users_fts_ai')"), 3);
+        QCOMPARE(AdminService::searchUsers("wren").users.size(), 1);
+    }
+
+    void testReports() {
+        int reporter = countRowsImporter("SELECT id FROM users WHERE phone = '13600000001'");
+        int reported = countRowsImporter("SELECT id FROM users WHERE phone = '13600000002'");
+        QVERIFY(reporter > 0 && reported > 0);
+
+        QString path = m_dir.filePath("reports.csv");
+        QByteArray csv = QString("reporter_id,reported_user_id,reason\n"
+                                 "%1,%2,spam\n"
+                                 "%1,999999,ghost\n"
+                                 "%1,%1,self\n"
+                                 "x,%2,bad id\n")
+                             .arg(reporter).arg(reported).toUtf8();
+        QVERIFY(writeFile(path, csv));
+
+        ImportResult result = BulkImporter::importFile(ImportTable::Reports, path);
+        QVERIFY2(result.ok, qPrintable(result.error));
+        QCOMPARE(result.imported, qint64(1));
+        QCOMPARE(result.rejected, qint64(3));
+        QCOMPARE(countRowsImporter("SELECT COUNT(*) FROM reports WHERE reason = 'spam'"), 1);
+    }
+};
+
+// main provided by tests_runner.cpp
+#include "test_importer_qt.moc"
@@ -2,6 +2,7 @@
 #include <QStandardPaths>
 #include <QFile>
 
+#include "AdminService.h"
 #include "AuthService.h"
 #include "DatabaseManager.h"
 
@@ -43,6 +44,38 @@ private slots:
         auto login2 = AuthService::loginUser(phone, pwd);
         QVERIFY(!login2.first);
     }
+
+    void testBulkBanReportsEachId() {
+        RegistrationBatch batch;
+        for (int i = 0; i < 1200; ++i) {
+            batch.phones.append(QString("198%1").arg(i, 8, 10, QChar('0')));
+            batch.passwords.append("bulkpass");
+        }
+        RegistrationResult reg = AuthService::registerUsers(batch);
+        QCOMPARE(reg.createdCount, 1200);
+
+        // Spans several IN chunks; includes a repeat and a missing id
+        QList<int> ids = reg.ids;
+        QVERIFY(AdminService::banUser(ids[7], "already").first);
+        ids.append(ids[0]);
+        ids.append(999999);
+
+        ModerationResult banned = AdminService::banUsers(ids, "spam wave");
+        QCOMPARE(banned.statuses.size(), ids.size());
+        QCOMPARE(banned.changedCount, 1199);
+        QCOMPARE(banned.statuses[0], ModerationStatus::Changed);
+        QCOMPARE(banned.statuses[7], ModerationStatus::Unchanged);
+        QCOMPARE(banned.statuses[1200], ModerationStatus::Changed);
+        QCOMPARE(banned.statuses[1201], ModerationStatus::NotFound);
+        for (int i = 0; i < 1200; ++i) {
+            QVERIFY(AuthService::isUserBannedById(reg.ids[i]));
+        }
+
+        ModerationResult unbanned = AdminService::unbanUsers(reg.ids.mid(0, 600));
+        QCOMPARE(unbanned.changedCount, 600);
+        QVERIFY(!AuthService::isUserBannedById(reg.ids[0]));
+        QVERIFY(AuthService::isUserBannedById(reg.ids[600]));
+    }
 };
 
 // main provided by tests_runner.cpp
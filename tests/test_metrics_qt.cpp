@@ -0,0 +1,123 @@
+#include <QtTest>
+#include <QStandardPaths>
+#include <QFile>
+#include <QTemporaryDir>
+#include <thread>
+#include <vector>
+
+#include "AuthService.h"
+#include "DatabaseManager.h"
+#include "Metrics.h"
+
+static void removeTestDatabaseMetrics()
+{
+    QString appData = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+    QString dbPath = appData + "/marketplace.db";
+    QFile f(dbPath);
+    if (f.exists()) f.remove();
+}
+
+// Value of one sample line ("name{labels} value") of the exposition
+static QString metricsSample(const QByteArray& text, const QString& series)
+{
+    for (const QByteArray& line : text.split('\n')) {
+        QString sample = QString::fromUtf8(line);
+        if (sample.startsWith(series + " ")) {
+            return sample.mid(series.size() + 1);
+        }
+    }
+    return QString();
+}
+
+class MetricsTest : public QObject {
+    Q_OBJECT
+
+private slots:
+    void initTestCase() {
+        QStandardPaths::setTestModeEnabled(true);
+        removeTestDatabaseMetrics();
+        DatabaseManager::getInstance();
+    }
+
+    void cleanupTestCase() {
+        removeTestDatabaseMetrics();
+    }
+
+    void testCounterSumsThreads() {
+        Metrics& metrics = Metrics::getInstance();
+        Metrics::Counter& counter = metrics.counter("test_metrics_events_total", "Test events.");
+        QCOMPARE(&metrics.counter("test_metrics_events_total", "Test events."), &counter);
+
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 8; ++t) {
+            threads.emplace_back([&counter]() {
+                for (int i = 0; i < 10000; ++i) {
+                    counter.inc();
+                }
+            });
+        }
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+        QCOMPARE(counter.value(), quint64(80000));
+
+        QByteArray text = metrics.exposition();
+        QVERIFY(text.contains("# HELP test_metrics_events_total Test events.\n"));
+        QVERIFY(text.contains("# TYPE test_metrics_events_total counter\n"));
+        QCOMPARE(metricsSample(text, "test_metrics_events_total"), QString("80000"));
+    }
+
+    void testHistogramBuckets() {
+        Metrics::Histogram& histogram = Metrics::getInstance().histogram(
+            "test_metrics_seconds", "Test latency.", {0.001, 0.01}, "kind=\"test\"");
+        histogram.observe(0.0005);
+        histogram.observe(0.005);
+        histogram.observe(0.005);
+        histogram.observe(3);
+
+        Metrics::Histogram::Snapshot snapshot = histogram.snapshot();
+        QCOMPARE(snapshot.cumulative, QList<quint64>({1, 3, 4}));
+        QCOMPARE(snapshot.count, quint64(4));
+        QVERIFY(qAbs(snapshot.sumSeconds - 3.0105) < 1e-6);
+
+        QByteArray text = Metrics::getInstance().exposition();
+        QVERIFY(text.contains("# TYPE test_metrics_seconds histogram\n"));
+        QCOMPARE(metricsSample(text, "test_metrics_seconds_bucket{kind=\"test\",le=\"0.001\"}"), QString("1"));
+        QCOMPARE(metricsSample(text, "test_metrics_seconds_bucket{kind=\"test\",le=\"+Inf\"}"), QString("4"));
+        QCOMPARE(metricsSample(text, "test_metrics_seconds_count{kind=\"test\"}"), QString("4"));
+    }
+
+    void testServiceInstrumentation() {
+        Metrics& metrics = Metrics::getInstance();
+        quint64 attempts = metrics.counter("market_login_attempts_total", "").value();
+        quint64 logins = metrics.counter("market_logins_total", "").value();
+        quint64 badCredentials = metrics.counter("market_login_failures_total", "",
+                                                 "reason=\"bad_credentials\"").value();
+        quint64 statements = metrics.counter("market_db_statements_total", "").value();
+
+        QVERIFY(AuthService::loginUser("13800138000", "admin123").first);
+        QVERIFY(!AuthService::loginUser("13800138000", "wrong-password").first);
+
+        QCOMPARE(metrics.counter("market_login_attempts_total", "").value(), attempts + 2);
+        QCOMPARE(metrics.counter("market_logins_total", "").value(), logins + 1);
+        QCOMPARE(metrics.counter("market_login_failures_total", "", "reason=\"bad_credentials\"").value(),
+                 badCredentials + 1);
+        QVERIFY(metrics.counter("market_db_statements_total", "").value() >= statements + 4);
+    }
+
+    void testWriteFile() {
+        QTemporaryDir dir;
+        QVERIFY(dir.isValid());
+        QString path = dir.filePath("market.prom");
+        QVERIFY(Metrics::getInstance().writeFile(path));
+
+        QFile file(path);
+        QVERIFY(file.open(QIODevice::ReadOnly));
+        QByteArray text = file.readAll();
+        QVERIFY(text.contains("# TYPE market_login_seconds histogram\n"));
+        QVERIFY(text.endsWith('\n'));
+    }
+};
+
+// main provided by tests_runner.cpp
+#include "test_metrics_qt.moc"
@@ -0,0 +1,302 @@
+#include <QtTest>
+#include <QStandardPaths>
+#include <QFile>
+#include <QSet>
+
+#include "AdminService.h"
+#include "AuthService.h"
+#include "DatabaseManager.h"
+#include "Report.h"
+#include "ReportService.h"
+
+static void removeTestDatabaseReports()
+{
+    QString appData = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+    QString dbPath = appData + "/marketplace.db";
+    QFile f(dbPath);
+    if (f.exists()) f.remove();
+}
+
+class ReportsTest : public QObject {
+    Q_OBJECT
+
+private:
+    int m_reporterId = 0;
+    int m_reportedId = 0;
+
+    // Reports with created_at one minute apart, oldest first; returns ids.
+    QList<int> addReports(int count, const QString& startTime) {
+        DatabaseManager& db = DatabaseManager::getInstance();
+        QList<int> ids;
+        for (int i = 0; i < count; ++i) {
+            bool ok = db.executeQuery(
+                "INSERT INTO reports (reporter_id, reported_user_id, reason, created_at) "
+                "VALUES (?, ?, ?, datetime(?, ?))",
+                {m_reporterId, m_reportedId, QString("reason %1").arg(i), startTime,
+                 QString("+%1 minutes").arg(i)});
+            if (!ok) {
+                return QList<int>();
+            }
+            ids.append(db.getLastInsertId());
+        }
+        return ids;
+    }
+
+private slots:
+    void initTestCase() {
+        QStandardPaths::setTestModeEnabled(true);
+        removeTestDatabaseReports();
+        DatabaseManager::getInstance();
+
+        auto reporter = AuthService::registerUser("19700000001", "reportpwd", "reporter");
+        auto reported = AuthService::registerUser("19700000002", "reportpwd", "spammer");
+        QVERIFY(reporter.first && reported.first);
+        m_reporterId = reporter.second.getId();
+        m_reportedId = reported.second.getId();
+    }
+
+    void testGetReportsKeepsIds() {
+        QList<int> ids = addReports(3, "2024-01-01 10:00:00");
+        QCOMPARE(ids.size(), 3);
+
+        QPair<bool, QList<Report>> reports = AdminService::getReports(0, 10);
+        QVERIFY(reports.first);
+        QCOMPARE(reports.second.size(), 3);
+        // Newest first
+        const Report& newest = reports.second.first();
+        QCOMPARE(newest.getId(), ids.last());
+        QCOMPARE(newest.getReporterId(), m_reporterId);
+        QCOMPARE(newest.getReporterName(), QString("reporter"));
+        QCOMPARE(newest.getReportedName(), QString("spammer"));
+        QCOMPARE(newest.getReason(), QString("reason 2"));
+        QVERIFY(newest.isPending());
+        QVERIFY(!newest.getResolvedAt().isValid());
+        QCOMPARE(newest.getCreatedAt(), QDateTime(QDate(2024, 1, 1), QTime(10, 2), Qt::UTC));
+        QCOMPARE(newest.details(), QString("Reported spammer: reason 2 (Status: pending)"));
+    }
+
+    void testResolveReport() {
+        QPair<bool, QList<Report>> reports = AdminService::getReports(0, 1);
+        QVERIFY(reports.first);
+        int id = reports.second.first().getId();
+
+        QPair<bool, QString> resolved = AdminService::resolveReport(id, "resolved");
+        QVERIFY2(resolved.first, qPrintable(resolved.second));
+        QVERIFY(!AdminService::resolveReport(id, "rejected").first);
+        QVERIFY(!AdminService::resolveReport(999999, "resolved").first);
+
+        // Only the two outcomes are accepted
+        int pending = AdminService::getReports(0, 2).second.last().getId();
+        QVERIFY(!AdminService::resolveReport(pending, "pending").first);
+        QVERIFY(!AdminService::resolveReport(pending, "deleted").first);
+        QSqlQuery status = DatabaseManager::getInstance().executeQueryWithResult(
+            "SELECT status, resolved_at IS NULL FROM reports WHERE id = ?", {pending});
+        QVERIFY(status.next());
+        QCOMPARE(status.value(0).toString(), QString("pending"));
+        QVERIFY(status.value(1).toBool());
+
+        reports = AdminService::getReports(0, 1);
+        QCOMPARE(reports.second.first().getStatus(), QString("resolved"));
+        QVERIFY(reports.second.first().getResolvedAt().isValid());
+    }
+
+    void testClaimQueueOldestFirst() {
+        QList<int> older = addReports(5, "2023-06-01 08:00:00");
+        QCOMPARE(older.size(), 5);
+
+        // Admin ids are plain user ids; 1 is the seeded administrator
+        QPair<bool, QList<Report>> first = AdminService::claimNextReports(1, 4);
+        QVERIFY(first.first);
+        QCOMPARE(first.second.size(), 4);
+        for (int i = 0; i < 4; ++i) {
+            QCOMPARE(first.second[i].getId(), older[i]);
+            QCOMPARE(first.second[i].getClaimedBy(), 1);
+        }
+
+        // Another admin gets the rest, never a claimed or resolved report
+        QPair<bool, QList<Report>> second = AdminService::claimNextReports(m_reporterId, 10);
+        QVERIFY(second.first);
+        QSet<int> secondIds;
+        for (const Report& report : second.second) {
+            QVERIFY(report.isPending());
+            secondIds.insert(report.getId());
+        }
+        QCOMPARE(secondIds.size(), 3);  // older[4] plus the two pending from 2024
+        QVERIFY(secondIds.contains(older[4]));
+
+        QVERIFY(AdminService::claimNextReports(1, 10).second.isEmpty());
+
+        // Resolving ends the claim; releasing returns the others to the queue
+        QVERIFY(AdminService::resolveReport(older[0], "rejected").first);
+        QPair<bool, int> released = AdminService::releaseClaims(1);
+        QVERIFY(released.first);
+        QCOMPARE(released.second, 3);
+
+        QPair<bool, QList<Report>> again = AdminService::claimNextReports(1, 10);
+        QCOMPARE(again.second.size(), 3);
+        QCOMPARE(again.second.first().getId(), older[1]);
+
+        // An abandoned claim times out and goes to the next admin
+        QVERIFY(DatabaseManager::getInstance().executeQuery(
+            "UPDATE reports SET claimed_at = datetime('now', ?) WHERE id = ?",
+            {QString("-%1 seconds").arg(AdminService::kClaimTimeoutSecs + 60), older[1]}));
+        QPair<bool, QList<Report>> expired = AdminService::claimNextReports(m_reporterId, 10);
+        QVERIFY(expired.first);
+        QCOMPARE(expired.second.size(), 1);
+        QCOMPARE(expired.second.first().getId(), older[1]);
+        QCOMPARE(expired.second.first().getClaimedBy(), m_reporterId);
+        QCOMPARE(AdminService::releaseClaims(1).second, 2);
+        QCOMPARE(AdminService::releaseClaims(m_reporterId).second, 4);
+    }
+
+    void testQueueUsesPartialIndex() {
+        QSqlQuery plan = DatabaseManager::getInstance().executeQueryWithResult(
+            "EXPLAIN QUERY PLAN SELECT id FROM reports WHERE status = 'pending' "
+            "AND claimed_by IS NULL ORDER BY created_at, id LIMIT 10");
+        QString details;
+        while (plan.next()) {
+            details += plan.value(3).toString() + "\n";
+        }
+        QVERIFY2(details.contains("idx_reports_queue"), qPrintable(details));
+        QVERIFY2(!details.contains("TEMP B-TREE"), qPrintable(details));
+    }
+
+    void testSubmitReportAutoBans() {
+        QList<int> reporters;
+        for (int i = 0; i < 3; ++i) {
+            auto user = AuthService::registerUser(QString("1970000010%1").arg(i), "reportpwd");
+            QVERIFY(user.first);
+            reporters.append(user.second.getId());
+        }
+        auto target = AuthService::registerUser("19700000200", "reportpwd", "target");
+        QVERIFY(target.first);
+        int targetId = target.second.getId();
+
+        AutoBanRule rule;
+        rule.name = "test threshold";
+        rule.minDistinctReporters = 3;
+        rule.minPendingReports = 3;
+        AutoBanPolicy policy;
+        policy.addRule(rule);
+        ReportService::setAutoBanPolicy(policy);
+
+        QVERIFY(!ReportService::submitReport(targetId, targetId, "self").ok);
+        QVERIFY(!ReportService::submitReport(reporters[0], targetId, " ").ok);
+        QVERIFY(!ReportService::submitReport(reporters[0], 999999, "ghost").ok);
+
+        // A repeat reporter adds to the totals but not to distinct reporters
+        ReportSubmission first = ReportService::submitReport(reporters[0], targetId, "scam");
+        ReportSubmission repeat = ReportService::submitReport(reporters[0], targetId, "scam again");
+        QVERIFY(first.ok && repeat.ok);
+        QVERIFY(first.reportId > 0 && repeat.reportId > first.reportId);
+        QCOMPARE(repeat.stats.totalReports, 2);
+        QCOMPARE(repeat.stats.pendingReports, 2);
+        QCOMPARE(repeat.stats.distinctReporters, 1);
+        QVERIFY(repeat.stats.lastReportAt.isValid());
+        QVERIFY(!repeat.autoBanned);
+
+        ReportSubmission second = ReportService::submitReport(reporters[1], targetId, "scam");
+        QVERIFY(second.ok && !second.autoBanned);
+        QVERIFY(!AuthService::isUserBannedById(targetId));
+
+        ReportSubmission third = ReportService::submitReport(reporters[2], targetId, "scam");
+        QVERIFY(third.ok);
+        QCOMPARE(third.stats.distinctReporters, 3);
+        QVERIFY(third.autoBanned);
+        QVERIFY(AuthService::isUserBannedById(targetId));
+
+        // Resolving lowers the pending count only
+        QVERIFY(AdminService::resolveReport(first.reportId, "rejected").first);
+        QPair<bool, ReportStats> stats = ReportService::getReportStats(targetId);
+        QVERIFY(stats.first);
+        QCOMPARE(stats.second.totalReports, 4);
+        QCOMPARE(stats.second.pendingReports, 3);
+        QCOMPARE(stats.second.distinctReporters, 3);
+
+        // The seeded administrator is never auto-banned
+        for (int reporterId : reporters) {
+            QVERIFY(!ReportService::submitReport(reporterId, 1, "admin").autoBanned);
+        }
+        QVERIFY(!AuthService::isUserBannedById(1));
+
+        ReportService::setAutoBanPolicy(AutoBanPolicy::defaultPolicy());
+    }
+
+    void testCountersMatchAggregates() {
+        DatabaseManager& db = DatabaseManager::getInstance();
+        // Deleting the only report of a reporter drops them from distinct
+        QVERIFY(db.executeQuery("DELETE FROM reports WHERE id = (SELECT MIN(id) FROM reports "
+                                "WHERE reported_user_id = 1)"));
+
+        QSqlQuery mismatches = db.executeQueryWithResult(
+            "SELECT a.reported_user_id FROM "
+            "(SELECT reported_user_id, COUNT(*) AS total, SUM(status = 'pending') AS pending, "
+            "COUNT(DISTINCT reporter_id) AS reporters FROM reports GROUP BY reported_user_id) a "
+            "LEFT JOIN user_report_stats s ON s.user_id = a.reported_user_id "
+            "WHERE s.user_id IS NULL OR s.total_reports <> a.total "
+            "OR s.pending_reports <> a.pending OR s.distinct_reporters <> a.reporters");
+        QVERIFY(!mismatches.lastError().isValid());
+        QVERIFY2(!mismatches.next(), qPrintable(mismatches.value(0).toString()));
+
+        QPair<bool, ReportStats> admin = ReportService::getReportStats(1);
+        QVERIFY(admin.first);
+        QCOMPARE(admin.second.totalReports, 2);
+        QCOMPARE(admin.second.distinctReporters, 2);
+
+        QPair<bool, ReportStats> never = ReportService::getReportStats(999999);
+        QVERIFY(never.first);
+        QCOMPARE(never.second.totalReports, 0);
+    }
+
+    void testMarketStatsMatchRecount() {
+        QPair<bool, MarketStats> before = AdminService::getStats();
+        QPair<bool, MarketStats> counted = AdminService::recomputeStats();
+        QVERIFY(before.first && counted.first);
+        QVERIFY(before.second == counted.second);
+        QCOMPARE(before.second.adminUsers, 1);
+
+        auto user = AuthService::registerUser("19700000300", "reportpwd", "statsuser");
+        QVERIFY(user.first);
+        int userId = user.second.getId();
+        QVERIFY(AdminService::banUser(userId, "stats").first);
+        ReportSubmission report = ReportService::submitReport(userId, m_reportedId, "stats");
+        QVERIFY(report.ok);
+        QVERIFY(AdminService::resolveReport(report.reportId, "resolved").first);
+
+        QPair<bool, MarketStats> after = AdminService::getStats();
+        QVERIFY(after.first);
+        QCOMPARE(after.second.totalUsers, before.second.totalUsers + 1);
+        QCOMPARE(after.second.bannedUsers, before.second.bannedUsers + 1);
+        QCOMPARE(after.second.resolvedReports, before.second.resolvedReports + 1);
+        QCOMPARE(after.second.pendingReports, before.second.pendingReports);
+
+        // Deletes are counted out as well
+        DatabaseManager& db = DatabaseManager::getInstance();
+        QVERIFY(db.executeQuery("DELETE FROM reports WHERE id = ?", {report.reportId}));
+        QVERIFY(db.executeQuery("DELETE FROM users WHERE id = ?", {userId}));
+        counted = AdminService::recomputeStats();
+        QVERIFY(counted.first);
+        QVERIFY(AdminService::getStats().second == counted.second);
+        QCOMPARE(counted.second.totalUsers, before.second.totalUsers);
+    }
+
+    void testMissingMarketStatsRowIsRecounted() {
+        // As left by a first run that stopped after creating the table
+        DatabaseManager& db = DatabaseManager::getInstance();
+        QVERIFY(db.executeQuery("DELETE FROM market_stats"));
+        QVERIFY(!AdminService::getStats().first);
+
+        QVERIFY(DatabaseManager::createMarketStats(db.getDatabase()));
+        QPair<bool, MarketStats> stats = AdminService::getStats();
+        QVERIFY(stats.first);
+        QVERIFY(stats.second == AdminService::recomputeStats().second);
+        QVERIFY(stats.second.totalUsers > 0);
+
+        // Present rows are left to the triggers
+        QVERIFY(DatabaseManager::createMarketStats(db.getDatabase()));
+        QVERIFY(AdminService::getStats().second == stats.second);
+    }
+};
+
+// main provided by tests_runner.cpp
+#include "test_reports_qt.moc"
@@ -0,0 +1,249 @@
+#include <QtTest>
+#include <QStandardPaths>
+#include <QDir>
+#include <QFile>
+#include <QSet>
+#include <QTemporaryDir>
+
+#include "ApiToken.h"
+#include "AuthService.h"
+#include "DatabaseManager.h"
+#include "ServiceProtocol.h"
+#include "ShardRouter.h"
+
+static void removeTestDatabaseProtocol()
+{
+    QString appData = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+    QString dbPath = appData + "/marketplace.db";
+    QFile f(dbPath);
+    if (f.exists()) f.remove();
+    for (int shard = 0; shard < 4; ++shard) {
+        QFile::remove(ShardRouter::shardPath(shard));
+    }
+}
+
+// Request payload: header, then each argument as qint32 or string
+static QByteArray serviceRequest(quint32 requestId, quint8 opcode, const QVariantList& args = {})
+{
+    QByteArray payload;
+    QDataStream out(&payload, QIODevice::WriteOnly);
+    out.setVersion(QDataStream::Qt_6_0);
+    out.setByteOrder(QDataStream::BigEndian);
+    out << requestId << opcode;
+    for (const QVariant& arg : args) {
+        if (arg.typeId() == QMetaType::Int) {
+            out << static_cast<qint32>(arg.toInt());
+        } else {
+            ServiceProtocol::writeString(out, arg.toString());
+        }
+    }
+    return payload;
+}
+
+// Status of a response, checking it answers requestId; message responses only
+static int serviceStatus(const QByteArray& response, quint32 requestId, QString* message = nullptr)
+{
+    QDataStream in(response);
+    in.setVersion(QDataStream::Qt_6_0);
+    in.setByteOrder(QDataStream::BigEndian);
+    quint32 answered = 0;
+    quint8 status = 0;
+    in >> answered >> status;
+    if (in.status() != QDataStream::Ok || answered != requestId) {
+        return -1;
+    }
+    if (message) {
+        *message = ServiceProtocol::readString(in);
+    }
+    return status;
+}
+
+// User ids of a user list response, in order; empty unless it answers requestId with Ok
+static QList<int> protocolUserIds(const QByteArray& response, quint32 requestId)
+{
+    QDataStream in(response);
+    in.setVersion(QDataStream::Qt_6_0);
+    in.setByteOrder(QDataStream::BigEndian);
+    quint32 answered = 0;
+    quint8 status = 0;
+    quint32 count = 0;
+    in >> answered >> status >> count;
+    QList<int> ids;
+    if (in.status() != QDataStream::Ok || answered != requestId || status != ServiceProtocol::Ok) {
+        return ids;
+    }
+    for (quint32 i = 0; i < count; ++i) {
+        qint32 id = 0;
+        qint64 createdAt = 0;
+        quint8 flags = 0;
+        in >> id;
+        ServiceProtocol::readString(in);
+        ServiceProtocol::readString(in);
+        in >> createdAt >> flags;
+        ids.append(id);
+    }
+    return in.status() == QDataStream::Ok ? ids : QList<int>();
+}
+
+class ServiceProtocolTest : public QObject {
+    Q_OBJECT
+
+private slots:
+    void initTestCase() {
+        QStandardPaths::setTestModeEnabled(true);
+        removeTestDatabaseProtocol();
+        DatabaseManager::getInstance();
+    }
+
+    void cleanupTestCase() {
+        removeTestDatabaseProtocol();
+    }
+
+    void testTakeFrame() {
+        QByteArray first = ServiceProtocol::frame("hello");
+        QByteArray second = ServiceProtocol::frame(QByteArray());
+        QByteArray buffer = first + second.left(2);
+
+        QByteArray payload;
+        bool malformed = true;
+        QVERIFY(ServiceProtocol::takeFrame(buffer, &payload, &malformed));
+        QVERIFY(!malformed);
+        QCOMPARE(payload, QByteArray("hello"));
+
+        // Half a header: wait for more
+        QVERIFY(!ServiceProtocol::takeFrame(buffer, &payload, &malformed));
+        QVERIFY(!malformed);
+        buffer += second.mid(2);
+        QVERIFY(ServiceProtocol::takeFrame(buffer, &payload, &malformed));
+        QVERIFY(payload.isEmpty());
+        QVERIFY(buffer.isEmpty());
+
+        // A body that has not fully arrived yet
+        buffer = ServiceProtocol::frame("abcdef").left(7);
+        QVERIFY(!ServiceProtocol::takeFrame(buffer, &payload, &malformed));
+        QVERIFY(!malformed);
+        QCOMPARE(buffer.size(), 7);
+
+        buffer = QByteArray::fromHex("7fffffff") + "x";
+        QVERIFY(!ServiceProtocol::takeFrame(buffer, &payload, &malformed));
+        QVERIFY(malformed);
+    }
+
+    void testMalformedRequests() {
+        ServiceProtocol::Caller caller;
+        QCOMPARE(serviceStatus(ServiceProtocol::handleRequest(QByteArray("\0\0", 2), caller), 0),
+                 int(ServiceProtocol::BadRequest));
+        QCOMPARE(serviceStatus(ServiceProtocol::handleRequest(serviceRequest(3, 99), caller), 3),
+                 int(ServiceProtocol::BadRequest));
+        // Login without its password argument
+        QCOMPARE(serviceStatus(ServiceProtocol::handleRequest(
+                     serviceRequest(4, ServiceProtocol::Login, {"13800138000"}), caller), 4),
+                 int(ServiceProtocol::BadRequest));
+
+        QString message;
+        QCOMPARE(serviceStatus(ServiceProtocol::handleRequest(
+                     serviceRequest(5, ServiceProtocol::Ping), caller), 5, &message),
+                 int(ServiceProtocol::Ok));
+        QCOMPARE(message, QString("pong"));
+        QCOMPARE(serviceStatus(ServiceProtocol::handleRequest(
+                     serviceRequest(6, ServiceProtocol::ListUsers, {2147483647, 10000}), caller), 6),
+                 int(ServiceProtocol::BadRequest));
+    }
+
+    void testModerationNeedsToken() {
+        QPair<bool, User> created = AuthService::registerUser("13600000001", "protocolpwd", "protocol");
+        QVERIFY(created.first);
+        int userId = created.second.getId();
+        QByteArray ban = serviceRequest(10, ServiceProtocol::BanUser, {userId, "spam"});
+
+        ServiceProtocol::Caller caller;
+        QCOMPARE(serviceStatus(ServiceProtocol::handleRequest(ban, caller), 10),
+                 int(ServiceProtocol::Unauthorized));
+        QVERIFY(!AuthService::isUserBannedById(userId));
+
+        // Ordinary requests are not routed to authenticate()
+        QByteArray response;
+        QByteArray token(64, 'a');
+        QVERIFY(!ServiceProtocol::authenticate(serviceRequest(11, ServiceProtocol::Ping), token,
+                                               &caller, &response));
+        QVERIFY(response.isEmpty());
+
+        QVERIFY(ServiceProtocol::authenticate(serviceRequest(12, ServiceProtocol::Authenticate, {"wrong"}),
+                                              token, &caller, &response));
+        QCOMPARE(serviceStatus(response, 12), int(ServiceProtocol::Unauthorized));
+        QVERIFY(!caller.authorized);
+
+        QVERIFY(ServiceProtocol::authenticate(serviceRequest(13, ServiceProtocol::Authenticate,
+                                                             {QString::fromLatin1(token)}),
+                                              token, &caller, &response));
+        QCOMPARE(serviceStatus(response, 13), int(ServiceProtocol::Ok));
+        QVERIFY(caller.authorized);
+
+        QCOMPARE(serviceStatus(ServiceProtocol::handleRequest(ban, caller), 10), int(ServiceProtocol::Ok));
+        QVERIFY(AuthService::isUserBannedById(userId));
+        QCOMPARE(serviceStatus(ServiceProtocol::handleRequest(
+                     serviceRequest(14, ServiceProtocol::UnbanUser, {userId}), caller), 14),
+                 int(ServiceProtocol::Ok));
+        QVERIFY(!AuthService::isUserBannedById(userId));
+    }
+
+    void testShardedListing() {
+        QVERIFY(ShardRouter::getInstance().configure(4));
+        QSet<int> created;
+        for (int i = 0; i < 12; ++i) {
+            QPair<bool, User> user = AuthService::registerUser(QString("1361000%1").arg(i, 4, 10, QChar('0')),
+                                                               "protocolpwd");
+            QVERIFY(user.first);
+            created.insert(user.second.getId());
+        }
+
+        // Pages over every shard, without gaps or repeats
+        ServiceProtocol::Caller caller;
+        QList<int> listed;
+        for (int page = 0; page < 3; ++page) {
+            QList<int> ids = protocolUserIds(ServiceProtocol::handleRequest(
+                serviceRequest(20 + page, ServiceProtocol::ListUsers, {page, 5}), caller), 20 + page);
+            QCOMPARE(ids.size(), page < 2 ? 5 : 2);
+            listed += ids;
+        }
+        QCOMPARE(QSet<int>(listed.cbegin(), listed.cend()), created);
+        QCOMPARE(listed.size(), created.size());
+
+        QVERIFY(ShardRouter::getInstance().configure(0));
+    }
+
+    void testTokenFile() {
+        QTemporaryDir dir;
+        QVERIFY(dir.isValid());
+        QString path = dir.filePath("nested/daemon.token");
+
+        QString error;
+        QByteArray token = ApiToken::loadOrCreate(path, &error);
+        QVERIFY2(!token.isEmpty(), qPrintable(error));
+        QCOMPARE(ApiToken::loadOrCreate(path, &error), token);
+        QCOMPARE(QFile::permissions(path) & (QFileDevice::ReadGroup | QFileDevice::ReadOther),
+                 QFileDevice::Permissions());
+
+        // An existing file that cannot be read, or holds no token, is an error
+        QString unreadable = dir.filePath("directory.token");
+        QVERIFY(QDir().mkpath(unreadable));
+        error.clear();
+        QVERIFY(ApiToken::loadOrCreate(unreadable, &error).isEmpty());
+        QVERIFY(!error.isEmpty());
+        QString shortPath = dir.filePath("short.token");
+        QFile shortFile(shortPath);
+        QVERIFY(shortFile.open(QIODevice::WriteOnly));
+        shortFile.write("abc\n");
+        shortFile.close();
+        error.clear();
+        QVERIFY(ApiToken::loadOrCreate(shortPath, &error).isEmpty());
+        QVERIFY(!error.isEmpty());
+
+        QVERIFY(ApiToken::matches(token, token));
+        QVERIFY(!ApiToken::matches(token, token.left(token.size() - 1) + "x"));
+        QVERIFY(!ApiToken::matches(QByteArray(), QByteArray()));
+    }
+};
+
+// main provided by tests_runner.cpp
+#include "test_serviceprotocol_qt.moc"
@@ -0,0 +1,289 @@
+#include <QtTest>
+#include <QStandardPaths>
+#include <QFile>
+#include <QSet>
+#include <limits>
+
+#include "AdminService.h"
+#include "AuthService.h"
+#include "ChangeFeed.h"
+#include "DatabaseManager.h"
+#include "ReportService.h"
+#include "ShardRouter.h"
+
+static void removeTestDatabaseShards()
+{
+    QString appData = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+    QString dbPath = appData + "/marketplace.db";
+    QFile f(dbPath);
+    if (f.exists()) f.remove();
+    for (int shard = 0; shard < 8; ++shard) {
+        QFile::remove(ShardRouter::shardPath(shard));
+    }
+}
+
+static QString shardTestPhone(int i)
+{
+    return QString("139%1").arg(i, 8, 10, QChar('0'));
+}
+
+class ShardRouterTest : public QObject {
+    Q_OBJECT
+
+private slots:
+    void initTestCase() {
+        QStandardPaths::setTestModeEnabled(true);
+        removeTestDatabaseShards();
+        DatabaseManager::getInstance();
+        QVERIFY(ShardRouter::getInstance().configure(4));
+    }
+
+    void cleanupTestCase() {
+        // Later suites use the primary file only
+        QVERIFY(ShardRouter::getInstance().configure(0));
+        removeTestDatabaseShards();
+    }
+
+    void testRouting() {
+        ShardRouter& shards = ShardRouter::getInstance();
+        QCOMPARE(shards.shardCount(), 4);
+
+        QSet<int> ids;
+        QSet<int> used;
+        for (int i = 0; i < 40; ++i) {
+            QString phone = shardTestPhone(i);
+            QPair<bool, User> created = AuthService::registerUser(phone, "shardpwd");
+            QVERIFY(created.first);
+            int id = created.second.getId();
+            int shard = shards.shardForPhone(phone);
+            // The id alone leads back to the row
+            QCOMPARE(shards.shardForId(id), shard);
+            QVERIFY(!ids.contains(id));
+            ids.insert(id);
+            used.insert(shard);
+
+            QSqlQuery row = shards.executeQueryWithResult(shard, "SELECT id FROM users WHERE phone = ?", {phone});
+            QVERIFY(row.next());
+            QCOMPARE(row.value(0).toInt(), id);
+        }
+        QCOMPARE(used.size(), 4);
+        for (int shard = 0; shard < shards.shardCount(); ++shard) {
+            QSqlQuery mode = shards.executeQueryWithResult(shard, "PRAGMA journal_mode");
+            QVERIFY(mode.next());
+            QCOMPARE(mode.value(0).toString(), QString("wal"));
+        }
+
+        QVERIFY(!AuthService::registerUser(shardTestPhone(0), "shardpwd").first);
+        QSqlQuery primary = DatabaseManager::getInstance().executeQueryWithResult(
+            "SELECT COUNT(*) FROM users WHERE phone LIKE '139%'");
+        QVERIFY(primary.next());
+        QCOMPARE(primary.value(0).toInt(), 0);
+    }
+
+    void testLoginAndBan() {
+        QPair<bool, User> admin = AuthService::loginUser("13800138000", "admin123");
+        QVERIFY(admin.first);
+        QVERIFY(admin.second.isAdmin());
+
+        QString phone = shardTestPhone(5);
+        QPair<bool, User> user = AuthService::loginUser(phone, "shardpwd");
+        QVERIFY(user.first);
+        int id = user.second.getId();
+
+        QVERIFY(AdminService::banUser(id, "shard test", admin.second.getId()).first);
+        QVERIFY(AuthService::isUserBannedById(id));
+        QVERIFY(AuthService::isUserBanned(phone));
+        QVERIFY(!AuthService::loginUser(phone, "shardpwd").first);
+        QCOMPARE(AdminService::banUser(id, "again").second, QString("User is already banned"));
+        QVERIFY(AdminService::unbanUser(id).first);
+        QVERIFY(AuthService::loginUser(phone, "shardpwd").first);
+        QCOMPARE(AdminService::banUser(999999, "missing").second, QString("User not found"));
+
+        // Bulk moderation groups the ids by shard
+        QList<int> group;
+        for (int i = 10; i < 16; ++i) {
+            group.append(AuthService::loginUser(shardTestPhone(i), "shardpwd").second.getId());
+        }
+        QCOMPARE(AdminService::banUsers(group, "bulk").changedCount, group.size());
+        QCOMPARE(AdminService::listUsersAfter(ListCursor(), 50, true).users.size(), group.size());
+        QCOMPARE(AdminService::unbanUsers(group).changedCount, group.size());
+    }
+
+    void testBatchRegistration() {
+        ShardRouter& shards = ShardRouter::getInstance();
+        RegistrationBatch batch;
+        batch.phones = {"13900001000", "13900001001", shardTestPhone(1), "13900001000", "bad"};
+        batch.passwords = {"batchpwd", "batchpwd", "batchpwd", "batchpwd", "batchpwd"};
+        RegistrationResult result = AuthService::registerUsers(batch);
+
+        QCOMPARE(result.createdCount, 2);
+        QCOMPARE(result.statuses[0], RegistrationStatus::Created);
+        QCOMPARE(result.statuses[1], RegistrationStatus::Created);
+        QCOMPARE(result.statuses[2], RegistrationStatus::AlreadyRegistered);
+        QCOMPARE(result.statuses[3], RegistrationStatus::DuplicateInBatch);
+        QCOMPARE(result.statuses[4], RegistrationStatus::InvalidInput);
+        QCOMPARE(shards.shardForId(result.ids[0]), shards.shardForPhone(batch.phones[0]));
+        QCOMPARE(shards.shardForId(result.ids[1]), shards.shardForPhone(batch.phones[1]));
+        QVERIFY(AuthService::loginUser("13900001001", "batchpwd").first);
+    }
+
+    void testFanOutListing() {
+        ShardRouter& shards = ShardRouter::getInstance();
+        int total = 0;
+        for (int shard = 0; shard < shards.shardCount(); ++shard) {
+            QSqlQuery count = shards.executeQueryWithResult(shard, "SELECT COUNT(*) FROM users");
+            QVERIFY(count.next());
+            total += count.value(0).toInt();
+        }
+
+        // Page by page through all shards, newest first, nothing twice
+        QList<int> seen;
+        ListCursor cursor;
+        qint64 lastSecs = std::numeric_limits<qint64>::max();
+        int lastId = std::numeric_limits<int>::max();
+        for (;;) {
+            UserListResult page = AdminService::listUsersAfter(cursor, 7);
+            QVERIFY(page.ok);
+            if (page.users.isEmpty()) {
+                break;
+            }
+            for (int row = 0; row < page.users.size(); ++row) {
+                qint64 secs = page.users.createdAtSecs(row);
+                int id = page.users.id(row);
+                QVERIFY(secs < lastSecs || (secs == lastSecs && id < lastId));
+                lastSecs = secs;
+                lastId = id;
+                seen.append(id);
+            }
+            cursor = page.next;
+        }
+        QCOMPARE(seen.size(), total);
+        QCOMPARE(QSet<int>(seen.begin(), seen.end()).size(), total);
+
+        // Search falls back to substring matching, merged by id
+        QList<int> found;
+        ListCursor after;
+        for (;;) {
+            UserListResult page = AdminService::searchUsers("3900000", after, 15);
+            QVERIFY(page.ok);
+            if (page.users.isEmpty()) {
+                break;
+            }
+            for (int row = 0; row < page.users.size(); ++row) {
+                QVERIFY(found.isEmpty() || page.users.id(row) > found.last());
+                found.append(page.users.id(row));
+            }
+            after = page.next;
+        }
+        QCOMPARE(found.size(), 40);
+    }
+
+    void testReports() {
+        ShardRouter& shards = ShardRouter::getInstance();
+        AutoBanPolicy savedPolicy = ReportService::autoBanPolicy();
+        ReportService::setAutoBanPolicy(AutoBanPolicy());
+
+        QPair<bool, User> reporter = AuthService::registerUser("13900002000", "shardpwd", "Reporter");
+        QPair<bool, User> second = AuthService::registerUser("13900002001", "shardpwd", "Second");
+        QVERIFY(reporter.first && second.first);
+
+        // Reported user on another shard than the reporter
+        int reported = -1;
+        for (int i = 0; i < 40 && reported < 0; ++i) {
+            if (shards.shardForPhone(shardTestPhone(i)) != shards.shardForId(reporter.second.getId())) {
+                reported = AuthService::loginUser(shardTestPhone(i), "shardpwd").second.getId();
+            }
+        }
+        QVERIFY(reported > 0);
+
+        ReportSubmission first = ReportService::submitReport(reporter.second.getId(), reported, "shard spam");
+        QVERIFY2(first.ok, qPrintable(first.message));
+        QCOMPARE(shards.shardForId(first.reportId), shards.shardForId(reported));
+        QCOMPARE(first.stats.totalReports, 1);
+        ReportSubmission again = ReportService::submitReport(second.second.getId(), reported, "shard scam");
+        QVERIFY2(again.ok, qPrintable(again.message));
+        QCOMPARE(again.stats.totalReports, 2);
+        QCOMPARE(again.stats.pendingReports, 2);
+        QCOMPARE(again.stats.distinctReporters, 2);
+        QVERIFY(!ReportService::submitReport(999999, reported, "ghost").ok);
+
+        QPair<bool, QList<Report>> listed = AdminService::getReportsAfter(ListCursor(), 10);
+        QVERIFY(listed.first);
+        QCOMPARE(listed.second.size(), 2);
+        QSet<QString> names;
+        for (const Report& report : listed.second) {
+            QCOMPARE(report.getReportedUserId(), reported);
+            names.insert(report.getReporterName());
+        }
+        QCOMPARE(names, QSet<QString>({"Reporter", "Second"}));
+
+        QVERIFY(AdminService::resolveReport(first.reportId, "resolved").first);
+        QCOMPARE(AdminService::resolveReport(first.reportId, "rejected").second,
+                 QString("Report has already been processed"));
+        QPair<bool, ReportStats> stats = ReportService::getReportStats(reported);
+        QVERIFY(stats.first);
+        QCOMPARE(stats.second.totalReports, 2);
+        QCOMPARE(stats.second.pendingReports, 1);
+
+        ReportService::setAutoBanPolicy(savedPolicy);
+    }
+
+    void testQueueAndStatsSpanShards() {
+        ShardRouter& shards = ShardRouter::getInstance();
+        AutoBanPolicy savedPolicy = ReportService::autoBanPolicy();
+        ReportService::setAutoBanPolicy(AutoBanPolicy());
+        int reporter = AuthService::loginUser("13900002000", "shardpwd").second.getId();
+        QSet<int> reportShards;
+        for (int i = 20; i < 28; ++i) {
+            int reported = AuthService::loginUser(shardTestPhone(i), "shardpwd").second.getId();
+            ReportSubmission filed = ReportService::submitReport(reporter, reported, "queue");
+            QVERIFY2(filed.ok, qPrintable(filed.message));
+            reportShards.insert(shards.shardForId(filed.reportId));
+        }
+        QVERIFY(reportShards.size() > 1);
+        ReportService::setAutoBanPolicy(savedPolicy);
+
+        // Dashboard totals add up the shards' own rows
+        QPair<bool, MarketStats> stats = AdminService::getStats();
+        QVERIFY(stats.first);
+        QCOMPARE(stats.second, AdminService::recomputeStats().second);
+        QCOMPARE(stats.second.pendingReports, 9);
+
+        // Two admins split the queue without overlap
+        QPair<bool, QList<Report>> first = AdminService::claimNextReports(1, 5);
+        QPair<bool, QList<Report>> second = AdminService::claimNextReports(2, 5);
+        QVERIFY(first.first && second.first);
+        QCOMPARE(first.second.size(), 5);
+        QCOMPARE(second.second.size(), 4);
+        QSet<int> claimed;
+        for (const Report& report : first.second) {
+            QCOMPARE(report.getClaimedBy(), 1);
+            claimed.insert(report.getId());
+        }
+        for (const Report& report : second.second) {
+            QCOMPARE(report.getClaimedBy(), 2);
+            claimed.insert(report.getId());
+        }
+        QCOMPARE(claimed.size(), 9);
+        for (int i = 1; i < first.second.size(); ++i) {
+            QVERIFY(first.second[i - 1].getCreatedAt() <= first.second[i].getCreatedAt());
+        }
+        QCOMPARE(AdminService::releaseClaims(2), qMakePair(true, 4));
+        QCOMPARE(AdminService::claimNextReports(3, 10).second.size(), 4);
+        QCOMPARE(AdminService::releaseClaims(1), qMakePair(true, 5));
+        QCOMPARE(AdminService::releaseClaims(3), qMakePair(true, 4));
+
+        // The change log does not cover shard files
+        ChangeFeed feed;
+        QVERIFY(!feed.poll());
+    }
+
+    void testCountMismatch() {
+        // The files were made for four shards; three would misplace rows
+        QVERIFY(!ShardRouter::getInstance().configure(3));
+        QCOMPARE(ShardRouter::getInstance().shardCount(), 4);
+    }
+};
+
+// main provided by tests_runner.cpp
+#include "test_shardrouter_qt.moc"
@@ -0,0 +1,275 @@
+#include <QtTest>
+#include <QStandardPaths>
+#include <QFile>
+#include <QSet>
+#include <QThreadPool>
+
+#include "AdminService.h"
+#include "AuthService.h"
+#include "DatabaseManager.h"
+#include "UserTableModel.h"
+#include "ReportTableModel.h"
+#include "ChangeNotifier.h"
+
+static void removeTestDatabaseTableModels()
+{
+    QString appData = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+    QString dbPath = appData + "/marketplace.db";
+    QFile f(dbPath);
+    if (f.exists()) f.remove();
+}
+
+static int countRows(const QString& query)
+{
+    QSqlQuery result = DatabaseManager::getInstance().executeQueryWithResult(query);
+    return result.next() ? result.value(0).toInt() : -1;
+}
+
+class TableModelTest : public QObject {
+    Q_OBJECT
+
+private slots:
+    void initTestCase() {
+        QStandardPaths::setTestModeEnabled(true);
+        removeTestDatabaseTableModels();
+        DatabaseManager::getInstance();
+
+        // Same created_at second for most rows, so the id tiebreak matters
+        RegistrationBatch batch;
+        for (int i = 0; i < 5000; ++i) {
+            batch.phones.append(QString("133%1").arg(i, 8, 10, QChar('0')));
+            batch.passwords.append("modelpwd");
+        }
+        QCOMPARE(AuthService::registerUsers(batch).createdCount, 5000);
+    }
+
+    void testKeysetPagesCoverEveryUserOnce() {
+        QSet<int> seen;
+        ListCursor cursor;
+        while (true) {
+            UserListResult page = AdminService::listUsersAfter(cursor, 700);
+            QVERIFY(page.ok);
+            for (int i = 0; i < page.users.size(); ++i) {
+                QVERIFY(!seen.contains(page.users.id(i)));
+                seen.insert(page.users.id(i));
+            }
+            if (page.users.size() < 700) {
+                break;
+            }
+            cursor.createdAtSecs = page.users.createdAtSecs(page.users.size() - 1);
+            cursor.id = page.users.id(page.users.size() - 1);
+        }
+        QCOMPARE(seen.size(), countRows("SELECT COUNT(*) FROM users"));
+    }
+
+    void testModelFetchesOnDemand() {
+        UserTableModel model;
+        QCOMPARE(model.rowCount(), 0);
+        QVERIFY(model.canFetchMore(QModelIndex()));
+
+        model.fetchMore(QModelIndex());
+        QCOMPARE(model.rowCount(), int(UserTableModel::kPageSize));
+        int firstId = model.userId(0);
+        QVERIFY(firstId > 0);
+        QCOMPARE(model.data(model.index(0, UserTableModel::IdColumn)).toInt(), firstId);
+
+        while (model.canFetchMore(QModelIndex())) {
+            model.fetchMore(QModelIndex());
+        }
+        QCOMPARE(model.rowCount(), countRows("SELECT COUNT(*) FROM users"));
+        QVERIFY(model.cachedPageCount() <= UserTableModel::kCachedPages);
+
+        // First page was evicted; it is re-read from its cursor
+        QCOMPARE(model.userId(0), firstId);
+        QCOMPARE(model.data(model.index(model.rowCount() - 1, UserTableModel::StatusColumn)).toString(),
+                 QString("Active"));
+        QVERIFY(!model.data(model.index(model.rowCount(), 0)).isValid());
+    }
+
+    void testBannedOnly() {
+        QPair<bool, QList<User>> some = AdminService::getAllUsers(0, 3);
+        QVERIFY(some.first);
+        for (const User& user : some.second) {
+            QVERIFY(AdminService::banUser(user.getId(), "model test").first);
+        }
+
+        UserTableModel model;
+        model.setBannedOnly(true);
+        while (model.canFetchMore(QModelIndex())) {
+            model.fetchMore(QModelIndex());
+        }
+        QCOMPARE(model.rowCount(), countRows("SELECT COUNT(*) FROM users WHERE is_banned = 1"));
+        for (int row = 0; row < model.rowCount(); ++row) {
+            QVERIFY(model.isBanned(row));
+        }
+    }
+
+    void testBanPatchesRowInPlace() {
+        UserTableModel model;
+        model.fetchMore(QModelIndex());
+        int rows = model.rowCount();
+        int row = 0;
+        while (row < rows && model.isBanned(row)) {
+            ++row;
+        }
+        QVERIFY(row < rows);
+        int userId = model.userId(row);
+
+        QSignalSpy changed(&ChangeNotifier::getInstance(), &ChangeNotifier::userChanged);
+        QSignalSpy patched(&model, &QAbstractItemModel::dataChanged);
+        QSignalSpy reset(&model, &QAbstractItemModel::modelReset);
+        QVERIFY(AdminService::banUser(userId, "patch test").first);
+
+        QCOMPARE(changed.count(), 1);
+        User user = changed.first().first().value<User>();
+        QCOMPARE(user.getId(), userId);
+        QVERIFY(user.isBanned());
+        QCOMPARE(patched.count(), 1);
+        QCOMPARE(patched.first().first().toModelIndex().row(), row);
+        QCOMPARE(reset.count(), 0);
+        QCOMPARE(model.rowCount(), rows);
+        QVERIFY(model.isBanned(row));
+        QCOMPARE(model.data(model.index(row, UserTableModel::StatusColumn)).toString(), QString("Banned"));
+
+        // A failed ban changes nothing and announces nothing
+        QVERIFY(!AdminService::banUser(userId, "patch test").first);
+        QCOMPARE(changed.count(), 1);
+
+        QVERIFY(AdminService::unbanUser(userId).first);
+        QVERIFY(!model.isBanned(row));
+    }
+
+    void testPrefetchAdjacentPages() {
+        UserTableModel reference;
+        reference.fetchMore(QModelIndex());
+        reference.fetchMore(QModelIndex());
+
+        UserTableModel model;
+        model.fetchMore(QModelIndex());
+        QVERIFY(!model.hasPrefetchedNext());
+
+        // The next page is read on the pool and taken by fetchMore()
+        model.prefetchAround(0);
+        QTRY_VERIFY(model.hasPrefetchedNext());
+        model.fetchMore(QModelIndex());
+        QVERIFY(!model.hasPrefetchedNext());
+        QCOMPARE(model.rowCount(), 2 * UserTableModel::kPageSize);
+        QCOMPARE(model.userId(UserTableModel::kPageSize), reference.userId(UserTableModel::kPageSize));
+
+        // A write while a read-ahead is in flight discards its result
+        model.prefetchAround(UserTableModel::kPageSize);
+        int userId = model.userId(0);
+        QVERIFY(AdminService::banUser(userId, "prefetch test").first);
+        QThreadPool::globalInstance()->waitForDone();
+        QCoreApplication::processEvents();
+        QVERIFY(!model.hasPrefetchedNext());
+        QVERIFY(AdminService::unbanUser(userId).first);
+
+        // A reload discards it too
+        model.prefetchAround(UserTableModel::kPageSize);
+        model.reload();
+        QThreadPool::globalInstance()->waitForDone();
+        QCoreApplication::processEvents();
+        QVERIFY(!model.hasPrefetchedNext());
+        QCOMPARE(model.rowCount(), 0);
+    }
+
+    void testSearchUsers() {
+        UserListResult exact = AdminService::searchUsers("00000012");
+        QVERIFY(exact.ok);
+        QCOMPARE(exact.users.size(), 1);
+        QCOMPARE(exact.users.phone(0), QString("13300000012"));
+
+        // Below trigram length the LIKE path is used; wildcards are literal
+        UserListResult shortText = AdminService::searchUsers("%");
+        QVERIFY(shortText.ok);
+        QCOMPARE(shortText.users.size(), 0);
+
+        // Keyset pages over a broad match cover each user once
+        QSet<int> seen;
+        ListCursor cursor;
+        while (true) {
+            UserListResult page = AdminService::searchUsers("1330000", cursor, 700);
+            QVERIFY(page.ok);
+            for (int i = 0; i < page.users.size(); ++i) {
+                QVERIFY(page.users.phone(i).contains("1330000"));
+                QVERIFY(!seen.contains(page.users.id(i)));
+                seen.insert(page.users.id(i));
+            }
+            if (page.users.size() < 700) {
+                break;
+            }
+            cursor = page.next;
+        }
+        QCOMPARE(seen.size(), 5000);
+
+        // Exact, then prefix, then anywhere; writes between pages do not
+        // move rows across the cursor
+        QVERIFY(DatabaseManager::getInstance().executeQuery(
+            "UPDATE users SET username = '1330000001' WHERE phone = '13300000019'"));
+        UserListResult ranked = AdminService::searchUsers("1330000001", ListCursor(), 5);
+        QVERIFY(ranked.ok);
+        QCOMPARE(ranked.users.size(), 5);
+        QCOMPARE(ranked.users.phone(0), QString("13300000019"));
+        QCOMPARE(ranked.next.rank, 1);
+        QVERIFY(AuthService::registerUser("13300099999", "searchpwd").first);
+        UserListResult rest = AdminService::searchUsers("1330000001", ranked.next, 100);
+        QVERIFY(rest.ok);
+        QCOMPARE(ranked.users.size() + rest.users.size(), 10);
+        for (int i = 0; i < rest.users.size(); ++i) {
+            QVERIFY(rest.users.id(i) > ranked.users.id(ranked.users.size() - 1));
+        }
+
+        // The banned filter applies to matches as well
+        int bannedId = ranked.users.id(2);
+        QVERIFY(AdminService::banUser(bannedId, "search test").first);
+        UserListResult banned = AdminService::searchUsers("1330000001", ListCursor(), 50, true);
+        QVERIFY(banned.ok);
+        QCOMPARE(banned.users.size(), 1);
+        QCOMPARE(banned.users.id(0), bannedId);
+        UserTableModel bannedModel;
+        bannedModel.setBannedOnly(true);
+        bannedModel.setSearchText("1330000001");
+        bannedModel.fetchMore(QModelIndex());
+        QCOMPARE(bannedModel.rowCount(), 1);
+        QVERIFY(AdminService::unbanUser(bannedId).first);
+
+        // Username changes reach the index through the triggers
+        int userId = exact.users.id(0);
+        QVERIFY(DatabaseManager::getInstance().executeQuery(
+            "UPDATE users SET username = 'zebrafinch' WHERE id = ?", {userId}));
+        UserListResult renamed = AdminService::searchUsers("rafin");
+        QVERIFY(renamed.ok);
+        QCOMPARE(renamed.users.size(), 1);
+        QCOMPARE(renamed.users.id(0), userId);
+
+        UserTableModel model;
+        model.setSearchText("zebra");
+        model.fetchMore(QModelIndex());
+        QCOMPARE(model.rowCount(), 1);
+        QCOMPARE(model.userId(0), userId);
+    }
+
+    void testReportModelUsesReportIds() {
+        QVERIFY(DatabaseManager::getInstance().executeQuery(
+            "INSERT INTO reports (reporter_id, reported_user_id, reason) "
+            "SELECT id, id + 1, 'spam' FROM users WHERE phone LIKE '133%' LIMIT 300"));
+
+        ReportTableModel model;
+        while (model.canFetchMore(QModelIndex())) {
+            model.fetchMore(QModelIndex());
+        }
+        QCOMPARE(model.rowCount(), countRows("SELECT COUNT(*) FROM reports"));
+
+        int lastRow = model.rowCount() - 1;
+        int id = model.reportId(lastRow);
+        QCOMPARE(model.data(model.index(lastRow, ReportTableModel::IdColumn)).toInt(), id);
+        QSqlQuery reason = DatabaseManager::getInstance().executeQueryWithResult(
+            "SELECT reason FROM reports WHERE id = ?", {id});
+        QVERIFY(reason.next());
+        QVERIFY(model.details(lastRow).contains(reason.value(0).toString()));
+    }
+};
+
+// main provided by tests_runner.cpp
+#include "test_tablemodels_qt.moc"
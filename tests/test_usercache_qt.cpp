@@ -0,0 +1,206 @@
+#include <QtTest>
+#include <QStandardPaths>
+#include <QFile>
+#include <QThread>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+
+#include "AdminService.h"
+#include "AuthService.h"
+#include "DatabaseManager.h"
+#include "UserCache.h"
+
+static void removeTestDatabaseUserCache()
+{
+    QString appData = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+    QString dbPath = appData + "/marketplace.db";
+    QFile f(dbPath);
+    if (f.exists()) f.remove();
+}
+
+static User cacheTestUser(int id)
+{
+    return User(id, QString("135%1").arg(id, 8, 10, QChar('0')), "hash", "cached",
+                QDateTime::currentDateTime(), false, false);
+}
+
+class UserCacheTest : public QObject {
+    Q_OBJECT
+
+private slots:
+    void initTestCase() {
+        QStandardPaths::setTestModeEnabled(true);
+        removeTestDatabaseUserCache();
+        DatabaseManager::getInstance();
+        m_capacity = UserCache::getInstance().capacity();
+    }
+
+    void cleanup() {
+        UserCache& cache = UserCache::getInstance();
+        cache.setCapacity(m_capacity);
+        cache.setMaxAgeMs(5000);
+        cache.clear();
+    }
+
+    void cleanupTestCase() {
+        removeTestDatabaseUserCache();
+    }
+
+    void testScanDoesNotFlushHotUsers() {
+        UserCache& cache = UserCache::getInstance();
+        cache.clear();
+        cache.setCapacity(256);
+
+        // Hot users come back between short runs of one-off lookups, the
+        // way logins interleave with listings
+        int next = 100000;
+        User found;
+        for (int round = 0; round < 10; ++round) {
+            for (int id = 1; id <= 32; ++id) {
+                if (!cache.findById(id, &found)) {
+                    cache.insert(cacheTestUser(id), cache.fillToken());
+                }
+            }
+            for (int i = 0; i < 64; ++i) {
+                cache.insert(cacheTestUser(next++), cache.fillToken());
+            }
+        }
+
+        // A scan twenty times the capacity; LRU would keep none of them
+        for (int i = 0; i < 5000; ++i) {
+            cache.insert(cacheTestUser(next++), cache.fillToken());
+        }
+        for (int id = 1; id <= 32; ++id) {
+            QVERIFY2(cache.findById(id, &found), qPrintable(QString("hot user %1 was evicted").arg(id)));
+        }
+        QVERIFY(cache.stats().size <= 256);
+        QVERIFY(cache.stats().evictions > 0);
+
+        // Phones lead to the same rows
+        QVERIFY(cache.findByPhone(cacheTestUser(7).getPhone(), &found));
+        QCOMPARE(found.getId(), 7);
+
+        // Expiry refills rows where they are; a hot row sent back to recent
+        // would not survive the next scan
+        cache.setMaxAgeMs(1);
+        QThread::msleep(5);
+        for (int id = 1; id <= 32; ++id) {
+            QVERIFY(!cache.findById(id, &found));
+            cache.insert(cacheTestUser(id), cache.fillToken());
+        }
+        cache.setMaxAgeMs(5000);
+        for (int i = 0; i < 5000; ++i) {
+            cache.insert(cacheTestUser(next++), cache.fillToken());
+        }
+        for (int id = 1; id <= 32; ++id) {
+            QVERIFY2(cache.findById(id, &found), qPrintable(QString("hot user %1 lost after expiry").arg(id)));
+        }
+    }
+
+    void testStaleFillIsDropped() {
+        UserCache& cache = UserCache::getInstance();
+        User found;
+
+        // Invalidated while the row was being read: the row may predate it
+        quint64 token = cache.fillToken();
+        cache.invalidate(42);
+        cache.insert(cacheTestUser(42), token);
+        QVERIFY(!cache.findById(42, &found));
+
+        cache.insert(cacheTestUser(42), cache.fillToken());
+        QVERIFY(cache.findById(42, &found));
+
+        cache.setMaxAgeMs(1);
+        cache.insert(cacheTestUser(43), cache.fillToken());
+        QThread::msleep(5);
+        QVERIFY(!cache.findById(43, &found));
+    }
+
+    void testServiceWritesInvalidate() {
+        UserCache& cache = UserCache::getInstance();
+        QString phone = "13500000001";
+        QPair<bool, User> created = AuthService::registerUser(phone, "cachepwd", "cached");
+        QVERIFY(created.first);
+        int id = created.second.getId();
+
+        // The first login reads the row, the second one is answered from the cache
+        QVERIFY(AuthService::loginUser(phone, "cachepwd").first);
+        UserCache::Stats before = cache.stats();
+        QVERIFY(AuthService::loginUser(phone, "cachepwd").first);
+        QVERIFY(!AuthService::loginUser(phone, "wrongpwd").first);
+        UserCache::Stats after = cache.stats();
+        QCOMPARE(after.hits, before.hits + 2);
+        QCOMPARE(after.misses, before.misses);
+        QVERIFY(after.hitRate() > 0);
+
+        QVERIFY(AdminService::banUser(id, "cache test").first);
+        QVERIFY(AuthService::isUserBanned(phone));
+        QVERIFY(AuthService::isUserBannedById(id));
+        QVERIFY(!AuthService::loginUser(phone, "cachepwd").first);
+
+        QCOMPARE(AdminService::unbanUsers({id}).changedCount, 1);
+        QVERIFY(!AuthService::isUserBanned(phone));
+        QVERIFY(AuthService::loginUser(phone, "cachepwd").first);
+        QVERIFY(cache.stats().invalidations > after.invalidations);
+    }
+
+    void testRawWritesClearTheCache() {
+        QString phone = "13500000002";
+        QVERIFY(AuthService::registerUser(phone, "cachepwd", "raw").first);
+        QVERIFY(AuthService::loginUser(phone, "cachepwd").first);
+        QVERIFY(UserCache::getInstance().stats().size > 0);
+
+        // Not through the service layer, so the cache cannot know the row
+        DatabaseManager& db = DatabaseManager::getInstance();
+        QVERIFY(db.executeQuery("UPDATE users SET is_banned = 1 WHERE phone = ?", {phone}));
+        QCOMPARE(UserCache::getInstance().stats().size, 0);
+        QVERIFY(AuthService::isUserBanned(phone));
+
+        QVERIFY(UserCache::changesUsers("  delete from users WHERE id = 1"));
+        QVERIFY(UserCache::changesUsers("UPDATE OR IGNORE users SET is_banned = 1"));
+        QVERIFY(UserCache::changesUsers("WITH doomed AS (SELECT 1) UPDATE\n    \"users\" SET is_banned = 1"));
+        QVERIFY(UserCache::changesUsers("INSERT INTO users (phone) VALUES (?) "
+                                        "ON CONFLICT(phone) DO UPDATE SET username = excluded.username"));
+        QVERIFY(UserCache::changesUsers("INSERT OR REPLACE INTO main.users (id) VALUES (1)"));
+        QVERIFY(!UserCache::changesUsers("DELETE FROM users_fts WHERE rowid = 1"));
+        QVERIFY(!UserCache::changesUsers("SELECT * FROM users"));
+        QVERIFY(!UserCache::changesUsers("INSERT INTO users (phone, password) VALUES (?, ?)"));
+        QVERIFY(!UserCache::changesUsers("UPDATE reports SET status = 'resolved', updated_at = 1"));
+    }
+
+    void testOtherConnectionsBanAtOnce() {
+        UserCache& cache = UserCache::getInstance();
+        QString phone = "13500000003";
+        QPair<bool, User> created = AuthService::registerUser(phone, "cachepwd", "remote");
+        QVERIFY(created.first);
+        QVERIFY(AuthService::loginUser(phone, "cachepwd").first);
+        User cached;
+        QVERIFY(cache.findByPhone(phone, &cached));
+        QVERIFY(!cached.isBanned());
+
+        // Another process: no execWithRetry(), no ChangeFeed, cache untouched
+        {
+            QSqlDatabase other = QSqlDatabase::addDatabase("QSQLITE", "usercache_other_process");
+            other.setDatabaseName(DatabaseManager::databasePath());
+            QVERIFY(other.open());
+            QSqlQuery ban(other);
+            QVERIFY(ban.prepare("UPDATE users SET is_banned = 1 WHERE phone = ?"));
+            ban.addBindValue(phone);
+            QVERIFY(ban.exec());
+            other.close();
+        }
+        QSqlDatabase::removeDatabase("usercache_other_process");
+
+        QVERIFY(AuthService::isUserBanned(phone));
+        QVERIFY(AuthService::isUserBannedById(created.second.getId()));
+        QVERIFY(!AuthService::loginUser(phone, "cachepwd").first);
+        // The stale row was dropped on the way
+        QVERIFY(!cache.findByPhone(phone, &cached) || cached.isBanned());
+    }
+
+private:
+    int m_capacity = 0;
+};
+
+// main provided by tests_runner.cpp
+#include "test_usercache_qt.moc"
@@ -0,0 +1,108 @@
+#include <QtTest>
+#include <QStandardPaths>
+#include <QFile>
+
+#include "AdminService.h"
+#include "AuthService.h"
+#include "DatabaseManager.h"
+#include "UserTable.h"
+
+static void removeTestDatabaseUserTable()
+{
+    QString appData = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+    QString dbPath = appData + "/marketplace.db";
+    QFile f(dbPath);
+    if (f.exists()) f.remove();
+}
+
+class UserTableTest : public QObject {
+    Q_OBJECT
+
+private slots:
+    void initTestCase() {
+        QStandardPaths::setTestModeEnabled(true);
+        removeTestDatabaseUserTable();
+        DatabaseManager::getInstance();
+
+        RegistrationBatch batch;
+        for (int i = 0; i < 2000; ++i) {
+            batch.phones.append(QString("137%1").arg(i, 8, 10, QChar('0')));
+            batch.passwords.append("tablepwd");
+            batch.usernames.append(QString("user%1").arg(i));
+        }
+        QCOMPARE(AuthService::registerUsers(batch).createdCount, 2000);
+    }
+
+    void testDefaultUserIsNotBanned() {
+        User user;
+        QVERIFY(!user.isBanned());
+        QVERIFY(!user.isAdmin());
+    }
+
+    void testRoundTrip() {
+        UserTable table;
+        QDateTime created = QDateTime::fromSecsSinceEpoch(1700000000, Qt::UTC);
+        table.append(7, "13912345678", "alice", created.toSecsSinceEpoch(), true, false);
+        table.append(8, "0123-x", "", 0, false, true);
+
+        QCOMPARE(table.size(), 2);
+        QCOMPARE(table.phone(0), QString("13912345678"));
+        QVERIFY(!(table.record(0).flags & CompactUser::PhoneInArena));
+        QCOMPARE(table.username(0), QString("alice"));
+        QCOMPARE(table.createdAt(0), created);
+        QVERIFY(table.isAdmin(0));
+        QCOMPARE(table.phone(1), QString("0123-x"));
+        QVERIFY(table.username(1).isEmpty());
+        QVERIFY(table.isBanned(1));
+
+        User view = table.at(0);
+        QCOMPARE(view.getId(), 7);
+        QCOMPARE(view.getPhone(), QString("13912345678"));
+        QVERIFY(view.isAdmin());
+
+        table.setBanned(0, true);
+        QVERIFY(table.isBanned(0));
+    }
+
+    void testBytesPerUser() {
+        QCOMPARE(sizeof(CompactUser), size_t(24));
+
+        UserListResult listing = AdminService::listUsers(0, 2000);
+        QVERIFY(listing.ok);
+        QVERIFY(listing.users.size() >= 2000);
+
+        double perUser = double(listing.users.memoryBytes()) / listing.users.size();
+        qDebug() << "UserTable bytes per user:" << perUser
+                 << "vs sizeof(User) before string payloads:" << sizeof(User);
+        QVERIFY(perUser < 48.0);
+    }
+
+    void testListingMatchesGetAllUsers() {
+        UserListResult compact = AdminService::listUsers(0, 50);
+        QPair<bool, QList<User>> legacy = AdminService::getAllUsers(0, 50);
+        QVERIFY(compact.ok && legacy.first);
+        QCOMPARE(compact.users.size(), legacy.second.size());
+        for (int i = 0; i < compact.users.size(); ++i) {
+            QCOMPARE(compact.users.id(i), legacy.second[i].getId());
+            QCOMPARE(compact.users.phone(i), legacy.second[i].getPhone());
+            QCOMPARE(compact.users.username(i), legacy.second[i].getUsername());
+        }
+    }
+
+    void benchListUsersCompact() {
+        QBENCHMARK {
+            UserListResult listing = AdminService::listUsers(0, 2000);
+            QVERIFY(listing.ok);
+        }
+    }
+
+    void benchGetAllUsers() {
+        QBENCHMARK {
+            QPair<bool, QList<User>> listing = AdminService::getAllUsers(0, 2000);
+            QVERIFY(listing.first);
+        }
+    }
+};
+
+// main provided by tests_runner.cpp
+#include "test_usertable_qt.moc"
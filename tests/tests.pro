@@ -1,17 +1,56 @@
 TEMPLATE = app
 CONFIG += console
-QT += core sql testlib
+QT += core gui sql testlib concurrent network
 CONFIG += c++17
 
 SOURCES += test_authservice_qt.cpp \
            test_databasemanager_qt.cpp \
            test_integration_qt.cpp \
            test_integration_ban_qt.cpp \
+           test_usertable_qt.cpp \
+           test_tablemodels_qt.cpp \
+           test_reports_qt.cpp \
+           test_auditlog_qt.cpp \
+           test_exporter_qt.cpp \
+           test_importer_qt.cpp \
+           test_changefeed_qt.cpp \
+           test_shardrouter_qt.cpp \
+           test_metrics_qt.cpp \
+           test_usercache_qt.cpp \
+           test_serviceprotocol_qt.cpp \
+           test_httpapi_qt.cpp \
            tests_runner.cpp
 
 # Link project implementation files so tests resolve symbols
-SOURCES += ../AuthService.cpp \
+SOURCES += ../AuditLog.cpp \
+           ../AuthService.cpp \
+           ../AutoBanPolicy.cpp \
+           ../BulkImporter.cpp \
+           ../ChangeFeed.cpp \
+           ../ChangeNotifier.cpp \
+           ../DataExporter.cpp \
+           ../AdminService.cpp \
            ../DatabaseManager.cpp \
-           ../User.cpp
+           ../Metrics.cpp \
+           ../Report.cpp \
+           ../ReportService.cpp \
+           ../ShardRouter.cpp \
+           ../User.cpp \
+           ../UserCache.cpp \
+           ../UserTable.cpp \
+           ../UserTableModel.cpp \
+           ../ReportTableModel.cpp
 
-INCLUDEPATH += ../
+# Daemon protocol code under test
+SOURCES += ../daemon/ApiToken.cpp \
+           ../daemon/HttpApiServer.cpp \
+           ../daemon/JsonWriter.cpp \
+           ../daemon/ServiceProtocol.cpp
+
+HEADERS += ../ChangeFeed.h \
+           ../ChangeNotifier.h \
+           ../UserTableModel.h \
+           ../ReportTableModel.h \
+           ../daemon/HttpApiServer.h
+
+INCLUDEPATH += ../ ../daemon
@@ -3,6 +3,18 @@
 #include "test_databasemanager_qt.cpp"
 #include "test_integration_qt.cpp"
 #include "test_integration_ban_qt.cpp"
+#include "test_usertable_qt.cpp"
+#include "test_tablemodels_qt.cpp"
+#include "test_reports_qt.cpp"
+#include "test_auditlog_qt.cpp"
+#include "test_exporter_qt.cpp"
+#include "test_importer_qt.cpp"
+#include "test_changefeed_qt.cpp"
+#include "test_shardrouter_qt.cpp"
+#include "test_metrics_qt.cpp"
+#include "test_usercache_qt.cpp"
+#include "test_serviceprotocol_qt.cpp"
+#include "test_httpapi_qt.cpp"
 
 int main(int argc, char** argv) {
     QCoreApplication app(argc, argv);
@@ -20,5 +32,41 @@ int main(int argc, char** argv) {
     IntegrationBanTest integrationBanTest;
     status |= QTest::qExec(&integrationBanTest, argc, argv);
 
+    UserTableTest userTableTest;
+    status |= QTest::qExec(&userTableTest, argc, argv);
+
+    TableModelTest tableModelTest;
+    status |= QTest::qExec(&tableModelTest, argc, argv);
+
+    ReportsTest reportsTest;
+    status |= QTest::qExec(&reportsTest, argc, argv);
+
+    AuditLogTest auditLogTest;
+    status |= QTest::qExec(&auditLogTest, argc, argv);
+
+    ExporterTest exporterTest;
+    status |= QTest::qExec(&exporterTest, argc, argv);
+
+    ImporterTest importerTest;
+    status |= QTest::qExec(&importerTest, argc, argv);
+
+    ChangeFeedTest changeFeedTest;
+    status |= QTest::qExec(&changeFeedTest, argc, argv);
+
+    ShardRouterTest shardRouterTest;
+    status |= QTest::qExec(&shardRouterTest, argc, argv);
+
+    MetricsTest metricsTest;
+    status |= QTest::qExec(&metricsTest, argc, argv);
+
+    UserCacheTest userCacheTest;
+    status |= QTest::qExec(&userCacheTest, argc, argv);
+
+    ServiceProtocolTest serviceProtocolTest;
+    status |= QTest::qExec(&serviceProtocolTest, argc, argv);
+
+    HttpApiTest httpApiTest;
+    status |= QTest::qExec(&httpApiTest, argc, argv);
+
     return status;
 }